@@ -65,6 +65,20 @@ cbuffer cbCamera : register( b0 )
 
 	float  c_max_sample_tap_distance;
 
+	uint   c_jitter_source;
+
+	uint   c_packed_velocity_depth;
+
+	uint   c_velocity_encoding;
+
+	float  c_clip_near;
+
+	float  c_clip_far;
+
+	uint   c_adaptive_samples;
+
+	float2 c_padding;
+
 };
 
 
@@ -79,10 +93,30 @@ cbuffer cbObject : register( b1 )
 
 	row_major matrix c_model_xform_normal_new;
 
+	float4 c_position_scale; // vs_scene_quantized.hlsl: position = unorm * scale + bias over the mesh bounds (xyz)
+
+	float4 c_position_bias;
+
 };
 
 
 
+// vs_scene_instanced.hlsl: one per instance (CPUBlur::InstanceTransforms), the x, y and z columns of the row-major
+
+// model transforms and of the normal transform into view space
+
+struct InstanceTransforms
+
+{
+
+	float4 model_new[3];
+
+	float4 model_old[3];
+
+	float4 normal_new[3];
+
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Constant and utilities
@@ -103,7 +137,7 @@ static const float EPSILON2                 =   0.001f;
 
 static const float HALF_VELOCITY_CUTOFF     =   0.25f;
 
-static const float SOFT_Z_EXTENT            =   0.10f;
+static const float SOFT_Z_EXTENT            =   0.10f; // View-space units with the linear depth prepass
 
 static const float CYLINDER_CORNER_1        =   0.95f;
 
@@ -115,6 +149,44 @@ static const float WEIGHT_CORRECTION_FACTOR =  60.0f;
 
 
 
+// Adaptive sample count (ps_tilesamples.hlsl): taps per pixel of blur length along NX, and the fewest taps a blurred tile gets
+
+static const float ADAPTIVE_TAPS_PER_PIXEL  =   1.0f;
+
+static const uint  ADAPTIVE_MIN_S           =   3;
+
+
+
+// c_jitter_source (JitterSource in cpu_blur/parameters.h)
+
+static const uint JITTER_RANDOM_TEXTURE       = 0;
+
+static const uint JITTER_BLUE_NOISE           = 1;
+
+static const uint JITTER_INTERLEAVED_GRADIENT = 2;
+
+static const uint BLUE_NOISE_SIZE             = 64;
+
+
+
+// c_velocity_encoding (VelocityEncoding in cpu_blur/velocity_encoding.h), the format of V, TileMax and NeighborMax
+
+static const uint VELOCITY_ENCODING_BIAS_SCALE = 0;
+
+static const uint VELOCITY_ENCODING_HALF_FLOAT = 1;
+
+static const uint VELOCITY_ENCODING_LOG_POLAR  = 2;
+
+static const float VELOCITY_LOG2_MIN = -8.0f;
+
+static const float VELOCITY_LOG2_MAX =  5.0f;
+
+static const float TWO_PI            =  6.28318531f;
+
+
+
+static const float2 VZERO = float2(0.0f, 0.0f);
+
 static const float2 VHALF = float2(0.5f, 0.5f);
 
 static const float2 VONE  = float2(1.0f, 1.0f);
@@ -151,6 +223,90 @@ float2 writeBiasScale(float2 v)
 
 
 
+// Half-velocity to texel of V, TileMax and NeighborMax. The log-polar format keeps 256 directions in x and, in y,
+
+// code 0 for zero or 1 to 255 for log2 of the length stepping evenly through [VELOCITY_LOG2_MIN, VELOCITY_LOG2_MAX].
+
+float2 encodeVelocity(float2 v)
+
+{
+
+	if (c_velocity_encoding == VELOCITY_ENCODING_HALF_FLOAT)
+
+	{
+
+		return v;
+
+	}
+
+	if (c_velocity_encoding == VELOCITY_ENCODING_LOG_POLAR)
+
+	{
+
+		float fLength = length(v);
+
+		float fMagnitude = (fLength > 0.0f) ? round((log2(fLength) - VELOCITY_LOG2_MIN) / (VELOCITY_LOG2_MAX - VELOCITY_LOG2_MIN) * 254.0f) : -1.0f;
+
+		if (fMagnitude < 0.0f)
+
+		{
+
+			return VZERO;
+
+		}
+
+		float fAngle = frac(atan2(v.y, v.x) / TWO_PI);
+
+		return float2(fmod(round(fAngle * 256.0f), 256.0f), min(fMagnitude, 254.0f) + 1.0f) / 255.0f;
+
+	}
+
+	return writeBiasScale(v);
+
+}
+
+
+
+float2 decodeVelocity(float2 texel)
+
+{
+
+	if (c_velocity_encoding == VELOCITY_ENCODING_HALF_FLOAT)
+
+	{
+
+		return texel;
+
+	}
+
+	if (c_velocity_encoding == VELOCITY_ENCODING_LOG_POLAR)
+
+	{
+
+		float2 code = round(texel * 255.0f);
+
+		if (code.y == 0.0f)
+
+		{
+
+			return VZERO;
+
+		}
+
+		float fLength = exp2(VELOCITY_LOG2_MIN + (code.y - 1.0f) * ((VELOCITY_LOG2_MAX - VELOCITY_LOG2_MIN) / 254.0f));
+
+		float fAngle = code.x * (TWO_PI / 256.0f);
+
+		return fLength * float2(cos(fAngle), sin(fAngle));
+
+	}
+
+	return readBiasScale(texel);
+
+}
+
+
+
 float2 textureSize(Texture2D tex)
 
 {
@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/cs_tilemax_neighbormax.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+#define GROUP_SIZE  16
+#define WINDOW_SIZE (GROUP_SIZE + 2)
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texVelocity : register(t0);
+
+RWTexture2D<float2> rwTileMax     : register(u0);
+RWTexture2D<float2> rwNeighborMax : register(u1);
+
+// TileMax of the group's tiles and a one-tile border around them, kept as the texel of V that won so that
+// NeighborMax sees exactly what it would read back from the R8G8 TileMax target
+groupshared float2 gsTileMax[WINDOW_SIZE][WINDOW_SIZE];
+
+////////////////////////////////////////////////////////////////////////////////
+// Compute Shader
+
+// The K x K loop of ps_tilemax.hlsl for one tile
+float2 tileMax(uint2 tile, float2 tileDims)
+{
+	float2 vOutput = encodeVelocity(VZERO);
+	float2 texCoordBase = (float2(tile) + VHALF) / tileDims;
+	float2 texCoordIncrement = float2(1, 1) / textureSize(texVelocity);
+	float fMaxMagnitudeSquared = 0.0;
+	for (int s = 0; s < c_K; ++s)
+	{
+		for (int t = 0; t < c_K; ++t)
+		{
+			float2 texCoords = texCoordBase + (float2(s, t) * texCoordIncrement);
+			float2 texLookup = texVelocity.SampleLevel(sampPointClamp, texCoords, 0).xy;
+			float2 vVelocity = decodeVelocity(texLookup);
+			float fMagnitudeSquared = dot(vVelocity, vVelocity);
+			if (fMaxMagnitudeSquared < fMagnitudeSquared)
+			{
+				vOutput = texLookup;
+				fMaxMagnitudeSquared = fMagnitudeSquared;
+			}
+		}
+	}
+	return vOutput;
+}
+
+// TileMax and NeighborMax in one pass. Each group computes TileMax for a (GROUP_SIZE + 2)^2 window of tiles into
+// groupshared memory, then NeighborMax for the GROUP_SIZE^2 tiles inside it, so TileMax is never read back from
+// memory. The border tiles are computed by both neighbouring groups.
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void main(uint3 groupId : SV_GroupID, uint3 groupThreadId : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+	uint tileWidth, tileHeight;
+	rwTileMax.GetDimensions(tileWidth, tileHeight);
+	float2 tileDims = float2(tileWidth, tileHeight);
+	int2 groupOrigin = int2(groupId.xy) * GROUP_SIZE;
+
+	// Border tiles outside the target are clamped to the edge, as sampPointClamp does in ps_neighbormax.hlsl
+	for (uint i = groupIndex; i < WINDOW_SIZE * WINDOW_SIZE; i += GROUP_SIZE * GROUP_SIZE)
+	{
+		int2 windowPos = int2(i % WINDOW_SIZE, i / WINDOW_SIZE);
+		int2 windowTile = clamp(groupOrigin + windowPos - IVONE, IVZERO, int2(tileWidth, tileHeight) - IVONE);
+		gsTileMax[windowPos.y][windowPos.x] = tileMax(uint2(windowTile), tileDims);
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	uint2 tile = uint2(groupOrigin) + groupThreadId.xy;
+	if (any(tile >= uint2(tileWidth, tileHeight)))
+	{
+		return;
+	}
+
+	int2 center = int2(groupThreadId.xy) + IVONE;
+	rwTileMax[tile] = gsTileMax[center.y][center.x];
+
+	// The 3x3 directional filter of ps_neighbormax.hlsl
+	float2 vOutput = encodeVelocity(VZERO);
+	float fMaxMagnitudeSquared = 0.0;
+	for (int s = -1; s <= 1; ++s)
+	{
+		for (int t = -1; t <= 1; ++t)
+		{
+			float2 texLookup = gsTileMax[center.y + t][center.x + s];
+			float2 vVelocity = decodeVelocity(texLookup);
+			float fMagnitudeSquared = dot(vVelocity, vVelocity);
+			if (fMaxMagnitudeSquared < fMagnitudeSquared)
+			{
+				float  fDisplacement = abs(float(s)) + abs(float(t));
+				float2 vOrientation = sign(float2(s, t) * vVelocity);
+				float  fDistance = vOrientation.x + vOrientation.y;
+				if (abs(fDistance) == fDisplacement)
+				{
+					vOutput = texLookup;
+					fMaxMagnitudeSquared = fMagnitudeSquared;
+				}
+			}
+		}
+	}
+	rwNeighborMax[tile] = vOutput;
+}
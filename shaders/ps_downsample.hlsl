@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/ps_downsample.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texColor    : register(t0);
+Texture2D texDepth    : register(t1);
+Texture2D texVelocity : register(t2);
+
+////////////////////////////////////////////////////////////////////////////////
+// IO Structures
+
+struct VS_OUTPUT
+{
+	float4 P  : SV_POSITION;
+	float2 TC : TEXCOORD0;
+};
+
+struct PS_OUTPUT
+{
+	float4 C : SV_Target0;
+	float  Z : SV_Target1;
+	float4 V : SV_Target2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+
+// Gather inputs of the half-resolution mode: the average color of the 2x2 footprint, and the depth and raw velocity
+// texel of its closest pixel, so that thin foreground objects keep their motion. Footprints on the last row or column
+// of an odd-sized target repeat the edge pixels.
+PS_OUTPUT main(VS_OUTPUT input)
+{
+	int2 dims = int2(textureSize(texColor));
+	int2 base = int2(input.P.xy) * 2;
+
+	PS_OUTPUT output;
+	output.C = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	output.Z = 0.0f;
+	output.V = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float closest = 0.0f;
+	[unroll]
+	for (int i = 0; i < 4; ++i)
+	{
+		int3 pixel = int3(min(base + int2(i & 1, i >> 1), dims - 1), 0);
+		output.C += 0.25f * texColor.Load(pixel);
+		float Z = texDepth.Load(pixel).r;
+		if (i == 0 || Z < closest)
+		{
+			closest = Z;
+			output.Z = Z;
+			output.V = texVelocity.Load(pixel);
+		}
+	}
+	return output;
+}
@@ -37,6 +37,20 @@
 
 
 
+// GATHER_S fixes the number of sample taps at compile time (see ps_gather_s*.hlsl); otherwise c_S is used
+
+#ifdef GATHER_S
+
+#define GATHER_TAP_COUNT GATHER_S
+
+#else
+
+#define GATHER_TAP_COUNT TapCount
+
+#endif
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Resources
@@ -53,6 +67,10 @@ Texture2D texNeighborMax : register(t3);
 
 Texture2D texRandom      : register(t4);
 
+Texture2D texVelocityDepth : register(t5); // (Z, TempV) from ps_pack_velocity_depth.hlsl, when c_packed_velocity_depth
+
+Texture2D<uint> texTileSamples : register(t6); // Per-tile tap count from ps_tilesamples.hlsl, when c_adaptive_samples
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -91,10 +109,44 @@ float getDepth(float2 UV)
 
 
 
-float pseudoRandom(float2 UV)
+float interleavedGradientNoise(float2 pixel)
 
 {
 
+	return frac(52.9829189f * frac(dot(pixel, float2(0.06711056f, 0.00583715f))));
+
+}
+
+
+
+float pseudoRandom(float2 UV, float2 pixel)
+
+{
+
+	// No texture: interleaved gradient noise of the integer pixel coordinates
+
+	if (c_jitter_source == JITTER_INTERLEAVED_GRADIENT)
+
+	{
+
+		return interleavedGradientNoise(floor(pixel)) - 0.5f;
+
+	}
+
+
+
+	// texRandom holds the blue-noise tile, repeated across the target
+
+	if (c_jitter_source == JITTER_BLUE_NOISE)
+
+	{
+
+		return texRandom.Load(int3(uint2(pixel) & (BLUE_NOISE_SIZE - 1), 0)).r - 0.5f;
+
+	}
+
+
+
 	// Scale up the texcoord and wrap to tile the random numbers across the target
 
 	return texRandom.SampleLevel(sampPointWrap, UV * c_K, 0).r - 0.5f;
@@ -125,7 +177,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 	// Sample from the NeighborMax buffer at X; holds dominant half-velocity for the current fragment's neighborhood tile
 
-	float2 NX = readBiasScale(texNeighborMax.Sample(sampPointClamp, X).xy);
+	float2 NX = decodeVelocity(texNeighborMax.Sample(sampPointClamp, X).xy);
 
 	float NXLength = length(NX);
 
@@ -169,7 +221,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 	// Sample from the primary half-velocity buffer at X
 
-	float2 VX = readBiasScale(texVelocity.Sample(sampPointClamp, X).xy);
+	float2 VX = decodeVelocity(texVelocity.Sample(sampPointClamp, X).xy);
 
 	float VXLength = length(VX);
 
@@ -197,7 +249,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 	// Random value in [-0.5, 0.5]
 
-	float R = pseudoRandom(X);
+	float R = pseudoRandom(X, input.P.xy);
 
 
 
@@ -213,9 +265,29 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 
 
+#ifndef GATHER_S
+
+	// Number of taps: the tile's own count in the adaptive mode, c_S otherwise
+
+	float TapCount = c_S;
+
+	if (c_adaptive_samples)
+
+	{
+
+		uint2 tileDim;
+
+		texTileSamples.GetDimensions(tileDim.x, tileDim.y);
+
+		TapCount = (float)texTileSamples.Load(int3(min(uint2(X * tileDim), tileDim - 1), 0));
+
+	}
+
+#endif
+
 	// Weight value (suggested by the article authors' implementation)
 
-	float Weight = c_S / WEIGHT_CORRECTION_FACTOR / TempVX;
+	float Weight = GATHER_TAP_COUNT / WEIGHT_CORRECTION_FACTOR / TempVX;
 
 
 
@@ -227,7 +299,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 	// Index for same fragment
 
-	int SelfIndex = (c_S - 1) / 2;
+	int SelfIndex = (GATHER_TAP_COUNT - 1) / 2;
 
 
 
@@ -237,11 +309,23 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 	float2 half_texel = VHALF / texDim.x;
 
+#ifdef GATHER_S
+
+	float JitterScale = 2.0f * max_sample_tap_distance / (GATHER_S + 1.0f);
+
+#endif
+
 
 
 	// Iterate once for each reconstruction sample tap
 
-	for (int i = 0; i < c_S; ++i)
+#ifdef GATHER_S
+
+	[unroll]
+
+#endif
+
+	for (int i = 0; i < GATHER_TAP_COUNT; ++i)
 
 	{
 
@@ -257,10 +341,20 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 		//       a little further
 
-		float lerp_amount = (float(i) + R + 1.0f) / (c_S + 1.0f);
+#ifdef GATHER_S
+
+		// Same as below, split into a per-tap constant offset in [-1, 1] and the jitter
+
+		float T = max_sample_tap_distance * (2.0f * float(i + 1) / (GATHER_S + 1.0f) - 1.0f) + R * JitterScale;
+
+#else
+
+		float lerp_amount = (float(i) + R + 1.0f) / (GATHER_TAP_COUNT + 1.0f);
 
 		float T = lerp(-max_sample_tap_distance, max_sample_tap_distance, lerp_amount);
 
+#endif
+
 
 
 		// The authors' implementation suggests alternating between the
@@ -277,37 +371,61 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 
 
-		// Sample from the primary half-velocity buffer at Y
+		float TempVY;
 
-		float2 VY = readBiasScale(texVelocity.SampleLevel(sampPointClamp, Y, 0).xy);
+		float ZY;
 
-		float VYLength = length(VY);
+		if (c_packed_velocity_depth)
 
+		{
 
+			// Depth and clamped half-velocity length at Y in one fetch
 
-		// Weighting, correcting and clamping half-velocity
+			float2 ZVY = texVelocityDepth.SampleLevel(sampPointClamp, Y, 0).xy;
 
-		float TempVY = VYLength * c_half_exposure;
+			ZY = ZVY.x;
 
-		bool FlagVY = (TempVY >= EPSILON1);
+			TempVY = ZVY.y;
 
-		TempVY = clamp(TempVY, 0.1f, c_K);
+		}
 
-		if (FlagVY)
+		else
 
 		{
 
-			VY *= (TempVY / VYLength);
+			// Sample from the primary half-velocity buffer at Y
 
-			VYLength = length(VY);
+			float2 VY = decodeVelocity(texVelocity.SampleLevel(sampPointClamp, Y, 0).xy);
 
-		}
+			float VYLength = length(VY);
+
+
+
+			// Weighting, correcting and clamping half-velocity
+
+			TempVY = VYLength * c_half_exposure;
 
+			bool FlagVY = (TempVY >= EPSILON1);
 
+			TempVY = clamp(TempVY, 0.1f, c_K);
 
-		// Sample from the depth buffer at Y
+			if (FlagVY)
 
-		float ZY = getDepth(Y);
+			{
+
+				VY *= (TempVY / VYLength);
+
+				VYLength = length(VY);
+
+			}
+
+
+
+			// Sample from the depth buffer at Y
+
+			ZY = getDepth(Y);
+
+		}
 
 
 
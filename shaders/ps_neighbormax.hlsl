@@ -75,7 +75,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 {
 
-	float4 vOutputColor = GRAY;
+	float4 vOutputColor = float4(encodeVelocity(VZERO), 0.5f, 1.0f);
 
 
 
@@ -97,7 +97,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 			float2 texLookup = texTileMax.SampleLevel(sampPointClamp, texCoords, 0).xy;
 
-			float2 vVelocity = readBiasScale(texLookup);
+			float2 vVelocity = decodeVelocity(texLookup);
 
 
 
@@ -119,7 +119,7 @@ float4 main(VS_OUTPUT input) : SV_Target0
 
 				{
 
-					vOutputColor.xy = writeBiasScale(vVelocity);
+					vOutputColor.xy = texLookup;
 
 					fMaxMagnitudeSquared = fMagnitudeSquared;
 
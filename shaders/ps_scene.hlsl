@@ -119,7 +119,7 @@ PS_OUTPUT main(VS_OUTPUT input)
 
 	vQX *= fWeight;
 
-	final.V = float4(writeBiasScale(vQX), 0.5f, 1.0f);
+	final.V = float4(encodeVelocity(vQX), 0.5f, 1.0f);
 
 
 
@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/ps_tileclassify.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texTileMax     : register(t0);
+Texture2D texNeighborMax : register(t1);
+
+// Tiles are appended as (ty << 16) | tx
+AppendStructuredBuffer<uint> tileListNoBlur  : register(u0);
+AppendStructuredBuffer<uint> tileListUniform : register(u1);
+AppendStructuredBuffer<uint> tileListComplex : register(u2);
+
+////////////////////////////////////////////////////////////////////////////////
+// IO Structures
+
+struct VS_OUTPUT
+{
+	float4 P  : SV_POSITION;
+	float2 TC : TEXCOORD0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+
+// Runs once per tile after NeighborMax and sorts the tile into one of three lists:
+//  - no blur: NeighborMax is below the gather's HALF_VELOCITY_CUTOFF, so the tile is a copy of C
+//  - uniform velocity: every TileMax in the 3x3 neighborhood equals the tile's NeighborMax
+//  - complex: everything else
+void main(VS_OUTPUT input)
+{
+	uint2 tile = uint2(input.P.xy);
+	uint packedTile = (tile.y << 16) | tile.x;
+
+	float2 texLookup = texNeighborMax.SampleLevel(sampPointClamp, input.TC, 0).xy;
+	float2 NX = decodeVelocity(texLookup);
+	float TempNX = clamp(length(NX) * c_half_exposure, 0.1f, c_K);
+	if (TempNX < HALF_VELOCITY_CUTOFF)
+	{
+		tileListNoBlur.Append(packedTile);
+		return;
+	}
+
+	float2 texCoordIncrement = float2(1, 1) / textureSize(texTileMax);
+	bool bUniform = true;
+	for (int s = -1; s <= 1; ++s)
+	{
+		for (int t = -1; t <= 1; ++t)
+		{
+			float2 texCoords = input.TC + (float2(s, t) * texCoordIncrement);
+			float2 vNeighbor = texTileMax.SampleLevel(sampPointClamp, texCoords, 0).xy;
+			bUniform = bUniform && all(vNeighbor == texLookup);
+		}
+	}
+
+	if (bUniform)
+	{
+		tileListUniform.Append(packedTile);
+	}
+	else
+	{
+		tileListComplex.Append(packedTile);
+	}
+}
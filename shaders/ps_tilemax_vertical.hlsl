@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/ps_tilemax_vertical.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texTileMaxHorizontal : register(t0);
+
+////////////////////////////////////////////////////////////////////////////////
+// IO Structures
+
+struct VS_OUTPUT
+{
+	float4 P  : SV_POSITION;
+	float2 TC : TEXCOORD0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+
+// Second stage of the separable TileMax: reduces K rows of the horizontal stage into the (w/K, h/K)
+// TileMax target. Equal magnitudes are resolved towards the smaller column index, and then towards
+// the smaller row, which selects the same texel as the K x K loop in ps_tilemax.hlsl.
+float4 main(VS_OUTPUT input) : SV_Target0
+{
+	float4 vOutputColor = float4(encodeVelocity(VZERO), 0.5f, 1.0f);
+
+	float2 texCoordBase = input.TC;
+	float2 texCoordIncrement = float2(1, 1) / textureSize(texTileMaxHorizontal);
+	float fMaxMagnitudeSquared = 0.0;
+	float fMaxColumn = 1.0;
+	for (int t = 0; t < c_K; ++t)
+	{
+		float2 texCoords = texCoordBase + (float2(0, t) * texCoordIncrement);
+		float4 texLookup = texTileMaxHorizontal.SampleLevel(sampPointClamp, texCoords, 0);
+		float2 vVelocity = decodeVelocity(texLookup.xy);
+
+		float fMagnitudeSquared = dot(vVelocity, vVelocity);
+		bool bSelected = (texLookup.w > 0.5f);
+		if (bSelected && ((fMaxMagnitudeSquared < fMagnitudeSquared) || (fMaxMagnitudeSquared == fMagnitudeSquared && texLookup.z < fMaxColumn)))
+		{
+			vOutputColor.xy = texLookup.xy;
+			fMaxMagnitudeSquared = fMagnitudeSquared;
+			fMaxColumn = texLookup.z;
+		}
+	}
+	return vOutputColor;
+}
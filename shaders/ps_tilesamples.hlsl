@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/ps_tilesamples.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texNeighborMax : register(t0);
+
+// Sum of the tap counts of all tiles, for the average shown under the frame rate
+RWByteAddressBuffer tapCountSum : register(u1);
+
+////////////////////////////////////////////////////////////////////////////////
+// IO Structures
+
+struct VS_OUTPUT
+{
+	float4 P  : SV_POSITION;
+	float2 TC : TEXCOORD0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+
+// Runs once per tile after NeighborMax and writes the number of gather taps for the tile into an R8_UINT target. The
+// NX taps reach TempNX * c_max_sample_tap_distance pixels to either side, which get ADAPTIVE_TAPS_PER_PIXEL taps each,
+// plus the centre; the count is clamped to [ADAPTIVE_MIN_S, c_S]. Tiles that take the gather's early-out get 0.
+uint main(VS_OUTPUT input) : SV_Target0
+{
+	float2 NX = decodeVelocity(texNeighborMax.Load(int3(int2(input.P.xy), 0)).xy);
+	float TempNX = clamp(length(NX) * c_half_exposure, 0.1f, c_K);
+
+	uint S = 0;
+	if (TempNX >= HALF_VELOCITY_CUTOFF)
+	{
+		float Reach = TempNX * c_max_sample_tap_distance;
+		S = 2 * (uint)ceil(Reach * ADAPTIVE_TAPS_PER_PIXEL) + 1;
+		S = min(max(S, ADAPTIVE_MIN_S), (uint)c_S);
+	}
+
+	tapCountSum.InterlockedAdd(0, S);
+	return S;
+}
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\assets\shaders/ps_upsample.hlsl
+// SDK Version: v1.2 
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "constants.hlsli"
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Resources
+
+Texture2D texColor        : register(t0);
+Texture2D texDepth        : register(t1);
+Texture2D texVelocity     : register(t2);
+Texture2D texNeighborMax  : register(t3);
+Texture2D texHalfDepth    : register(t4); // From ps_downsample.hlsl
+Texture2D texHalfVelocity : register(t5);
+Texture2D texHalfBlurred  : register(t6); // Output of the gather at half resolution
+
+////////////////////////////////////////////////////////////////////////////////
+// Constants
+
+// Each tap is scaled by 2^-(|dZ| / SOFT_Z_EXTENT + |dV| / UPSAMPLE_VELOCITY_EXTENT), dV in exposure-scaled half-velocity
+static const float UPSAMPLE_VELOCITY_EXTENT = 0.5f;
+
+// Below this total weight no tap resembles the pixel, and the most similar one is used alone
+static const float UPSAMPLE_MIN_WEIGHT      = 1.0e-4f;
+
+////////////////////////////////////////////////////////////////////////////////
+// IO Structures
+
+struct VS_OUTPUT
+{
+	float4 P  : SV_POSITION;
+	float2 TC : TEXCOORD0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+
+// Joint-bilateral upsample of the half-resolution gather, guided by the full-resolution Z and V: of the four texels a
+// bilinear fetch would blend, those across a depth edge or moving differently from the pixel are weighted down.
+float4 main(VS_OUTPUT input) : SV_Target0
+{
+	int2 pixel = int2(input.P.xy);
+	float4 CX = texColor.Load(int3(pixel, 0));
+
+	// Same early-out as the gather: without motion in the neighborhood the pixel is not blurred at all
+	float2 NX = decodeVelocity(texNeighborMax.Sample(sampPointClamp, input.TC).xy);
+	float TempNX = clamp(length(NX) * c_half_exposure, 0.1f, c_K);
+	if (TempNX < HALF_VELOCITY_CUTOFF)
+	{
+		return CX;
+	}
+
+	float ZX = texDepth.Load(int3(pixel, 0)).r;
+	float2 VX = decodeVelocity(texVelocity.Load(int3(pixel, 0)).xy);
+
+	// The centre of an even pixel lies a quarter texel right of the half-resolution texel centre to its left, an odd
+	// pixel a quarter texel left of the one to its right
+	int2 half_max = int2(textureSize(texHalfBlurred)) - 1;
+	int2 base = (pixel + 1) / 2 - 1;
+	float2 f = float2((pixel.x & 1) ? 0.25f : 0.75f, (pixel.y & 1) ? 0.25f : 0.75f);
+
+	float3 Sum = float3(0.0f, 0.0f, 0.0f);
+	float SumWeight = 0.0f;
+	float BestSimilarity = -1.0f;
+	float3 Best = CX.xyz;
+	[unroll]
+	for (int i = 0; i < 4; ++i)
+	{
+		int2 offset = int2(i & 1, i >> 1);
+		int3 texel = int3(clamp(base + offset, int2(0, 0), half_max), 0);
+		float2 bilinear = lerp(1.0f - f, f, float2(offset));
+
+		float2 dV = (decodeVelocity(texHalfVelocity.Load(texel).xy) - VX) * c_half_exposure;
+		float Similarity = exp2(-(abs(texHalfDepth.Load(texel).r - ZX) / SOFT_Z_EXTENT + length(dV) / UPSAMPLE_VELOCITY_EXTENT));
+		float Weight = bilinear.x * bilinear.y * Similarity;
+
+		float3 CY = texHalfBlurred.Load(texel).xyz;
+		Sum += Weight * CY;
+		SumWeight += Weight;
+		if (Similarity > BestSimilarity)
+		{
+			BestSimilarity = Similarity;
+			Best = CY;
+		}
+	}
+
+	if (SumWeight < UPSAMPLE_MIN_WEIGHT)
+	{
+		return float4(Best, 1);
+	}
+	return float4(Sum / SumWeight, 1);
+}
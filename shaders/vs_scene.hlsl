@@ -43,6 +43,58 @@
 
 
 
+#ifdef SCENE_QUANTIZED_VERTICES
+
+// One interleaved stream (Scene::QuantizedVertex): R16G16B16A16_UNORM position over the mesh bounds, R16G16_SNORM
+
+// octahedral normal and R16G16_FLOAT texture coordinates
+
+struct VS_INPUT
+
+{
+
+	float4 Position : POSITION0;
+
+	float2 Normal   : NORMAL0;
+
+	float2 TexCoord : TEXCOORD0;
+
+#ifdef SCENE_INSTANCED
+
+	uint InstanceID : SV_InstanceID;
+
+#endif
+
+};
+
+
+
+float3 decodePosition(VS_INPUT input)
+
+{
+
+	return input.Position.xyz * c_position_scale.xyz + c_position_bias.xyz;
+
+}
+
+
+
+float3 decodeNormal(VS_INPUT input)
+
+{
+
+	float3 n = float3(input.Normal, 1.0f - abs(input.Normal.x) - abs(input.Normal.y));
+
+	float t = saturate(-n.z);
+
+	n.xy += (n.xy >= 0.0f) ? -t : t;
+
+	return normalize(n);
+
+}
+
+#else
+
 struct VS_INPUT
 
 {
@@ -53,10 +105,114 @@ struct VS_INPUT
 
 	float2 TexCoord : TEXCOORD0;
 
+#ifdef SCENE_INSTANCED
+
+	uint InstanceID : SV_InstanceID;
+
+#endif
+
 };
 
 
 
+float3 decodePosition(VS_INPUT input)
+
+{
+
+	return input.Position;
+
+}
+
+
+
+float3 decodeNormal(VS_INPUT input)
+
+{
+
+	return input.Normal;
+
+}
+
+#endif
+
+
+
+#ifdef SCENE_INSTANCED
+
+// Per-instance transforms from one structured buffer; the cbObject matrices are not read
+
+StructuredBuffer<InstanceTransforms> t_instances : register(t0);
+
+
+
+float3 transformModelNew(VS_INPUT input, float3 p)
+
+{
+
+	InstanceTransforms instance = t_instances[input.InstanceID];
+
+	return float3(dot(float4(p, 1), instance.model_new[0]), dot(float4(p, 1), instance.model_new[1]), dot(float4(p, 1), instance.model_new[2]));
+
+}
+
+
+
+float3 transformModelOld(VS_INPUT input, float3 p)
+
+{
+
+	InstanceTransforms instance = t_instances[input.InstanceID];
+
+	return float3(dot(float4(p, 1), instance.model_old[0]), dot(float4(p, 1), instance.model_old[1]), dot(float4(p, 1), instance.model_old[2]));
+
+}
+
+
+
+float3 transformNormal(VS_INPUT input, float3 n)
+
+{
+
+	InstanceTransforms instance = t_instances[input.InstanceID];
+
+	return float3(dot(n, instance.normal_new[0].xyz), dot(n, instance.normal_new[1].xyz), dot(n, instance.normal_new[2].xyz));
+
+}
+
+#else
+
+float3 transformModelNew(VS_INPUT input, float3 p)
+
+{
+
+	return mul(float4(p, 1), c_model_xform_new).xyz;
+
+}
+
+
+
+float3 transformModelOld(VS_INPUT input, float3 p)
+
+{
+
+	return mul(float4(p, 1), c_model_xform_old).xyz;
+
+}
+
+
+
+float3 transformNormal(VS_INPUT input, float3 n)
+
+{
+
+	return mul(float4(n, 1), c_model_xform_normal_new).xyz;
+
+}
+
+#endif
+
+
+
 struct VS_OUTPUT
 
 {
@@ -99,9 +255,11 @@ VS_OUTPUT main( VS_INPUT input )
 
 	VS_OUTPUT output;
 
-	float3 PNew_Local = mul(float4(input.Position, 1), c_model_xform_new).xyz;
+	float3 position = decodePosition(input);
+
+	float3 PNew_Local = transformModelNew(input, position);
 
-	float3 POld_Local = mul(float4(input.Position, 1), c_model_xform_old).xyz;
+	float3 POld_Local = transformModelOld(input, position);
 
 
 
@@ -121,7 +279,7 @@ VS_OUTPUT main( VS_INPUT input )
 
 
 
-	float3 normal = mul(float4(input.Normal, 1), c_model_xform_normal_new).xyz;
+	float3 normal = transformNormal(input, decodeNormal(input));
 
 	float3 light_dir = normalize(light_pos);
 
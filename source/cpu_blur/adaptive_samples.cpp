@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/adaptive_samples.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "adaptive_samples.h"
+#include <math.h>
+#include <vector>
+#include "tile_classification.h"
+
+namespace CPUBlur
+{
+    uint32_t compute_tile_sample_count(Unorm8x2 neighbor_max, Parameters const &params)
+    {
+        // Same test as the gather's early-out
+        float temp_NX = clamp(length(read_velocity(neighbor_max)) * params.half_exposure, 0.1f, float(params.K));
+        if (temp_NX < HALF_VELOCITY_CUTOFF)
+        {
+            return 0;
+        }
+
+        // The NX taps reach TempNX * max_sample_tap_distance pixels to either side of the pixel
+        float reach = temp_NX * params.max_sample_tap_distance;
+        uint32_t S = 2 * uint32_t(ceilf(reach * ADAPTIVE_TAPS_PER_PIXEL)) + 1;
+        return std::min(std::max(S, ADAPTIVE_MIN_S), params.S);
+    }
+
+    void compute_tile_sample_counts(VelocityImage const &neighbor_max, Parameters const &params, TileSampleImage &out)
+    {
+        out.resize(neighbor_max.get_width(), neighbor_max.get_height());
+        for (uint32_t ty = 0; ty < neighbor_max.get_height(); ++ty)
+        {
+            for (uint32_t tx = 0; tx < neighbor_max.get_width(); ++tx)
+            {
+                out.at(tx, ty) = uint8_t(compute_tile_sample_count(neighbor_max.at(tx, ty), params));
+            }
+        }
+    }
+
+    float compute_average_taps_per_pixel(TileSampleImage const &tile_samples, uint32_t width, uint32_t height)
+    {
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(width, tile_samples.get_width(), first_x);
+        compute_tile_pixel_ranges(height, tile_samples.get_height(), first_y);
+
+        uint64_t taps = 0;
+        for (uint32_t ty = 0; ty < tile_samples.get_height(); ++ty)
+        {
+            for (uint32_t tx = 0; tx < tile_samples.get_width(); ++tx)
+            {
+                uint64_t pixels = uint64_t(first_x[tx + 1] - first_x[tx]) * (first_y[ty + 1] - first_y[ty]);
+                taps += pixels * tile_samples.at(tx, ty);
+            }
+        }
+        return float(double(taps) / (double(width) * double(height)));
+    }
+
+    void gather_adaptive(Inputs const &inputs, Parameters const &params, TileSampleImage const &tile_samples, ColorImage &out, ThreadPool &pool, SimdLevel level)
+    {
+        uint32_t tile_width = tile_samples.get_width();
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(out.get_width(), tile_width, first_x);
+        compute_tile_pixel_ranges(out.get_height(), tile_samples.get_height(), first_y);
+
+        // One kernel per tap count that occurs, looked up once
+        GatherSpanFunction gather_spans[256];
+        for (uint32_t S = 1; S <= params.S && S < 256; ++S)
+        {
+            gather_spans[S] = get_gather_span_function(level, S);
+        }
+
+        pool.parallel_rows(tile_samples.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            Parameters tile_params = params;
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    uint32_t S = tile_samples.at(tx, ty);
+                    tile_params.S = S;
+                    for (uint32_t y = first_y[ty]; y < first_y[ty + 1]; ++y)
+                    {
+                        if (S == 0)
+                        {
+                            Float4 const *src = inputs.color->row(y);
+                            std::copy(src + first_x[tx], src + first_x[tx + 1], out.row(y) + first_x[tx]);
+                        }
+                        else
+                        {
+                            gather_spans[S](inputs, tile_params, y, first_x[tx], first_x[tx + 1], out.row(y));
+                        }
+                    }
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,56 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/adaptive_samples.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// CPU counterpart of ps_tilesamples.hlsl: instead of the global S, each tile gathers with a tap count proportional to
+// the blur length of its NeighborMax, ADAPTIVE_TAPS_PER_PIXEL taps per pixel, odd and clamped to
+// [ADAPTIVE_MIN_S, params.S]. Tiles that take the HALF_VELOCITY_CUTOFF early-out get 0.
+
+namespace CPUBlur
+{
+    uint32_t compute_tile_sample_count(Unorm8x2 neighbor_max, Parameters const &params);
+    void compute_tile_sample_counts(VelocityImage const &neighbor_max, Parameters const &params, TileSampleImage &out);
+
+    // Mean of the tap counts over the pixels of a (width, height) frame, early-out pixels counting as 0
+    float compute_average_taps_per_pixel(TileSampleImage const &tile_samples, uint32_t width, uint32_t height);
+
+    // gather_simd with each tile's tap count taken from tile_samples, through the kernel specialized for it where there
+    // is one; tiles at 0 are copied from C
+    void gather_adaptive(Inputs const &inputs, Parameters const &params, TileSampleImage const &tile_samples, ColorImage &out, ThreadPool &pool, SimdLevel level);
+}
@@ -0,0 +1,1845 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/benchmark.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "benchmark.h"
+#include <string.h>
+#include <mutex>
+#include <vector>
+#include "adaptive_samples.h"
+#include "blocked_gather.h"
+#include "fused_tile_max.h"
+#include "half_resolution.h"
+#include "incremental_tiles.h"
+#include "instance_transforms.h"
+#include "jitter.h"
+#include "reconstruction.h"
+#include "scheduled_gather.h"
+#include "separable_tile_max.h"
+#include "simd_gather.h"
+#include "software_rasterizer.h"
+#include "tile_classification.h"
+#include "uniform_velocity.h"
+#include "velocity_encoding.h"
+#include "../mesh_optimizer.h"
+#include "../mesh_pack.h"
+#include "../render_queue.h"
+#include "../vertex_quantization.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const uint32_t BENCHMARK_REPETITIONS = 5;
+
+    // Best of BENCHMARK_REPETITIONS runs, in milliseconds
+    template <typename F>
+    double time_best_of(F const &fn)
+    {
+        double best = 0.0;
+        for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+        {
+            CPUBlur::Stopwatch stopwatch;
+            stopwatch.start();
+            fn();
+            stopwatch.stop();
+            best = (repetition == 0) ? stopwatch.milliseconds() : std::min(best, stopwatch.milliseconds());
+        }
+        return best;
+    }
+
+    // L1D read misses and last-level cache misses of the calling thread, from perf_event_open. Unavailable outside
+    // Linux, and where the kernel or the hypervisor does not expose the hardware counters.
+    class CacheMissCounters
+    {
+    public:
+        CacheMissCounters()
+        {
+            this->error = 0;
+            this->fds[0] = this->fds[1] = -1;
+#if defined(__linux__)
+            uint64_t configs[2][2] = {
+                {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}};
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = uint32_t(configs[i][0]);
+                attr.config = configs[i][1];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                this->fds[i] = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+                if (this->fds[i] < 0)
+                {
+                    this->error = errno;
+                }
+            }
+#else
+            this->error = -1;
+#endif
+        }
+
+        ~CacheMissCounters()
+        {
+#if defined(__linux__)
+            for (int fd : this->fds)
+            {
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        bool is_available() const { return this->error == 0; }
+        const char *get_error() const { return (this->error > 0) ? strerror(this->error) : "not supported on this platform"; }
+
+        // Counts over one call of fn: l1d_misses and llc_misses
+        template <typename F>
+        void measure(F const &fn, uint64_t &l1d_misses, uint64_t &llc_misses)
+        {
+            l1d_misses = llc_misses = 0;
+            if (!this->is_available())
+            {
+                fn();
+                return;
+            }
+#if defined(__linux__)
+            for (int fd : this->fds)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+            fn();
+            for (int fd : this->fds)
+            {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+            if (read(this->fds[0], &l1d_misses, sizeof(l1d_misses)) != sizeof(l1d_misses) ||
+                read(this->fds[1], &llc_misses, sizeof(llc_misses)) != sizeof(llc_misses))
+            {
+                l1d_misses = llc_misses = 0;
+            }
+#endif
+        }
+
+    private:
+        CacheMissCounters(CacheMissCounters const &);
+        CacheMissCounters &operator=(CacheMissCounters const &);
+
+        int error;
+        int fds[2];
+    };
+
+    // Fraction of the AC power of a size x size window of jitter values at spatial frequencies below size / 8 cycles.
+    // About 5% for white noise; blue noise pushes it towards 0, which is what hides the jitter as fine grain.
+    double low_frequency_energy(std::vector<float> const &values, uint32_t size)
+    {
+        const double two_pi = 6.283185307179586;
+        double mean = 0.0;
+        for (float v : values)
+        {
+            mean += v;
+        }
+        mean /= double(values.size());
+
+        double total = 0.0;
+        double low = 0.0;
+        for (uint32_t fy = 0; fy < size; ++fy)
+        {
+            for (uint32_t fx = 0; fx < size; ++fx)
+            {
+                if (fx == 0 && fy == 0)
+                {
+                    continue;
+                }
+                double re = 0.0, im = 0.0;
+                for (uint32_t y = 0; y < size; ++y)
+                {
+                    for (uint32_t x = 0; x < size; ++x)
+                    {
+                        double phase = two_pi * (double(fx * x) + double(fy * y)) / double(size);
+                        double v = values[y * size + x] - mean;
+                        re += v * cos(phase);
+                        im -= v * sin(phase);
+                    }
+                }
+                double power = re * re + im * im;
+                int32_t kx = (fx <= size / 2) ? int32_t(fx) : int32_t(fx) - int32_t(size);
+                int32_t ky = (fy <= size / 2) ? int32_t(fy) : int32_t(fy) - int32_t(size);
+                total += power;
+                low += (kx * kx + ky * ky < int32_t(size * size / 64)) ? power : 0.0;
+            }
+        }
+        return low / total;
+    }
+
+    // V of make_test_frame before quantization, with the disk spinning K times faster and the length weighting of
+    // ps_scene.hlsl, so that lengths run from about 0.05 near the centre up to K at the rim
+    void make_velocity_field(uint32_t width, uint32_t height, uint32_t K, CPUBlur::VelocityFieldImage &velocity)
+    {
+        velocity.resize(width, height);
+
+        float center_x = 0.5f * float(width);
+        float center_y = 0.5f * float(height);
+        float radius = 0.35f * float(height);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                float dx = float(x) + 0.5f - center_x;
+                float dy = float(y) + 0.5f - center_y;
+                CPUBlur::Float2 v = {0.0f, 0.0f};
+                if ((dx * dx + dy * dy) < (radius * radius))
+                {
+                    v.x = -dy / radius * float(K);
+                    v.y = dx / radius * float(K);
+                    float v_length = CPUBlur::length(v);
+                    float weight = std::max(0.5f, std::min(v_length, float(K))) / (v_length + CPUBlur::EPSILON1);
+                    v.x *= weight;
+                    v.y *= weight;
+                }
+                velocity.at(x, y) = v;
+            }
+        }
+    }
+
+    // Over RGB, for colors in [0, 1]
+    double psnr(CPUBlur::ColorImage const &a, CPUBlur::ColorImage const &b)
+    {
+        double squared_error = 0.0;
+        uint32_t count = a.get_width() * a.get_height();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            CPUBlur::Float4 const &p = a.data()[i];
+            CPUBlur::Float4 const &q = b.data()[i];
+            squared_error += (double(p.x - q.x) * (p.x - q.x) + double(p.y - q.y) * (p.y - q.y) + double(p.z - q.z) * (p.z - q.z)) / 3.0;
+        }
+        double mse = squared_error / double(count);
+        return (mse > 0.0) ? 10.0 * log10(1.0 / mse) : HUGE_VAL;
+    }
+
+    // DirectX::XMMatrixLookAtLH
+    CPUBlur::Float4x4 look_at_lh(CPUBlur::Float3 eye, CPUBlur::Float3 at, CPUBlur::Float3 up)
+    {
+        CPUBlur::Float3 z = {at.x - eye.x, at.y - eye.y, at.z - eye.z};
+        float z_length = sqrtf(z.x * z.x + z.y * z.y + z.z * z.z);
+        z = {z.x / z_length, z.y / z_length, z.z / z_length};
+        CPUBlur::Float3 x = {up.y * z.z - up.z * z.y, up.z * z.x - up.x * z.z, up.x * z.y - up.y * z.x};
+        float x_length = sqrtf(x.x * x.x + x.y * x.y + x.z * x.z);
+        x = {x.x / x_length, x.y / x_length, x.z / x_length};
+        CPUBlur::Float3 y = {z.y * x.z - z.z * x.y, z.z * x.x - z.x * x.z, z.x * x.y - z.y * x.x};
+
+        CPUBlur::Float4x4 result = {{{x.x, y.x, z.x, 0.0f},
+                                     {x.y, y.y, z.y, 0.0f},
+                                     {x.z, y.z, z.z, 0.0f},
+                                     {-(x.x * eye.x + x.y * eye.y + x.z * eye.z), -(y.x * eye.x + y.y * eye.y + y.z * eye.z), -(z.x * eye.x + z.y * eye.y + z.z * eye.z), 1.0f}}};
+        return result;
+    }
+
+    // DirectX::XMMatrixPerspectiveFovLH
+    CPUBlur::Float4x4 perspective_fov_lh(float fov_y, float aspect_ratio, float z_near, float z_far)
+    {
+        float y_scale = 1.0f / tanf(0.5f * fov_y);
+        float range = z_far / (z_far - z_near);
+        CPUBlur::Float4x4 result = {{{y_scale / aspect_ratio, 0.0f, 0.0f, 0.0f},
+                                     {0.0f, y_scale, 0.0f, 0.0f},
+                                     {0.0f, 0.0f, range, 1.0f},
+                                     {0.0f, 0.0f, -range * z_near, 0.0f}}};
+        return result;
+    }
+
+    // Rotation of the fan blades about their hub, as in BlurSample::Render
+    CPUBlur::Float4x4 fan_blades_xform(float degrees)
+    {
+        const CPUBlur::Float3 hub = {0.0f, 8.74925041f, 2.67939997f};
+        float s = sinf(degrees * 3.14159265f / 180.0f);
+        float c = cosf(degrees * 3.14159265f / 180.0f);
+        CPUBlur::Float4x4 to_origin = CPUBlur::identity_matrix();
+        to_origin.m[3][0] = -hub.x;
+        to_origin.m[3][1] = -hub.y;
+        to_origin.m[3][2] = -hub.z;
+        CPUBlur::Float4x4 rotation = {{{c, s, 0.0f, 0.0f}, {-s, c, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}};
+        CPUBlur::Float4x4 to_world = CPUBlur::identity_matrix();
+        to_world.m[3][0] = hub.x;
+        to_world.m[3][1] = hub.y;
+        to_world.m[3][2] = hub.z;
+        return CPUBlur::multiply(CPUBlur::multiply(to_origin, rotation), to_world);
+    }
+
+    // Inverse transpose of a rigid model-view transform; its translation only reaches w
+    CPUBlur::Float4x4 rigid_normal_xform(CPUBlur::Float4x4 const &model, CPUBlur::Float4x4 const &view)
+    {
+        CPUBlur::Float4x4 result = CPUBlur::multiply(model, view);
+        result.m[3][0] = result.m[3][1] = result.m[3][2] = 0.0f;
+        return result;
+    }
+
+    // The sample's default camera (CAMERA_CLIP_NEAR/FAR), exposure and sail speed at 60 frames per second
+    const float WINDMILL_FRAME_RATE = 60.0f;
+    const float WINDMILL_SAIL_SPEED = 350.0f;
+    const float WINDMILL_CLIP_NEAR = 1.0f;
+    const float WINDMILL_CLIP_FAR = 100.0f;
+
+    // The pack written by MeshPackConverter, looked for from the working directory up to the repository root (the
+    // executables land in build/bin/<platform>/<configuration>). Mapped once and kept for the life of the process.
+    Scene::MeshPackFile const &get_windmill_mesh_pack()
+    {
+        static Scene::MeshPackFile pack;
+        static bool searched = false;
+        if (!searched)
+        {
+            searched = true;
+            const char *const paths[] = {"windmill.meshpack", "media/windmill.meshpack", "../media/windmill.meshpack", "../../media/windmill.meshpack", "../../../media/windmill.meshpack", "../../../../media/windmill.meshpack"};
+            for (uint32_t i = 0; i < sizeof(paths) / sizeof(paths[0]) && !pack.is_open(); ++i)
+            {
+                pack.open(paths[i]);
+            }
+            if (!pack.is_open())
+            {
+                fprintf(stderr, "windmill.meshpack not found; the windmill frame will be empty\n");
+            }
+        }
+        return pack;
+    }
+
+    // A mesh from the windmill pack, or an empty one if the pack or the mesh is missing
+    CPUBlur::Mesh get_windmill_mesh(char const *name)
+    {
+        Scene::MeshStreams streams;
+        if (!get_windmill_mesh_pack().find_mesh(name, streams))
+        {
+            return CPUBlur::Mesh{0, nullptr, 0, nullptr, nullptr, nullptr};
+        }
+        return CPUBlur::Mesh{streams.num_faces, streams.indices, streams.num_vertices, streams.vertices, streams.normals, streams.texture_coords};
+    }
+
+    struct WindmillScene
+    {
+        CPUBlur::SceneCamera camera;
+        CPUBlur::Mesh house;
+        CPUBlur::Mesh fan;
+        CPUBlur::SceneObject objects[2];
+
+        WindmillScene(uint32_t width, uint32_t height)
+        {
+            this->camera.projection_xform = perspective_fov_lh(3.14159265f / 4.0f, float(width) / float(height), WINDMILL_CLIP_NEAR, WINDMILL_CLIP_FAR);
+            this->camera.world_xform_new = this->camera.world_xform_old = CPUBlur::identity_matrix();
+            this->camera.view_xform_new = this->camera.view_xform_old = look_at_lh(CPUBlur::Float3{0.0f, 10.0f, -20.0f}, CPUBlur::Float3{0.0f, 10.0f, 0.0f}, CPUBlur::Float3{0.0f, 1.0f, 0.0f});
+            this->camera.half_exposure_x_framerate = 0.5f * WINDMILL_FRAME_RATE;
+            this->camera.K = 20.0f;
+
+            this->house = get_windmill_mesh("house");
+            this->fan = get_windmill_mesh("fan");
+            this->objects[0].mesh = &this->house;
+            this->objects[0].model_xform_new = this->objects[0].model_xform_old = this->objects[0].model_xform_normal_new = CPUBlur::identity_matrix();
+            this->objects[0].diffuse = nullptr;
+            this->objects[1].mesh = &this->fan;
+            this->objects[1].model_xform_old = fan_blades_xform(0.0f);
+            this->objects[1].model_xform_new = fan_blades_xform(WINDMILL_SAIL_SPEED / WINDMILL_FRAME_RATE);
+            this->objects[1].model_xform_normal_new = rigid_normal_xform(this->objects[1].model_xform_new, this->camera.view_xform_new);
+            this->objects[1].diffuse = nullptr;
+        }
+    };
+
+    // The spinning disk, and the software-rasterized windmill with linear depth
+    const char *const DISK_AND_WINDMILL_FRAME_NAMES[2] = {"disk", "windmill"};
+
+    void make_disk_and_windmill_frames(uint32_t width, uint32_t height, CPUBlur::TestFrame frames[2], CPUBlur::ThreadPool &pool)
+    {
+        CPUBlur::make_test_frame(width, height, frames[0]);
+
+        WindmillScene scene(width, height);
+        frames[1].color.resize(width, height);
+        frames[1].depth.resize(width, height);
+        frames[1].velocity.resize(width, height);
+        CPUBlur::SoftwareRasterizer rasterizer;
+        rasterizer.render(scene.camera, scene.objects, 2, nullptr, frames[1].color, frames[1].depth, frames[1].velocity, pool);
+        CPUBlur::DepthImage windmill_depth = frames[1].depth;
+        CPUBlur::linear_depth(windmill_depth, WINDMILL_CLIP_NEAR, WINDMILL_CLIP_FAR, frames[1].depth, pool);
+    }
+
+    // The disk frame seen from a camera panning at a constant rate: the background moves as one
+    const CPUBlur::Float2 PANNING_VELOCITY = {0.6f, 0.25f};
+
+    void make_panning_frame(uint32_t width, uint32_t height, CPUBlur::TestFrame &frame)
+    {
+        CPUBlur::make_test_frame(width, height, frame);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                if (frame.depth.at(x, y) > 0.5f)
+                {
+                    frame.velocity.at(x, y) = CPUBlur::write_velocity(PANNING_VELOCITY);
+                }
+            }
+        }
+    }
+}
+
+namespace CPUBlur
+{
+    void make_test_frame(uint32_t width, uint32_t height, TestFrame &frame)
+    {
+        frame.color.resize(width, height);
+        frame.depth.resize(width, height);
+        frame.velocity.resize(width, height);
+
+        float center_x = 0.5f * float(width);
+        float center_y = 0.5f * float(height);
+        float radius = 0.35f * float(height);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                float dx = float(x) + 0.5f - center_x;
+                float dy = float(y) + 0.5f - center_y;
+                bool on_disk = (dx * dx + dy * dy) < (radius * radius);
+
+                Float4 c = {
+                    float((x / 8 + y / 8) & 1) * 0.75f + 0.125f,
+                    float(x % 64) / 64.0f,
+                    float(y % 48) / 48.0f,
+                    1.0f};
+                frame.color.at(x, y) = c;
+
+                frame.depth.at(x, y) = on_disk ? 0.35f : 0.95f;
+
+                // Tangential velocity growing with the distance from the centre
+                Float2 v = {0.0f, 0.0f};
+                if (on_disk)
+                {
+                    v.x = -dy / radius;
+                    v.y = dx / radius;
+                }
+                frame.velocity.at(x, y) = write_velocity(v);
+            }
+        }
+    }
+
+    void benchmark_tile_max(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        fprintf(out, "TileMax %ux%u, %u threads (ms, best of %u)\n", width, height, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "   K  single-pass  separable  speedup  identical\n");
+
+        for (uint32_t K = 1; K <= 20; ++K)
+        {
+            uint32_t tile_width, tile_height;
+            compute_tiled_dimensions(width, height, K, tile_width, tile_height);
+
+            VelocityImage single_pass(tile_width, tile_height);
+            VelocityImage separable(tile_width, tile_height);
+            TileMaxCandidateImage horizontal(tile_width, height);
+
+            double single_pass_ms = time_best_of([&]() { tile_max(frame.velocity, K, single_pass, pool); });
+            double separable_ms = time_best_of([&]() { tile_max_separable(frame.velocity, K, horizontal, separable, pool); });
+
+            bool identical = (memcmp(single_pass.data(), separable.data(), sizeof(Unorm8x2) * tile_width * tile_height) == 0);
+            fprintf(out, "  %2u  %11.3f  %9.3f  %6.2fx  %s\n", K, single_pass_ms, separable_ms, single_pass_ms / separable_ms, identical ? "yes" : "NO");
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_thread_scaling(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+        SimdLevel level = detect_simd_level();
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+        Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        ColorImage result(width, height);
+
+        // 1, 2, 4, ... threads up to every hardware thread
+        uint32_t max_thread_count = std::max(1U, std::thread::hardware_concurrency());
+        std::vector<uint32_t> thread_counts;
+        for (uint32_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2)
+        {
+            thread_counts.push_back(thread_count);
+        }
+        thread_counts.push_back(max_thread_count);
+
+        fprintf(out, "Thread scaling %ux%u, K=%u, S=%u, %s (ms, best of %u; speedup and efficiency against 1 thread)\n", width, height, params.K, params.S,
+                get_simd_level_name(level), BENCHMARK_REPETITIONS);
+        fprintf(out, "  threads  TileMax+NeighborMax  speedup  efficiency  gather     speedup  efficiency\n");
+
+        double single_thread_tile_ms = 0.0;
+        double single_thread_gather_ms = 0.0;
+        for (uint32_t thread_count : thread_counts)
+        {
+            ThreadPool pool(thread_count);
+            double tile_ms = time_best_of([&]() {
+                tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+                neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            });
+            double gather_ms = time_best_of([&]() { gather_simd(inputs, params, result, pool, level); });
+            if (thread_count == 1)
+            {
+                single_thread_tile_ms = tile_ms;
+                single_thread_gather_ms = gather_ms;
+            }
+
+            double tile_speedup = single_thread_tile_ms / tile_ms;
+            double gather_speedup = single_thread_gather_ms / gather_ms;
+            fprintf(out, "  %7u  %19.3f  %6.2fx  %9.1f%%  %9.3f  %6.2fx  %9.1f%%\n", thread_count, tile_ms, tile_speedup, 100.0 * tile_speedup / thread_count, gather_ms,
+                    gather_speedup, 100.0 * gather_speedup / thread_count);
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_tile_classification(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_random(random, 0);
+
+        Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        ColorImage reference(width, height);
+        ColorImage classified(width, height);
+        TileLists lists;
+
+        double gather_ms = time_best_of([&]() { gather(inputs, params, reference, pool); });
+        double classify_ms = time_best_of([&]() { classify_tiles(tile_max_buffer, neighbor_max_buffer, params, lists); });
+        double classified_ms = time_best_of([&]() { gather_classified(inputs, params, lists, classified, pool); });
+
+        bool identical = (memcmp(reference.data(), classified.data(), sizeof(Float4) * width * height) == 0);
+        fprintf(out, "Tile classification %ux%u, K=%u, S=%u, %u threads (ms, best of %u)\n", width, height, params.K, params.S, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  tiles: no blur %u, uniform %u, complex %u\n", uint32_t(lists.tiles[TILE_CLASS_NO_BLUR].size()), uint32_t(lists.tiles[TILE_CLASS_UNIFORM].size()), uint32_t(lists.tiles[TILE_CLASS_COMPLEX].size()));
+        fprintf(out, "  gather %.3f, classify %.3f + classified gather %.3f, identical %s\n\n", gather_ms, classify_ms, classified_ms, identical ? "yes" : "NO");
+    }
+
+    void benchmark_simd_gather(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_random(random, 0);
+
+        Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        ColorImage reference(width, height);
+        ColorImage result(width, height);
+        gather(inputs, params, reference, pool);
+
+        double megapixels = double(width) * double(height) * 1e-6;
+        fprintf(out, "SIMD gather %ux%u, K=%u, S=%u, %u threads (best of %u)\n", width, height, params.K, params.S, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  ISA      width  ms         Mpixels/s  max error\n");
+
+        SimdLevel supported = detect_simd_level();
+        for (uint32_t level = SIMD_LEVEL_SCALAR; level <= uint32_t(supported); ++level)
+        {
+            double ms = time_best_of([&]() { gather_simd(inputs, params, result, pool, SimdLevel(level), false); });
+
+            float max_error = 0.0f;
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    Float4 const &a = reference.at(x, y);
+                    Float4 const &b = result.at(x, y);
+                    max_error = std::max(max_error, std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z))));
+                }
+            }
+
+            fprintf(out, "  %-7s  %5u  %9.3f  %9.2f  %g\n", get_simd_level_name(SimdLevel(level)), get_simd_level_width(SimdLevel(level)), ms, megapixels / (ms * 1e-3), max_error);
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_specialized_gather(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_random(random, 0);
+
+        Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        ColorImage generic(width, height);
+        ColorImage specialized(width, height);
+
+        fprintf(out, "Specialized gather %ux%u, K=%u, %u threads (ms, best of %u)\n", width, height, params.K, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  ISA       S  generic    specialized  speedup  max difference\n");
+
+        const uint32_t sample_counts[] = {5, 15, 19};
+        SimdLevel supported = detect_simd_level();
+        for (uint32_t level = SIMD_LEVEL_SCALAR; level <= uint32_t(supported); ++level)
+        {
+            for (uint32_t S : sample_counts)
+            {
+                params.S = S;
+                double generic_ms = time_best_of([&]() { gather_simd(inputs, params, generic, pool, SimdLevel(level), false); });
+                double specialized_ms = time_best_of([&]() { gather_simd(inputs, params, specialized, pool, SimdLevel(level), true); });
+
+                float max_difference = 0.0f;
+                for (uint32_t y = 0; y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        Float4 const &a = generic.at(x, y);
+                        Float4 const &b = specialized.at(x, y);
+                        max_difference = std::max(max_difference, std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z))));
+                    }
+                }
+
+                fprintf(out, "  %-7s  %2u  %9.3f  %11.3f  %6.2fx  %g\n", get_simd_level_name(SimdLevel(level)), S, generic_ms, specialized_ms, generic_ms / specialized_ms, max_difference);
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_fused_tile_max(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        fprintf(out, "Fused TileMax/NeighborMax %ux%u, %u threads (ms, best of %u)\n", width, height, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "   K  two-pass  fused    speedup  identical\n");
+
+        const uint32_t tile_sizes[] = {2, 5, 10, 20};
+        for (uint32_t K : tile_sizes)
+        {
+            uint32_t tile_width, tile_height;
+            compute_tiled_dimensions(width, height, K, tile_width, tile_height);
+            VelocityImage tile_max_buffer(tile_width, tile_height);
+            VelocityImage two_pass(tile_width, tile_height);
+            VelocityImage fused(tile_width, tile_height);
+
+            double two_pass_ms = time_best_of([&]() {
+                tile_max(frame.velocity, K, tile_max_buffer, pool);
+                neighbor_max(tile_max_buffer, two_pass, pool);
+            });
+            double fused_ms = time_best_of([&]() { tile_max_neighbor_max_fused(frame.velocity, K, fused, pool); });
+
+            bool identical = (memcmp(two_pass.data(), fused.data(), sizeof(Unorm8x2) * tile_width * tile_height) == 0);
+            fprintf(out, "  %2u  %8.3f  %7.3f  %6.2fx  %s\n", K, two_pass_ms, fused_ms, two_pass_ms / fused_ms, identical ? "yes" : "NO");
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_incremental_tiles(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        // Frame N+1 differs from frame N by a small square moving sideways in front of the disk
+        uint32_t object_size = height / 10;
+        uint32_t object_y = height / 8;
+        uint32_t object_step = 8;
+        VelocityImage previous_velocity = frame.velocity;
+        VelocityImage current_velocity = frame.velocity;
+        Float2 object_velocity = {1.0f, 0.0f};
+        for (uint32_t y = object_y; y < object_y + object_size; ++y)
+        {
+            for (uint32_t x = 0; x < object_size; ++x)
+            {
+                previous_velocity.at(width / 8 + x, y) = write_velocity(object_velocity);
+                current_velocity.at(width / 8 + object_step + x, y) = write_velocity(object_velocity);
+            }
+        }
+
+        fprintf(out, "Incremental TileMax/NeighborMax %ux%u, %u threads (ms, best of %u)\n", width, height, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "   K  full     incremental  speedup  TileMax  NeighborMax  identical\n");
+
+        const uint32_t tile_sizes[] = {10, 20, 40};
+        for (uint32_t K : tile_sizes)
+        {
+            uint32_t tile_width, tile_height;
+            compute_tiled_dimensions(width, height, K, tile_width, tile_height);
+            VelocityImage full_tile_max(tile_width, tile_height);
+            VelocityImage full_neighbor_max(tile_width, tile_height);
+            VelocityImage tile_max_buffer(tile_width, tile_height);
+            VelocityImage neighbor_max_buffer(tile_width, tile_height);
+
+            double full_ms = time_best_of([&]() {
+                tile_max(current_velocity, K, full_tile_max, pool);
+                neighbor_max(full_tile_max, full_neighbor_max, pool);
+            });
+
+            // Every repetition starts from the state after frame N, which is not part of the timing
+            IncrementalTiles incremental;
+            double incremental_ms = 0.0;
+            for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+            {
+                incremental.invalidate();
+                incremental.update(previous_velocity, K, tile_max_buffer, neighbor_max_buffer, pool);
+
+                Stopwatch stopwatch;
+                stopwatch.start();
+                incremental.update(current_velocity, K, tile_max_buffer, neighbor_max_buffer, pool);
+                stopwatch.stop();
+                incremental_ms = (repetition == 0) ? stopwatch.milliseconds() : std::min(incremental_ms, stopwatch.milliseconds());
+            }
+
+            IncrementalTileStats const &stats = incremental.get_stats();
+            size_t tile_bytes = sizeof(Unorm8x2) * tile_width * tile_height;
+            bool identical = (memcmp(full_tile_max.data(), tile_max_buffer.data(), tile_bytes) == 0) &&
+                             (memcmp(full_neighbor_max.data(), neighbor_max_buffer.data(), tile_bytes) == 0);
+            fprintf(out, "  %2u  %7.3f  %11.3f  %6.2fx  %6.2f%%  %10.2f%%  %s\n", K, full_ms, incremental_ms, full_ms / incremental_ms,
+                    100.0 * stats.tile_max_recomputed / stats.tile_count, 100.0 * stats.neighbor_max_recomputed / stats.tile_count, identical ? "yes" : "NO");
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_jitter_sources(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        RandomImage blue_noise;
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_blue_noise(blue_noise);
+
+        // Reference: 4x the taps, averaged over four rand() textures
+        const uint32_t reference_seeds = 4;
+        Parameters reference_params = params;
+        reference_params.S = 4 * params.S + 1;
+        ColorImage reference(width, height);
+        ColorImage result(width, height);
+        reference.fill(Float4{0.0f, 0.0f, 0.0f, 0.0f});
+        for (uint32_t seed = 0; seed < reference_seeds; ++seed)
+        {
+            fill_random(random, seed + 1);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+            gather_simd(inputs, reference_params, result, pool, detect_simd_level());
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                Float4 &r = reference.data()[i];
+                Float4 const &c = result.data()[i];
+                r.x += c.x / reference_seeds;
+                r.y += c.y / reference_seeds;
+                r.z += c.z / reference_seeds;
+            }
+        }
+        fill_random(random, 0);
+
+        fprintf(out, "Jitter sources %ux%u, K=%u, S=%u, %u threads (ms, best of %u)\n", width, height, params.K, params.S, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  source                 texture bytes  gather   low-frequency energy  RMSE vs %u-tap reference\n", reference_params.S);
+
+        const char *names[] = {"rand() texture", "blue noise", "interleaved gradient"};
+        for (uint32_t source = JITTER_RANDOM_TEXTURE; source <= JITTER_INTERLEAVED_GRADIENT; ++source)
+        {
+            params.jitter_source = JitterSource(source);
+            RandomImage const *texture = (source == JITTER_BLUE_NOISE) ? &blue_noise : (source == JITTER_RANDOM_TEXTURE) ? &random : nullptr;
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, texture, nullptr};
+            double ms = time_best_of([&]() { gather_simd(inputs, params, result, pool, detect_simd_level()); });
+
+            // R over the top-left BLUE_NOISE_SIZE^2 pixels, as computed by prepare_gather_pixel
+            std::vector<float> window(BLUE_NOISE_SIZE * BLUE_NOISE_SIZE);
+            for (uint32_t y = 0; y < BLUE_NOISE_SIZE; ++y)
+            {
+                for (uint32_t x = 0; x < BLUE_NOISE_SIZE; ++x)
+                {
+                    float R;
+                    if (source == JITTER_INTERLEAVED_GRADIENT)
+                    {
+                        R = interleaved_gradient_noise(x, y);
+                    }
+                    else if (source == JITTER_BLUE_NOISE)
+                    {
+                        R = unorm8_to_float(blue_noise.at(x, y));
+                    }
+                    else
+                    {
+                        Float2 uv = {(float(x) + 0.5f) / float(width) * float(params.K), (float(y) + 0.5f) / float(height) * float(params.K)};
+                        R = unorm8_to_float(random.sample_point_wrap(uv));
+                    }
+                    window[y * BLUE_NOISE_SIZE + x] = R;
+                }
+            }
+
+            double squared_error = 0.0;
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                Float4 const &a = reference.data()[i];
+                Float4 const &b = result.data()[i];
+                squared_error += (double(a.x - b.x) * (a.x - b.x) + double(a.y - b.y) * (a.y - b.y) + double(a.z - b.z) * (a.z - b.z)) / 3.0;
+            }
+
+            size_t texture_bytes = texture ? size_t(texture->get_width()) * texture->get_height() : 0;
+            fprintf(out, "  %-21s  %13u  %7.3f  %19.3f%%  %.5f\n", names[source], uint32_t(texture_bytes), ms,
+                    100.0 * low_frequency_energy(window, BLUE_NOISE_SIZE), sqrt(squared_error / (double(width) * double(height))));
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_packed_velocity_depth(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        VelocityDepthImage velocity_depth(width, height);
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_random(random, 0);
+
+        Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        Inputs packed_inputs = inputs;
+        packed_inputs.velocity_depth = &velocity_depth;
+
+        // Taps actually executed: every pixel that does not take the early-out runs S - 1 of them
+        uint64_t gathered_pixels = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                GatherPixelState state;
+                gathered_pixels += prepare_gather_pixel(inputs, params, x, y, state) ? 1 : 0;
+            }
+        }
+        uint64_t taps = gathered_pixels * (params.S - 1);
+
+        ColorImage reference(width, height);
+        ColorImage result(width, height);
+        double pack_ms = time_best_of([&]() { pack_velocity_depth(frame.depth, frame.velocity, params, velocity_depth, pool); });
+
+        fprintf(out, "Packed velocity/depth %ux%u, K=%u, S=%u, %u threads (ms, best of %u)\n", width, height, params.K, params.S, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  %.2f Mtaps; per tap: separate Z + V 2 fetches / 6 bytes, packed 1 fetch / 8 bytes (+ C in both)\n", taps * 1e-6);
+        fprintf(out, "  pack pass %.3f (reads %.1f MB, writes %.1f MB)\n", pack_ms, width * height * 6.0 * 1e-6, width * height * 8.0 * 1e-6);
+        fprintf(out, "  ISA      separate  packed   packed+pack  max error\n");
+
+        SimdLevel supported = detect_simd_level();
+        for (uint32_t level = SIMD_LEVEL_SCALAR; level <= uint32_t(supported); ++level)
+        {
+            double separate_ms = time_best_of([&]() { gather_simd(inputs, params, reference, pool, SimdLevel(level)); });
+            double packed_ms = time_best_of([&]() { gather_simd(packed_inputs, params, result, pool, SimdLevel(level)); });
+
+            float max_error = 0.0f;
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                Float4 const &a = reference.data()[i];
+                Float4 const &b = result.data()[i];
+                max_error = std::max(max_error, std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z))));
+            }
+            fprintf(out, "  %-7s  %8.3f  %7.3f  %11.3f  %g\n", get_simd_level_name(SimdLevel(level)), separate_ms, packed_ms, packed_ms + pack_ms, max_error);
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_velocity_encodings(FILE *out, uint32_t width, uint32_t height)
+    {
+        TestFrame frame;
+        make_test_frame(width, height, frame);
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        VelocityFieldImage velocity;
+        make_velocity_field(width, height, params.K, velocity);
+        ColorImage reference(width, height);
+        reconstruct_velocity_field(frame.color, frame.depth, velocity, &random, params, reference, pool);
+
+        // The reference passes with bias/scale velocities must reproduce the scalar passes on the R8G8 texels
+        VelocityImage velocity_texels(width, height);
+        for (uint32_t i = 0; i < width * height; ++i)
+        {
+            velocity_texels.data()[i] = write_velocity(velocity.data()[i]);
+        }
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        ColorImage bias_scale_result(width, height);
+        tile_max(velocity_texels, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        Inputs inputs = {&frame.color, &frame.depth, &velocity_texels, &neighbor_max_buffer, &random, nullptr};
+        gather(inputs, params, bias_scale_result, pool);
+
+        fprintf(out, "Velocity encodings %ux%u, K=%u, S=%u, %u threads\n", width, height, params.K, params.S, pool.get_thread_count());
+        fprintf(out, "  MB of velocity texels fetched/written by each pass, before caching; RMSE of the gather against float velocities\n");
+        fprintf(out, "  encoding          bytes  scene  TileMax  NeighborMax  gather   total  max |dV|/|V|  RMSE\n");
+
+        VelocityFieldImage quantized;
+        ColorImage result(width, height);
+        for (uint32_t encoding = VELOCITY_ENCODING_BIAS_SCALE; encoding < VELOCITY_ENCODING_COUNT; ++encoding)
+        {
+            quantize_velocity_field(velocity, VelocityEncoding(encoding), quantized, pool);
+            uint64_t gathered_pixels = reconstruct_velocity_field(frame.color, frame.depth, quantized, &random, params, result, pool);
+
+            // Relative error of the stored velocities that are at least a texel long
+            float max_velocity_error = 0.0f;
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                Float2 a = velocity.data()[i];
+                Float2 b = quantized.data()[i];
+                Float2 d = {a.x - b.x, a.y - b.y};
+                max_velocity_error = (length(a) >= 1.0f) ? std::max(max_velocity_error, length(d) / length(a)) : max_velocity_error;
+            }
+
+            double squared_error = 0.0;
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                Float4 const &a = reference.data()[i];
+                Float4 const &b = result.data()[i];
+                squared_error += (double(a.x - b.x) * (a.x - b.x) + double(a.y - b.y) * (a.y - b.y) + double(a.z - b.z) * (a.z - b.z)) / 3.0;
+            }
+
+            // V is written once; TileMax reads K^2 texels and NeighborMax 9 per tile; the gather reads NX at every
+            // pixel, and VX and S - 1 taps at the pixels past the early-out
+            double bytes = double(get_velocity_encoding_bytes(VelocityEncoding(encoding)));
+            double tiles = double(tile_width) * double(tile_height);
+            double scene_mb = double(width) * double(height) * bytes * 1e-6;
+            double tile_max_mb = tiles * (params.K * params.K + 1) * bytes * 1e-6;
+            double neighbor_max_mb = tiles * (9 + 1) * bytes * 1e-6;
+            double gather_mb = (double(width) * double(height) + double(gathered_pixels) * params.S) * bytes * 1e-6;
+            fprintf(out, "  %-16s  %5u  %5.1f  %7.1f  %11.2f  %6.1f  %6.1f  %11.2f%%  %.5f\n", get_velocity_encoding_name(VelocityEncoding(encoding)),
+                    uint32_t(bytes), scene_mb, tile_max_mb, neighbor_max_mb, gather_mb, scene_mb + tile_max_mb + neighbor_max_mb + gather_mb,
+                    100.0 * max_velocity_error, sqrt(squared_error / (double(width) * double(height))));
+
+            if (encoding == VELOCITY_ENCODING_BIAS_SCALE)
+            {
+                bool identical = (memcmp(result.data(), bias_scale_result.data(), size_t(width) * height * sizeof(Float4)) == 0);
+                fprintf(out, "  %-16s  matches the scalar passes on R8G8 texels: %s\n", "", identical ? "yes" : "NO");
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_linear_depth(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        WindmillScene scene(width, height);
+        TestFrame frame;
+        frame.color.resize(width, height);
+        frame.depth.resize(width, height);
+        frame.velocity.resize(width, height);
+        SoftwareRasterizer rasterizer;
+        rasterizer.render(scene.camera, scene.objects, 2, nullptr, frame.color, frame.depth, frame.velocity, pool);
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        fill_random(random, 0);
+
+        DepthImage linear(width, height);
+        double prepass_ms = time_best_of([&]() { linear_depth(frame.depth, WINDMILL_CLIP_NEAR, WINDMILL_CLIP_FAR, linear, pool); });
+
+        // Pixel pairs K apart on a row whose depths differ by more than SOFT_Z_EXTENT, so that soft_depth_compare
+        // orders them instead of blending them as if they were at the same depth
+        uint64_t pairs = 0;
+        uint64_t hyperbolic_ordered = 0;
+        uint64_t linear_ordered = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x + params.K < width; ++x)
+            {
+                pairs++;
+                hyperbolic_ordered += (fabsf(frame.depth.at(x, y) - frame.depth.at(x + params.K, y)) > SOFT_Z_EXTENT) ? 1 : 0;
+                linear_ordered += (fabsf(linear.at(x, y) - linear.at(x + params.K, y)) > SOFT_Z_EXTENT) ? 1 : 0;
+            }
+        }
+
+        Inputs hyperbolic_inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        Inputs linear_inputs = hyperbolic_inputs;
+        linear_inputs.depth = &linear;
+
+        uint64_t gathered_pixels = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                GatherPixelState state;
+                gathered_pixels += prepare_gather_pixel(hyperbolic_inputs, params, x, y, state) ? 1 : 0;
+            }
+        }
+        uint64_t taps = gathered_pixels * (params.S - 1);
+
+        ColorImage hyperbolic_result(width, height);
+        ColorImage linear_result(width, height);
+        SimdLevel level = detect_simd_level();
+        double hyperbolic_ms = time_best_of([&]() { gather_simd(hyperbolic_inputs, params, hyperbolic_result, pool, level); });
+        double linear_ms = time_best_of([&]() { gather_simd(linear_inputs, params, linear_result, pool, level); });
+
+        uint64_t changed_pixels = 0;
+        for (uint32_t i = 0; i < width * height; ++i)
+        {
+            Float4 const &a = hyperbolic_result.data()[i];
+            Float4 const &b = linear_result.data()[i];
+            changed_pixels += (std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z))) > 1.0f / 255.0f) ? 1 : 0;
+        }
+
+        fprintf(out, "Linear depth %ux%u windmill frame, K=%u, S=%u, %s, %u threads (ms, best of %u)\n", width, height, params.K, params.S,
+                get_simd_level_name(level), pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  depth         gather   prepass  tap depth MB  pairs K apart ordered by SOFT_Z_EXTENT\n");
+        fprintf(out, "  D24 (z/w)    %7.3f         -  %12.1f  %6.2f%%\n", hyperbolic_ms, taps * 4.0 * 1e-6, 100.0 * hyperbolic_ordered / pairs);
+        fprintf(out, "  linear R16F  %7.3f  %8.3f  %12.1f  %6.2f%%\n", linear_ms, prepass_ms, taps * 2.0 * 1e-6, 100.0 * linear_ordered / pairs);
+        fprintf(out, "  %.2f Mtaps; %.2f%% of the pixels change by more than 1/255\n", taps * 1e-6, 100.0 * changed_pixels / (double(width) * double(height)));
+        fprintf(out, "\n");
+    }
+
+    void benchmark_half_resolution_gather(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        SimdLevel level = detect_simd_level();
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        TestFrame frames[2];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+
+        fprintf(out, "Half-resolution gather %ux%u, K=%u, S=%u, %s, %u threads (ms, best of %u)\n", width, height, params.K, params.S,
+                get_simd_level_name(level), pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  frame     full gather  downsample  half gather  upsample  total  speedup  PSNR vs full (dB)  unblurred C\n");
+
+        for (uint32_t f = 0; f < 2; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+            neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+
+            ColorImage full(width, height);
+            ColorImage result(width, height);
+            HalfResolutionFrame half;
+            double full_ms = time_best_of([&]() { gather_simd(inputs, params, full, pool, level); });
+            double downsample_ms = time_best_of([&]() { downsample_gather_inputs(frame.color, frame.depth, frame.velocity, half, pool); });
+
+            Inputs half_inputs = inputs;
+            half_inputs.color = &half.color;
+            half_inputs.depth = &half.depth;
+            half_inputs.velocity = &half.velocity;
+            Parameters half_params = params;
+            half_params.max_sample_tap_distance = 0.5f * params.max_sample_tap_distance;
+            double gather_ms = time_best_of([&]() { gather_simd(half_inputs, half_params, half.blurred, pool, level); });
+            double upsample_ms = time_best_of([&]() { upsample_gather(inputs, half, params, result, pool); });
+
+            double total_ms = downsample_ms + gather_ms + upsample_ms;
+            fprintf(out, "  %-8s  %11.3f  %10.3f  %11.3f  %8.3f  %5.1f  %6.2fx  %17.2f  %11.2f\n", DISK_AND_WINDMILL_FRAME_NAMES[f], full_ms, downsample_ms, gather_ms,
+                    upsample_ms, total_ms, full_ms / total_ms, psnr(full, result), psnr(full, frame.color));
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_adaptive_samples(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        SimdLevel level = detect_simd_level();
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        TestFrame frames[2];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+
+        fprintf(out, "Adaptive sample count %ux%u, K=%u, S=%u (min %u, %.2f taps per pixel of reach), %s, %u threads (ms, best of %u)\n", width, height,
+                params.K, params.S, ADAPTIVE_MIN_S, ADAPTIVE_TAPS_PER_PIXEL, get_simd_level_name(level), pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  frame     fixed S  adaptive  speedup  taps/pixel fixed  adaptive  PSNR vs fixed (dB)\n");
+
+        for (uint32_t f = 0; f < 2; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+            neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+
+            // The fixed-S gather runs S taps on every tile that does not take the early-out
+            TileSampleImage tile_samples;
+            compute_tile_sample_counts(neighbor_max_buffer, params, tile_samples);
+            TileSampleImage fixed_samples = tile_samples;
+            for (uint32_t i = 0; i < tile_width * tile_height; ++i)
+            {
+                fixed_samples.data()[i] = (tile_samples.data()[i] != 0) ? uint8_t(params.S) : 0;
+            }
+
+            ColorImage fixed(width, height);
+            ColorImage adaptive(width, height);
+            double fixed_ms = time_best_of([&]() { gather_simd(inputs, params, fixed, pool, level); });
+            double adaptive_ms = time_best_of([&]() {
+                compute_tile_sample_counts(neighbor_max_buffer, params, tile_samples);
+                gather_adaptive(inputs, params, tile_samples, adaptive, pool, level);
+            });
+
+            fprintf(out, "  %-8s  %7.3f  %8.3f  %6.2fx  %16.2f  %8.2f  %18.2f\n", DISK_AND_WINDMILL_FRAME_NAMES[f], fixed_ms, adaptive_ms, fixed_ms / adaptive_ms,
+                    compute_average_taps_per_pixel(fixed_samples, width, height), compute_average_taps_per_pixel(tile_samples, width, height), psnr(fixed, adaptive));
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_uniform_velocity(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        SimdLevel level = detect_simd_level();
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        const char *const frame_names[3] = {DISK_AND_WINDMILL_FRAME_NAMES[0], DISK_AND_WINDMILL_FRAME_NAMES[1], "panning"};
+        TestFrame frames[3];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+        make_panning_frame(width, height, frames[2]);
+
+        fprintf(out, "Uniform-velocity fast path %ux%u, K=%u, S=%u, %s, %u threads (ms, best of %u)\n", width, height, params.K, params.S,
+                get_simd_level_name(level), pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  frame     gather  fast path  speedup  uniform tiles  PSNR vs gather (dB)\n");
+
+        for (uint32_t f = 0; f < 3; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+            neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+
+            ColorImage gathered(width, height);
+            ColorImage fast(width, height);
+            TileBoundsImage bounds;
+            UniformVelocityStats stats;
+            double gather_ms = time_best_of([&]() { gather_simd(inputs, params, gathered, pool, level); });
+            double fast_ms = time_best_of([&]() { gather_uniform_velocity(inputs, params, bounds, fast, pool, level, &stats); });
+
+            fprintf(out, "  %-8s  %6.3f  %9.3f  %6.2fx  %12.1f%%  %19.2f\n", frame_names[f], gather_ms, fast_ms, gather_ms / fast_ms,
+                    100.0 * stats.uniform_tiles / double(stats.tile_count), psnr(gathered, fast));
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_blocked_gather(FILE *out, uint32_t width, uint32_t height)
+    {
+        // One thread, so that the counters of the calling thread see every tap
+        ThreadPool pool(1);
+        SimdLevel level = detect_simd_level();
+        CacheMissCounters counters;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        const char *const frame_names[3] = {DISK_AND_WINDMILL_FRAME_NAMES[0], DISK_AND_WINDMILL_FRAME_NAMES[1], "panning"};
+        TestFrame frames[3];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+        make_panning_frame(width, height, frames[2]);
+
+        fprintf(out, "Cache-blocked gather %ux%u, K=%u, S=%u, L2 %u KB, %s, 1 thread (ms, best of %u; misses per pixel)\n", width, height, params.K,
+                params.S, detect_l2_cache_size() / 1024, get_simd_level_name(level), BENCHMARK_REPETITIONS);
+        if (!counters.is_available())
+        {
+            fprintf(out, "  cache counters unavailable: %s\n", counters.get_error());
+        }
+        fprintf(out, "  frame     halo  block  row-major  blocked  speedup  L1D row-major  blocked  LLC row-major  blocked\n");
+
+        for (uint32_t f = 0; f < 3; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+            neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+
+            uint32_t halo = compute_gather_halo(neighbor_max_buffer, params);
+            uint32_t block_size = compute_gather_block_size(halo, get_gather_bytes_per_pixel(inputs), detect_l2_cache_size(), get_simd_level_width(level));
+
+            ColorImage row_major(width, height);
+            ColorImage blocked(width, height);
+            double row_major_ms = time_best_of([&]() { gather_simd(inputs, params, row_major, pool, level); });
+            double blocked_ms = time_best_of([&]() { gather_blocked(inputs, params, blocked, pool, level, block_size); });
+
+            uint64_t misses[2][2];
+            counters.measure([&]() { gather_simd(inputs, params, row_major, pool, level); }, misses[0][0], misses[0][1]);
+            counters.measure([&]() { gather_blocked(inputs, params, blocked, pool, level, block_size); }, misses[1][0], misses[1][1]);
+
+            fprintf(out, "  %-8s  %4u  %5u  %9.3f  %7.3f  %6.2fx", frame_names[f], halo, block_size, row_major_ms, blocked_ms, row_major_ms / blocked_ms);
+            if (counters.is_available())
+            {
+                double pixels = double(width) * double(height);
+                fprintf(out, "  %13.3f  %7.3f  %13.3f  %7.3f\n", misses[0][0] / pixels, misses[1][0] / pixels, misses[0][1] / pixels, misses[1][1] / pixels);
+            }
+            else
+            {
+                fprintf(out, "  %13s  %7s  %13s  %7s\n", "n/a", "n/a", "n/a", "n/a");
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    namespace
+    {
+        struct SwizzledLayoutTimes
+        {
+            double swizzle_ms;
+            double tile_max_ms;
+            double neighbor_max_ms;
+            double gather_ms;
+            bool identical;
+        };
+
+        template <typename Layout>
+        SwizzledLayoutTimes time_swizzled_layout(TestFrame const &frame, Parameters const &params, RandomImage const &random,
+                                                 VelocityImage const &reference_neighbor_max, ColorImage const &reference, ThreadPool &pool)
+        {
+            SwizzledLayoutTimes times;
+            SwizzledFrame<Layout> swizzled;
+            times.swizzle_ms = time_best_of([&]() {
+                swizzle(frame.color, swizzled.color, pool);
+                swizzle(frame.depth, swizzled.depth, pool);
+                swizzle(frame.velocity, swizzled.velocity, pool);
+            });
+
+            // NeighborMax reads TileMax through the swizzled layout too, so that both tile passes are measured
+            VelocityImage tile_max_buffer(reference_neighbor_max.get_width(), reference_neighbor_max.get_height());
+            SwizzledImage<Unorm8x2, Layout> swizzled_tile_max;
+            VelocityImage neighbor_max_buffer(reference_neighbor_max.get_width(), reference_neighbor_max.get_height());
+            times.tile_max_ms = time_best_of([&]() { tile_max(swizzled.velocity, params.K, tile_max_buffer, pool); });
+            swizzle(tile_max_buffer, swizzled_tile_max, pool);
+            times.neighbor_max_ms = time_best_of([&]() { neighbor_max(swizzled_tile_max, neighbor_max_buffer, pool); });
+
+            SwizzledInputs<Layout> inputs = {&swizzled.color, &swizzled.depth, &swizzled.velocity, &neighbor_max_buffer, &random};
+            ColorImage blurred(reference.get_width(), reference.get_height());
+            times.gather_ms = time_best_of([&]() { gather(inputs, params, blurred, pool); });
+
+            size_t tile_bytes = sizeof(Unorm8x2) * size_t(neighbor_max_buffer.get_width()) * neighbor_max_buffer.get_height();
+            size_t color_bytes = sizeof(Float4) * size_t(reference.get_width()) * reference.get_height();
+            times.identical = (memcmp(neighbor_max_buffer.data(), reference_neighbor_max.data(), tile_bytes) == 0) &&
+                              (memcmp(blurred.data(), reference.data(), color_bytes) == 0);
+            return times;
+        }
+    }
+
+    void benchmark_swizzled_layouts(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        TestFrame frames[2];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+
+        fprintf(out, "Swizzled C/Z/V %ux%u, K=%u, S=%u, scalar kernels, %u threads (ms, best of %u)\n", width, height, params.K, params.S,
+                pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  frame     layout        swizzle  tile_max  neighbor_max   gather  speedup  identical\n");
+
+        for (uint32_t f = 0; f < 2; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            double tile_max_ms = time_best_of([&]() { tile_max(frame.velocity, params.K, tile_max_buffer, pool); });
+            double neighbor_max_ms = time_best_of([&]() { neighbor_max(tile_max_buffer, neighbor_max_buffer, pool); });
+
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+            ColorImage reference(width, height);
+            double gather_ms = time_best_of([&]() { gather(inputs, params, reference, pool); });
+
+            SwizzledLayoutTimes times[2] = {time_swizzled_layout<BlockLinearLayout>(frame, params, random, neighbor_max_buffer, reference, pool),
+                                            time_swizzled_layout<MortonLayout>(frame, params, random, neighbor_max_buffer, reference, pool)};
+            const char *const layout_names[2] = {"block-linear", "morton"};
+
+            fprintf(out, "  %-8s  %-12s  %7s  %8.3f  %12.3f  %7.3f  %6.2fx  %s\n", DISK_AND_WINDMILL_FRAME_NAMES[f], "row-major", "-", tile_max_ms,
+                    neighbor_max_ms, gather_ms, 1.0, "-");
+            for (uint32_t l = 0; l < 2; ++l)
+            {
+                fprintf(out, "  %-8s  %-12s  %7.3f  %8.3f  %12.3f  %7.3f  %6.2fx  %s\n", DISK_AND_WINDMILL_FRAME_NAMES[f], layout_names[l], times[l].swizzle_ms,
+                        times[l].tile_max_ms, times[l].neighbor_max_ms, times[l].gather_ms, gather_ms / times[l].gather_ms, times[l].identical ? "yes" : "NO");
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    namespace
+    {
+        // gather_simd's row bands, timed band by band in the form of parallel_tasks' statistics
+        void gather_bands(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, TaskStats &stats)
+        {
+            GatherSpanFunction gather_span = get_gather_span_function(level, params.S);
+            std::mutex mutex;
+            stats.thread_busy_ms.assign(pool.get_thread_count(), 0.0);
+            stats.thread_finish_ms.assign(pool.get_thread_count(), 0.0);
+            stats.task_count = 0;
+            stats.stolen_task_count = 0;
+            stats.makespan_ms = 0.0;
+
+            auto frame_start = std::chrono::high_resolution_clock::now();
+            pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+                auto band_start = std::chrono::high_resolution_clock::now();
+                for (uint32_t y = row_begin; y < row_end; ++y)
+                {
+                    gather_span(inputs, params, y, 0, out.get_width(), out.row(y));
+                }
+                auto band_finish = std::chrono::high_resolution_clock::now();
+
+                // One band per thread, so the band's finish is its thread's
+                std::lock_guard<std::mutex> lock(mutex);
+                uint32_t band = stats.task_count++;
+                stats.thread_busy_ms[band] = std::chrono::duration<double, std::milli>(band_finish - band_start).count();
+                stats.thread_finish_ms[band] = std::chrono::duration<double, std::milli>(band_finish - frame_start).count();
+                stats.makespan_ms = std::max(stats.makespan_ms, stats.thread_finish_ms[band]);
+            });
+            stats.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frame_start).count();
+        }
+    }
+
+    void benchmark_work_stealing(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        SimdLevel level = detect_simd_level();
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        VelocityImage tile_max_buffer(tile_width, tile_height);
+        VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        RandomImage random(tile_width, tile_height);
+        fill_random(random, 0);
+
+        const char *const frame_names[3] = {DISK_AND_WINDMILL_FRAME_NAMES[0], DISK_AND_WINDMILL_FRAME_NAMES[1], "panning"};
+        TestFrame frames[3];
+        make_disk_and_windmill_frames(width, height, frames, pool);
+        make_panning_frame(width, height, frames[2]);
+
+        fprintf(out, "Work-stealing gather %ux%u, K=%u, S=%u, %s, %u threads (ms of the fastest run; makespan = last thread done; utilization = busy / (threads x makespan))\n",
+                width, height, params.K, params.S, get_simd_level_name(level), pool.get_thread_count());
+        fprintf(out, "  frame     bands  makespan  utilization  tasks  stolen  scheduled  makespan  utilization  speedup  identical\n");
+
+        for (uint32_t f = 0; f < 3; ++f)
+        {
+            TestFrame const &frame = frames[f];
+            tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+            neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+            Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+
+            // Statistics of the fastest of BENCHMARK_REPETITIONS runs of each
+            ColorImage bands(width, height);
+            ColorImage scheduled(width, height);
+            TaskStats band_stats, task_stats;
+            for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+            {
+                TaskStats stats;
+                gather_bands(inputs, params, bands, pool, level, stats);
+                band_stats = (repetition == 0 || stats.wall_ms < band_stats.wall_ms) ? stats : band_stats;
+                gather_scheduled(inputs, params, scheduled, pool, level, &stats);
+                task_stats = (repetition == 0 || stats.wall_ms < task_stats.wall_ms) ? stats : task_stats;
+            }
+
+            bool identical = (memcmp(bands.data(), scheduled.data(), sizeof(Float4) * width * height) == 0);
+            fprintf(out, "  %-8s  %7.3f  %8.3f  %10.1f%%  %5u  %6u  %9.3f  %8.3f  %10.1f%%  %6.2fx  %s\n", frame_names[f], band_stats.wall_ms,
+                    band_stats.makespan_ms, 100.0 * band_stats.get_utilization(), task_stats.task_count, task_stats.stolen_task_count, task_stats.wall_ms,
+                    task_stats.makespan_ms, 100.0 * task_stats.get_utilization(), band_stats.wall_ms / task_stats.wall_ms, identical ? "yes" : "NO");
+        }
+        fprintf(out, "\n");
+    }
+
+    void benchmark_software_rasterizer(FILE *out, uint32_t width, uint32_t height)
+    {
+        Reconstruction reconstruction;
+        ThreadPool &pool = reconstruction.get_thread_pool();
+
+        WindmillScene scene(width, height);
+        TestFrame frame;
+        frame.color.resize(width, height);
+        frame.depth.resize(width, height);
+        frame.velocity.resize(width, height);
+        SoftwareRasterizer rasterizer;
+        double render_ms = time_best_of([&]() { rasterizer.render(scene.camera, scene.objects, 2, nullptr, frame.color, frame.depth, frame.velocity, pool); });
+
+        uint32_t moving_pixels = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                Unorm8x2 v = frame.velocity.at(x, y);
+                moving_pixels += (v.x != VELOCITY_GRAY.x || v.y != VELOCITY_GRAY.y) ? 1 : 0;
+            }
+        }
+
+        Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(compute_max_sample_tap_distance(height));
+        params.jitter_source = JITTER_RANDOM_TEXTURE;
+        ColorImage blurred(width, height);
+        reconstruction.set_linear_depth(true, WINDMILL_CLIP_NEAR, WINDMILL_CLIP_FAR);
+        double reconstruction_ms = time_best_of([&]() { reconstruction.run(frame.color, frame.depth, frame.velocity, params, blurred); });
+
+        double megapixels = double(width) * double(height) * 1e-6;
+        fprintf(out, "Software G-buffer %ux%u, %u threads (ms, best of %u)\n", width, height, pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  render %.3f (%.1f Mpixels/s, %u triangles, %.2f%% moving pixels), reconstruction %.3f, frame %.3f\n", render_ms,
+                megapixels / (render_ms * 1e-3), rasterizer.get_triangle_count(), 100.0 * moving_pixels / (double(width) * double(height)),
+                reconstruction_ms, render_ms + reconstruction_ms);
+        fprintf(out, "\n");
+    }
+
+    void benchmark_quantized_vertices(FILE *out, uint32_t width, uint32_t height)
+    {
+        ThreadPool pool;
+        WindmillScene scene(width, height);
+        WindmillScene decoded_scene(width, height);
+        const char *const names[2] = {"house", "fan"};
+        Mesh const *meshes[2] = {&scene.house, &scene.fan};
+        Mesh *decoded_meshes[2] = {&decoded_scene.house, &decoded_scene.fan};
+        std::vector<float> decoded_streams[2][3];
+        const uint32_t float_stride = sizeof(float) * 8;
+        const uint32_t quantized_stride = sizeof(Scene::QuantizedVertex);
+        uint32_t cache_size = Scene::MESH_OPTIMIZER_REPORT_CACHE_SIZES[0];
+
+        fprintf(out, "Quantized vertices: %u-byte Scene::QuantizedVertex against %u bytes of float streams (ms, best of %u)\n", quantized_stride, float_stride, BENCHMARK_REPETITIONS);
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            Mesh const &mesh = *meshes[i];
+            Scene::MeshStreams streams = {mesh.num_faces, mesh.indices, mesh.num_vertices, mesh.vertices, mesh.normals, mesh.texture_coords};
+            Scene::PositionQuantization quantization = Scene::compute_position_quantization(mesh.vertices, mesh.num_vertices);
+            std::vector<Scene::QuantizedVertex> quantized(mesh.num_vertices);
+            double encode_ms = time_best_of([&]() { Scene::quantize_vertices(streams, quantization, quantized.data()); });
+
+            // The CPU decode path: back to float streams for the software rasterizer
+            std::vector<float>(&decoded)[3] = decoded_streams[i];
+            decoded[0].resize(3 * size_t(mesh.num_vertices));
+            decoded[1].resize(3 * size_t(mesh.num_vertices));
+            decoded[2].resize(2 * size_t(mesh.num_vertices));
+            double decode_ms = time_best_of([&]() { Scene::dequantize_vertices(quantized.data(), mesh.num_vertices, quantization, decoded[0].data(), decoded[1].data(), decoded[2].data()); });
+            *decoded_meshes[i] = Mesh{mesh.num_faces, mesh.indices, mesh.num_vertices, decoded[0].data(), decoded[1].data(), decoded[2].data()};
+
+            float position_error = 0.0f;
+            float normal_error = 0.0f;
+            float uv_error = 0.0f;
+            for (uint32_t v = 0; v < mesh.num_vertices; ++v)
+            {
+                float dot = 0.0f;
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    position_error = std::max(position_error, fabsf(decoded[0][3 * v + axis] - mesh.vertices[3 * v + axis]));
+                    dot += decoded[1][3 * v + axis] * mesh.normals[3 * v + axis];
+                }
+                float normal_length = sqrtf(mesh.normals[3 * v + 0] * mesh.normals[3 * v + 0] + mesh.normals[3 * v + 1] * mesh.normals[3 * v + 1] + mesh.normals[3 * v + 2] * mesh.normals[3 * v + 2]);
+                if (normal_length > 0.0f)
+                {
+                    normal_error = std::max(normal_error, acosf(std::min(dot / normal_length, 1.0f)) * (180.0f / 3.14159265f));
+                }
+                uv_error = std::max(uv_error, std::max(fabsf(decoded[2][2 * v + 0] - mesh.texture_coords[2 * v + 0]), fabsf(decoded[2][2 * v + 1] - mesh.texture_coords[2 * v + 1])));
+            }
+
+            // Every vertex shader invocation fetches its vertex: ACMR invocations per triangle
+            float acmr = Scene::compute_acmr(mesh.indices, 3 * mesh.num_faces, mesh.num_vertices, cache_size);
+            double fetched = double(acmr) * double(mesh.num_faces) / 1024.0;
+            fprintf(out, "  %s, %u vertices: buffers %.1f -> %.1f KB, fetched per draw %.1f -> %.1f KB (ACMR %.2f at %u), encode %.3f, decode %.3f\n", names[i],
+                    mesh.num_vertices, float_stride * mesh.num_vertices / 1024.0, quantized_stride * mesh.num_vertices / 1024.0, fetched * float_stride, fetched * quantized_stride,
+                    acmr, cache_size, encode_ms, decode_ms);
+            fprintf(out, "    largest decode error: position %.2e, normal %.4f degrees, uv %.2e\n", position_error, normal_error, uv_error);
+        }
+
+        // The G-buffer of the decoded meshes against that of the float ones
+        ColorImage color[2];
+        DepthImage depth[2];
+        VelocityImage velocity[2];
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            color[i].resize(width, height);
+            depth[i].resize(width, height);
+            velocity[i].resize(width, height);
+            SoftwareRasterizer rasterizer;
+            WindmillScene &rendered = i ? decoded_scene : scene;
+            rasterizer.render(rendered.camera, rendered.objects, 2, nullptr, color[i], depth[i], velocity[i], pool);
+        }
+        float depth_error = 0.0f;
+        uint32_t velocity_differences = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                depth_error = std::max(depth_error, fabsf(depth[0].at(x, y) - depth[1].at(x, y)));
+                Unorm8x2 a = velocity[0].at(x, y);
+                Unorm8x2 b = velocity[1].at(x, y);
+                velocity_differences += (a.x != b.x || a.y != b.y) ? 1 : 0;
+            }
+        }
+        double pixels = double(width) * double(height);
+        fprintf(out, "  windmill %ux%u from the decoded meshes: color PSNR %.1f dB, largest depth difference %.2e, velocity differs at %.3f%% of pixels\n\n", width,
+                height, psnr(color[0], color[1]), depth_error, 100.0 * velocity_differences / pixels);
+    }
+
+    void benchmark_instance_transforms(FILE *out, uint32_t count)
+    {
+        ThreadPool pool;
+
+        // Rigid movers spinning about random axes, a small step apart between the frames
+        std::vector<RigidPose> poses_new(count), poses_old(count);
+        uint32_t state = 0x9e3779b9u;
+        auto next_float = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return float(state >> 8) * (1.0f / 16777216.0f);
+        };
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Float3 axis = {next_float() - 0.5f, next_float() - 0.5f, next_float() - 0.5f};
+            float axis_length = std::max(sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z), 1e-6f);
+            float angle = 6.2831853f * next_float();
+            for (uint32_t frame = 0; frame < 2; ++frame)
+            {
+                float s = sinf(0.5f * (angle - 0.05f * frame)) / axis_length;
+                RigidPose &pose = frame ? poses_old[i] : poses_new[i];
+                pose.rotation = Float4{axis.x * s, axis.y * s, axis.z * s, cosf(0.5f * (angle - 0.05f * frame))};
+                pose.translation = Float3{100.0f * next_float(), 10.0f * next_float(), 100.0f * next_float()};
+            }
+        }
+        RigidPose camera = {Float4{0.0f, 0.38268343f, 0.0f, 0.92387953f}, Float3{-50.0f, -5.0f, 20.0f}};
+        Float4x4 view_xform = get_pose_matrix(camera);
+
+        std::vector<InstanceTransforms> scalar(count), simd(count), pooled(count);
+        double scalar_ms = time_best_of([&]() { build_instance_transforms_scalar(poses_new.data(), poses_old.data(), count, view_xform, scalar.data()); });
+        double simd_ms = time_best_of([&]() { build_instance_transforms(poses_new.data(), poses_old.data(), count, view_xform, simd.data()); });
+        double pooled_ms = time_best_of([&]() { build_instance_transforms(poses_new.data(), poses_old.data(), count, view_xform, pooled.data(), pool); });
+
+        // The scalar path against the full 4x4 products, and the SIMD paths against the scalar one
+        float reference_error = 0.0f;
+        float simd_error = 0.0f;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Float4x4 model_new = get_pose_matrix(poses_new[i]);
+            Float4x4 normal_new = multiply(model_new, view_xform);
+            for (uint32_t column = 0; column < 3; ++column)
+            {
+                float const *s = &scalar[i].model_xform_new[column].x;
+                float const *n = &scalar[i].model_xform_normal_new[column].x;
+                for (uint32_t row = 0; row < 4; ++row)
+                {
+                    reference_error = std::max(reference_error, fabsf(s[row] - model_new.m[row][column]));
+                    reference_error = std::max(reference_error, (row < 3) ? fabsf(n[row] - normal_new.m[row][column]) : 0.0f);
+                }
+            }
+            float const *a = &scalar[i].model_xform_new[0].x;
+            float const *b = &simd[i].model_xform_new[0].x;
+            float const *c = &pooled[i].model_xform_new[0].x;
+            for (uint32_t j = 0; j < sizeof(InstanceTransforms) / sizeof(float); ++j)
+            {
+                simd_error = std::max(simd_error, std::max(fabsf(a[j] - b[j]), fabsf(a[j] - c[j])));
+            }
+        }
+
+        double bytes = double(sizeof(RigidPose)) * 2.0 * count + double(sizeof(InstanceTransforms)) * count;
+        fprintf(out, "Instance transforms, %u instances of %u bytes (%.2f MB upload per frame), %u threads (ms, best of %u)\n", count, uint32_t(sizeof(InstanceTransforms)),
+                sizeof(InstanceTransforms) * double(count) / (1024.0 * 1024.0), pool.get_thread_count(), BENCHMARK_REPETITIONS);
+        fprintf(out, "  scalar %.3f (%.1f ns/instance, %.2f GB/s), %s %.3f (%.1f ns/instance, %.2f GB/s, %.2fx), pool %.3f (%.2fx)\n", scalar_ms,
+                1e6 * scalar_ms / count, bytes / (scalar_ms * 1e6), CPUBLUR_SIMD_X86 ? "SSE" : "scalar fallback", simd_ms, 1e6 * simd_ms / count,
+                bytes / (simd_ms * 1e6), scalar_ms / simd_ms, pooled_ms, scalar_ms / pooled_ms);
+        fprintf(out, "  largest difference: scalar against the 4x4 products %.2e, SIMD against scalar %.2e\n\n", reference_error, simd_error);
+    }
+
+    void benchmark_render_queue(FILE *out, uint32_t draw_count)
+    {
+        // A scene of draw_count objects in random order: two vertex layouts, four vertex shaders, 32 materials and 256
+        // meshes, each object with its own constants, and one in 16 drawn instanced from one of four instance buffers
+        const uint32_t layout_keys[2] = {0x00000a12u, 0x00020a2bu};
+        std::vector<Scene::DrawItem> items(draw_count);
+        uint32_t state = 0x2545f491u;
+        auto next = [&state](uint32_t range) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state % range;
+        };
+        for (uint32_t i = 0; i < draw_count; ++i)
+        {
+            Scene::DrawItem &item = items[i];
+            item.geometry = next(256);
+            item.layout_key = layout_keys[item.geometry % 2];
+            item.shader = next(4);
+            item.material = next(32);
+            item.object_constants = i;
+            item.instance_data = (next(16) == 0) ? next(4) : Scene::RENDER_QUEUE_NONE;
+            item.index_count = 3 * (1 + item.geometry);
+            item.first_index = 0;
+            item.base_vertex = 0;
+            item.instance_count = (item.instance_data != Scene::RENDER_QUEUE_NONE) ? 64 : 0;
+            item.depth = 1000.0f * float(next(65536)) / 65536.0f;
+        }
+
+        Scene::RenderQueue queue;
+        double push_ms = time_best_of([&]() {
+            queue.clear();
+            for (uint32_t i = 0; i < draw_count; ++i)
+            {
+                queue.push(items[i]);
+            }
+        });
+        Scene::RecordingBackend backend;
+        Scene::RenderQueueStats unsorted = queue.submit(backend);
+        bool unsorted_valid = backend.check_bound_state();
+        double sort_ms = time_best_of([&]() { queue.sort(); });
+        double submit_ms = time_best_of([&]() {
+            backend.clear();
+            queue.submit(backend);
+        });
+        Scene::RenderQueueStats sorted = queue.submit(backend);
+        bool sorted_valid = backend.check_bound_state();
+
+        // The radix sort against std::stable_sort of the same keys
+        std::vector<uint64_t> keys(draw_count);
+        for (uint32_t i = 0; i < draw_count; ++i)
+        {
+            keys[i] = Scene::make_sort_key(items[i].layout_key == layout_keys[0] ? 0 : 1, items[i]);
+        }
+        std::vector<uint32_t> reference_order(draw_count);
+        double std_sort_ms = time_best_of([&]() {
+            for (uint32_t i = 0; i < draw_count; ++i)
+            {
+                reference_order[i] = i;
+            }
+            std::stable_sort(reference_order.begin(), reference_order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        });
+        std::vector<uint64_t> radix_keys = keys;
+        std::vector<uint32_t> radix_order;
+        Scene::radix_sort(radix_keys, radix_order);
+        bool same_order = (radix_order == reference_order);
+
+        uint32_t all_bindings = sorted.get_state_changes() + sorted.skipped_bindings;
+        fprintf(out, "Render queue, %u draws (ms, best of %u)\n", draw_count, BENCHMARK_REPETITIONS);
+        fprintf(out, "  push %.3f, radix sort %.3f (std::stable_sort %.3f, same order: %s), submit to the recording backend %.3f\n", push_ms, sort_ms, std_sort_ms,
+                same_order ? "yes" : "NO", submit_ms);
+        fprintf(out, "  bindings: %u without tracking, %u tracked in push order, %u tracked after sorting (bound state correct: %s)\n", all_bindings,
+                unsorted.get_state_changes(), sorted.get_state_changes(), (unsorted_valid && sorted_valid) ? "yes" : "NO");
+        fprintf(out, "  sorted: layout %u, shader %u, material %u, geometry %u, constants %u, instance data %u\n\n", sorted.layout_changes, sorted.shader_changes,
+                sorted.material_changes, sorted.geometry_changes, sorted.constant_changes, sorted.instance_changes);
+    }
+
+    void run_benchmarks(FILE *out)
+    {
+        benchmark_tile_max(out, 1920, 1080);
+        benchmark_tile_max(out, 3840, 2160);
+        benchmark_thread_scaling(out, 1920, 1080);
+        benchmark_thread_scaling(out, 3840, 2160);
+        benchmark_thread_scaling(out, 7680, 4320);
+        benchmark_tile_classification(out, 1920, 1080);
+        benchmark_tile_classification(out, 3840, 2160);
+        benchmark_simd_gather(out, 1920, 1080);
+        benchmark_simd_gather(out, 3840, 2160);
+        benchmark_specialized_gather(out, 1920, 1080);
+        benchmark_fused_tile_max(out, 1920, 1080);
+        benchmark_fused_tile_max(out, 3840, 2160);
+        benchmark_incremental_tiles(out, 1920, 1080);
+        benchmark_incremental_tiles(out, 3840, 2160);
+        benchmark_jitter_sources(out, 1920, 1080);
+        benchmark_packed_velocity_depth(out, 1920, 1080);
+        benchmark_packed_velocity_depth(out, 3840, 2160);
+        benchmark_velocity_encodings(out, 1920, 1080);
+        benchmark_linear_depth(out, 1920, 1080);
+        benchmark_half_resolution_gather(out, 1920, 1080);
+        benchmark_half_resolution_gather(out, 3840, 2160);
+        benchmark_adaptive_samples(out, 1920, 1080);
+        benchmark_adaptive_samples(out, 3840, 2160);
+        benchmark_uniform_velocity(out, 1920, 1080);
+        benchmark_uniform_velocity(out, 3840, 2160);
+        benchmark_blocked_gather(out, 1920, 1080);
+        benchmark_blocked_gather(out, 3840, 2160);
+        benchmark_swizzled_layouts(out, 1920, 1080);
+        benchmark_swizzled_layouts(out, 3840, 2160);
+        benchmark_work_stealing(out, 1920, 1080);
+        benchmark_work_stealing(out, 3840, 2160);
+        benchmark_software_rasterizer(out, 1280, 720);
+        benchmark_software_rasterizer(out, 1920, 1080);
+        benchmark_quantized_vertices(out, 1920, 1080);
+        benchmark_instance_transforms(out, 10000);
+        benchmark_instance_transforms(out, 100000);
+        benchmark_instance_transforms(out, 1000000);
+        benchmark_render_queue(out, 1000);
+        benchmark_render_queue(out, 10000);
+        benchmark_render_queue(out, 100000);
+    }
+}
@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/benchmark.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include "image.h"
+
+// Micro-benchmarks of the CPU reconstruction kernels. Results are written as plain text to the given stream.
+
+namespace CPUBlur
+{
+    class Stopwatch
+    {
+    public:
+        void start() { this->start_time = std::chrono::high_resolution_clock::now(); }
+        void stop() { this->stop_time = std::chrono::high_resolution_clock::now(); }
+        double milliseconds() const { return std::chrono::duration<double, std::milli>(this->stop_time - this->start_time).count(); }
+
+    private:
+        std::chrono::high_resolution_clock::time_point start_time;
+        std::chrono::high_resolution_clock::time_point stop_time;
+    };
+
+    // Synthetic C, Z, V inputs: a static textured background and a spinning disk in front of it, with
+    // velocities in the [-1, 1] range of the R8G8 encoding
+    struct TestFrame
+    {
+        ColorImage color;
+        DepthImage depth;
+        VelocityImage velocity;
+    };
+
+    void make_test_frame(uint32_t width, uint32_t height, TestFrame &frame);
+
+    void benchmark_tile_max(FILE *out, uint32_t width, uint32_t height);
+
+    // TileMax plus NeighborMax, and the gather at the best instruction set, on pools of 1, 2, 4, ... threads up to every
+    // hardware thread, with the speedup of each against one thread
+    void benchmark_thread_scaling(FILE *out, uint32_t width, uint32_t height);
+
+    void benchmark_tile_classification(FILE *out, uint32_t width, uint32_t height);
+
+    // Mpixels/s of the gather for every instruction set supported by this CPU, at K=20, S=15
+    void benchmark_simd_gather(FILE *out, uint32_t width, uint32_t height);
+
+    // Gather kernels compiled for a fixed S against the generic tap loop, for every supported instruction set
+    void benchmark_specialized_gather(FILE *out, uint32_t width, uint32_t height);
+
+    // Separate TileMax and NeighborMax passes against the fused streaming pass
+    void benchmark_fused_tile_max(FILE *out, uint32_t width, uint32_t height);
+
+    // Full TileMax/NeighborMax against IncrementalTiles::update on the frame after a small object moved
+    void benchmark_incremental_tiles(FILE *out, uint32_t width, uint32_t height);
+
+    // Gather time, spectrum and error against a many-tap reference for each JitterSource
+    void benchmark_jitter_sources(FILE *out, uint32_t width, uint32_t height);
+
+    // Gather with separate Z and V reads per tap against the packed (Z, TempV) layout, for every instruction set
+    void benchmark_packed_velocity_depth(FILE *out, uint32_t width, uint32_t height);
+
+    // Memory traffic of the velocity buffers and gather error against float velocities for each VelocityEncoding
+    void benchmark_velocity_encodings(FILE *out, uint32_t width, uint32_t height);
+
+    // Gather on D24-style post-projection depth against the R16_FLOAT view-space depth of linear_depth, on the
+    // software-rasterized windmill frame
+    void benchmark_linear_depth(FILE *out, uint32_t width, uint32_t height);
+
+    // Full-resolution gather against downsample + half-resolution gather + joint-bilateral upsample: cost of each
+    // step and PSNR against the full-resolution result
+    void benchmark_half_resolution_gather(FILE *out, uint32_t width, uint32_t height);
+
+    // Gather with the global S against the per-tile tap counts of compute_tile_sample_counts: time, average taps per
+    // pixel and PSNR against the fixed-S result
+    void benchmark_adaptive_samples(FILE *out, uint32_t width, uint32_t height);
+
+    // gather_simd against gather_uniform_velocity on the disk, windmill and panning-camera frames: time, share of tiles
+    // taking the fast path and PSNR against the gather
+    void benchmark_uniform_velocity(FILE *out, uint32_t width, uint32_t height);
+
+    // Row-major gather_simd against gather_blocked at K=20 on one thread: time, and L1D and last-level cache misses per
+    // pixel from perf_event_open where the counters are available
+    void benchmark_blocked_gather(FILE *out, uint32_t width, uint32_t height);
+
+    // Scalar TileMax, NeighborMax and gather with C, Z and V in row-major, 8x8 block-linear and Morton order on the
+    // disk and windmill frames: conversion cost, time of each pass and whether the results match the row-major ones
+    void benchmark_swizzled_layouts(FILE *out, uint32_t width, uint32_t height);
+
+    // gather_simd's equal row bands against gather_scheduled on the disk, windmill and panning-camera frames: time,
+    // makespan (when the last thread finished) and thread utilization over it for each, and tasks stolen
+    void benchmark_work_stealing(FILE *out, uint32_t width, uint32_t height);
+
+    // Software G-buffer pass over the windmill meshes, followed by the reconstruction of its output
+    void benchmark_software_rasterizer(FILE *out, uint32_t width, uint32_t height);
+
+    // Float vertex streams against the interleaved Scene::QuantizedVertex layout for the windmill meshes: buffer and
+    // fetch bytes, encode and decode time, decode error, and how the software G-buffer of the decoded meshes differs
+    void benchmark_quantized_vertices(FILE *out, uint32_t width, uint32_t height);
+
+    // build_instance_transforms_scalar against the SSE build_instance_transforms, alone and across the pool, for count
+    // rigid instances: time, throughput and largest difference from the scalar results
+    void benchmark_instance_transforms(FILE *out, uint32_t count);
+
+    // Scene::RenderQueue over draw_count random draws submitted to a Scene::RecordingBackend: push, radix sort and
+    // submission time, and the bindings issued without state tracking, with it in push order and after sorting
+    void benchmark_render_queue(FILE *out, uint32_t draw_count);
+
+    // Runs every benchmark at the resolutions of interest
+    void run_benchmarks(FILE *out);
+}
@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/blocked_gather.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "blocked_gather.h"
+#include <math.h>
+#include <algorithm>
+
+namespace CPUBlur
+{
+    uint32_t get_gather_bytes_per_pixel(Inputs const &inputs)
+    {
+        if (inputs.velocity_depth)
+        {
+            return uint32_t(sizeof(Float4) + sizeof(Float2));
+        }
+        return uint32_t(sizeof(Float4) + sizeof(float) + sizeof(Unorm8x2));
+    }
+
+    uint32_t compute_gather_halo(VelocityImage const &neighbor_max, Parameters const &params)
+    {
+        float temp_max = 0.0f;
+        for (uint32_t ty = 0; ty < neighbor_max.get_height(); ++ty)
+        {
+            Unorm8x2 const *row = neighbor_max.row(ty);
+            for (uint32_t tx = 0; tx < neighbor_max.get_width(); ++tx)
+            {
+                temp_max = std::max(temp_max, clamp(length(read_velocity(row[tx])) * params.half_exposure, 0.1f, float(params.K)));
+            }
+        }
+
+        // The odd taps follow the normalized velocity and reach max_sample_tap_distance, the even ones TempNX times it
+        return uint32_t(ceilf(params.max_sample_tap_distance * std::max(temp_max, 1.0f))) + 1;
+    }
+
+    uint32_t compute_gather_block_size(uint32_t halo, uint32_t bytes_per_pixel, uint32_t cache_size, uint32_t simd_width)
+    {
+        uint32_t footprint = uint32_t(sqrtf(float(cache_size / 2) / float(bytes_per_pixel)));
+        uint32_t block_size = (footprint > 2 * halo) ? footprint - 2 * halo : 0;
+        return std::max(block_size / simd_width * simd_width, simd_width);
+    }
+
+    void compute_morton_block_order(uint32_t blocks_x, uint32_t blocks_y, std::vector<uint32_t> &order)
+    {
+        order.resize(blocks_x * blocks_y);
+        for (uint32_t i = 0; i < blocks_x * blocks_y; ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [blocks_x](uint32_t a, uint32_t b) {
+            return morton_encode(a % blocks_x, a / blocks_x) < morton_encode(b % blocks_x, b / blocks_x);
+        });
+    }
+
+    void gather_blocked(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, uint32_t block_size)
+    {
+        uint32_t width = out.get_width();
+        uint32_t height = out.get_height();
+        if (block_size == 0)
+        {
+            uint32_t halo = compute_gather_halo(*inputs.neighbor_max, params);
+            block_size = compute_gather_block_size(halo, get_gather_bytes_per_pixel(inputs), detect_l2_cache_size(), get_simd_level_width(level));
+        }
+
+        uint32_t blocks_x = (width + block_size - 1) / block_size;
+        uint32_t blocks_y = (height + block_size - 1) / block_size;
+        std::vector<uint32_t> order;
+        compute_morton_block_order(blocks_x, blocks_y, order);
+
+        GatherSpanFunction gather_span = get_gather_span_function(level, params.S);
+
+        // Each thread takes a contiguous stretch of the Morton order, which is a compact region of the frame
+        pool.parallel_rows(uint32_t(order.size()), [&](uint32_t block_begin, uint32_t block_end) {
+            for (uint32_t i = block_begin; i < block_end; ++i)
+            {
+                uint32_t bx = order[i] % blocks_x;
+                uint32_t by = order[i] / blocks_x;
+                uint32_t x_begin = bx * block_size;
+                uint32_t x_end = std::min(x_begin + block_size, width);
+                uint32_t y_end = std::min((by + 1) * block_size, height);
+                for (uint32_t y = by * block_size; y < y_end; ++y)
+                {
+                    gather_span(inputs, params, y, x_begin, x_end, out.row(y));
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/blocked_gather.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// Cache-blocked traversal of the gather. Row-major spans sweep whole rows, so once the taps reach a few rows away the
+// texels a row needs have been evicted by the time the rows below need them again. Here the frame is cut into square
+// blocks sized so that a block plus a halo of the longest tap reach (max_sample_tap_distance * |NX|) fits in half of
+// L2, and the blocks are handed out in Morton order so that consecutive blocks, and the band of each thread, share
+// most of their halo.
+
+namespace CPUBlur
+{
+    // Bytes a tap pixel costs: C, Z and V, or C and the packed velocity/depth
+    uint32_t get_gather_bytes_per_pixel(Inputs const &inputs);
+
+    // Farthest a tap lands from its pixel, in pixels, for the longest NeighborMax of the frame, with a pixel of margin
+    // for the half-texel offset and the bilinear fetch
+    uint32_t compute_gather_halo(VelocityImage const &neighbor_max, Parameters const &params);
+
+    // Largest multiple of simd_width whose block plus halo fits in half of cache_size; never below simd_width
+    uint32_t compute_gather_block_size(uint32_t halo, uint32_t bytes_per_pixel, uint32_t cache_size, uint32_t simd_width);
+
+    // Block indices (by * blocks_x + bx) sorted by morton_encode(bx, by)
+    void compute_morton_block_order(uint32_t blocks_x, uint32_t blocks_y, std::vector<uint32_t> &order);
+
+    // gather_simd over square blocks of block_size pixels in Morton order; 0 sizes them from detect_l2_cache_size
+    // and the halo of the frame
+    void gather_blocked(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, uint32_t block_size = 0);
+}
@@ -0,0 +1,199 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/constants.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// Portable mirror of shaders/constants.hlsli, shared by every CPU implementation of the reconstruction filter.
+
+namespace CPUBlur
+{
+    struct Float2
+    {
+        float x;
+        float y;
+    };
+
+    struct Float4
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+
+    // Texel of an R8G8_UNORM target (V, TileMax and NeighborMax)
+    struct Unorm8x2
+    {
+        uint8_t x;
+        uint8_t y;
+    };
+
+    const float EPSILON1 = 0.01f;
+    const float EPSILON2 = 0.001f;
+    const float HALF_VELOCITY_CUTOFF = 0.25f;
+    const float SOFT_Z_EXTENT = 0.10f;
+    const float CYLINDER_CORNER_1 = 0.95f;
+    const float CYLINDER_CORNER_2 = 1.05f;
+    const float VARIANCE_THRESHOLD = 1.5f;
+    const float WEIGHT_CORRECTION_FACTOR = 60.0f;
+
+    // Adaptive sample count: taps per pixel of blur length along NX, and the fewest taps a blurred tile gets
+    const float ADAPTIVE_TAPS_PER_PIXEL = 1.0f;
+    const uint32_t ADAPTIVE_MIN_S = 3;
+
+    // Work-stealing gather: estimated cost of an early-out pixel and setup cost of a blurred pixel, both in taps, and
+    // tasks dealt to each thread. Measured on gather_simd at 1080p, an early-out pixel costs about as much as the setup
+    // of a blurred one, four taps.
+    const float SCHEDULER_EARLY_OUT_COST = 4.0f;
+    const float SCHEDULER_PIXEL_COST = 4.0f;
+    const uint32_t SCHEDULER_TASKS_PER_THREAD = 8;
+
+    // Velocity clear value (GRAY in the shaders)
+    const Unorm8x2 VELOCITY_GRAY = {128, 128};
+
+    inline float saturate(float v)
+    {
+        return std::min(std::max(v, 0.0f), 1.0f);
+    }
+
+    inline float clamp(float v, float lo, float hi)
+    {
+        return std::min(std::max(v, lo), hi);
+    }
+
+    inline float smoothstep(float a, float b, float x)
+    {
+        float t = saturate((x - a) / (b - a));
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    inline float sign(float v)
+    {
+        return (v > 0.0f) ? 1.0f : ((v < 0.0f) ? -1.0f : 0.0f);
+    }
+
+    inline float dot(Float2 a, Float2 b)
+    {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    inline float length(Float2 v)
+    {
+        return sqrtf(dot(v, v));
+    }
+
+    inline Float2 normalize(Float2 v)
+    {
+        float inv_length = 1.0f / length(v);
+        Float2 result = {v.x * inv_length, v.y * inv_length};
+        return result;
+    }
+
+    inline float unorm8_to_float(uint8_t v)
+    {
+        return float(v) * (1.0f / 255.0f);
+    }
+
+    // D3D FLOAT -> UNORM conversion (saturate, scale and round to nearest)
+    inline uint8_t float_to_unorm8(float v)
+    {
+        return uint8_t(saturate(v) * 255.0f + 0.5f);
+    }
+
+    // D3D FLOAT32 -> FLOAT16 conversion (round to nearest even, overflow to infinity), widened back to float
+    inline float round_to_half(float v)
+    {
+        float magnitude = fabsf(v);
+        if (!(magnitude < 65520.0f))
+        {
+            return (v > 0.0f) ? HUGE_VALF : ((v < 0.0f) ? -HUGE_VALF : v);
+        }
+        if (magnitude >= 6.10351562e-05f)
+        {
+            // Normal range: drop the 13 low mantissa bits, rounding to nearest even
+            uint32_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            bits += 0x0fffu + ((bits >> 13) & 1u);
+            bits &= ~0x1fffu;
+            memcpy(&v, &bits, sizeof(bits));
+            return v;
+        }
+        // Subnormal range: fixed step of 2^-24
+        return ldexpf(nearbyintf(ldexpf(v, 24)), -24);
+    }
+
+    inline Float2 read_bias_scale(Float2 v)
+    {
+        Float2 result = {v.x * 2.0f - 1.0f, v.y * 2.0f - 1.0f};
+        return result;
+    }
+
+    inline Float2 write_bias_scale(Float2 v)
+    {
+        Float2 result = {(v.x + 1.0f) * 0.5f, (v.y + 1.0f) * 0.5f};
+        return result;
+    }
+
+    inline Float2 read_velocity(Unorm8x2 texel)
+    {
+        Float2 v = {unorm8_to_float(texel.x), unorm8_to_float(texel.y)};
+        return read_bias_scale(v);
+    }
+
+    inline Unorm8x2 write_velocity(Float2 velocity)
+    {
+        Float2 v = write_bias_scale(velocity);
+        Unorm8x2 texel = {float_to_unorm8(v.x), float_to_unorm8(v.y)};
+        return texel;
+    }
+
+    inline float cone(float mag_diff, float mag_v)
+    {
+        return 1.0f - fabsf(mag_diff) / mag_v;
+    }
+
+    inline float cylinder(float mag_diff, float mag_v)
+    {
+        return 1.0f - smoothstep(CYLINDER_CORNER_1 * mag_v, CYLINDER_CORNER_2 * mag_v, fabsf(mag_diff));
+    }
+
+    inline float soft_depth_compare(float za, float zb)
+    {
+        return clamp(1.0f - (za - zb) / SOFT_Z_EXTENT, 0.0f, 1.0f);
+    }
+}
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/fused_tile_max.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "fused_tile_max.h"
+#include <vector>
+#include "reconstruction.h"
+
+namespace CPUBlur
+{
+    void tile_max_neighbor_max_fused(VelocityImage const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool)
+    {
+        uint32_t tile_width = out.get_width();
+        uint32_t tile_height = out.get_height();
+
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            // TileMax row y lives in slot y % 3. Every band starts its own window, so the TileMax rows just
+            // outside a band are computed by both of its neighbours.
+            std::vector<Unorm8x2> window(3 * size_t(tile_width));
+
+            uint32_t rows[3];
+            neighbor_max_rows(tile_height, row_begin, rows);
+            uint32_t next_row = rows[0];
+
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                // rows[] spans at most ty - 1 .. ty + 1, so the three slots never alias
+                neighbor_max_rows(tile_height, ty, rows);
+                for (; next_row <= rows[2]; ++next_row)
+                {
+                    Unorm8x2 *dst = &window[size_t(next_row % 3) * tile_width];
+                    for (uint32_t tx = 0; tx < tile_width; ++tx)
+                    {
+                        dst[tx] = tile_max_texel(velocity, K, tile_width, tile_height, tx, next_row);
+                    }
+                }
+
+                Unorm8x2 const *tile_max_rows[3];
+                for (uint32_t t = 0; t < 3; ++t)
+                {
+                    tile_max_rows[t] = &window[size_t(rows[t] % 3) * tile_width];
+                }
+
+                Unorm8x2 *dst = out.row(ty);
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    dst[tx] = neighbor_max_texel(tile_max_rows, tile_width, tx);
+                }
+            }
+        });
+    }
+}
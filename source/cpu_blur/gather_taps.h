@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/gather_taps.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// Sample tap layout of ps_gather.hlsl for a compile-time S. The shader places tap i at
+//   T = lerp(-d, d, (i + R + 1) / (S + 1))
+// which is split here into a constant per-tap offset and the per-pixel jitter:
+//   T = d * offset[tap] + R * 2d / (S + 1)
+// Taps are listed in loop order with SelfIndex = (S - 1) / 2 already removed.
+
+namespace CPUBlur
+{
+    // The UI steps S through the odd values 1..19; every one of them has a specialized gather
+    const uint32_t GATHER_MAX_SPECIALIZED_S = 19;
+
+    inline bool is_specialized_S(uint32_t S)
+    {
+        return (S & 1) == 1 && S <= GATHER_MAX_SPECIALIZED_S;
+    }
+
+    template <uint32_t S>
+    struct GatherTapTable
+    {
+        static const uint32_t COUNT = S - 1;
+
+        float offset[S];           // In [-1, 1], multiplied by max_sample_tap_distance
+        bool use_corrected_VX[S];  // Odd loop indices take CorrectedVX, even ones NX
+    };
+
+    template <uint32_t S>
+    constexpr GatherTapTable<S> make_gather_tap_table()
+    {
+        GatherTapTable<S> table = {};
+        uint32_t tap = 0;
+        for (uint32_t i = 0; i < S; ++i)
+        {
+            if (i == (S - 1) / 2)
+            {
+                continue;
+            }
+            table.offset[tap] = 2.0f * float(i + 1) / float(S + 1) - 1.0f;
+            table.use_corrected_VX[tap] = (i & 1) == 1;
+            ++tap;
+        }
+        return table;
+    }
+
+    template <uint32_t S>
+    struct GatherTaps
+    {
+        static constexpr GatherTapTable<S> TABLE = make_gather_tap_table<S>();
+
+        // R * JITTER_SCALE * max_sample_tap_distance is the per-pixel part of T
+        static constexpr float JITTER_SCALE = 2.0f / float(S + 1);
+    };
+
+    template <uint32_t S>
+    constexpr GatherTapTable<S> GatherTaps<S>::TABLE;
+
+    template <uint32_t S>
+    constexpr float GatherTaps<S>::JITTER_SCALE;
+}
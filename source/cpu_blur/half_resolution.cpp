@@ -0,0 +1,265 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/half_resolution.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "half_resolution.h"
+#include <string.h>
+#include <vector>
+
+namespace CPUBlur
+{
+    namespace
+    {
+        // 2^x for x <= 0 to within 0.2%, which is plenty for the bilateral weights and much cheaper than exp2f. Flushed
+        // at 2^-32, far below UPSAMPLE_MIN_WEIGHT, so that the weighted sums never go denormal.
+        float fast_exp2(float x)
+        {
+            x = std::max(x, -32.0f);
+            int32_t exponent = int32_t(x);
+            exponent -= (float(exponent) > x) ? 1 : 0;
+            float f = x - float(exponent);
+            float mantissa = 1.0f + f * (0.6565f + f * 0.3435f);
+            int32_t bits;
+            memcpy(&bits, &mantissa, sizeof(bits));
+            bits += exponent << 23;
+            memcpy(&mantissa, &bits, sizeof(bits));
+            return mantissa;
+        }
+    }
+
+    void compute_half_resolution_dimensions(uint32_t width, uint32_t height, uint32_t &half_width, uint32_t &half_height)
+    {
+        half_width = (width + 1) / 2;
+        half_height = (height + 1) / 2;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_downsample.hlsl
+
+    void downsample_gather_inputs(ColorImage const &color, DepthImage const &depth, VelocityImage const &velocity, HalfResolutionFrame &half, ThreadPool &pool)
+    {
+        uint32_t width = color.get_width();
+        uint32_t height = color.get_height();
+        uint32_t half_width, half_height;
+        compute_half_resolution_dimensions(width, height, half_width, half_height);
+        half.color.resize(half_width, half_height);
+        half.depth.resize(half_width, half_height);
+        half.velocity.resize(half_width, half_height);
+        half.blurred.resize(half_width, half_height);
+
+        pool.parallel_rows(half_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t j = row_begin; j < row_end; ++j)
+            {
+                uint32_t y[2] = {2 * j, std::min(2 * j + 1, height - 1)};
+                for (uint32_t i = 0; i < half_width; ++i)
+                {
+                    uint32_t x[2] = {2 * i, std::min(2 * i + 1, width - 1)};
+
+                    Float4 sum = {0.0f, 0.0f, 0.0f, 0.0f};
+                    uint32_t closest_x = x[0];
+                    uint32_t closest_y = y[0];
+                    for (uint32_t t = 0; t < 2; ++t)
+                    {
+                        for (uint32_t s = 0; s < 2; ++s)
+                        {
+                            Float4 const &c = color.at(x[s], y[t]);
+                            sum.x += c.x;
+                            sum.y += c.y;
+                            sum.z += c.z;
+                            sum.w += c.w;
+                            if (depth.at(x[s], y[t]) < depth.at(closest_x, closest_y))
+                            {
+                                closest_x = x[s];
+                                closest_y = y[t];
+                            }
+                        }
+                    }
+
+                    half.color.at(i, j) = Float4{sum.x * 0.25f, sum.y * 0.25f, sum.z * 0.25f, sum.w * 0.25f};
+                    half.depth.at(i, j) = depth.at(closest_x, closest_y);
+                    half.velocity.at(i, j) = velocity.at(closest_x, closest_y);
+                }
+            }
+        });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_upsample.hlsl
+
+    namespace
+    {
+        // Bilateral blend of the four half-resolution texels around a pixel that is not early-outed
+        Float4 upsample_taps(HalfResolutionFrame const &half, Parameters const &params, Float4 const &CX, float ZX, Float2 VX, uint32_t x, uint32_t y)
+        {
+            // The four half-resolution texels around the pixel centre, as a bilinear fetch would weight them: the centre
+            // of an even pixel lies a quarter texel right of the texel centre to its left, an odd pixel a quarter texel
+            // left of the one to its right
+            int32_t half_width = int32_t(half.blurred.get_width());
+            int32_t half_height = int32_t(half.blurred.get_height());
+            int32_t i0 = int32_t(x + 1) / 2 - 1;
+            int32_t j0 = int32_t(y + 1) / 2 - 1;
+            float fu = (x & 1) ? 0.25f : 0.75f;
+            float fv = (y & 1) ? 0.25f : 0.75f;
+
+            float sum_weight = 0.0f;
+            Float4 sum = {0.0f, 0.0f, 0.0f, 0.0f};
+            float best_similarity = -1.0f;
+            Float4 best = CX;
+            for (int32_t t = 0; t < 2; ++t)
+            {
+                uint32_t j = uint32_t(std::min(std::max(j0 + t, 0), half_height - 1));
+                float bilinear_y = (t == 0) ? 1.0f - fv : fv;
+                for (int32_t s = 0; s < 2; ++s)
+                {
+                    uint32_t i = uint32_t(std::min(std::max(i0 + s, 0), half_width - 1));
+                    float bilinear_x = (s == 0) ? 1.0f - fu : fu;
+
+                    Float2 VY = read_velocity(half.velocity.at(i, j));
+                    Float2 dV = {(VY.x - VX.x) * params.half_exposure, (VY.y - VX.y) * params.half_exposure};
+                    float similarity = fast_exp2(-(fabsf(half.depth.at(i, j) - ZX) * (1.0f / SOFT_Z_EXTENT) + length(dV) * (1.0f / UPSAMPLE_VELOCITY_EXTENT)));
+                    float weight = bilinear_x * bilinear_y * similarity;
+
+                    Float4 const &CY = half.blurred.at(i, j);
+                    sum.x += weight * CY.x;
+                    sum.y += weight * CY.y;
+                    sum.z += weight * CY.z;
+                    sum_weight += weight;
+                    if (similarity > best_similarity)
+                    {
+                        best_similarity = similarity;
+                        best = CY;
+                    }
+                }
+            }
+
+            if (sum_weight < UPSAMPLE_MIN_WEIGHT)
+            {
+                return Float4{best.x, best.y, best.z, 1.0f};
+            }
+            float inv_sum_weight = 1.0f / sum_weight;
+            return Float4{sum.x * inv_sum_weight, sum.y * inv_sum_weight, sum.z * inv_sum_weight, 1.0f};
+        }
+
+        bool is_still_tile(Unorm8x2 neighbor_max, Parameters const &params)
+        {
+            float temp_NX = clamp(length(read_velocity(neighbor_max)) * params.half_exposure, 0.1f, float(params.K));
+            return temp_NX < HALF_VELOCITY_CUTOFF;
+        }
+    }
+
+    Float4 upsample_gather_pixel(Inputs const &inputs, HalfResolutionFrame const &half, Parameters const &params, uint32_t x, uint32_t y)
+    {
+        ColorImage const &color = *inputs.color;
+        Float4 CX = color.at(x, y);
+
+        // Same early-out as the gather: without motion in the neighborhood the pixel is not blurred at all
+        Float2 X = {(float(x) + 0.5f) / float(color.get_width()), (float(y) + 0.5f) / float(color.get_height())};
+        if (is_still_tile(inputs.neighbor_max->sample_point_clamp(X), params))
+        {
+            return CX;
+        }
+
+        return upsample_taps(half, params, CX, inputs.depth->at(x, y), read_velocity(inputs.velocity->at(x, y)), x, y);
+    }
+
+    void upsample_gather(Inputs const &inputs, HalfResolutionFrame const &half, Parameters const &params, ColorImage &out, ThreadPool &pool)
+    {
+        uint32_t width = out.get_width();
+        uint32_t height = out.get_height();
+        VelocityImage const &neighbor_max = *inputs.neighbor_max;
+        uint32_t tile_width = neighbor_max.get_width();
+
+        // The NeighborMax column of every pixel, so that each row only classifies its tiles once and copies the still
+        // ones as whole spans
+        std::vector<uint32_t> tile_x(width);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            tile_x[x] = VelocityImage::point_clamp_index((float(x) + 0.5f) / float(width), tile_width);
+        }
+
+        pool.parallel_rows(height, [&](uint32_t row_begin, uint32_t row_end) {
+            std::vector<uint8_t> still(tile_width);
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                uint32_t ty = VelocityImage::point_clamp_index((float(y) + 0.5f) / float(height), neighbor_max.get_height());
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    still[tx] = is_still_tile(neighbor_max.at(tx, ty), params) ? 1 : 0;
+                }
+
+                Float4 const *src = inputs.color->row(y);
+                float const *depth = inputs.depth->row(y);
+                Unorm8x2 const *velocity = inputs.velocity->row(y);
+                Float4 *dst = out.row(y);
+                uint32_t x = 0;
+                while (x < width)
+                {
+                    uint32_t span_end = x + 1;
+                    while (span_end < width && tile_x[span_end] == tile_x[x])
+                    {
+                        ++span_end;
+                    }
+                    if (still[tile_x[x]])
+                    {
+                        memcpy(dst + x, src + x, (span_end - x) * sizeof(Float4));
+                    }
+                    else
+                    {
+                        for (; x < span_end; ++x)
+                        {
+                            dst[x] = upsample_taps(half, params, src[x], depth[x], read_velocity(velocity[x]), x, y);
+                        }
+                    }
+                    x = span_end;
+                }
+            }
+        });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    void gather_half_resolution(Inputs const &inputs, Parameters const &params, HalfResolutionFrame &half, ColorImage &out, ThreadPool &pool, SimdLevel level)
+    {
+        downsample_gather_inputs(*inputs.color, *inputs.depth, *inputs.velocity, half, pool);
+
+        Inputs half_inputs = inputs;
+        half_inputs.color = &half.color;
+        half_inputs.depth = &half.depth;
+        half_inputs.velocity = &half.velocity;
+        half_inputs.velocity_depth = nullptr;
+        Parameters half_params = params;
+        half_params.max_sample_tap_distance = 0.5f * params.max_sample_tap_distance;
+        gather_simd(half_inputs, half_params, half.blurred, pool, level);
+
+        upsample_gather(inputs, half, params, out, pool);
+    }
+}
@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/half_resolution.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// Quality mode that runs the gather on half-resolution C, Z, V (ps_downsample.hlsl) and brings the result back with a
+// joint-bilateral upsample guided by the full-resolution Z and V (ps_upsample.hlsl). Pixels whose NeighborMax is below
+// HALF_VELOCITY_CUTOFF keep their full-resolution color, as they do in the full-resolution gather.
+
+namespace CPUBlur
+{
+    // Bilateral weights of the upsample: each tap is scaled by 2^-(|dZ| / SOFT_Z_EXTENT + |dV| / this), with dV the
+    // difference of the half-velocities scaled by the exposure
+    const float UPSAMPLE_VELOCITY_EXTENT = 0.5f;
+
+    // Below this total weight no half-resolution tap resembles the pixel, and the most similar one is used alone
+    const float UPSAMPLE_MIN_WEIGHT = 1.0e-4f;
+
+    // Gather inputs at half resolution, and the output of the gather at that resolution
+    struct HalfResolutionFrame
+    {
+        ColorImage color;
+        DepthImage depth;
+        VelocityImage velocity;
+        ColorImage blurred;
+    };
+
+    // Rounded up, so that every full-resolution texel belongs to a 2x2 footprint
+    void compute_half_resolution_dimensions(uint32_t width, uint32_t height, uint32_t &half_width, uint32_t &half_height);
+
+    // Each half-resolution texel takes the average color of its 2x2 footprint, and the depth and velocity of the closest
+    // texel in it, so that thin foreground objects keep their motion. Resizes half.
+    void downsample_gather_inputs(ColorImage const &color, DepthImage const &depth, VelocityImage const &velocity, HalfResolutionFrame &half, ThreadPool &pool);
+
+    Float4 upsample_gather_pixel(Inputs const &inputs, HalfResolutionFrame const &half, Parameters const &params, uint32_t x, uint32_t y);
+    void upsample_gather(Inputs const &inputs, HalfResolutionFrame const &half, Parameters const &params, ColorImage &out, ThreadPool &pool);
+
+    // Downsample, gather_simd at half resolution with half the tap distance in pixels (the same distance in UV), and
+    // upsample into out. inputs.velocity_depth is ignored. Depth should be linear (linear_depth) for the bilateral
+    // weights to be meaningful.
+    void gather_half_resolution(Inputs const &inputs, Parameters const &params, HalfResolutionFrame &half, ColorImage &out, ThreadPool &pool, SimdLevel level);
+}
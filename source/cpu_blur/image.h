@@ -0,0 +1,171 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/image.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include "constants.h"
+
+namespace CPUBlur
+{
+    // Row-major 2D texel array with the addressing modes used by the reconstruction shaders
+    template <typename T>
+    class Image
+    {
+    public:
+        Image()
+        {
+            this->width = 0;
+            this->height = 0;
+        }
+
+        Image(uint32_t w, uint32_t h)
+        {
+            this->resize(w, h);
+        }
+
+        void resize(uint32_t w, uint32_t h)
+        {
+            this->width = w;
+            this->height = h;
+            this->texels.assign(size_t(w) * size_t(h), T());
+        }
+
+        void fill(T const &value)
+        {
+            std::fill(this->texels.begin(), this->texels.end(), value);
+        }
+
+        uint32_t get_width() const { return this->width; }
+        uint32_t get_height() const { return this->height; }
+        bool empty() const { return this->texels.empty(); }
+
+        T *data() { return this->texels.data(); }
+        T const *data() const { return this->texels.data(); }
+
+        T *row(uint32_t y) { return &this->texels[size_t(y) * this->width]; }
+        T const *row(uint32_t y) const { return &this->texels[size_t(y) * this->width]; }
+
+        T &at(uint32_t x, uint32_t y) { return this->texels[size_t(y) * this->width + x]; }
+        T const &at(uint32_t x, uint32_t y) const { return this->texels[size_t(y) * this->width + x]; }
+
+        // Texel index along one axis as selected by sampPointClamp
+        static uint32_t point_clamp_index(float uv, uint32_t size)
+        {
+            float texel = floorf(uv * float(size));
+            return uint32_t(clamp(texel, 0.0f, float(size - 1)));
+        }
+
+        // Texel index along one axis as selected by sampPointWrap
+        static uint32_t point_wrap_index(float uv, uint32_t size)
+        {
+            int32_t texel = int32_t(floorf(uv * float(size))) % int32_t(size);
+            return uint32_t((texel < 0) ? texel + int32_t(size) : texel);
+        }
+
+        T const &sample_point_clamp(Float2 uv) const
+        {
+            return this->at(point_clamp_index(uv.x, this->width), point_clamp_index(uv.y, this->height));
+        }
+
+        T const &sample_point_wrap(Float2 uv) const
+        {
+            return this->at(point_wrap_index(uv.x, this->width), point_wrap_index(uv.y, this->height));
+        }
+
+    private:
+        uint32_t width;
+        uint32_t height;
+        std::vector<T> texels;
+    };
+
+    typedef Image<Float4> ColorImage;     // C (R16G16B16A16_FLOAT on the GPU)
+    typedef Image<float> DepthImage;      // Z (R24 part of D24S8 on the GPU)
+    typedef Image<Unorm8x2> VelocityImage; // V, TileMax and NeighborMax (R8G8_UNORM on the GPU)
+    typedef Image<uint8_t> RandomImage;   // Jitter texture (R8_UNORM on the GPU)
+    typedef Image<Float2> VelocityDepthImage; // Packed (Z, TempV) for the gather taps (R32G32_FLOAT on the GPU)
+    typedef Image<uint8_t> TileSampleImage; // Per-tile tap count of the adaptive gather (R8_UINT on the GPU)
+
+    // Z-order index of (x, y), both below 2^16: the bits of x on the even positions, those of y on the odd ones
+    inline uint32_t morton_encode(uint32_t x, uint32_t y)
+    {
+        uint32_t v[2] = {x & 0xFFFF, y & 0xFFFF};
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            v[i] = (v[i] | (v[i] << 8)) & 0x00FF00FF;
+            v[i] = (v[i] | (v[i] << 4)) & 0x0F0F0F0F;
+            v[i] = (v[i] | (v[i] << 2)) & 0x33333333;
+            v[i] = (v[i] | (v[i] << 1)) & 0x55555555;
+        }
+        return v[0] | (v[1] << 1);
+    }
+
+    // sampLinearClamp on the color buffer, in any layout with the interface of Image
+    template <typename ColorImageT>
+    inline Float4 sample_linear_clamp(ColorImageT const &image, Float2 uv)
+    {
+        uint32_t w = image.get_width();
+        uint32_t h = image.get_height();
+
+        float fx = uv.x * float(w) - 0.5f;
+        float fy = uv.y * float(h) - 0.5f;
+        float x0f = floorf(fx);
+        float y0f = floorf(fy);
+        float ax = fx - x0f;
+        float ay = fy - y0f;
+
+        uint32_t x0 = uint32_t(clamp(x0f, 0.0f, float(w - 1)));
+        uint32_t x1 = uint32_t(clamp(x0f + 1.0f, 0.0f, float(w - 1)));
+        uint32_t y0 = uint32_t(clamp(y0f, 0.0f, float(h - 1)));
+        uint32_t y1 = uint32_t(clamp(y0f + 1.0f, 0.0f, float(h - 1)));
+
+        Float4 const &c00 = image.at(x0, y0);
+        Float4 const &c10 = image.at(x1, y0);
+        Float4 const &c01 = image.at(x0, y1);
+        Float4 const &c11 = image.at(x1, y1);
+
+        float w00 = (1.0f - ax) * (1.0f - ay);
+        float w10 = ax * (1.0f - ay);
+        float w01 = (1.0f - ax) * ay;
+        float w11 = ax * ay;
+
+        Float4 result = {
+            c00.x * w00 + c10.x * w10 + c01.x * w01 + c11.x * w11,
+            c00.y * w00 + c10.y * w10 + c01.y * w01 + c11.y * w11,
+            c00.z * w00 + c10.z * w10 + c01.z * w01 + c11.z * w11,
+            c00.w * w00 + c10.w * w10 + c01.w * w01 + c11.w * w11};
+        return result;
+    }
+}
@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/incremental_tiles.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "incremental_tiles.h"
+#include <algorithm>
+#include <string.h>
+#include "reconstruction.h"
+
+namespace CPUBlur
+{
+    void compute_tile_max_footprint(uint32_t size, uint32_t tile_count, uint32_t K, uint32_t t, uint32_t &first, uint32_t &last)
+    {
+        // Same coordinates as tile_max_texel; the index is monotonic in the tap, so the first and last taps bound it
+        float tex_coord_base = (float(t) + 0.5f) / float(tile_count);
+        float tex_coord_increment = 1.0f / float(size);
+        first = VelocityImage::point_clamp_index(tex_coord_base, size);
+        last = VelocityImage::point_clamp_index(tex_coord_base + float(K - 1) * tex_coord_increment, size);
+    }
+
+    IncrementalTiles::IncrementalTiles()
+    {
+        this->valid = false;
+        this->last_K = 0;
+        this->stats.tile_count = 0;
+        this->stats.tile_max_recomputed = 0;
+        this->stats.neighbor_max_recomputed = 0;
+    }
+
+    void IncrementalTiles::update(VelocityImage const &velocity, uint32_t K, VelocityImage &tile_max_out, VelocityImage &neighbor_max_out, ThreadPool &pool)
+    {
+        uint32_t width = velocity.get_width();
+        uint32_t height = velocity.get_height();
+        uint32_t tile_width = tile_max_out.get_width();
+        uint32_t tile_height = tile_max_out.get_height();
+        uint32_t tile_count = tile_width * tile_height;
+
+        this->stats.tile_count = tile_count;
+
+        if (!this->valid || K != this->last_K || this->previous_velocity.get_width() != width || this->previous_velocity.get_height() != height ||
+            this->tile_max_dirty.size() != tile_count)
+        {
+            tile_max(velocity, K, tile_max_out, pool);
+            neighbor_max(tile_max_out, neighbor_max_out, pool);
+
+            this->previous_velocity = velocity;
+            this->footprint_x_first.resize(tile_width);
+            this->footprint_x_last.resize(tile_width);
+            this->footprint_y_first.resize(tile_height);
+            this->footprint_y_last.resize(tile_height);
+            for (uint32_t tx = 0; tx < tile_width; ++tx)
+            {
+                compute_tile_max_footprint(width, tile_width, K, tx, this->footprint_x_first[tx], this->footprint_x_last[tx]);
+            }
+            for (uint32_t ty = 0; ty < tile_height; ++ty)
+            {
+                compute_tile_max_footprint(height, tile_height, K, ty, this->footprint_y_first[ty], this->footprint_y_last[ty]);
+            }
+            this->tile_max_dirty.assign(tile_count, 0);
+            this->tile_max_changed.assign(tile_count, 0);
+
+            this->valid = true;
+            this->last_K = K;
+            this->stats.tile_max_recomputed = tile_count;
+            this->stats.neighbor_max_recomputed = tile_count;
+            return;
+        }
+
+        // Diff V against the previous frame inside every footprint, refreshing the copy as we go. Footprints are K
+        // texels wide at a stride of at least K, so no two tiles touch the same texels.
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    uint32_t x_first = this->footprint_x_first[tx];
+                    size_t segment_size = sizeof(Unorm8x2) * (this->footprint_x_last[tx] - x_first + 1);
+
+                    bool dirty = false;
+                    for (uint32_t y = this->footprint_y_first[ty]; y <= this->footprint_y_last[ty]; ++y)
+                    {
+                        Unorm8x2 const *current = velocity.row(y) + x_first;
+                        Unorm8x2 *previous = this->previous_velocity.row(y) + x_first;
+                        if (memcmp(current, previous, segment_size) != 0)
+                        {
+                            memcpy(previous, current, segment_size);
+                            dirty = true;
+                        }
+                    }
+
+                    uint32_t tile = ty * tile_width + tx;
+                    this->tile_max_dirty[tile] = dirty ? 1 : 0;
+                    this->tile_max_changed[tile] = 0;
+                    if (dirty)
+                    {
+                        Unorm8x2 value = tile_max_texel(velocity, K, tile_width, tile_height, tx, ty);
+                        Unorm8x2 &texel = tile_max_out.at(tx, ty);
+                        this->tile_max_changed[tile] = (value.x != texel.x || value.y != texel.y) ? 1 : 0;
+                        texel = value;
+                    }
+                }
+            }
+        });
+
+        // NeighborMax reads the 3x3 TileMax neighborhood, so only tiles next to a changed TileMax texel can change
+        uint32_t tile_max_recomputed = 0;
+        for (uint32_t tile = 0; tile < tile_count; ++tile)
+        {
+            tile_max_recomputed += this->tile_max_dirty[tile];
+        }
+
+        std::vector<uint32_t> neighbor_max_recomputed(tile_height, 0);
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                uint32_t y_first = (ty > 0) ? ty - 1 : 0;
+                uint32_t y_last = std::min(ty + 1, tile_height - 1);
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    uint32_t x_first = (tx > 0) ? tx - 1 : 0;
+                    uint32_t x_last = std::min(tx + 1, tile_width - 1);
+
+                    bool dirty = false;
+                    for (uint32_t y = y_first; y <= y_last && !dirty; ++y)
+                    {
+                        for (uint32_t x = x_first; x <= x_last; ++x)
+                        {
+                            dirty = dirty || (this->tile_max_changed[y * tile_width + x] != 0);
+                        }
+                    }
+
+                    if (dirty)
+                    {
+                        neighbor_max_out.at(tx, ty) = neighbor_max_texel(tile_max_out, tx, ty);
+                        neighbor_max_recomputed[ty]++;
+                    }
+                }
+            }
+        });
+
+        this->stats.tile_max_recomputed = tile_max_recomputed;
+        this->stats.neighbor_max_recomputed = 0;
+        for (uint32_t ty = 0; ty < tile_height; ++ty)
+        {
+            this->stats.neighbor_max_recomputed += neighbor_max_recomputed[ty];
+        }
+    }
+}
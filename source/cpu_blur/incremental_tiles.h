@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/incremental_tiles.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "image.h"
+#include "thread_pool.h"
+
+// Incremental TileMax/NeighborMax: keeps both tile buffers from the previous frame and recomputes only the tiles whose
+// footprint in V changed, plus the NeighborMax tiles within one tile of a TileMax texel that changed value.
+
+namespace CPUBlur
+{
+    struct IncrementalTileStats
+    {
+        uint32_t tile_count;
+        uint32_t tile_max_recomputed;
+        uint32_t neighbor_max_recomputed;
+    };
+
+    // Range of texels [first, last] along one axis that tile_max_texel reads for tile t
+    void compute_tile_max_footprint(uint32_t size, uint32_t tile_count, uint32_t K, uint32_t t, uint32_t &first, uint32_t &last);
+
+    class IncrementalTiles
+    {
+    public:
+        IncrementalTiles();
+
+        // Forces the next update to recompute every tile
+        void invalidate() { this->valid = false; }
+
+        // tile_max and neighbor_max must hold the previous frame's output unless the state was invalidated since
+        void update(VelocityImage const &velocity, uint32_t K, VelocityImage &tile_max, VelocityImage &neighbor_max, ThreadPool &pool);
+
+        IncrementalTileStats const &get_stats() const { return this->stats; }
+
+    private:
+        bool valid;
+        uint32_t last_K;
+
+        // V as of the last update, only kept up to date inside tile footprints
+        VelocityImage previous_velocity;
+
+        std::vector<uint32_t> footprint_x_first, footprint_x_last;
+        std::vector<uint32_t> footprint_y_first, footprint_y_last;
+        std::vector<uint8_t> tile_max_dirty;
+        std::vector<uint8_t> tile_max_changed;
+
+        IncrementalTileStats stats;
+    };
+}
@@ -0,0 +1,203 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/instance_transforms.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "instance_transforms.h"
+#include "simd_gather.h"
+
+#if CPUBLUR_SIMD_X86
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    // Rotation of a unit quaternion as rows for row vectors, as DirectX::XMMatrixRotationQuaternion
+    void get_rotation_rows(CPUBlur::Float4 q, float r[3][3])
+    {
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        r[0][0] = 1.0f - 2.0f * (yy + zz);
+        r[0][1] = 2.0f * (xy + wz);
+        r[0][2] = 2.0f * (xz - wy);
+        r[1][0] = 2.0f * (xy - wz);
+        r[1][1] = 1.0f - 2.0f * (xx + zz);
+        r[1][2] = 2.0f * (yz + wx);
+        r[2][0] = 2.0f * (xz + wy);
+        r[2][1] = 2.0f * (yz - wx);
+        r[2][2] = 1.0f - 2.0f * (xx + yy);
+    }
+
+    // Columns x, y, z of the affine matrix with rows r and translation t
+    void store_affine_columns(float const r[3][3], CPUBlur::Float3 t, CPUBlur::Float4 out[3])
+    {
+        float translation[3] = {t.x, t.y, t.z};
+        for (uint32_t column = 0; column < 3; ++column)
+        {
+            out[column].x = r[0][column];
+            out[column].y = r[1][column];
+            out[column].z = r[2][column];
+            out[column].w = translation[column];
+        }
+    }
+
+#if CPUBLUR_SIMD_X86
+    // The nine rotation entries and three translations of four poses, one lane per pose
+    struct PoseLanes
+    {
+        __m128 r[3][3];
+        __m128 t[3];
+    };
+
+    void load_pose_lanes(CPUBlur::RigidPose const *poses, PoseLanes &lanes)
+    {
+        __m128 x = _mm_loadu_ps(&poses[0].rotation.x);
+        __m128 y = _mm_loadu_ps(&poses[1].rotation.x);
+        __m128 z = _mm_loadu_ps(&poses[2].rotation.x);
+        __m128 w = _mm_loadu_ps(&poses[3].rotation.x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 two = _mm_set1_ps(2.0f);
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+        lanes.r[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+        lanes.r[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+        lanes.r[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+        lanes.r[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+        lanes.r[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+        lanes.r[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+        lanes.r[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+        lanes.r[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+        lanes.r[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+        lanes.t[0] = _mm_setr_ps(poses[0].translation.x, poses[1].translation.x, poses[2].translation.x, poses[3].translation.x);
+        lanes.t[1] = _mm_setr_ps(poses[0].translation.y, poses[1].translation.y, poses[2].translation.y, poses[3].translation.y);
+        lanes.t[2] = _mm_setr_ps(poses[0].translation.z, poses[1].translation.z, poses[2].translation.z, poses[3].translation.z);
+    }
+
+    // Transposes column c of four matrices (rows r, fourth entries w) back to one Float4 per instance. member selects
+    // the transform inside InstanceTransforms.
+    void store_column_lanes(__m128 r0, __m128 r1, __m128 r2, __m128 w, CPUBlur::InstanceTransforms *out, CPUBlur::Float4 (CPUBlur::InstanceTransforms::*member)[3], uint32_t column)
+    {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, w);
+        _mm_storeu_ps(&(out[0].*member)[column].x, r0);
+        _mm_storeu_ps(&(out[1].*member)[column].x, r1);
+        _mm_storeu_ps(&(out[2].*member)[column].x, r2);
+        _mm_storeu_ps(&(out[3].*member)[column].x, w);
+    }
+
+    void build_instance_transforms_sse(CPUBlur::RigidPose const *poses_new, CPUBlur::RigidPose const *poses_old, CPUBlur::Float4x4 const &view_xform, CPUBlur::InstanceTransforms *out)
+    {
+        PoseLanes pose_new;
+        PoseLanes pose_old;
+        load_pose_lanes(poses_new, pose_new);
+        load_pose_lanes(poses_old, pose_old);
+
+        __m128 zero = _mm_setzero_ps();
+        for (uint32_t column = 0; column < 3; ++column)
+        {
+            store_column_lanes(pose_new.r[0][column], pose_new.r[1][column], pose_new.r[2][column], pose_new.t[column], out, &CPUBlur::InstanceTransforms::model_xform_new, column);
+            store_column_lanes(pose_old.r[0][column], pose_old.r[1][column], pose_old.r[2][column], pose_old.t[column], out, &CPUBlur::InstanceTransforms::model_xform_old, column);
+
+            // Rotation of model * view; the translations only reach w, which the shader drops
+            __m128 normal[3];
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                normal[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pose_new.r[row][0], _mm_set1_ps(view_xform.m[0][column])),
+                                                    _mm_mul_ps(pose_new.r[row][1], _mm_set1_ps(view_xform.m[1][column]))),
+                                         _mm_mul_ps(pose_new.r[row][2], _mm_set1_ps(view_xform.m[2][column])));
+            }
+            store_column_lanes(normal[0], normal[1], normal[2], zero, out, &CPUBlur::InstanceTransforms::model_xform_normal_new, column);
+        }
+    }
+#endif
+}
+
+namespace CPUBlur
+{
+    Float4x4 get_pose_matrix(RigidPose const &pose)
+    {
+        float r[3][3];
+        get_rotation_rows(pose.rotation, r);
+        Float4x4 result = {{{r[0][0], r[0][1], r[0][2], 0.0f},
+                            {r[1][0], r[1][1], r[1][2], 0.0f},
+                            {r[2][0], r[2][1], r[2][2], 0.0f},
+                            {pose.translation.x, pose.translation.y, pose.translation.z, 1.0f}}};
+        return result;
+    }
+
+    void build_instance_transforms_scalar(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float r_new[3][3];
+            float r_old[3][3];
+            get_rotation_rows(poses_new[i].rotation, r_new);
+            get_rotation_rows(poses_old[i].rotation, r_old);
+            store_affine_columns(r_new, poses_new[i].translation, out[i].model_xform_new);
+            store_affine_columns(r_old, poses_old[i].translation, out[i].model_xform_old);
+
+            // Rotation of model * view; the translations only reach w, which the shader drops
+            float normal[3][3];
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                for (uint32_t column = 0; column < 3; ++column)
+                {
+                    normal[row][column] = r_new[row][0] * view_xform.m[0][column] + r_new[row][1] * view_xform.m[1][column] + r_new[row][2] * view_xform.m[2][column];
+                }
+            }
+            Float3 no_translation = {0.0f, 0.0f, 0.0f};
+            store_affine_columns(normal, no_translation, out[i].model_xform_normal_new);
+        }
+    }
+
+    void build_instance_transforms(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out)
+    {
+        uint32_t i = 0;
+#if CPUBLUR_SIMD_X86
+        for (; i + 4 <= count; i += 4)
+        {
+            build_instance_transforms_sse(poses_new + i, poses_old + i, view_xform, out + i);
+        }
+#endif
+        build_instance_transforms_scalar(poses_new + i, poses_old + i, count - i, view_xform, out + i);
+    }
+
+    void build_instance_transforms(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out, ThreadPool &pool)
+    {
+        pool.parallel_rows(count, [&](uint32_t begin, uint32_t end) {
+            build_instance_transforms(poses_new + begin, poses_old + begin, end - begin, view_xform, out + begin);
+        });
+    }
+}
@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/instance_transforms.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "software_rasterizer.h"
+#include "thread_pool.h"
+
+// Per-instance data of the instanced scene path (vs_scene_instanced.hlsl). Every frame, the pose of each rigid mover
+// this frame and last frame becomes the two model transforms the vertex shader needs for velocity, plus the normal
+// transform into view space. The array is then uploaded to a structured buffer with one Map.
+
+namespace CPUBlur
+{
+    // p' = rotate(p, rotation) + translation, with rotation a unit quaternion (x, y, z, w)
+    struct RigidPose
+    {
+        Float4 rotation;
+        Float3 translation;
+    };
+
+    // InstanceTransforms of constants.hlsli: the x, y and z columns of the row-major affine model transforms (new and
+    // old) and of the normal transform into view space. Their fourth columns are (0, 0, 0, 1) and are not stored,
+    // which takes an instance from 192 to 144 bytes.
+    struct InstanceTransforms
+    {
+        Float4 model_xform_new[3];
+        Float4 model_xform_old[3];
+        Float4 model_xform_normal_new[3];
+    };
+
+    // Row-major transform of a pose: DirectX::XMMatrixRotationQuaternion followed by the translation
+    Float4x4 get_pose_matrix(RigidPose const &pose);
+
+    // One instance at a time, the reference for the SIMD path
+    void build_instance_transforms_scalar(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out);
+
+    // Four instances at a time with the poses transposed into SSE registers; the scalar path on other targets and for
+    // the last count % 4 instances. view_xform must be rigid.
+    void build_instance_transforms(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out);
+
+    // The same, split into bands across the pool
+    void build_instance_transforms(RigidPose const *poses_new, RigidPose const *poses_old, uint32_t count, Float4x4 const &view_xform, InstanceTransforms *out, ThreadPool &pool);
+}
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/jitter.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "jitter.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Width of the Gaussian energy filter, and fraction of texels set in the initial binary pattern
+    const float VOID_AND_CLUSTER_SIGMA = 1.5f;
+    const uint32_t INITIAL_PATTERN_DIVISOR = 10;
+    const uint32_t BLUE_NOISE_SEED = 0x5eed;
+
+    // Energy of every texel of a toroidal binary pattern: the sum of the Gaussian filter over the set texels
+    class EnergyField
+    {
+    public:
+        explicit EnergyField(uint32_t size)
+            : size(size), filter(size * size), energy(size * size, 0.0f), pattern(size * size, 0)
+        {
+            for (uint32_t dy = 0; dy < size; ++dy)
+            {
+                for (uint32_t dx = 0; dx < size; ++dx)
+                {
+                    float x = float(std::min(dx, size - dx));
+                    float y = float(std::min(dy, size - dy));
+                    this->filter[dy * size + dx] = expf(-(x * x + y * y) / (2.0f * VOID_AND_CLUSTER_SIGMA * VOID_AND_CLUSTER_SIGMA));
+                }
+            }
+        }
+
+        void set(uint32_t index, bool value)
+        {
+            this->pattern[index] = value ? 1 : 0;
+            float sign = value ? 1.0f : -1.0f;
+            uint32_t x0 = index % this->size;
+            uint32_t y0 = index / this->size;
+            for (uint32_t y = 0; y < this->size; ++y)
+            {
+                uint32_t dy = (y + this->size - y0) % this->size;
+                for (uint32_t x = 0; x < this->size; ++x)
+                {
+                    uint32_t dx = (x + this->size - x0) % this->size;
+                    this->energy[y * this->size + x] += sign * this->filter[dy * this->size + dx];
+                }
+            }
+        }
+
+        bool get(uint32_t index) const { return this->pattern[index] != 0; }
+
+        // Set texel with the highest energy
+        uint32_t tightest_cluster() const
+        {
+            uint32_t best = UINT32_MAX;
+            for (uint32_t i = 0; i < this->energy.size(); ++i)
+            {
+                if (this->pattern[i] && (best == UINT32_MAX || this->energy[i] > this->energy[best]))
+                {
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        // Unset texel with the lowest energy
+        uint32_t largest_void() const
+        {
+            uint32_t best = UINT32_MAX;
+            for (uint32_t i = 0; i < this->energy.size(); ++i)
+            {
+                if (!this->pattern[i] && (best == UINT32_MAX || this->energy[i] < this->energy[best]))
+                {
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+    private:
+        uint32_t size;
+        std::vector<float> filter;
+        std::vector<float> energy;
+        std::vector<uint8_t> pattern;
+    };
+}
+
+namespace CPUBlur
+{
+    void fill_blue_noise(RandomImage &blue_noise)
+    {
+        const uint32_t size = BLUE_NOISE_SIZE;
+        const uint32_t texel_count = size * size;
+
+        // Initial binary pattern: random texels, then relaxed by moving the tightest cluster into the largest void
+        // until that no longer changes anything
+        EnergyField initial(size);
+        std::mt19937 generator(BLUE_NOISE_SEED);
+        uint32_t ones = 0;
+        while (ones < texel_count / INITIAL_PATTERN_DIVISOR)
+        {
+            uint32_t index = uint32_t(generator() % texel_count);
+            if (!initial.get(index))
+            {
+                initial.set(index, true);
+                ++ones;
+            }
+        }
+        for (;;)
+        {
+            uint32_t cluster = initial.tightest_cluster();
+            initial.set(cluster, false);
+            uint32_t hole = initial.largest_void();
+            initial.set(hole, true);
+            if (hole == cluster)
+            {
+                break;
+            }
+        }
+
+        std::vector<uint32_t> rank(texel_count);
+
+        // Ranks below the initial pattern: remove the tightest cluster one texel at a time
+        EnergyField removal = initial;
+        for (uint32_t r = ones; r-- > 0;)
+        {
+            uint32_t cluster = removal.tightest_cluster();
+            removal.set(cluster, false);
+            rank[cluster] = r;
+        }
+
+        // Ranks above: fill the largest void. Past half the texels this is the tightest cluster of the unset texels,
+        // so one loop covers both of the remaining phases of the original algorithm.
+        EnergyField insertion = initial;
+        for (uint32_t r = ones; r < texel_count; ++r)
+        {
+            uint32_t hole = insertion.largest_void();
+            insertion.set(hole, true);
+            rank[hole] = r;
+        }
+
+        blue_noise.resize(size, size);
+        for (uint32_t i = 0; i < texel_count; ++i)
+        {
+            blue_noise.data()[i] = static_cast<uint8_t>((rank[i] * 256) / texel_count);
+        }
+    }
+}
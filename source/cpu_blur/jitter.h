@@ -0,0 +1,60 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/jitter.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include "image.h"
+
+// Alternatives to the rand() jitter texture of pseudoRandom (ps_gather.hlsl). Both are deterministic: a fixed
+// BLUE_NOISE_SIZE^2 blue-noise tile, built once and repeated over the target, and interleaved gradient noise, which
+// needs no texture at all.
+
+namespace CPUBlur
+{
+    // Side of the blue-noise tile; a power of two so that the shader can wrap with a mask
+    const uint32_t BLUE_NOISE_SIZE = 64;
+
+    // Void-and-cluster ranking (Ulichney 1993) with a fixed seed, quantized to R8. blue_noise is resized to
+    // BLUE_NOISE_SIZE x BLUE_NOISE_SIZE.
+    void fill_blue_noise(RandomImage &blue_noise);
+
+    // Jimenez, "Next Generation Post Processing in Call of Duty: Advanced Warfare", in [0, 1) for pixel (x, y)
+    inline float interleaved_gradient_noise(uint32_t x, uint32_t y)
+    {
+        float f = 0.06711056f * float(x) + 0.00583715f * float(y);
+        f = 52.9829189f * (f - floorf(f));
+        return f - floorf(f);
+    }
+}
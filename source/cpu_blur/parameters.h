@@ -0,0 +1,68 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/parameters.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "image.h"
+
+namespace CPUBlur
+{
+    // Jitter of the gather taps, c_jitter_source in cbCamera
+    enum JitterSource
+    {
+        JITTER_RANDOM_TEXTURE = 0, // rand() texture of size (w/K, h/K), sampled with wrap at UV * K
+        JITTER_BLUE_NOISE,         // Fixed BLUE_NOISE_SIZE^2 blue-noise tile (jitter.h)
+        JITTER_INTERLEAVED_GRADIENT // interleaved_gradient_noise, no texture
+    };
+
+    // The subset of cbCamera read by the post-process passes
+    struct Parameters
+    {
+        float half_exposure;
+        uint32_t K;
+        uint32_t S;
+        float max_sample_tap_distance;
+        JitterSource jitter_source;
+    };
+
+    struct Inputs
+    {
+        ColorImage const *color;          // C
+        DepthImage const *depth;          // Z
+        VelocityImage const *velocity;    // V
+        VelocityImage const *neighbor_max; // NeighborMax(TileMax(V))
+        RandomImage const *random;        // Jitter texture: (w/K, h/K) rand() texture or the blue-noise tile, unused by JITTER_INTERLEAVED_GRADIENT
+        VelocityDepthImage const *velocity_depth; // Optional pack_velocity_depth output; the taps then read it instead of Z and V
+    };
+}
@@ -0,0 +1,677 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/reconstruction.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "reconstruction.h"
+#include <stdlib.h>
+#include <time.h>
+#include "adaptive_samples.h"
+#include "fused_tile_max.h"
+#include "half_resolution.h"
+#include "jitter.h"
+
+namespace CPUBlur
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    uint32_t compute_max_sample_tap_distance(uint32_t height)
+    {
+        return (2 * height + 1056) / 416;
+    }
+
+    void compute_tiled_dimensions(uint32_t width, uint32_t height, uint32_t K, uint32_t &width_divided_by_K, uint32_t &height_divided_by_K)
+    {
+        uint32_t k = (K > 0) ? K : 1;
+        width_divided_by_K = width / k;
+        height_divided_by_K = height / k;
+    }
+
+    void fill_random(RandomImage &random, uint32_t seed)
+    {
+        srand(seed);
+        for (uint32_t j = 0; j < random.get_height(); j++)
+        {
+            for (uint32_t i = 0; i < random.get_width(); i++)
+            {
+                random.at(i, j) = static_cast<uint8_t>(rand()) & static_cast<uint8_t>(0x00ff);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_tilemax.hlsl
+
+    namespace
+    {
+        template <typename VelocityImageT>
+        Unorm8x2 generic_tile_max_texel(VelocityImageT const &velocity, uint32_t K, uint32_t tile_width, uint32_t tile_height, uint32_t tx, uint32_t ty)
+        {
+            Unorm8x2 output = VELOCITY_GRAY;
+
+            uint32_t w = velocity.get_width();
+            uint32_t h = velocity.get_height();
+            float tex_coord_base_x = (float(tx) + 0.5f) / float(tile_width);
+            float tex_coord_base_y = (float(ty) + 0.5f) / float(tile_height);
+            float tex_coord_increment_x = 1.0f / float(w);
+            float tex_coord_increment_y = 1.0f / float(h);
+
+            float max_magnitude_squared = 0.0f;
+            for (uint32_t s = 0; s < K; ++s)
+            {
+                uint32_t x = VelocityImageT::point_clamp_index(tex_coord_base_x + float(s) * tex_coord_increment_x, w);
+                for (uint32_t t = 0; t < K; ++t)
+                {
+                    uint32_t y = VelocityImageT::point_clamp_index(tex_coord_base_y + float(t) * tex_coord_increment_y, h);
+                    Unorm8x2 texel = velocity.at(x, y);
+                    Float2 v = read_velocity(texel);
+
+                    float magnitude_squared = dot(v, v);
+                    if (max_magnitude_squared < magnitude_squared)
+                    {
+                        // writeBiasScale(readBiasScale(texel)) round-trips to the same 8-bit texel
+                        output = texel;
+                        max_magnitude_squared = magnitude_squared;
+                    }
+                }
+            }
+            return output;
+        }
+
+        template <typename VelocityImageT>
+        void generic_tile_max(VelocityImageT const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool)
+        {
+            uint32_t tile_width = out.get_width();
+            uint32_t tile_height = out.get_height();
+
+            pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+                for (uint32_t ty = row_begin; ty < row_end; ++ty)
+                {
+                    Unorm8x2 *dst = out.row(ty);
+                    for (uint32_t tx = 0; tx < tile_width; ++tx)
+                    {
+                        dst[tx] = generic_tile_max_texel(velocity, K, tile_width, tile_height, tx, ty);
+                    }
+                }
+            });
+        }
+    }
+
+    Unorm8x2 tile_max_texel(VelocityImage const &velocity, uint32_t K, uint32_t tile_width, uint32_t tile_height, uint32_t tx, uint32_t ty)
+    {
+        return generic_tile_max_texel(velocity, K, tile_width, tile_height, tx, ty);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_neighbormax.hlsl
+
+    void neighbor_max_rows(uint32_t tile_height, uint32_t ty, uint32_t rows[3])
+    {
+        float tex_coord_base_y = (float(ty) + 0.5f) / float(tile_height);
+        float tex_coord_increment_y = 1.0f / float(tile_height);
+        for (int t = -1; t <= 1; ++t)
+        {
+            rows[t + 1] = VelocityImage::point_clamp_index(tex_coord_base_y + float(t) * tex_coord_increment_y, tile_height);
+        }
+    }
+
+    namespace
+    {
+        // fetch(x, t) returns the TileMax texel in column x of the row read for t (-1, 0 or 1)
+        template <typename Fetch>
+        Unorm8x2 filter_neighbor_max(uint32_t tile_width, uint32_t tx, Fetch const &fetch)
+        {
+            Unorm8x2 output = VELOCITY_GRAY;
+
+            uint32_t w = tile_width;
+            float tex_coord_base_x = (float(tx) + 0.5f) / float(w);
+            float tex_coord_increment_x = 1.0f / float(w);
+
+            float max_magnitude_squared = 0.0f;
+            for (int s = -1; s <= 1; ++s)
+            {
+                uint32_t x = VelocityImage::point_clamp_index(tex_coord_base_x + float(s) * tex_coord_increment_x, w);
+                for (int t = -1; t <= 1; ++t)
+                {
+                    Unorm8x2 texel = fetch(x, t);
+                    Float2 v = read_velocity(texel);
+
+                    float magnitude_squared = dot(v, v);
+                    if (max_magnitude_squared < magnitude_squared)
+                    {
+                        float displacement = fabsf(float(s)) + fabsf(float(t));
+                        float orientation_x = sign(float(s) * v.x);
+                        float orientation_y = sign(float(t) * v.y);
+                        float distance = orientation_x + orientation_y;
+
+                        if (fabsf(distance) == displacement)
+                        {
+                            output = texel;
+                            max_magnitude_squared = magnitude_squared;
+                        }
+                    }
+                }
+            }
+            return output;
+        }
+    }
+
+    Unorm8x2 neighbor_max_texel(Unorm8x2 const *const tile_max_rows[3], uint32_t tile_width, uint32_t tx)
+    {
+        return filter_neighbor_max(tile_width, tx, [tile_max_rows](uint32_t x, int t) { return tile_max_rows[t + 1][x]; });
+    }
+
+    Unorm8x2 neighbor_max_texel(VelocityImage const &tile_max, uint32_t tx, uint32_t ty)
+    {
+        uint32_t rows[3];
+        neighbor_max_rows(tile_max.get_height(), ty, rows);
+
+        Unorm8x2 const *tile_max_rows[3] = {tile_max.row(rows[0]), tile_max.row(rows[1]), tile_max.row(rows[2])};
+        return neighbor_max_texel(tile_max_rows, tile_max.get_width(), tx);
+    }
+
+    namespace
+    {
+        template <typename TileMaxImageT>
+        Unorm8x2 generic_neighbor_max_texel(TileMaxImageT const &tile_max, uint32_t tx, uint32_t ty)
+        {
+            uint32_t rows[3];
+            neighbor_max_rows(tile_max.get_height(), ty, rows);
+            return filter_neighbor_max(tile_max.get_width(), tx, [&](uint32_t x, int t) { return tile_max.at(x, rows[t + 1]); });
+        }
+
+        template <typename TileMaxImageT>
+        void generic_neighbor_max(TileMaxImageT const &tile_max, VelocityImage &out, ThreadPool &pool)
+        {
+            uint32_t tile_width = out.get_width();
+
+            pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+                for (uint32_t ty = row_begin; ty < row_end; ++ty)
+                {
+                    Unorm8x2 *dst = out.row(ty);
+                    for (uint32_t tx = 0; tx < tile_width; ++tx)
+                    {
+                        dst[tx] = generic_neighbor_max_texel(tile_max, tx, ty);
+                    }
+                }
+            });
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_gather.hlsl
+
+    namespace
+    {
+        VelocityDepthImage const *get_velocity_depth(Inputs const &inputs)
+        {
+            return inputs.velocity_depth;
+        }
+
+        template <typename Layout>
+        VelocityDepthImage const *get_velocity_depth(SwizzledInputs<Layout> const &)
+        {
+            return nullptr;
+        }
+
+        template <typename InputsT>
+        bool generic_prepare_gather_pixel(InputsT const &inputs, Parameters const &params, uint32_t x, uint32_t y, GatherPixelState &state)
+        {
+            auto const &color = *inputs.color;
+            float tex_dim_x = float(color.get_width());
+            float tex_dim_y = float(color.get_height());
+            float K = float(params.K);
+            float S = float(params.S);
+
+            // X (position of current fragment)
+            Float2 X = {(float(x) + 0.5f) / tex_dim_x, (float(y) + 0.5f) / tex_dim_y};
+            state.X = X;
+
+            // Color at X; a bilinear fetch at the texel centre returns the texel itself
+            state.CX = color.at(x, y);
+
+            // Dominant half-velocity for the current fragment's neighborhood tile
+            Float2 NX = read_velocity(inputs.neighbor_max->sample_point_clamp(X));
+            float NX_length = length(NX);
+
+            // Weighting, correcting, and clamping half-velocity
+            float temp_NX = NX_length * params.half_exposure;
+            bool flag_NX = (temp_NX >= EPSILON1);
+            temp_NX = clamp(temp_NX, 0.1f, K);
+
+            // If the velocities are too short, we simply show the color texel and exit
+            if (temp_NX < HALF_VELOCITY_CUTOFF)
+            {
+                return false;
+            }
+
+            if (flag_NX)
+            {
+                float scale = temp_NX / NX_length;
+                NX.x *= scale;
+                NX.y *= scale;
+            }
+            state.NX = NX;
+
+            // Primary half-velocity at X
+            Float2 VX = read_velocity(inputs.velocity->at(x, y));
+            float VX_length = length(VX);
+
+            float temp_VX = VX_length * params.half_exposure;
+            bool flag_VX = (temp_VX >= EPSILON1);
+            temp_VX = clamp(temp_VX, 0.1f, K);
+            if (flag_VX)
+            {
+                float scale = temp_VX / VX_length;
+                VX.x *= scale;
+                VX.y *= scale;
+                VX_length = length(VX);
+            }
+            state.temp_VX = temp_VX;
+
+            // Random value in [-0.5, 0.5]
+            if (params.jitter_source == JITTER_INTERLEAVED_GRADIENT)
+            {
+                state.R = interleaved_gradient_noise(x, y) - 0.5f;
+            }
+            else if (params.jitter_source == JITTER_BLUE_NOISE)
+            {
+                state.R = unorm8_to_float(inputs.random->at(x & (BLUE_NOISE_SIZE - 1), y & (BLUE_NOISE_SIZE - 1))) - 0.5f;
+            }
+            else
+            {
+                Float2 random_uv = {X.x * K, X.y * K};
+                state.R = unorm8_to_float(inputs.random->sample_point_wrap(random_uv)) - 0.5f;
+            }
+
+            // Depths are negative, as in the paper
+            state.ZX = -inputs.depth->at(x, y);
+
+            // If VX is too small, we use NX (for the current tile)
+            state.corrected_VX = (VX_length < VARIANCE_THRESHOLD) ? normalize(NX) : normalize(VX);
+
+            state.weight = S / WEIGHT_CORRECTION_FACTOR / temp_VX;
+            return true;
+        }
+
+        template <typename InputsT>
+        Float4 generic_gather_pixel(InputsT const &inputs, Parameters const &params, uint32_t x, uint32_t y)
+        {
+            GatherPixelState state;
+            if (!generic_prepare_gather_pixel(inputs, params, x, y, state))
+            {
+                return state.CX;
+            }
+
+            auto const &color = *inputs.color;
+            float tex_dim_x = float(color.get_width());
+            float S = float(params.S);
+            float K = float(params.K);
+
+            Float2 X = state.X;
+            float weight = state.weight;
+            float sum_x = state.CX.x * weight;
+            float sum_y = state.CX.y * weight;
+            float sum_z = state.CX.z * weight;
+
+            int self_index = int((S - 1.0f) / 2.0f);
+
+            float max_sample_tap_distance = params.max_sample_tap_distance / tex_dim_x;
+            float half_texel = 0.5f / tex_dim_x;
+            VelocityDepthImage const *velocity_depth = get_velocity_depth(inputs);
+
+            for (int i = 0; i < int(params.S); ++i)
+            {
+                if (i == self_index)
+                {
+                    continue;
+                }
+
+                float lerp_amount = (float(i) + state.R + 1.0f) / (S + 1.0f);
+                float T = -max_sample_tap_distance + (2.0f * max_sample_tap_distance) * lerp_amount;
+
+                Float2 switch_v = ((i & 1) == 1) ? state.corrected_VX : state.NX;
+                Float2 Y = {X.x + switch_v.x * T + half_texel, X.y + switch_v.y * T + half_texel};
+
+                float temp_VY;
+                float ZY;
+                if (velocity_depth)
+                {
+                    Float2 ZV_Y = velocity_depth->sample_point_clamp(Y);
+                    ZY = ZV_Y.x;
+                    temp_VY = ZV_Y.y;
+                }
+                else
+                {
+                    Float2 VY = read_velocity(inputs.velocity->sample_point_clamp(Y));
+                    float VY_length = length(VY);
+                    temp_VY = clamp(VY_length * params.half_exposure, 0.1f, K);
+
+                    ZY = -inputs.depth->sample_point_clamp(Y);
+                }
+
+                // alpha = foreground contribution + background contribution + blur of both foreground and background
+                float alpha_Y = soft_depth_compare(state.ZX, ZY) * cone(T, temp_VY) +
+                                soft_depth_compare(ZY, state.ZX) * cone(T, state.temp_VX) +
+                                cylinder(T, temp_VY) * cylinder(T, state.temp_VX) * 2.0f;
+
+                Float4 CY = sample_linear_clamp(color, Y);
+                weight += alpha_Y;
+                sum_x += alpha_Y * CY.x;
+                sum_y += alpha_Y * CY.y;
+                sum_z += alpha_Y * CY.z;
+            }
+
+            Float4 result = {sum_x / weight, sum_y / weight, sum_z / weight, 1.0f};
+            return result;
+        }
+
+        template <typename InputsT>
+        void generic_gather(InputsT const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool)
+        {
+            uint32_t width = out.get_width();
+
+            pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+                for (uint32_t y = row_begin; y < row_end; ++y)
+                {
+                    Float4 *dst = out.row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        dst[x] = generic_gather_pixel(inputs, params, x, y);
+                    }
+                }
+            });
+        }
+    }
+
+    bool prepare_gather_pixel(Inputs const &inputs, Parameters const &params, uint32_t x, uint32_t y, GatherPixelState &state)
+    {
+        return generic_prepare_gather_pixel(inputs, params, x, y, state);
+    }
+
+    Float4 gather_pixel(Inputs const &inputs, Parameters const &params, uint32_t x, uint32_t y)
+    {
+        return generic_gather_pixel(inputs, params, x, y);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_pack_velocity_depth.hlsl
+
+    Float2 pack_velocity_depth_texel(DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, uint32_t x, uint32_t y)
+    {
+        Float2 V = read_velocity(velocity.at(x, y));
+        Float2 result = {-depth.at(x, y), clamp(length(V) * params.half_exposure, 0.1f, float(params.K))};
+        return result;
+    }
+
+    void pack_velocity_depth(DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, VelocityDepthImage &out, ThreadPool &pool)
+    {
+        uint32_t width = out.get_width();
+
+        pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                Float2 *dst = out.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    dst[x] = pack_velocity_depth_texel(depth, velocity, params, x, y);
+                }
+            }
+        });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ps_linear_depth.hlsl
+
+    float linear_depth_texel(float depth, float clip_near, float clip_far)
+    {
+        return round_to_half((clip_near * clip_far) / (clip_far - depth * (clip_far - clip_near)));
+    }
+
+    void linear_depth(DepthImage const &depth, float clip_near, float clip_far, DepthImage &out, ThreadPool &pool)
+    {
+        uint32_t width = out.get_width();
+
+        pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                float const *src = depth.row(y);
+                float *dst = out.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    dst[x] = linear_depth_texel(src[x], clip_near, clip_far);
+                }
+            }
+        });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    void tile_max(VelocityImage const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool)
+    {
+        generic_tile_max(velocity, K, out, pool);
+    }
+
+    void neighbor_max(VelocityImage const &tile_max, VelocityImage &out, ThreadPool &pool)
+    {
+        generic_neighbor_max(tile_max, out, pool);
+    }
+
+    void gather(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool)
+    {
+        generic_gather(inputs, params, out, pool);
+    }
+
+    template <typename Layout>
+    void tile_max(SwizzledImage<Unorm8x2, Layout> const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool)
+    {
+        generic_tile_max(velocity, K, out, pool);
+    }
+
+    template <typename Layout>
+    void neighbor_max(SwizzledImage<Unorm8x2, Layout> const &tile_max, VelocityImage &out, ThreadPool &pool)
+    {
+        generic_neighbor_max(tile_max, out, pool);
+    }
+
+    template <typename Layout>
+    Float4 gather_pixel(SwizzledInputs<Layout> const &inputs, Parameters const &params, uint32_t x, uint32_t y)
+    {
+        return generic_gather_pixel(inputs, params, x, y);
+    }
+
+    template <typename Layout>
+    void gather(SwizzledInputs<Layout> const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool)
+    {
+        generic_gather(inputs, params, out, pool);
+    }
+
+    template void tile_max(SwizzledImage<Unorm8x2, BlockLinearLayout> const &, uint32_t, VelocityImage &, ThreadPool &);
+    template void tile_max(SwizzledImage<Unorm8x2, MortonLayout> const &, uint32_t, VelocityImage &, ThreadPool &);
+    template void neighbor_max(SwizzledImage<Unorm8x2, BlockLinearLayout> const &, VelocityImage &, ThreadPool &);
+    template void neighbor_max(SwizzledImage<Unorm8x2, MortonLayout> const &, VelocityImage &, ThreadPool &);
+    template Float4 gather_pixel(SwizzledInputs<BlockLinearLayout> const &, Parameters const &, uint32_t, uint32_t);
+    template Float4 gather_pixel(SwizzledInputs<MortonLayout> const &, Parameters const &, uint32_t, uint32_t);
+    template void gather(SwizzledInputs<BlockLinearLayout> const &, Parameters const &, ColorImage &, ThreadPool &);
+    template void gather(SwizzledInputs<MortonLayout> const &, Parameters const &, ColorImage &, ThreadPool &);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    Reconstruction::Reconstruction(uint32_t thread_count)
+        : pool(thread_count)
+    {
+        this->last_width = 0;
+        this->last_height = 0;
+        this->last_K = 0;
+        this->tile_classification = false;
+        this->simd_level = detect_simd_level();
+        this->incremental = false;
+        this->fused_tile_max = false;
+        this->packed_velocity_depth = false;
+        this->linear_depth = false;
+        this->half_resolution = false;
+        this->adaptive_samples = false;
+        this->average_taps_per_pixel = 0.0f;
+        this->uniform_velocity = false;
+        this->cache_blocking = false;
+        this->work_stealing = false;
+        this->uniform_velocity_stats.tile_count = 0;
+        this->uniform_velocity_stats.uniform_tiles = 0;
+        this->clip_near = 1.0f;
+        this->clip_far = 100.0f;
+    }
+
+    void Reconstruction::resize(uint32_t width, uint32_t height, uint32_t K)
+    {
+        uint32_t width_divided_by_K, height_divided_by_K;
+        compute_tiled_dimensions(width, height, K, width_divided_by_K, height_divided_by_K);
+
+        this->tile_max_buffer.resize(width_divided_by_K, height_divided_by_K);
+        this->neighbor_max_buffer.resize(width_divided_by_K, height_divided_by_K);
+        this->random.resize(width_divided_by_K, height_divided_by_K);
+        fill_random(this->random, static_cast<uint32_t>(time(NULL)));
+
+        this->last_width = width;
+        this->last_height = height;
+        this->last_K = K;
+
+        this->incremental_tiles.invalidate();
+    }
+
+    void Reconstruction::set_incremental_tiles(bool enabled)
+    {
+        this->incremental = enabled;
+        this->incremental_tiles.invalidate();
+    }
+
+    void Reconstruction::run(ColorImage const &color, DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, ColorImage &out)
+    {
+        uint32_t width = color.get_width();
+        uint32_t height = color.get_height();
+
+        if (width != this->last_width || height != this->last_height || params.K != this->last_K)
+        {
+            this->resize(width, height, params.K);
+        }
+        if (out.get_width() != width || out.get_height() != height)
+        {
+            out.resize(width, height);
+        }
+
+        if (this->incremental)
+        {
+            this->incremental_tiles.update(velocity, params.K, this->tile_max_buffer, this->neighbor_max_buffer, this->pool);
+        }
+        else if (this->fused_tile_max && !this->tile_classification)
+        {
+            tile_max_neighbor_max_fused(velocity, params.K, this->neighbor_max_buffer, this->pool);
+        }
+        else
+        {
+            tile_max(velocity, params.K, this->tile_max_buffer, this->pool);
+            neighbor_max(this->tile_max_buffer, this->neighbor_max_buffer, this->pool);
+        }
+
+        DepthImage const *gather_depth = &depth;
+        if (this->linear_depth)
+        {
+            if (this->linear_depth_buffer.get_width() != width || this->linear_depth_buffer.get_height() != height)
+            {
+                this->linear_depth_buffer.resize(width, height);
+            }
+            CPUBlur::linear_depth(depth, this->clip_near, this->clip_far, this->linear_depth_buffer, this->pool);
+            gather_depth = &this->linear_depth_buffer;
+        }
+
+        Inputs inputs;
+        inputs.color = &color;
+        inputs.depth = gather_depth;
+        inputs.velocity = &velocity;
+        inputs.neighbor_max = &this->neighbor_max_buffer;
+        inputs.random = &this->random;
+        inputs.velocity_depth = nullptr;
+        if (this->packed_velocity_depth && !this->half_resolution)
+        {
+            if (this->velocity_depth.get_width() != width || this->velocity_depth.get_height() != height)
+            {
+                this->velocity_depth.resize(width, height);
+            }
+            pack_velocity_depth(*gather_depth, velocity, params, this->velocity_depth, this->pool);
+            inputs.velocity_depth = &this->velocity_depth;
+        }
+        if (params.jitter_source == JITTER_BLUE_NOISE)
+        {
+            if (this->blue_noise.get_width() == 0)
+            {
+                fill_blue_noise(this->blue_noise);
+            }
+            inputs.random = &this->blue_noise;
+        }
+
+        if (this->half_resolution)
+        {
+            this->tile_lists.clear();
+            gather_half_resolution(inputs, params, this->half_resolution_frame, out, this->pool, this->simd_level);
+        }
+        else if (this->adaptive_samples)
+        {
+            this->tile_lists.clear();
+            compute_tile_sample_counts(this->neighbor_max_buffer, params, this->tile_samples);
+            this->average_taps_per_pixel = compute_average_taps_per_pixel(this->tile_samples, width, height);
+            gather_adaptive(inputs, params, this->tile_samples, out, this->pool, this->simd_level);
+        }
+        else if (this->uniform_velocity)
+        {
+            this->tile_lists.clear();
+            gather_uniform_velocity(inputs, params, this->tile_bounds, out, this->pool, this->simd_level, &this->uniform_velocity_stats);
+        }
+        else if (this->tile_classification)
+        {
+            classify_tiles(this->tile_max_buffer, this->neighbor_max_buffer, params, this->tile_lists);
+            gather_classified(inputs, params, this->tile_lists, out, this->pool, get_gather_span_function(this->simd_level, params.S));
+        }
+        else if (this->work_stealing)
+        {
+            this->tile_lists.clear();
+            gather_scheduled(inputs, params, out, this->pool, this->simd_level, &this->scheduler_stats);
+        }
+        else if (this->cache_blocking)
+        {
+            this->tile_lists.clear();
+            gather_blocked(inputs, params, out, this->pool, this->simd_level);
+        }
+        else
+        {
+            this->tile_lists.clear();
+            gather_simd(inputs, params, out, this->pool, this->simd_level);
+        }
+    }
+}
@@ -0,0 +1,229 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/reconstruction.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "blocked_gather.h"
+#include "half_resolution.h"
+#include "incremental_tiles.h"
+#include "parameters.h"
+#include "scheduled_gather.h"
+#include "simd_gather.h"
+#include "swizzled_image.h"
+#include "thread_pool.h"
+#include "tile_classification.h"
+#include "uniform_velocity.h"
+
+// CPU implementation of the TileMax, NeighborMax and gather passes (ps_tilemax.hlsl, ps_neighbormax.hlsl and
+// ps_gather.hlsl), so that the reconstruction filter can run without a GPU. Every kernel samples its inputs with the
+// same coordinates and addressing modes as the corresponding pixel shader.
+
+namespace CPUBlur
+{
+    // Same heuristic as SceneController::ComputeMaxSampleTapDistance
+    uint32_t compute_max_sample_tap_distance(uint32_t height);
+
+    // Tile buffer size for a (width, height) frame, as in SceneController::ComputeTiledDimensions
+    void compute_tiled_dimensions(uint32_t width, uint32_t height, uint32_t K, uint32_t &width_divided_by_K, uint32_t &height_divided_by_K);
+
+    // Fills the jitter texture the way BackBufferResized does
+    void fill_random(RandomImage &random, uint32_t seed);
+
+    // State of a gather pixel ahead of the S-tap loop
+    struct GatherPixelState
+    {
+        Float2 X;
+        Float4 CX;
+        Float2 NX;
+        Float2 corrected_VX;
+        float temp_VX;
+        float ZX;
+        float R;
+        float weight;
+    };
+
+    // Single tile/pixel kernels
+    Unorm8x2 tile_max_texel(VelocityImage const &velocity, uint32_t K, uint32_t tile_width, uint32_t tile_height, uint32_t tx, uint32_t ty);
+    Unorm8x2 neighbor_max_texel(VelocityImage const &tile_max, uint32_t tx, uint32_t ty);
+
+    // ps_neighbormax.hlsl split by row: neighbor_max_rows returns the TileMax rows read by tile row ty (for t = -1, 0, 1),
+    // and neighbor_max_texel filters those rows, so that callers can keep TileMax as a rolling window of rows
+    void neighbor_max_rows(uint32_t tile_height, uint32_t ty, uint32_t rows[3]);
+    Unorm8x2 neighbor_max_texel(Unorm8x2 const *const tile_max_rows[3], uint32_t tile_width, uint32_t tx);
+    Float4 gather_pixel(Inputs const &inputs, Parameters const &params, uint32_t x, uint32_t y);
+
+    // Everything in ps_gather.hlsl before the S-tap loop. Returns false for pixels that take the
+    // HALF_VELOCITY_CUTOFF early-out, in which case only X and CX are set.
+    bool prepare_gather_pixel(Inputs const &inputs, Parameters const &params, uint32_t x, uint32_t y, GatherPixelState &state);
+
+    // Full passes; out must already have the size of the corresponding render target
+    void tile_max(VelocityImage const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool);
+    void neighbor_max(VelocityImage const &tile_max, VelocityImage &out, ThreadPool &pool);
+    void gather(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool);
+
+    // The same kernels on V, TileMax or C, Z, V in a swizzled layout, instantiated for BlockLinearLayout and MortonLayout
+    template <typename Layout>
+    void tile_max(SwizzledImage<Unorm8x2, Layout> const &velocity, uint32_t K, VelocityImage &out, ThreadPool &pool);
+    template <typename Layout>
+    void neighbor_max(SwizzledImage<Unorm8x2, Layout> const &tile_max, VelocityImage &out, ThreadPool &pool);
+    template <typename Layout>
+    Float4 gather_pixel(SwizzledInputs<Layout> const &inputs, Parameters const &params, uint32_t x, uint32_t y);
+    template <typename Layout>
+    void gather(SwizzledInputs<Layout> const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool);
+
+    // ps_pack_velocity_depth.hlsl: (-Z, TempV) per pixel, the two values each gather tap derives from Z and V, so
+    // that a tap makes one fetch from 8 bytes instead of two and skips the velocity decode and length
+    Float2 pack_velocity_depth_texel(DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, uint32_t x, uint32_t y);
+    void pack_velocity_depth(DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, VelocityDepthImage &out, ThreadPool &pool);
+
+    // ps_linear_depth.hlsl: view-space depth from the post-projection depth of a left-handed perspective projection
+    // with the given clip planes, rounded to R16_FLOAT, for soft_depth_compare to work in scene units
+    float linear_depth_texel(float depth, float clip_near, float clip_far);
+    void linear_depth(DepthImage const &depth, float clip_near, float clip_far, DepthImage &out, ThreadPool &pool);
+
+    // Runs TileMax, NeighborMax and the gather on a frame, owning the tile buffers and the jitter texture
+    class Reconstruction
+    {
+    public:
+        // thread_count == 0 uses every hardware thread
+        explicit Reconstruction(uint32_t thread_count = 0);
+
+        void run(ColorImage const &color, DepthImage const &depth, VelocityImage const &velocity, Parameters const &params, ColorImage &out);
+
+        // Sorts the tiles into TileLists after NeighborMax, and gathers only the tiles that need it
+        void set_tile_classification(bool enabled) { this->tile_classification = enabled; }
+        TileLists const &get_tile_lists() const { return this->tile_lists; }
+
+        // Instruction set of the gather, detect_simd_level() by default
+        void set_simd_level(SimdLevel level) { this->simd_level = level; }
+        SimdLevel get_simd_level() const { return this->simd_level; }
+
+        // Keeps TileMax/NeighborMax between runs and recomputes only the tiles whose velocity changed
+        void set_incremental_tiles(bool enabled);
+        IncrementalTileStats const &get_incremental_tile_stats() const { return this->incremental_tiles.get_stats(); }
+
+        // Computes NeighborMax straight from V with tile_max_neighbor_max_fused. TileMax is then never stored, so this
+        // has no effect while tile classification or incremental tiles, which both read TileMax, are enabled.
+        void set_fused_tile_max(bool enabled) { this->fused_tile_max = enabled; }
+
+        // Runs pack_velocity_depth ahead of the gather and has the taps read its output
+        void set_packed_velocity_depth(bool enabled) { this->packed_velocity_depth = enabled; }
+
+        // Runs linear_depth ahead of the gather, which then reads view-space depth; depth passed to run() must come
+        // from a projection with these clip planes
+        void set_linear_depth(bool enabled, float clip_near, float clip_far)
+        {
+            this->linear_depth = enabled;
+            this->clip_near = clip_near;
+            this->clip_far = clip_far;
+        }
+
+        // Runs the gather at half resolution with gather_half_resolution. Tile classification and the packed
+        // velocity/depth layout do not apply to it and are skipped while it is enabled.
+        void set_half_resolution(bool enabled) { this->half_resolution = enabled; }
+
+        // Gathers each tile with its own tap count from compute_tile_sample_counts, up to params.S. Replaces tile
+        // classification, whose no blur tiles are the tiles at 0 taps; has no effect at half resolution.
+        void set_adaptive_samples(bool enabled) { this->adaptive_samples = enabled; }
+        TileSampleImage const &get_tile_samples() const { return this->tile_samples; }
+        float get_average_taps_per_pixel() const { return this->average_taps_per_pixel; }
+
+        // Gathers tiles whose neighborhood moves as one with gather_uniform_velocity, at a cost that does not depend
+        // on S or on the blur length; the other tiles go through the regular gather. Has no effect at half resolution
+        // or with adaptive samples.
+        void set_uniform_velocity(bool enabled) { this->uniform_velocity = enabled; }
+        UniformVelocityStats const &get_uniform_velocity_stats() const { return this->uniform_velocity_stats; }
+
+        // Runs the plain gather (no classification, adaptive samples, uniform-velocity fast path or half resolution)
+        // with gather_blocked: L2-sized blocks in Morton order instead of full rows
+        void set_cache_blocking(bool enabled) { this->cache_blocking = enabled; }
+
+        // Runs the plain gather with gather_scheduled: tasks priced from NeighborMax, handed out with work stealing.
+        // Takes precedence over cache blocking.
+        void set_work_stealing(bool enabled) { this->work_stealing = enabled; }
+        TaskStats const &get_scheduler_stats() const { return this->scheduler_stats; }
+
+        VelocityImage const &get_tile_max() const { return this->tile_max_buffer; }
+        VelocityImage const &get_neighbor_max() const { return this->neighbor_max_buffer; }
+        ThreadPool &get_thread_pool() { return this->pool; }
+
+    private:
+        void resize(uint32_t width, uint32_t height, uint32_t K);
+
+        ThreadPool pool;
+
+        uint32_t last_width;
+        uint32_t last_height;
+        uint32_t last_K;
+
+        VelocityImage tile_max_buffer;
+        VelocityImage neighbor_max_buffer;
+        RandomImage random;
+        RandomImage blue_noise; // Built on the first run with JITTER_BLUE_NOISE
+
+        bool packed_velocity_depth;
+        VelocityDepthImage velocity_depth;
+
+        bool linear_depth;
+        float clip_near;
+        float clip_far;
+        DepthImage linear_depth_buffer;
+
+        bool half_resolution;
+        HalfResolutionFrame half_resolution_frame;
+
+        bool adaptive_samples;
+        TileSampleImage tile_samples;
+        float average_taps_per_pixel;
+
+        bool uniform_velocity;
+        TileBoundsImage tile_bounds;
+        UniformVelocityStats uniform_velocity_stats;
+
+        bool tile_classification;
+        TileLists tile_lists;
+
+        bool cache_blocking;
+
+        bool work_stealing;
+        TaskStats scheduler_stats;
+
+        SimdLevel simd_level;
+
+        bool incremental;
+        IncrementalTiles incremental_tiles;
+
+        bool fused_tile_max;
+    };
+}
@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/scheduled_gather.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "scheduled_gather.h"
+#include <algorithm>
+#include "tile_classification.h"
+
+namespace CPUBlur
+{
+    float estimate_tile_gather_cost(Unorm8x2 neighbor_max, Parameters const &params)
+    {
+        // Same test as the gather's early-out
+        float temp_NX = clamp(length(read_velocity(neighbor_max)) * params.half_exposure, 0.1f, float(params.K));
+        if (temp_NX < HALF_VELOCITY_CUTOFF)
+        {
+            return SCHEDULER_EARLY_OUT_COST;
+        }
+        return SCHEDULER_PIXEL_COST + float(params.S);
+    }
+
+    void build_gather_tasks(VelocityImage const &neighbor_max, Parameters const &params, uint32_t width, uint32_t height, uint32_t thread_count,
+                            std::vector<GatherTask> &tasks)
+    {
+        uint32_t tile_width = neighbor_max.get_width();
+        uint32_t tile_height = neighbor_max.get_height();
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(width, tile_width, first_x);
+        compute_tile_pixel_ranges(height, tile_height, first_y);
+
+        std::vector<float> tile_costs(size_t(tile_width) * tile_height);
+        double total_cost = 0.0;
+        for (uint32_t ty = 0; ty < tile_height; ++ty)
+        {
+            for (uint32_t tx = 0; tx < tile_width; ++tx)
+            {
+                float pixels = float((first_x[tx + 1] - first_x[tx]) * (first_y[ty + 1] - first_y[ty]));
+                float cost = pixels * estimate_tile_gather_cost(neighbor_max.at(tx, ty), params);
+                tile_costs[size_t(ty) * tile_width + tx] = cost;
+                total_cost += cost;
+            }
+        }
+
+        float target_cost = float(total_cost / double(std::max(thread_count, 1U) * SCHEDULER_TASKS_PER_THREAD));
+
+        tasks.clear();
+        for (uint32_t ty = 0; ty < tile_height; ++ty)
+        {
+            GatherTask task = {ty, 0, 0, 0.0f};
+            for (uint32_t tx = 0; tx < tile_width; ++tx)
+            {
+                float cost = tile_costs[size_t(ty) * tile_width + tx];
+                if (task.tx_end > task.tx_begin && task.cost + cost > target_cost)
+                {
+                    tasks.push_back(task);
+                    task.tx_begin = tx;
+                    task.cost = 0.0f;
+                }
+                task.tx_end = tx + 1;
+                task.cost += cost;
+            }
+            if (task.tx_end > task.tx_begin)
+            {
+                tasks.push_back(task);
+            }
+        }
+
+        // Ties keep frame order, so that equal tasks dealt to a thread stay close together
+        std::stable_sort(tasks.begin(), tasks.end(), [](GatherTask const &a, GatherTask const &b) { return a.cost > b.cost; });
+    }
+
+    void gather_scheduled(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, TaskStats *stats)
+    {
+        uint32_t width = out.get_width();
+        uint32_t height = out.get_height();
+
+        std::vector<GatherTask> tasks;
+        build_gather_tasks(*inputs.neighbor_max, params, width, height, pool.get_thread_count(), tasks);
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(width, inputs.neighbor_max->get_width(), first_x);
+        compute_tile_pixel_ranges(height, inputs.neighbor_max->get_height(), first_y);
+
+        std::vector<uint32_t> order(tasks.size());
+        for (uint32_t i = 0; i < uint32_t(tasks.size()); ++i)
+        {
+            order[i] = i;
+        }
+
+        GatherSpanFunction gather_span = get_gather_span_function(level, params.S);
+        pool.parallel_tasks(order, [&](uint32_t index) {
+            GatherTask const &task = tasks[index];
+            uint32_t x_begin = first_x[task.tx_begin];
+            uint32_t x_end = first_x[task.tx_end];
+            for (uint32_t y = first_y[task.ty]; y < first_y[task.ty + 1]; ++y)
+            {
+                gather_span(inputs, params, y, x_begin, x_end, out.row(y));
+            }
+        }, stats);
+    }
+}
@@ -0,0 +1,69 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/scheduled_gather.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// Gather scheduled by estimated cost instead of by row bands. A tile's cost ranges from the early-out, one fetch of C
+// and NeighborMax per pixel, to the full S-tap loop, so equal bands leave threads idle when the blur is concentrated
+// in part of the frame (the fan blades). Here NeighborMax prices every tile, runs of tiles are cut into tasks of about
+// equal cost, and ThreadPool::parallel_tasks hands them out most expensive first with work stealing.
+
+namespace CPUBlur
+{
+    // Horizontal run of tiles [tx_begin, tx_end) in tile row ty
+    struct GatherTask
+    {
+        uint32_t ty;
+        uint32_t tx_begin;
+        uint32_t tx_end;
+        float cost;
+    };
+
+    // Estimated cost of one pixel of a tile, in taps: SCHEDULER_EARLY_OUT_COST when the tile takes the
+    // HALF_VELOCITY_CUTOFF early-out, SCHEDULER_PIXEL_COST + S otherwise
+    float estimate_tile_gather_cost(Unorm8x2 neighbor_max, Parameters const &params);
+
+    // Cuts every tile row into runs of about total / (thread_count * SCHEDULER_TASKS_PER_THREAD), never splitting a
+    // tile nor joining two rows, and sorts them by decreasing cost
+    void build_gather_tasks(VelocityImage const &neighbor_max, Parameters const &params, uint32_t width, uint32_t height, uint32_t thread_count,
+                            std::vector<GatherTask> &tasks);
+
+    // Same result as gather_simd; stats, when given, receives the timing of the task run
+    void gather_scheduled(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, TaskStats *stats = nullptr);
+}
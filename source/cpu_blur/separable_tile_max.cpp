@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/separable_tile_max.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "separable_tile_max.h"
+
+namespace CPUBlur
+{
+    TileMaxCandidate tile_max_horizontal_texel(VelocityImage const &velocity, uint32_t K, uint32_t tile_width, uint32_t tx, uint32_t y)
+    {
+        TileMaxCandidate output = {VELOCITY_GRAY, 0, 0};
+
+        uint32_t w = velocity.get_width();
+        uint32_t h = velocity.get_height();
+        float tex_coord_base_x = (float(tx) + 0.5f) / float(tile_width);
+        float tex_coord_base_y = (float(y) + 0.5f) / float(h);
+        float tex_coord_increment_x = 1.0f / float(w);
+
+        uint32_t row = VelocityImage::point_clamp_index(tex_coord_base_y, h);
+
+        float max_magnitude_squared = 0.0f;
+        for (uint32_t s = 0; s < K; ++s)
+        {
+            uint32_t x = VelocityImage::point_clamp_index(tex_coord_base_x + float(s) * tex_coord_increment_x, w);
+            Unorm8x2 texel = velocity.at(x, row);
+            Float2 v = read_velocity(texel);
+
+            float magnitude_squared = dot(v, v);
+            if (max_magnitude_squared < magnitude_squared)
+            {
+                output.velocity = texel;
+                output.column = uint8_t(s);
+                output.selected = 255;
+                max_magnitude_squared = magnitude_squared;
+            }
+        }
+        return output;
+    }
+
+    Unorm8x2 tile_max_vertical_texel(TileMaxCandidateImage const &horizontal, uint32_t K, uint32_t tile_height, uint32_t tx, uint32_t ty)
+    {
+        Unorm8x2 output = VELOCITY_GRAY;
+
+        uint32_t w = horizontal.get_width();
+        uint32_t h = horizontal.get_height();
+        float tex_coord_base_x = (float(tx) + 0.5f) / float(w);
+        float tex_coord_base_y = (float(ty) + 0.5f) / float(tile_height);
+        float tex_coord_increment_y = 1.0f / float(h);
+
+        uint32_t column = TileMaxCandidateImage::point_clamp_index(tex_coord_base_x, w);
+
+        float max_magnitude_squared = 0.0f;
+        uint32_t max_column = 256;
+        for (uint32_t t = 0; t < K; ++t)
+        {
+            uint32_t y = TileMaxCandidateImage::point_clamp_index(tex_coord_base_y + float(t) * tex_coord_increment_y, h);
+            TileMaxCandidate const &candidate = horizontal.at(column, y);
+            if (!candidate.selected)
+            {
+                continue;
+            }
+
+            Float2 v = read_velocity(candidate.velocity);
+            float magnitude_squared = dot(v, v);
+
+            // The single-pass loop visits columns in the outer loop, so equal magnitudes go to the smaller column
+            if ((max_magnitude_squared < magnitude_squared) || (max_magnitude_squared == magnitude_squared && candidate.column < max_column))
+            {
+                output = candidate.velocity;
+                max_magnitude_squared = magnitude_squared;
+                max_column = candidate.column;
+            }
+        }
+        return output;
+    }
+
+    void tile_max_separable(VelocityImage const &velocity, uint32_t K, TileMaxCandidateImage &horizontal, VelocityImage &out, ThreadPool &pool)
+    {
+        uint32_t tile_width = out.get_width();
+        uint32_t tile_height = out.get_height();
+
+        pool.parallel_rows(horizontal.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                TileMaxCandidate *dst = horizontal.row(y);
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    dst[tx] = tile_max_horizontal_texel(velocity, K, tile_width, tx, y);
+                }
+            }
+        });
+
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                Unorm8x2 *dst = out.row(ty);
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    dst[tx] = tile_max_vertical_texel(horizontal, K, tile_height, tx, ty);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,61 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/separable_tile_max.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "image.h"
+#include "thread_pool.h"
+
+// CPU counterpart of ps_tilemax_horizontal.hlsl and ps_tilemax_vertical.hlsl: TileMax as a K x 1 reduction into a
+// (w/K, h) intermediate buffer followed by a 1 x K reduction into the (w/K, h/K) TileMax buffer. The result is
+// bit-identical to tile_max(), including which texel wins when several share the maximum magnitude.
+
+namespace CPUBlur
+{
+    // Texel of the R8G8B8A8_UNORM intermediate buffer
+    struct TileMaxCandidate
+    {
+        Unorm8x2 velocity; // Texel with the largest magnitude in the row segment
+        uint8_t column;    // Its index s within the segment
+        uint8_t selected;  // 255 if anything was selected, 0 otherwise
+    };
+
+    typedef Image<TileMaxCandidate> TileMaxCandidateImage;
+
+    TileMaxCandidate tile_max_horizontal_texel(VelocityImage const &velocity, uint32_t K, uint32_t tile_width, uint32_t tx, uint32_t y);
+    Unorm8x2 tile_max_vertical_texel(TileMaxCandidateImage const &horizontal, uint32_t K, uint32_t tile_height, uint32_t tx, uint32_t ty);
+
+    // horizontal must be (out.width, velocity.height)
+    void tile_max_separable(VelocityImage const &velocity, uint32_t K, TileMaxCandidateImage &horizontal, VelocityImage &out, ThreadPool &pool);
+}
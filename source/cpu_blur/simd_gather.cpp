@@ -0,0 +1,260 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/simd_gather.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "simd_gather.h"
+#include "simd_gather_kernel.h"
+#include "reconstruction.h"
+
+#if CPUBLUR_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+    // One lane, for the specialized kernels without vector instructions
+    struct Scalar
+    {
+        typedef float Float;
+        typedef int32_t Int;
+        static const uint32_t WIDTH = 1;
+
+        static Float set1(float v) { return v; }
+        static Float load(float const *p) { return *p; }
+        static void store(float *p, Float v) { *p = v; }
+        static Float add(Float a, Float b) { return a + b; }
+        static Float sub(Float a, Float b) { return a - b; }
+        static Float mul(Float a, Float b) { return a * b; }
+        static Float div(Float a, Float b) { return a / b; }
+        static Float min(Float a, Float b) { return std::min(a, b); }
+        static Float max(Float a, Float b) { return std::max(a, b); }
+        static Float sqrt(Float v) { return sqrtf(v); }
+        static Float abs(Float v) { return fabsf(v); }
+        static Float neg(Float v) { return -v; }
+        static Float floor(Float v) { return floorf(v); }
+        static Int to_int(Float v) { return Int(v); }
+
+        static Int set1_i(int32_t v) { return v; }
+        static Int add_i(Int a, Int b) { return a + b; }
+        static Int mul_i(Int a, Int b) { return a * b; }
+
+        static Float gather(float const *base, Int index) { return base[index]; }
+        static Int gather_u16(uint16_t const *base, Int index, uint32_t) { return base[index]; }
+
+        static void decode_unorm8x2(Int texels, Float &x, Float &y)
+        {
+            x = Float(texels & 0xFF);
+            y = Float((texels >> 8) & 0xFF);
+        }
+    };
+
+#if CPUBLUR_SIMD_X86
+    void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+    {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, int(leaf), int(subleaf));
+        for (int i = 0; i < 4; ++i)
+        {
+            registers[i] = uint32_t(values[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // XCR0, the register state the OS saves on context switches
+    uint64_t read_xcr0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (uint64_t(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    CPUBlur::SimdLevel detect_simd_level_uncached()
+    {
+#if CPUBLUR_SIMD_X86
+        uint32_t registers[4];
+        cpuid(0, 0, registers);
+        uint32_t max_leaf = registers[0];
+
+        cpuid(1, 0, registers);
+        bool sse42 = (registers[2] & (1u << 20)) != 0;
+        bool osxsave = (registers[2] & (1u << 27)) != 0;
+        bool avx = (registers[2] & (1u << 28)) != 0;
+        if (!sse42)
+        {
+            return CPUBlur::SIMD_LEVEL_SCALAR;
+        }
+        if (!osxsave || !avx || max_leaf < 7)
+        {
+            return CPUBlur::SIMD_LEVEL_SSE42;
+        }
+
+        uint64_t xcr0 = read_xcr0();
+        bool ymm_state = (xcr0 & 0x6) == 0x6;
+        bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+
+        cpuid(7, 0, registers);
+        bool avx2 = (registers[1] & (1u << 5)) != 0;
+        bool avx512f = (registers[1] & (1u << 16)) != 0;
+
+        if (avx512f && zmm_state)
+        {
+            return CPUBlur::SIMD_LEVEL_AVX512;
+        }
+        if (avx2 && ymm_state)
+        {
+            return CPUBlur::SIMD_LEVEL_AVX2;
+        }
+        return CPUBlur::SIMD_LEVEL_SSE42;
+#else
+        return CPUBlur::SIMD_LEVEL_SCALAR;
+#endif
+    }
+
+    const uint32_t DEFAULT_L2_CACHE_SIZE = 256 * 1024;
+
+    uint32_t detect_l2_cache_size_uncached()
+    {
+#if CPUBLUR_SIMD_X86
+        // Extended leaf 0x80000006, reported by both Intel and AMD: ECX[31:16] is the L2 size in KB
+        uint32_t registers[4];
+        cpuid(0x80000000u, 0, registers);
+        if (registers[0] >= 0x80000006u)
+        {
+            cpuid(0x80000006u, 0, registers);
+            uint32_t kilobytes = registers[2] >> 16;
+            if (kilobytes != 0)
+            {
+                return kilobytes * 1024;
+            }
+        }
+#endif
+        return DEFAULT_L2_CACHE_SIZE;
+    }
+}
+
+namespace CPUBlur
+{
+    SimdLevel detect_simd_level()
+    {
+        static const SimdLevel level = detect_simd_level_uncached();
+        return level;
+    }
+
+    uint32_t detect_l2_cache_size()
+    {
+        static const uint32_t size = detect_l2_cache_size_uncached();
+        return size;
+    }
+
+    const char *get_simd_level_name(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SIMD_LEVEL_SSE42:
+            return "SSE4.2";
+        case SIMD_LEVEL_AVX2:
+            return "AVX2";
+        case SIMD_LEVEL_AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+        }
+    }
+
+    uint32_t get_simd_level_width(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SIMD_LEVEL_SSE42:
+            return 4;
+        case SIMD_LEVEL_AVX2:
+            return 8;
+        case SIMD_LEVEL_AVX512:
+            return 16;
+        default:
+            return 1;
+        }
+    }
+
+    void gather_span_scalar(Inputs const &inputs, Parameters const &params, uint32_t y, uint32_t x_begin, uint32_t x_end, Float4 *row)
+    {
+        for (uint32_t x = x_begin; x < x_end; ++x)
+        {
+            row[x] = gather_pixel(inputs, params, x, y);
+        }
+    }
+
+    GatherSpanFunction get_gather_span_function(SimdLevel level, uint32_t S)
+    {
+        level = std::min(level, detect_simd_level());
+        switch (level)
+        {
+#if CPUBLUR_SIMD_X86
+        case SIMD_LEVEL_SSE42:
+            return get_gather_span_sse42(S);
+        case SIMD_LEVEL_AVX2:
+            return get_gather_span_avx2(S);
+        case SIMD_LEVEL_AVX512:
+            return get_gather_span_avx512(S);
+#endif
+        default:
+            // The generic scalar path is gather_pixel itself
+            return is_specialized_S(S) ? select_gather_span_kernel<Scalar>(S) : gather_span_scalar;
+        }
+    }
+
+    void gather_simd(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, bool specialize_S)
+    {
+        GatherSpanFunction gather_span = get_gather_span_function(level, specialize_S ? params.S : 0);
+        uint32_t width = out.get_width();
+
+        pool.parallel_rows(out.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                gather_span(inputs, params, y, 0, width, out.row(y));
+            }
+        });
+    }
+}
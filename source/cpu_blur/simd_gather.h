@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/simd_gather.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include "parameters.h"
+#include "thread_pool.h"
+
+// SoA-vectorized gather: the S-tap loop of ps_gather.hlsl evaluated for 4, 8 or 16 horizontally adjacent pixels at
+// once, with the instruction set picked at run time. Every lane performs the same operations in the same order as
+// gather_pixel.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPUBLUR_SIMD_X86 1
+#else
+#define CPUBLUR_SIMD_X86 0
+#endif
+
+namespace CPUBlur
+{
+    enum SimdLevel
+    {
+        SIMD_LEVEL_SCALAR = 0,
+        SIMD_LEVEL_SSE42,
+        SIMD_LEVEL_AVX2,
+        SIMD_LEVEL_AVX512,
+        SIMD_LEVEL_COUNT
+    };
+
+    // Highest level supported by both the CPU and the OS (saved YMM/ZMM state)
+    SimdLevel detect_simd_level();
+
+    const char *get_simd_level_name(SimdLevel level);
+
+    // L2 cache of one core in bytes, as reported by CPUID; 256 KB when the CPU does not report it
+    uint32_t detect_l2_cache_size();
+
+    // Pixels processed per kernel iteration
+    uint32_t get_simd_level_width(SimdLevel level);
+
+    // Gathers pixels [x_begin, x_end) of row y into row[x_begin, x_end)
+    typedef void (*GatherSpanFunction)(Inputs const &inputs, Parameters const &params, uint32_t y, uint32_t x_begin, uint32_t x_end, Float4 *row);
+
+    void gather_span_scalar(Inputs const &inputs, Parameters const &params, uint32_t y, uint32_t x_begin, uint32_t x_end, Float4 *row);
+
+    // Levels above detect_simd_level() fall back to the highest supported one. S selects the kernel compiled for that
+    // sample count (odd values up to GATHER_MAX_SPECIALIZED_S); 0, or any other value, the generic loop over params.S.
+    GatherSpanFunction get_gather_span_function(SimdLevel level, uint32_t S = 0);
+
+    // Same result as gather, bit for bit without specialize_S (the vector code is compiled without FMA contraction). With
+    // specialize_S, the rounding of the precomputed tap offsets moves the colors by about 1e-6
+    void gather_simd(Inputs const &inputs, Parameters const &params, ColorImage &out, ThreadPool &pool, SimdLevel level, bool specialize_S = true);
+}
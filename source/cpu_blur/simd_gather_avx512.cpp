@@ -0,0 +1,120 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/simd_gather_avx512.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "simd_gather.h"
+#include "reconstruction.h"
+
+#if CPUBLUR_SIMD_X86
+
+// No contraction of the kernel's multiplies and adds into FMA where the target or -march provides it, so that the
+// results stay bit-identical to the scalar gather
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+// GCC 12's avx512fintrin.h trips -Wmaybe-uninitialized on _mm512_undefined_ps
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+#include <immintrin.h>
+#include "simd_gather_kernel.h"
+
+namespace
+{
+    // 16 lanes, AVX-512F only
+    struct Avx512
+    {
+        typedef __m512 Float;
+        typedef __m512i Int;
+        static const uint32_t WIDTH = 16;
+
+        static Float set1(float v) { return _mm512_set1_ps(v); }
+        static Float load(float const *p) { return _mm512_load_ps(p); }
+        static void store(float *p, Float v) { _mm512_store_ps(p, v); }
+        static Float add(Float a, Float b) { return _mm512_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm512_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm512_mul_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm512_div_ps(a, b); }
+        static Float min(Float a, Float b) { return _mm512_min_ps(a, b); }
+        static Float max(Float a, Float b) { return _mm512_max_ps(a, b); }
+        static Float sqrt(Float v) { return _mm512_sqrt_ps(v); }
+        static Float abs(Float v) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x7FFFFFFF))); }
+        static Float neg(Float v) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi32(int32_t(0x80000000u)))); }
+        static Float floor(Float v) { return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+        static Int to_int(Float v) { return _mm512_cvttps_epi32(v); }
+
+        static Int set1_i(int32_t v) { return _mm512_set1_epi32(v); }
+        static Int add_i(Int a, Int b) { return _mm512_add_epi32(a, b); }
+        static Int mul_i(Int a, Int b) { return _mm512_mullo_epi32(a, b); }
+
+        static Float gather(float const *base, Int index) { return _mm512_i32gather_ps(index, base, 4); }
+
+        // Same scheme as the AVX2 version
+        static Int gather_u16(uint16_t const *base, Int index, uint32_t count)
+        {
+            Int clamped = _mm512_min_epi32(index, _mm512_set1_epi32(int32_t(count) - 2));
+            Int pairs = _mm512_i32gather_epi32(clamped, base, 2);
+            Int shift = _mm512_slli_epi32(_mm512_sub_epi32(index, clamped), 4);
+            return _mm512_and_si512(_mm512_srlv_epi32(pairs, shift), _mm512_set1_epi32(0xFFFF));
+        }
+
+        static void decode_unorm8x2(Int texels, Float &x, Float &y)
+        {
+            Int mask = _mm512_set1_epi32(0xFF);
+            x = _mm512_cvtepi32_ps(_mm512_and_si512(texels, mask));
+            y = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texels, 8), mask));
+        }
+    };
+}
+
+namespace CPUBlur
+{
+    GatherSpanFunction get_gather_span_avx512(uint32_t S)
+    {
+        return select_gather_span_kernel<Avx512>(S);
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,370 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/simd_gather_kernel.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include "gather_taps.h"
+#include "reconstruction.h"
+#include "simd_gather.h"
+
+// Shared body of the vectorized gather. Each ISA translation unit defines a traits struct V (vector types, WIDTH and
+// the handful of operations below) and instantiates gather_span_kernel<V, S> with its target options enabled, so this
+// header must be included after them.
+
+namespace CPUBlur
+{
+#if CPUBLUR_SIMD_X86
+    GatherSpanFunction get_gather_span_sse42(uint32_t S);
+    GatherSpanFunction get_gather_span_avx2(uint32_t S);
+    GatherSpanFunction get_gather_span_avx512(uint32_t S);
+#endif
+
+    template <typename V>
+    inline typename V::Float clamp_v(typename V::Float v, typename V::Float lo, typename V::Float hi)
+    {
+        return V::min(V::max(v, lo), hi);
+    }
+
+    template <typename V>
+    inline typename V::Float cone_v(typename V::Float mag_diff, typename V::Float mag_v)
+    {
+        return V::sub(V::set1(1.0f), V::div(V::abs(mag_diff), mag_v));
+    }
+
+    template <typename V>
+    inline typename V::Float cylinder_v(typename V::Float mag_diff, typename V::Float mag_v)
+    {
+        typedef typename V::Float F;
+        F a = V::mul(V::set1(CYLINDER_CORNER_1), mag_v);
+        F b = V::mul(V::set1(CYLINDER_CORNER_2), mag_v);
+        F t = clamp_v<V>(V::div(V::sub(V::abs(mag_diff), a), V::sub(b, a)), V::set1(0.0f), V::set1(1.0f));
+        F smooth = V::mul(V::mul(t, t), V::sub(V::set1(3.0f), V::mul(V::set1(2.0f), t)));
+        return V::sub(V::set1(1.0f), smooth);
+    }
+
+    template <typename V>
+    inline typename V::Float soft_depth_compare_v(typename V::Float za, typename V::Float zb)
+    {
+        typedef typename V::Float F;
+        F v = V::sub(V::set1(1.0f), V::div(V::sub(za, zb), V::set1(SOFT_Z_EXTENT)));
+        return clamp_v<V>(v, V::set1(0.0f), V::set1(1.0f));
+    }
+
+    // sampPointClamp texel index along one axis (Image::point_clamp_index)
+    template <typename V>
+    inline typename V::Int point_clamp_index_v(typename V::Float uv, typename V::Float size, typename V::Float size_minus_one)
+    {
+        typename V::Float texel = V::floor(V::mul(uv, size));
+        return V::to_int(clamp_v<V>(texel, V::set1(0.0f), size_minus_one));
+    }
+
+    // Tap positions for a compile-time S, from the constexpr table in gather_taps.h
+    template <uint32_t S>
+    struct GatherTapLoop
+    {
+        template <typename V, typename Tap>
+        static void run(Parameters const &, typename V::Float R, float max_sample_tap_distance, Tap const &accumulate_tap)
+        {
+            typedef typename V::Float F;
+            F jitter = V::mul(R, V::set1(GatherTaps<S>::JITTER_SCALE * max_sample_tap_distance));
+            for (uint32_t tap = 0; tap < GatherTapTable<S>::COUNT; ++tap)
+            {
+                F T = V::add(V::set1(GatherTaps<S>::TABLE.offset[tap] * max_sample_tap_distance), jitter);
+                accumulate_tap(T, GatherTaps<S>::TABLE.use_corrected_VX[tap]);
+            }
+        }
+    };
+
+    // S == 0: the generic loop of ps_gather.hlsl over params.S
+    template <>
+    struct GatherTapLoop<0>
+    {
+        template <typename V, typename Tap>
+        static void run(Parameters const &params, typename V::Float R, float max_sample_tap_distance, Tap const &accumulate_tap)
+        {
+            typedef typename V::Float F;
+            float S = float(params.S);
+            int self_index = int((S - 1.0f) / 2.0f);
+            F S_plus_one = V::set1(S + 1.0f);
+            F negative_distance = V::set1(-max_sample_tap_distance);
+            F double_distance = V::set1(2.0f * max_sample_tap_distance);
+
+            for (int i = 0; i < int(params.S); ++i)
+            {
+                if (i == self_index)
+                {
+                    continue;
+                }
+
+                F lerp_amount = V::div(V::add(V::add(V::set1(float(i)), R), V::set1(1.0f)), S_plus_one);
+                F T = V::add(negative_distance, V::mul(double_distance, lerp_amount));
+                accumulate_tap(T, (i & 1) == 1);
+            }
+        }
+    };
+
+    // Gathers pixels [x_begin, x_end) of row y, V::WIDTH at a time, with the tap loop specialized for S (0 for the
+    // generic loop). The per-pixel setup goes through prepare_gather_pixel; lanes that take the early-out, or lie
+    // past x_end, run the tap loop on neutral values and are discarded.
+    template <typename V, uint32_t S>
+    void gather_span_kernel(Inputs const &inputs, Parameters const &params, uint32_t y, uint32_t x_begin, uint32_t x_end, Float4 *row)
+    {
+        typedef typename V::Float F;
+        typedef typename V::Int I;
+        const uint32_t W = V::WIDTH;
+
+        ColorImage const &color = *inputs.color;
+        uint32_t width = color.get_width();
+        uint32_t height = color.get_height();
+        uint32_t texel_count = width * height;
+        float tex_dim_x = float(width);
+
+        float max_sample_tap_distance = params.max_sample_tap_distance / tex_dim_x;
+        float half_texel = 0.5f / tex_dim_x;
+
+        float const *color_data = &color.data()->x;
+        float const *depth_data = inputs.depth->data();
+        uint16_t const *velocity_data = reinterpret_cast<uint16_t const *>(inputs.velocity->data());
+        float const *velocity_depth_data = inputs.velocity_depth ? &inputs.velocity_depth->data()->x : nullptr;
+
+        F one = V::set1(1.0f);
+        F zero = V::set1(0.0f);
+        F size_x = V::set1(float(width));
+        F size_y = V::set1(float(height));
+        F size_x_minus_one = V::set1(float(width - 1));
+        F size_y_minus_one = V::set1(float(height - 1));
+        F half = V::set1(0.5f);
+        F half_exposure = V::set1(params.half_exposure);
+        F min_velocity = V::set1(0.1f);
+        F max_velocity = V::set1(float(params.K));
+        F half_texel_v = V::set1(half_texel);
+        I row_pitch = V::set1_i(int32_t(width));
+        I channels = V::set1_i(4);
+
+        alignas(64) float lane_X_x[W], lane_X_y[W];
+        alignas(64) float lane_NX_x[W], lane_NX_y[W];
+        alignas(64) float lane_corrected_VX_x[W], lane_corrected_VX_y[W];
+        alignas(64) float lane_temp_VX[W], lane_ZX[W], lane_R[W], lane_weight[W];
+        alignas(64) float lane_sum_x[W], lane_sum_y[W], lane_sum_z[W];
+        GatherPixelState state[W];
+        bool active[W];
+
+        for (uint32_t x0 = x_begin; x0 < x_end; x0 += W)
+        {
+            uint32_t lane_count = std::min(W, x_end - x0);
+
+            bool any_active = false;
+            for (uint32_t lane = 0; lane < W; ++lane)
+            {
+                GatherPixelState &s = state[lane];
+                active[lane] = (lane < lane_count) && prepare_gather_pixel(inputs, params, x0 + lane, y, s);
+                any_active = any_active || active[lane];
+                if (active[lane])
+                {
+                    lane_X_x[lane] = s.X.x;
+                    lane_X_y[lane] = s.X.y;
+                    lane_NX_x[lane] = s.NX.x;
+                    lane_NX_y[lane] = s.NX.y;
+                    lane_corrected_VX_x[lane] = s.corrected_VX.x;
+                    lane_corrected_VX_y[lane] = s.corrected_VX.y;
+                    lane_temp_VX[lane] = s.temp_VX;
+                    lane_ZX[lane] = s.ZX;
+                    lane_R[lane] = s.R;
+                    lane_weight[lane] = s.weight;
+                    lane_sum_x[lane] = s.CX.x * s.weight;
+                    lane_sum_y[lane] = s.CX.y * s.weight;
+                    lane_sum_z[lane] = s.CX.z * s.weight;
+                }
+                else
+                {
+                    lane_X_x[lane] = 0.5f;
+                    lane_X_y[lane] = 0.5f;
+                    lane_NX_x[lane] = 0.0f;
+                    lane_NX_y[lane] = 0.0f;
+                    lane_corrected_VX_x[lane] = 0.0f;
+                    lane_corrected_VX_y[lane] = 0.0f;
+                    lane_temp_VX[lane] = 1.0f;
+                    lane_ZX[lane] = 0.0f;
+                    lane_R[lane] = 0.0f;
+                    lane_weight[lane] = 1.0f;
+                    lane_sum_x[lane] = 0.0f;
+                    lane_sum_y[lane] = 0.0f;
+                    lane_sum_z[lane] = 0.0f;
+                }
+            }
+
+            if (any_active)
+            {
+                F X_x = V::load(lane_X_x);
+                F X_y = V::load(lane_X_y);
+                F NX_x = V::load(lane_NX_x);
+                F NX_y = V::load(lane_NX_y);
+                F corrected_VX_x = V::load(lane_corrected_VX_x);
+                F corrected_VX_y = V::load(lane_corrected_VX_y);
+                F temp_VX = V::load(lane_temp_VX);
+                F ZX = V::load(lane_ZX);
+                F R = V::load(lane_R);
+                F weight = V::load(lane_weight);
+                F sum_x = V::load(lane_sum_x);
+                F sum_y = V::load(lane_sum_y);
+                F sum_z = V::load(lane_sum_z);
+
+                // One iteration of the tap loop, at distance T along CorrectedVX or NX
+                auto accumulate_tap = [&](F T, bool use_corrected_VX) {
+                    F switch_v_x = use_corrected_VX ? corrected_VX_x : NX_x;
+                    F switch_v_y = use_corrected_VX ? corrected_VX_y : NX_y;
+                    F Y_x = V::add(V::add(X_x, V::mul(switch_v_x, T)), half_texel_v);
+                    F Y_y = V::add(V::add(X_y, V::mul(switch_v_y, T)), half_texel_v);
+
+                    // V and Z at Y (sampPointClamp)
+                    I point_x = point_clamp_index_v<V>(Y_x, size_x, size_x_minus_one);
+                    I point_y = point_clamp_index_v<V>(Y_y, size_y, size_y_minus_one);
+                    I point_index = V::add_i(V::mul_i(point_y, row_pitch), point_x);
+
+                    F temp_VY, ZY;
+                    if (velocity_depth_data)
+                    {
+                        // Packed (Z, TempV): both gathers hit the same 8 bytes
+                        I packed_index = V::add_i(point_index, point_index);
+                        ZY = V::gather(velocity_depth_data, packed_index);
+                        temp_VY = V::gather(velocity_depth_data + 1, packed_index);
+                    }
+                    else
+                    {
+                        F VY_x, VY_y;
+                        V::decode_unorm8x2(V::gather_u16(velocity_data, point_index, texel_count), VY_x, VY_y);
+                        VY_x = V::sub(V::mul(V::mul(VY_x, V::set1(1.0f / 255.0f)), V::set1(2.0f)), one);
+                        VY_y = V::sub(V::mul(V::mul(VY_y, V::set1(1.0f / 255.0f)), V::set1(2.0f)), one);
+                        F VY_length = V::sqrt(V::add(V::mul(VY_x, VY_x), V::mul(VY_y, VY_y)));
+                        temp_VY = clamp_v<V>(V::mul(VY_length, half_exposure), min_velocity, max_velocity);
+
+                        ZY = V::neg(V::gather(depth_data, point_index));
+                    }
+
+                    // alpha = foreground contribution + background contribution + blur of both foreground and background
+                    F alpha_Y = V::add(V::add(V::mul(soft_depth_compare_v<V>(ZX, ZY), cone_v<V>(T, temp_VY)),
+                                              V::mul(soft_depth_compare_v<V>(ZY, ZX), cone_v<V>(T, temp_VX))),
+                                       V::mul(V::mul(cylinder_v<V>(T, temp_VY), cylinder_v<V>(T, temp_VX)), V::set1(2.0f)));
+
+                    // C at Y (sampLinearClamp, as in sample_linear_clamp)
+                    F fx = V::sub(V::mul(Y_x, size_x), half);
+                    F fy = V::sub(V::mul(Y_y, size_y), half);
+                    F x0f = V::floor(fx);
+                    F y0f = V::floor(fy);
+                    F ax = V::sub(fx, x0f);
+                    F ay = V::sub(fy, y0f);
+                    I x0i = V::to_int(clamp_v<V>(x0f, zero, size_x_minus_one));
+                    I x1i = V::to_int(clamp_v<V>(V::add(x0f, one), zero, size_x_minus_one));
+                    I y0i = V::mul_i(V::to_int(clamp_v<V>(y0f, zero, size_y_minus_one)), row_pitch);
+                    I y1i = V::mul_i(V::to_int(clamp_v<V>(V::add(y0f, one), zero, size_y_minus_one)), row_pitch);
+                    I i00 = V::mul_i(V::add_i(y0i, x0i), channels);
+                    I i10 = V::mul_i(V::add_i(y0i, x1i), channels);
+                    I i01 = V::mul_i(V::add_i(y1i, x0i), channels);
+                    I i11 = V::mul_i(V::add_i(y1i, x1i), channels);
+
+                    F w00 = V::mul(V::sub(one, ax), V::sub(one, ay));
+                    F w10 = V::mul(ax, V::sub(one, ay));
+                    F w01 = V::mul(V::sub(one, ax), ay);
+                    F w11 = V::mul(ax, ay);
+
+                    F CY[3];
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        F c00 = V::gather(color_data + c, i00);
+                        F c10 = V::gather(color_data + c, i10);
+                        F c01 = V::gather(color_data + c, i01);
+                        F c11 = V::gather(color_data + c, i11);
+                        CY[c] = V::add(V::add(V::add(V::mul(c00, w00), V::mul(c10, w10)), V::mul(c01, w01)), V::mul(c11, w11));
+                    }
+
+                    weight = V::add(weight, alpha_Y);
+                    sum_x = V::add(sum_x, V::mul(alpha_Y, CY[0]));
+                    sum_y = V::add(sum_y, V::mul(alpha_Y, CY[1]));
+                    sum_z = V::add(sum_z, V::mul(alpha_Y, CY[2]));
+                };
+
+                GatherTapLoop<S>::template run<V>(params, R, max_sample_tap_distance, accumulate_tap);
+
+                V::store(lane_sum_x, V::div(sum_x, weight));
+                V::store(lane_sum_y, V::div(sum_y, weight));
+                V::store(lane_sum_z, V::div(sum_z, weight));
+            }
+
+            for (uint32_t lane = 0; lane < lane_count; ++lane)
+            {
+                if (active[lane])
+                {
+                    Float4 result = {lane_sum_x[lane], lane_sum_y[lane], lane_sum_z[lane], 1.0f};
+                    row[x0 + lane] = result;
+                }
+                else
+                {
+                    row[x0 + lane] = state[lane].CX;
+                }
+            }
+        }
+    }
+
+    // Instantiation of gather_span_kernel<V, S> for a given S; S values without a specialization use the generic loop
+    template <typename V>
+    GatherSpanFunction select_gather_span_kernel(uint32_t S)
+    {
+        switch (S)
+        {
+        case 1:
+            return gather_span_kernel<V, 1>;
+        case 3:
+            return gather_span_kernel<V, 3>;
+        case 5:
+            return gather_span_kernel<V, 5>;
+        case 7:
+            return gather_span_kernel<V, 7>;
+        case 9:
+            return gather_span_kernel<V, 9>;
+        case 11:
+            return gather_span_kernel<V, 11>;
+        case 13:
+            return gather_span_kernel<V, 13>;
+        case 15:
+            return gather_span_kernel<V, 15>;
+        case 17:
+            return gather_span_kernel<V, 17>;
+        case 19:
+            return gather_span_kernel<V, 19>;
+        default:
+            return gather_span_kernel<V, 0>;
+        }
+    }
+}
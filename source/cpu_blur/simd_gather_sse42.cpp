@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/simd_gather_sse42.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "simd_gather.h"
+#include "reconstruction.h"
+
+#if CPUBLUR_SIMD_X86
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+#endif
+
+#include <nmmintrin.h>
+#include "simd_gather_kernel.h"
+
+namespace
+{
+    // 4 lanes; SSE has no gather instruction, so fetches go through scalar loads
+    struct Sse42
+    {
+        typedef __m128 Float;
+        typedef __m128i Int;
+        static const uint32_t WIDTH = 4;
+
+        static Float set1(float v) { return _mm_set1_ps(v); }
+        static Float load(float const *p) { return _mm_load_ps(p); }
+        static void store(float *p, Float v) { _mm_store_ps(p, v); }
+        static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+        static Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+        static Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+        static Float sqrt(Float v) { return _mm_sqrt_ps(v); }
+        static Float abs(Float v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+        static Float neg(Float v) { return _mm_xor_ps(_mm_set1_ps(-0.0f), v); }
+        static Float floor(Float v) { return _mm_floor_ps(v); }
+        static Int to_int(Float v) { return _mm_cvttps_epi32(v); }
+
+        static Int set1_i(int32_t v) { return _mm_set1_epi32(v); }
+        static Int add_i(Int a, Int b) { return _mm_add_epi32(a, b); }
+        static Int mul_i(Int a, Int b) { return _mm_mullo_epi32(a, b); }
+
+        static Float gather(float const *base, Int index)
+        {
+            alignas(16) int32_t i[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(i), index);
+            return _mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+        }
+
+        static Int gather_u16(uint16_t const *base, Int index, uint32_t)
+        {
+            alignas(16) int32_t i[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(i), index);
+            return _mm_setr_epi32(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+        }
+
+        static void decode_unorm8x2(Int texels, Float &x, Float &y)
+        {
+            Int mask = _mm_set1_epi32(0xFF);
+            x = _mm_cvtepi32_ps(_mm_and_si128(texels, mask));
+            y = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texels, 8), mask));
+        }
+    };
+}
+
+namespace CPUBlur
+{
+    GatherSpanFunction get_gather_span_sse42(uint32_t S)
+    {
+        return select_gather_span_kernel<Sse42>(S);
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
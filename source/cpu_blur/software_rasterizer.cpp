@@ -0,0 +1,549 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/software_rasterizer.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "software_rasterizer.h"
+#include <atomic>
+
+namespace
+{
+    // vs_scene.hlsl lighting
+    const CPUBlur::Float3 LIGHT_POS = {1.00f, 1.00f, -1.00f};
+    const float LIGHT_AMBIENT = 0.1f;
+    const float LIGHT_DIFFUSE = 0.7f;
+    const float LIGHT_SPECULAR = 1.0f;
+    const float LIGHT_SHININESS = 64.0f;
+
+    // Offsets into ShadedVertex::attributes
+    const uint32_t ATTRIBUTE_P_NEW = 0;
+    const uint32_t ATTRIBUTE_P_OLD = 4;
+    const uint32_t ATTRIBUTE_TC = 8;
+    const uint32_t ATTRIBUTE_L = 10;
+
+    CPUBlur::Float3 normalize3(CPUBlur::Float3 v)
+    {
+        float inv_length = 1.0f / sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        CPUBlur::Float3 result = {v.x * inv_length, v.y * inv_length, v.z * inv_length};
+        return result;
+    }
+
+    float dot3(CPUBlur::Float3 a, CPUBlur::Float3 b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // Clip-space triangles are clipped to |x|, |y| <= GUARD_BAND w, which keeps the snapped edge functions far from
+    // overflowing int64 at any render target size
+    const float GUARD_BAND = 4.0f;
+    const uint32_t CLIP_PLANE_COUNT = 5;
+    const uint32_t MAX_CLIPPED_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+    // Signed distance to clip plane i: z >= 0 (near), then the four guard band planes
+    float clip_distance(float const *position, uint32_t plane)
+    {
+        switch (plane)
+        {
+        case 0: return position[2];
+        case 1: return GUARD_BAND * position[3] - position[0];
+        case 2: return GUARD_BAND * position[3] + position[0];
+        case 3: return GUARD_BAND * position[3] - position[1];
+        default: return GUARD_BAND * position[3] + position[1];
+        }
+    }
+
+    int64_t floor_shift(int64_t v, uint32_t bits)
+    {
+        return (v >= 0) ? (v >> bits) : -((-v + (int64_t(1) << bits) - 1) >> bits);
+    }
+
+    int64_t ceil_shift(int64_t v, uint32_t bits)
+    {
+        return -floor_shift(-v, bits);
+    }
+}
+
+namespace CPUBlur
+{
+    Float4x4 identity_matrix()
+    {
+        Float4x4 result = {{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}};
+        return result;
+    }
+
+    Float4x4 multiply(Float4x4 const &a, Float4x4 const &b)
+    {
+        Float4x4 result;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            for (uint32_t j = 0; j < 4; ++j)
+            {
+                result.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+            }
+        }
+        return result;
+    }
+
+    Float4 transform(Float4 v, Float4x4 const &m)
+    {
+        Float4 result = {
+            v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+            v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+            v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+            v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3]};
+        return result;
+    }
+
+    SoftwareRasterizer::SoftwareRasterizer()
+    {
+        this->bins_x = 0;
+        this->bins_y = 0;
+        this->triangle_count = 0;
+    }
+
+    void SoftwareRasterizer::render(SceneCamera const &camera, SceneObject const *objects, uint32_t object_count, ColorImage const *background,
+                                    ColorImage &color, DepthImage &depth, VelocityImage &velocity, ThreadPool &pool)
+    {
+        uint32_t width = color.get_width();
+        uint32_t height = color.get_height();
+
+        // Clear, and draw the background quad
+        pool.parallel_rows(height, [&](uint32_t row_begin, uint32_t row_end) {
+            Float4 white = {1.0f, 1.0f, 1.0f, 1.0f};
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                Float4 *c = color.row(y);
+                float *z = depth.row(y);
+                Unorm8x2 *v = velocity.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    if (background)
+                    {
+                        Float2 uv = {(float(x) + 0.5f) / float(width), (float(y) + 0.5f) / float(height)};
+                        c[x] = background->sample_point_clamp(uv);
+                        c[x].w = 1.0f;
+                    }
+                    else
+                    {
+                        c[x] = white;
+                    }
+                    z[x] = 1.0f;
+                    v[x] = VELOCITY_GRAY;
+                }
+            }
+        });
+
+        // vs_scene.hlsl for every vertex of every object
+        std::vector<uint32_t> first_vertex(object_count + 1, 0);
+        std::vector<uint32_t> first_face(object_count + 1, 0);
+        for (uint32_t i = 0; i < object_count; ++i)
+        {
+            first_vertex[i + 1] = first_vertex[i] + objects[i].mesh->num_vertices;
+            first_face[i + 1] = first_face[i] + objects[i].mesh->num_faces;
+        }
+        this->vertices.resize(first_vertex[object_count]);
+
+        for (uint32_t i = 0; i < object_count; ++i)
+        {
+            SceneObject const &object = objects[i];
+            Mesh const &mesh = *object.mesh;
+            Float4x4 world_view_new = multiply(camera.world_xform_new, camera.view_xform_new);
+            Float4x4 world_view_old = multiply(camera.world_xform_old, camera.view_xform_old);
+            Float3 light_dir = normalize3(LIGHT_POS);
+            ShadedVertex *out = &this->vertices[first_vertex[i]];
+
+            pool.parallel_rows(mesh.num_vertices, [&](uint32_t vertex_begin, uint32_t vertex_end) {
+                for (uint32_t vertex = vertex_begin; vertex < vertex_end; ++vertex)
+                {
+                    float const *position = &mesh.vertices[3 * vertex];
+                    float const *normal_in = &mesh.normals[3 * vertex];
+                    Float4 P = {position[0], position[1], position[2], 1.0f};
+
+                    Float4 p_new_local = transform(P, object.model_xform_new);
+                    Float4 p_old_local = transform(P, object.model_xform_old);
+                    p_new_local.w = 1.0f;
+                    p_old_local.w = 1.0f;
+                    Float4 p_new_eye = transform(p_new_local, world_view_new);
+                    Float4 p_old_eye = transform(p_old_local, world_view_old);
+                    Float4 p_new = transform(p_new_eye, camera.projection_xform);
+                    Float4 p_old = transform(p_old_eye, camera.projection_xform);
+
+                    Float4 N = {normal_in[0], normal_in[1], normal_in[2], 1.0f};
+                    Float4 n = transform(N, object.model_xform_normal_new);
+                    Float3 normal = {n.x, n.y, n.z};
+                    Float3 eye_dir = normalize3(Float3{p_new_eye.x, p_new_eye.y, p_new_eye.z});
+                    Float3 h_vector = normalize3(Float3{light_dir.x - eye_dir.x, light_dir.y - eye_dir.y, light_dir.z - eye_dir.z});
+
+                    float L = LIGHT_AMBIENT;
+                    float n_dot_l = std::max(dot3(normal, light_dir), 0.0f);
+                    if (n_dot_l > 0.0f)
+                    {
+                        L += LIGHT_DIFFUSE * n_dot_l;
+                        float n_dot_h = std::max(dot3(normal, h_vector), 0.0f);
+                        L += LIGHT_SPECULAR * powf(n_dot_h, LIGHT_SHININESS);
+                    }
+
+                    float *a = out[vertex].attributes;
+                    a[ATTRIBUTE_P_NEW + 0] = p_new.x;
+                    a[ATTRIBUTE_P_NEW + 1] = p_new.y;
+                    a[ATTRIBUTE_P_NEW + 2] = p_new.z;
+                    a[ATTRIBUTE_P_NEW + 3] = p_new.w;
+                    a[ATTRIBUTE_P_OLD + 0] = p_old.x;
+                    a[ATTRIBUTE_P_OLD + 1] = p_old.y;
+                    a[ATTRIBUTE_P_OLD + 2] = p_old.z;
+                    a[ATTRIBUTE_P_OLD + 3] = p_old.w;
+                    a[ATTRIBUTE_TC + 0] = mesh.texture_coords[2 * vertex + 0];
+                    a[ATTRIBUTE_TC + 1] = mesh.texture_coords[2 * vertex + 1];
+                    a[ATTRIBUTE_L] = L;
+                }
+            });
+        }
+
+        // Set up and bin the triangles, one chunk of consecutive faces per thread
+        this->bins_x = (width + BIN_SIZE - 1) / BIN_SIZE;
+        this->bins_y = (height + BIN_SIZE - 1) / BIN_SIZE;
+        uint32_t bin_count = this->bins_x * this->bins_y;
+        uint32_t chunk_count = pool.get_thread_count();
+        uint32_t face_count = first_face[object_count];
+        this->chunks.resize(chunk_count);
+
+        pool.parallel_rows(chunk_count, [&](uint32_t chunk_begin, uint32_t chunk_end) {
+            for (uint32_t chunk_index = chunk_begin; chunk_index < chunk_end; ++chunk_index)
+            {
+                Chunk &chunk = this->chunks[chunk_index];
+                chunk.triangles.clear();
+                chunk.bins.resize(bin_count);
+                for (std::vector<uint32_t> &bin : chunk.bins)
+                {
+                    bin.clear();
+                }
+
+                uint32_t face_begin = uint32_t((uint64_t(face_count) * chunk_index) / chunk_count);
+                uint32_t face_end = uint32_t((uint64_t(face_count) * (chunk_index + 1)) / chunk_count);
+                uint32_t object = uint32_t(std::upper_bound(first_face.begin(), first_face.end(), face_begin) - first_face.begin()) - 1;
+                for (uint32_t face = face_begin; face < face_end; ++face)
+                {
+                    while (face >= first_face[object + 1])
+                    {
+                        ++object;
+                    }
+
+                    Mesh const &mesh = *objects[object].mesh;
+                    uint32_t const *indices = &mesh.indices[3 * (face - first_face[object])];
+                    ShadedVertex const *object_vertices = &this->vertices[first_vertex[object]];
+                    ShadedVertex const *triangle[3] = {&object_vertices[indices[0]], &object_vertices[indices[1]], &object_vertices[indices[2]]};
+                    this->setup_triangle(triangle, object, width, height, chunk);
+                }
+            }
+        });
+
+        this->triangle_count = 0;
+        for (Chunk const &chunk : this->chunks)
+        {
+            this->triangle_count += uint32_t(chunk.triangles.size());
+        }
+
+        // Rasterize and shade; threads take bins from a shared counter so that busy bins do not stall a whole band
+        std::atomic<uint32_t> next_bin(0);
+        pool.parallel_rows(pool.get_thread_count(), [&](uint32_t, uint32_t) {
+            for (uint32_t bin = next_bin++; bin < bin_count; bin = next_bin++)
+            {
+                this->rasterize_bin(bin, camera, objects, color, depth, velocity);
+            }
+        });
+    }
+
+    void SoftwareRasterizer::setup_triangle(ShadedVertex const *const triangle[3], uint32_t object, uint32_t width, uint32_t height, Chunk &chunk)
+    {
+        // Trivially reject triangles entirely outside one of the x/y clip planes, and find the planes they cross
+        uint32_t crossed_planes = 0;
+        for (uint32_t axis = 0; axis < 2; ++axis)
+        {
+            bool outside_min = true;
+            bool outside_max = true;
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                float c = triangle[i]->attributes[ATTRIBUTE_P_NEW + axis];
+                float w = triangle[i]->attributes[ATTRIBUTE_P_NEW + 3];
+                outside_min = outside_min && (c < -w);
+                outside_max = outside_max && (c > w);
+            }
+            if (outside_min || outside_max)
+            {
+                return;
+            }
+        }
+        for (uint32_t plane = 0; plane < CLIP_PLANE_COUNT; ++plane)
+        {
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                if (clip_distance(&triangle[i]->attributes[ATTRIBUTE_P_NEW], plane) < 0.0f)
+                {
+                    crossed_planes |= 1u << plane;
+                }
+            }
+        }
+
+        if (crossed_planes == 0)
+        {
+            this->bin_triangle(triangle, object, width, height, chunk);
+            return;
+        }
+
+        // Sutherland-Hodgman against the crossed planes, then a fan of the clipped polygon
+        ShadedVertex polygons[2][MAX_CLIPPED_VERTICES];
+        uint32_t vertex_count = 3;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            polygons[0][i] = *triangle[i];
+        }
+
+        uint32_t current = 0;
+        for (uint32_t plane = 0; plane < CLIP_PLANE_COUNT; ++plane)
+        {
+            if (!(crossed_planes & (1u << plane)))
+            {
+                continue;
+            }
+
+            ShadedVertex const *in = polygons[current];
+            ShadedVertex *out = polygons[current ^ 1];
+            uint32_t out_count = 0;
+            for (uint32_t i = 0; i < vertex_count; ++i)
+            {
+                ShadedVertex const &a = in[i];
+                ShadedVertex const &b = in[(i + 1) % vertex_count];
+                float da = clip_distance(&a.attributes[ATTRIBUTE_P_NEW], plane);
+                float db = clip_distance(&b.attributes[ATTRIBUTE_P_NEW], plane);
+                if (da >= 0.0f)
+                {
+                    out[out_count++] = a;
+                }
+                if ((da >= 0.0f) != (db >= 0.0f))
+                {
+                    float t = da / (da - db);
+                    ShadedVertex &v = out[out_count++];
+                    for (uint32_t k = 0; k < ATTRIBUTE_COUNT; ++k)
+                    {
+                        v.attributes[k] = a.attributes[k] + t * (b.attributes[k] - a.attributes[k]);
+                    }
+                }
+            }
+            vertex_count = out_count;
+            current ^= 1;
+        }
+
+        for (uint32_t fan = 1; fan + 1 < vertex_count; ++fan)
+        {
+            ShadedVertex const *corners[3] = {&polygons[current][0], &polygons[current][fan], &polygons[current][fan + 1]};
+            this->bin_triangle(corners, object, width, height, chunk);
+        }
+    }
+
+    void SoftwareRasterizer::bin_triangle(ShadedVertex const *const corners[3], uint32_t object, uint32_t width, uint32_t height, Chunk &chunk)
+    {
+        const float subpixel_scale = float(1 << SUBPIXEL_BITS);
+        const int64_t half_pixel = int64_t(1) << (SUBPIXEL_BITS - 1);
+
+        Triangle t;
+        int64_t X[3], Y[3];
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            float const *a = corners[i]->attributes;
+            float inv_w = 1.0f / a[ATTRIBUTE_P_NEW + 3];
+            float x = (0.5f + 0.5f * a[ATTRIBUTE_P_NEW + 0] * inv_w) * float(width);
+            float y = (0.5f - 0.5f * a[ATTRIBUTE_P_NEW + 1] * inv_w) * float(height);
+            X[i] = int64_t(floorf(x * subpixel_scale + 0.5f));
+            Y[i] = int64_t(floorf(y * subpixel_scale + 0.5f));
+            t.z[i] = a[ATTRIBUTE_P_NEW + 2] * inv_w;
+            t.inv_w[i] = inv_w;
+            for (uint32_t k = 0; k < ATTRIBUTE_COUNT; ++k)
+            {
+                t.attributes_over_w[i][k] = a[k] * inv_w;
+            }
+        }
+
+        // CullMode is NONE: orient every triangle counter-clockwise in y-down pixel space
+        int64_t double_area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+        if (double_area == 0)
+        {
+            return;
+        }
+        if (double_area < 0)
+        {
+            std::swap(X[1], X[2]);
+            std::swap(Y[1], Y[2]);
+            std::swap(t.z[1], t.z[2]);
+            std::swap(t.inv_w[1], t.inv_w[2]);
+            std::swap(t.attributes_over_w[1], t.attributes_over_w[2]);
+            double_area = -double_area;
+        }
+        t.inv_double_area = 1.0f / float(double_area);
+
+        // Pixels whose centre lies in the bounding box of the snapped vertices
+        int64_t X_min = std::min(X[0], std::min(X[1], X[2]));
+        int64_t Y_min = std::min(Y[0], std::min(Y[1], Y[2]));
+        int64_t X_max = std::max(X[0], std::max(X[1], X[2]));
+        int64_t Y_max = std::max(Y[0], std::max(Y[1], Y[2]));
+        t.x_min = int32_t(std::max(ceil_shift(X_min - half_pixel, SUBPIXEL_BITS), int64_t(0)));
+        t.y_min = int32_t(std::max(ceil_shift(Y_min - half_pixel, SUBPIXEL_BITS), int64_t(0)));
+        t.x_max = int32_t(std::min(floor_shift(X_max - half_pixel, SUBPIXEL_BITS), int64_t(width) - 1));
+        t.y_max = int32_t(std::min(floor_shift(Y_max - half_pixel, SUBPIXEL_BITS), int64_t(height) - 1));
+        if (t.x_min > t.x_max || t.y_min > t.y_max)
+        {
+            return;
+        }
+
+        // Edge i is opposite vertex i. Reversing an edge negates a, b and c exactly, and the top-left style tie rule
+        // (ties belong to edges going up, or going right along a row) gives a pixel centre on an edge shared by two
+        // triangles to exactly one of them; the other edges are biased by -1 so that coverage is e >= 0.
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            uint32_t j = (i + 1) % 3;
+            uint32_t k = (i + 2) % 3;
+            int64_t dx = X[k] - X[j];
+            int64_t dy = Y[k] - Y[j];
+            bool owns_ties = (dy < 0) || (dy == 0 && dx > 0);
+            t.edge_a[i] = -dy;
+            t.edge_b[i] = dx;
+            t.edge_c[i] = dy * X[j] - dx * Y[j] - (owns_ties ? 0 : 1);
+        }
+        t.object = object;
+
+        uint32_t index = uint32_t(chunk.triangles.size());
+        chunk.triangles.push_back(t);
+        for (uint32_t by = uint32_t(t.y_min) / BIN_SIZE; by <= uint32_t(t.y_max) / BIN_SIZE; ++by)
+        {
+            for (uint32_t bx = uint32_t(t.x_min) / BIN_SIZE; bx <= uint32_t(t.x_max) / BIN_SIZE; ++bx)
+            {
+                chunk.bins[by * this->bins_x + bx].push_back(index);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::rasterize_bin(uint32_t bin, SceneCamera const &camera, SceneObject const *objects, ColorImage &color, DepthImage &depth, VelocityImage &velocity)
+    {
+        const int64_t half_pixel = int64_t(1) << (SUBPIXEL_BITS - 1);
+        int32_t bin_x_min = int32_t((bin % this->bins_x) * BIN_SIZE);
+        int32_t bin_y_min = int32_t((bin / this->bins_x) * BIN_SIZE);
+        int32_t bin_x_max = std::min(bin_x_min + int32_t(BIN_SIZE), int32_t(color.get_width())) - 1;
+        int32_t bin_y_max = std::min(bin_y_min + int32_t(BIN_SIZE), int32_t(color.get_height())) - 1;
+
+        for (Chunk const &chunk : this->chunks)
+        {
+            for (uint32_t index : chunk.bins[bin])
+            {
+                Triangle const &t = chunk.triangles[index];
+                int32_t x_begin = std::max(t.x_min, bin_x_min);
+                int32_t x_end = std::min(t.x_max, bin_x_max);
+                int32_t y_begin = std::max(t.y_min, bin_y_min);
+                int32_t y_end = std::min(t.y_max, bin_y_max);
+                ColorImage const *diffuse = objects[t.object].diffuse;
+
+                int64_t step_x[3];
+                for (uint32_t i = 0; i < 3; ++i)
+                {
+                    step_x[i] = t.edge_a[i] << SUBPIXEL_BITS;
+                }
+
+                for (int32_t y = y_begin; y <= y_end; ++y)
+                {
+                    int64_t px = (int64_t(x_begin) << SUBPIXEL_BITS) + half_pixel;
+                    int64_t py = (int64_t(y) << SUBPIXEL_BITS) + half_pixel;
+                    int64_t e[3];
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        e[i] = t.edge_a[i] * px + t.edge_b[i] * py + t.edge_c[i];
+                    }
+
+                    Float4 *c = color.row(uint32_t(y));
+                    float *z = depth.row(uint32_t(y));
+                    Unorm8x2 *v = velocity.row(uint32_t(y));
+
+                    // Coverage of a row of a convex triangle is a single span
+                    bool entered = false;
+                    for (int32_t x = x_begin; x <= x_end; ++x, e[0] += step_x[0], e[1] += step_x[1], e[2] += step_x[2])
+                    {
+                        if ((e[0] | e[1] | e[2]) < 0)
+                        {
+                            if (entered)
+                            {
+                                break;
+                            }
+                            continue;
+                        }
+                        entered = true;
+
+                        // Depth is interpolated linearly in screen space; LESS_EQUAL test with depth clipping
+                        float b[3] = {float(e[0]) * t.inv_double_area, float(e[1]) * t.inv_double_area, float(e[2]) * t.inv_double_area};
+                        float pixel_z = b[0] * t.z[0] + b[1] * t.z[1] + b[2] * t.z[2];
+                        if (pixel_z > 1.0f || pixel_z > z[x])
+                        {
+                            continue;
+                        }
+                        z[x] = pixel_z;
+
+                        // Perspective-correct attributes
+                        float inv_w = b[0] * t.inv_w[0] + b[1] * t.inv_w[1] + b[2] * t.inv_w[2];
+                        float w = 1.0f / inv_w;
+                        float a[ATTRIBUTE_COUNT];
+                        for (uint32_t k = 0; k < ATTRIBUTE_COUNT; ++k)
+                        {
+                            a[k] = (b[0] * t.attributes_over_w[0][k] + b[1] * t.attributes_over_w[1][k] + b[2] * t.attributes_over_w[2][k]) * w;
+                        }
+
+                        // ps_scene.hlsl
+                        Float4 albedo = {1.0f, 1.0f, 1.0f, 1.0f};
+                        if (diffuse)
+                        {
+                            Float2 tc = {a[ATTRIBUTE_TC + 0], a[ATTRIBUTE_TC + 1]};
+                            albedo = sample_linear_clamp(*diffuse, tc);
+                        }
+                        float L = a[ATTRIBUTE_L];
+                        Float4 pixel_color = {albedo.x * L, albedo.y * L, albedo.z * L, 1.0f};
+                        c[x] = pixel_color;
+
+                        Float2 vQX = {
+                            (a[ATTRIBUTE_P_NEW + 0] / a[ATTRIBUTE_P_NEW + 3] - a[ATTRIBUTE_P_OLD + 0] / a[ATTRIBUTE_P_OLD + 3]) * camera.half_exposure_x_framerate,
+                            (a[ATTRIBUTE_P_NEW + 1] / a[ATTRIBUTE_P_NEW + 3] - a[ATTRIBUTE_P_OLD + 1] / a[ATTRIBUTE_P_OLD + 3]) * camera.half_exposure_x_framerate};
+                        float len_QX = length(vQX);
+                        float weight = std::max(0.5f, std::min(len_QX, camera.K));
+                        weight /= (len_QX + EPSILON1);
+                        vQX.x *= weight;
+                        vQX.y *= weight;
+                        v[x] = write_velocity(vQX);
+                    }
+                }
+            }
+        }
+    }
+}
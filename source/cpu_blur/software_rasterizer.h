@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/software_rasterizer.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "image.h"
+#include "thread_pool.h"
+
+// Headless replacement for the scene pass: a tile-binned, multi-threaded rasterizer that runs vs_scene.hlsl and
+// ps_scene.hlsl on the CPU and writes the C, Z, V buffers the reconstruction consumes, with the same velocity
+// clamping and R8G8 encoding.
+
+namespace CPUBlur
+{
+    struct Float3
+    {
+        float x;
+        float y;
+        float z;
+    };
+
+    // Row-major matrix applied to row vectors, like the row_major matrices of cbCamera and cbObject
+    struct Float4x4
+    {
+        float m[4][4];
+    };
+
+    Float4x4 identity_matrix();
+    Float4x4 multiply(Float4x4 const &a, Float4x4 const &b);
+    Float4 transform(Float4 v, Float4x4 const &m);
+
+    // Index and vertex arrays in the layout of assets/*.h, the same arrays Scene::load_model uploads
+    struct Mesh
+    {
+        uint32_t num_faces;
+        uint32_t const *indices;
+        uint32_t num_vertices;
+        float const *vertices;       // xyz
+        float const *normals;        // xyz
+        float const *texture_coords; // uv
+    };
+
+    // The cbCamera fields read by vs_scene.hlsl and ps_scene.hlsl
+    struct SceneCamera
+    {
+        Float4x4 projection_xform;
+        Float4x4 world_xform_new;
+        Float4x4 world_xform_old;
+        Float4x4 view_xform_new;
+        Float4x4 view_xform_old;
+        float half_exposure_x_framerate;
+        float K;
+    };
+
+    // One draw call: a mesh with its cbObject and diffuse texture (an albedo of 1 when null)
+    struct SceneObject
+    {
+        Mesh const *mesh;
+        Float4x4 model_xform_new;
+        Float4x4 model_xform_old;
+        Float4x4 model_xform_normal_new;
+        ColorImage const *diffuse;
+    };
+
+    class SoftwareRasterizer
+    {
+    public:
+        // Side of the screen-space bins triangles are sorted into; each bin is rasterized by one thread
+        static const uint32_t BIN_SIZE = 32;
+
+        SoftwareRasterizer();
+
+        // Draws the objects in order. color, depth and velocity must already have the size of the target. They are
+        // cleared first: C to the point-sampled background (ps_quad.hlsl), or white without one, Z to 1 and V to
+        // VELOCITY_GRAY.
+        void render(SceneCamera const &camera, SceneObject const *objects, uint32_t object_count, ColorImage const *background,
+                    ColorImage &color, DepthImage &depth, VelocityImage &velocity, ThreadPool &pool);
+
+        uint32_t get_triangle_count() const { return this->triangle_count; }
+
+    private:
+        // Sub-pixel precision of the snapped vertex positions, as in D3D11
+        static const uint32_t SUBPIXEL_BITS = 8;
+
+        // Interpolated vs_scene.hlsl outputs: PNew (which is also SV_Position), POld, TC and L
+        static const uint32_t ATTRIBUTE_COUNT = 11;
+
+        struct ShadedVertex
+        {
+            float attributes[ATTRIBUTE_COUNT];
+        };
+
+        // Vertices snapped to SUBPIXEL_BITS of sub-pixel precision, with edge functions e = a x + b y + c that are exact in
+        // that fixed point and are positive inside the triangle
+        struct Triangle
+        {
+            int64_t edge_a[3];
+            int64_t edge_b[3];
+            int64_t edge_c[3];
+            float inv_double_area;
+            float z[3];
+            float inv_w[3];
+            float attributes_over_w[3][ATTRIBUTE_COUNT];
+            int32_t x_min, y_min, x_max, y_max;
+            uint32_t object;
+        };
+
+        // Triangles set up by one thread, and the indices of those that touch each bin, in submission order
+        struct Chunk
+        {
+            std::vector<Triangle> triangles;
+            std::vector<std::vector<uint32_t>> bins;
+        };
+
+        void setup_triangle(ShadedVertex const *const triangle[3], uint32_t object, uint32_t width, uint32_t height, Chunk &chunk);
+        void bin_triangle(ShadedVertex const *const corners[3], uint32_t object, uint32_t width, uint32_t height, Chunk &chunk);
+        void rasterize_bin(uint32_t bin, SceneCamera const &camera, SceneObject const *objects, ColorImage &color, DepthImage &depth, VelocityImage &velocity);
+
+        std::vector<ShadedVertex> vertices;
+        std::vector<Chunk> chunks;
+        uint32_t bins_x;
+        uint32_t bins_y;
+        uint32_t triangle_count;
+    };
+}
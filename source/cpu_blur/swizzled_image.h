@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/swizzled_image.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "image.h"
+#include "thread_pool.h"
+
+// Image with a texel order that keeps 2D neighborhoods together in memory. In a row-major Image a step along y is a
+// full row away, so the taps of a vertical blur each touch a different cache line; in these layouts a cache line
+// holds a small square of texels instead. The interface matches Image where the reconstruction kernels use it (at,
+// sample_point_clamp, sample_point_wrap, sample_linear_clamp), without row access.
+
+namespace CPUBlur
+{
+    // 8x8 texel blocks, row-major inside a block and from block to block. The image is padded to a multiple of 8.
+    struct BlockLinearLayout
+    {
+        static const uint32_t ALIGNMENT = 8;
+
+        static size_t offset(uint32_t x, uint32_t y, uint32_t padded_width)
+        {
+            size_t block = size_t(y >> 3) * (padded_width >> 3) + (x >> 3);
+            return (block << 6) | ((y & 7) << 3) | (x & 7);
+        }
+    };
+
+    // Z-order inside 64x64 texel tiles, row-major from tile to tile. A Z-order curve over the whole frame would pad
+    // it to a power-of-two square, twice the memory at 1080p and 4K; the tiles bound the padding to 64 texels.
+    struct MortonLayout
+    {
+        static const uint32_t ALIGNMENT = 64;
+
+        static size_t offset(uint32_t x, uint32_t y, uint32_t padded_width)
+        {
+            size_t tile = size_t(y >> 6) * (padded_width >> 6) + (x >> 6);
+            return (tile << 12) | morton_encode(x & 63, y & 63);
+        }
+    };
+
+    template <typename T, typename Layout>
+    class SwizzledImage
+    {
+    public:
+        SwizzledImage()
+        {
+            this->width = 0;
+            this->height = 0;
+            this->padded_width = 0;
+        }
+
+        SwizzledImage(uint32_t w, uint32_t h)
+        {
+            this->resize(w, h);
+        }
+
+        void resize(uint32_t w, uint32_t h)
+        {
+            this->width = w;
+            this->height = h;
+            this->padded_width = (w + Layout::ALIGNMENT - 1) / Layout::ALIGNMENT * Layout::ALIGNMENT;
+            uint32_t padded_height = (h + Layout::ALIGNMENT - 1) / Layout::ALIGNMENT * Layout::ALIGNMENT;
+            this->texels.assign(size_t(this->padded_width) * size_t(padded_height), T());
+        }
+
+        uint32_t get_width() const { return this->width; }
+        uint32_t get_height() const { return this->height; }
+        bool empty() const { return this->texels.empty(); }
+
+        T &at(uint32_t x, uint32_t y) { return this->texels[Layout::offset(x, y, this->padded_width)]; }
+        T const &at(uint32_t x, uint32_t y) const { return this->texels[Layout::offset(x, y, this->padded_width)]; }
+
+        static uint32_t point_clamp_index(float uv, uint32_t size) { return Image<T>::point_clamp_index(uv, size); }
+        static uint32_t point_wrap_index(float uv, uint32_t size) { return Image<T>::point_wrap_index(uv, size); }
+
+        T const &sample_point_clamp(Float2 uv) const
+        {
+            return this->at(point_clamp_index(uv.x, this->width), point_clamp_index(uv.y, this->height));
+        }
+
+        T const &sample_point_wrap(Float2 uv) const
+        {
+            return this->at(point_wrap_index(uv.x, this->width), point_wrap_index(uv.y, this->height));
+        }
+
+    private:
+        uint32_t width;
+        uint32_t height;
+        uint32_t padded_width;
+        std::vector<T> texels;
+    };
+
+    // Conversions from and to the row-major layout; the destination is resized
+    template <typename T, typename Layout>
+    void swizzle(Image<T> const &src, SwizzledImage<T, Layout> &dst, ThreadPool &pool)
+    {
+        dst.resize(src.get_width(), src.get_height());
+        uint32_t width = src.get_width();
+        pool.parallel_rows(src.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                T const *row = src.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    dst.at(x, y) = row[x];
+                }
+            }
+        });
+    }
+
+    template <typename T, typename Layout>
+    void unswizzle(SwizzledImage<T, Layout> const &src, Image<T> &dst, ThreadPool &pool)
+    {
+        dst.resize(src.get_width(), src.get_height());
+        uint32_t width = src.get_width();
+        pool.parallel_rows(src.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                T *row = dst.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    row[x] = src.at(x, y);
+                }
+            }
+        });
+    }
+
+    // C, Z and V of a frame in one layout, for the kernels of reconstruction.h
+    template <typename Layout>
+    struct SwizzledFrame
+    {
+        SwizzledImage<Float4, Layout> color;
+        SwizzledImage<float, Layout> depth;
+        SwizzledImage<Unorm8x2, Layout> velocity;
+    };
+
+    // Inputs with C, Z and V in a swizzled layout; the tile buffers and the jitter texture stay row-major. There is no
+    // swizzled velocity_depth: the packed layout is a row-major option of the SIMD gather.
+    template <typename Layout>
+    struct SwizzledInputs
+    {
+        SwizzledImage<Float4, Layout> const *color;
+        SwizzledImage<float, Layout> const *depth;
+        SwizzledImage<Unorm8x2, Layout> const *velocity;
+        VelocityImage const *neighbor_max;
+        RandomImage const *random;
+    };
+}
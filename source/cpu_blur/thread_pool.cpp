@@ -0,0 +1,270 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/thread_pool.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include "thread_pool.h"
+
+namespace
+{
+    double elapsed_ms(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+namespace CPUBlur
+{
+    ThreadPool::ThreadPool(uint32_t thread_count)
+    {
+        if (thread_count == 0)
+        {
+            thread_count = std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        this->thread_count = thread_count;
+        this->job_generation = 0;
+        this->job_pending = 0;
+        this->shutting_down = false;
+        this->job_fn = nullptr;
+        this->job_row_count = 0;
+        this->task_fn = nullptr;
+        this->task_queues.reset(new TaskQueue[thread_count]);
+
+        for (uint32_t band_index = 1; band_index < thread_count; ++band_index)
+        {
+            this->workers.push_back(std::thread(&ThreadPool::worker_main, this, band_index));
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->shutting_down = true;
+        }
+        this->job_ready.notify_all();
+
+        for (auto worker = this->workers.begin(); worker != this->workers.end(); ++worker)
+        {
+            worker->join();
+        }
+    }
+
+    void ThreadPool::parallel_rows(uint32_t row_count, RowFunction const &fn)
+    {
+        // A single row runs on the calling thread; with fewer rows than threads the remaining bands are empty
+        if (this->workers.empty() || row_count < 2)
+        {
+            fn(0, row_count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->job_fn = &fn;
+            this->job_row_count = row_count;
+            this->job_pending = this->thread_count - 1;
+            ++this->job_generation;
+        }
+        this->job_ready.notify_all();
+
+        this->run_band(0);
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->job_done.wait(lock, [this]() { return this->job_pending == 0; });
+        this->job_fn = nullptr;
+    }
+
+    void ThreadPool::parallel_tasks(std::vector<uint32_t> const &tasks, TaskFunction const &fn, TaskStats *stats)
+    {
+        this->task_start = std::chrono::steady_clock::now();
+
+        uint32_t task_count = uint32_t(tasks.size());
+        for (uint32_t thread_index = 0; thread_index < this->thread_count; ++thread_index)
+        {
+            TaskQueue &queue = this->task_queues[thread_index];
+            queue.tasks.clear();
+            for (uint32_t task = thread_index; task < task_count; task += this->thread_count)
+            {
+                queue.tasks.push_back(tasks[task]);
+            }
+            queue.head = 0;
+            queue.tail = uint32_t(queue.tasks.size());
+            queue.stolen_task_count = 0;
+            queue.busy_ms = 0.0;
+            queue.finish_ms = 0.0;
+        }
+
+        if (this->workers.empty() || task_count < 2)
+        {
+            // With one task it sits in the first queue; with one thread there is only the first queue
+            this->task_fn = &fn;
+            this->run_tasks(0);
+            this->task_fn = nullptr;
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->task_fn = &fn;
+                this->job_pending = this->thread_count - 1;
+                ++this->job_generation;
+            }
+            this->job_ready.notify_all();
+
+            this->run_tasks(0);
+
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->job_done.wait(lock, [this]() { return this->job_pending == 0; });
+            this->task_fn = nullptr;
+        }
+
+        if (stats)
+        {
+            stats->task_count = task_count;
+            stats->stolen_task_count = 0;
+            stats->wall_ms = elapsed_ms(this->task_start);
+            stats->makespan_ms = 0.0;
+            stats->thread_busy_ms.resize(this->thread_count);
+            stats->thread_finish_ms.resize(this->thread_count);
+            for (uint32_t thread_index = 0; thread_index < this->thread_count; ++thread_index)
+            {
+                TaskQueue const &queue = this->task_queues[thread_index];
+                stats->stolen_task_count += queue.stolen_task_count;
+                stats->makespan_ms = std::max(stats->makespan_ms, queue.finish_ms);
+                stats->thread_busy_ms[thread_index] = queue.busy_ms;
+                stats->thread_finish_ms[thread_index] = queue.finish_ms;
+            }
+        }
+    }
+
+    void ThreadPool::run_tasks(uint32_t thread_index)
+    {
+        TaskQueue &own = this->task_queues[thread_index];
+
+        for (;;)
+        {
+            uint32_t task;
+            bool stolen = false;
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.head < own.tail)
+                {
+                    task = own.tasks[own.head++];
+                }
+                else
+                {
+                    stolen = true;
+                }
+            }
+            if (stolen && !this->steal_task(thread_index, task))
+            {
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            (*this->task_fn)(task);
+            auto finish = std::chrono::steady_clock::now();
+
+            own.busy_ms += std::chrono::duration<double, std::milli>(finish - start).count();
+            own.finish_ms = std::chrono::duration<double, std::milli>(finish - this->task_start).count();
+            own.stolen_task_count += stolen ? 1 : 0;
+        }
+    }
+
+    bool ThreadPool::steal_task(uint32_t thread_index, uint32_t &task)
+    {
+        // Tasks are never added during a call, so one pass that finds every queue empty means the call is done
+        for (uint32_t offset = 1; offset < this->thread_count; ++offset)
+        {
+            TaskQueue &victim = this->task_queues[(thread_index + offset) % this->thread_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.head < victim.tail)
+            {
+                task = victim.tasks[--victim.tail];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::run_band(uint32_t band_index)
+    {
+        uint64_t row_count = this->job_row_count;
+        uint32_t row_begin = uint32_t((row_count * band_index) / this->thread_count);
+        uint32_t row_end = uint32_t((row_count * (band_index + 1)) / this->thread_count);
+
+        if (row_begin < row_end)
+        {
+            (*this->job_fn)(row_begin, row_end);
+        }
+    }
+
+    void ThreadPool::worker_main(uint32_t band_index)
+    {
+        uint64_t seen_generation = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->job_ready.wait(lock, [this, seen_generation]() { return this->shutting_down || this->job_generation != seen_generation; });
+                if (this->shutting_down)
+                {
+                    return;
+                }
+                seen_generation = this->job_generation;
+            }
+
+            if (this->task_fn)
+            {
+                this->run_tasks(band_index);
+            }
+            else
+            {
+                this->run_band(band_index);
+            }
+
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                last = (--this->job_pending == 0);
+            }
+            if (last)
+            {
+                this->job_done.notify_one();
+            }
+        }
+    }
+}
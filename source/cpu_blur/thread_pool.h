@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/thread_pool.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <chrono>
+
+namespace CPUBlur
+{
+    // Timing of one parallel_tasks call
+    struct TaskStats
+    {
+        uint32_t task_count;
+        uint32_t stolen_task_count;
+        double wall_ms;
+        double makespan_ms;                   // From the start of the call until the last thread finished its last task
+        std::vector<double> thread_busy_ms;   // Time each thread spent inside tasks
+        std::vector<double> thread_finish_ms; // When each thread finished its last task, from the start of the call
+
+        TaskStats()
+        {
+            this->task_count = 0;
+            this->stolen_task_count = 0;
+            this->wall_ms = 0.0;
+            this->makespan_ms = 0.0;
+        }
+
+        // Share of the thread time until the makespan spent inside tasks
+        double get_utilization() const
+        {
+            double busy_ms = 0.0;
+            for (auto ms = this->thread_busy_ms.begin(); ms != this->thread_busy_ms.end(); ++ms)
+            {
+                busy_ms += *ms;
+            }
+            return (this->makespan_ms > 0.0) ? busy_ms / (this->makespan_ms * double(this->thread_busy_ms.size())) : 0.0;
+        }
+    };
+
+    // Fixed set of worker threads that split a frame into contiguous row bands, one band per thread, or share a list of
+    // tasks. The calling thread works on the first band or queue, so a pool of N threads spawns N - 1 workers.
+    class ThreadPool
+    {
+    public:
+        typedef std::function<void(uint32_t row_begin, uint32_t row_end)> RowFunction;
+        typedef std::function<void(uint32_t task)> TaskFunction;
+
+        // thread_count == 0 uses every hardware thread
+        explicit ThreadPool(uint32_t thread_count = 0);
+        ~ThreadPool();
+
+        uint32_t get_thread_count() const { return this->thread_count; }
+
+        // Runs fn on every non-empty band of [0, row_count) and returns once all of them are done. Bands are as even as
+        // possible, so that tile passes over fewer rows than threads still use one thread per row.
+        void parallel_rows(uint32_t row_count, RowFunction const &fn);
+
+        // Runs fn on every entry of tasks with work stealing, and returns once all of them are done. Tasks should come
+        // in decreasing order of cost: they are dealt round-robin, each thread runs its own share from the most
+        // expensive down, and a thread that runs out steals the cheapest remaining task of another thread.
+        void parallel_tasks(std::vector<uint32_t> const &tasks, TaskFunction const &fn, TaskStats *stats = nullptr);
+
+    private:
+        ThreadPool(ThreadPool const &);
+        ThreadPool &operator=(ThreadPool const &);
+
+        // Tasks dealt to one thread; the owner pops from head, thieves from tail
+        struct TaskQueue
+        {
+            std::mutex mutex;
+            std::vector<uint32_t> tasks;
+            uint32_t head;
+            uint32_t tail;
+            uint32_t stolen_task_count;
+            double busy_ms;
+            double finish_ms;
+        };
+
+        void worker_main(uint32_t band_index);
+        void run_band(uint32_t band_index);
+        void run_tasks(uint32_t thread_index);
+        bool steal_task(uint32_t thread_index, uint32_t &task);
+
+        uint32_t thread_count;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable job_done;
+        uint64_t job_generation;
+        uint32_t job_pending;
+        bool shutting_down;
+
+        RowFunction const *job_fn;
+        uint32_t job_row_count;
+
+        TaskFunction const *task_fn;
+        std::chrono::steady_clock::time_point task_start;
+        std::unique_ptr<TaskQueue[]> task_queues;
+    };
+}
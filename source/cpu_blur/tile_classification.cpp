@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/tile_classification.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "tile_classification.h"
+#include "reconstruction.h"
+
+namespace CPUBlur
+{
+    TileClass classify_tile(VelocityImage const &tile_max, VelocityImage const &neighbor_max, Parameters const &params, uint32_t tx, uint32_t ty)
+    {
+        Unorm8x2 texel = neighbor_max.at(tx, ty);
+
+        // Same test as the gather's early-out, which only depends on the tile
+        Float2 NX = read_velocity(texel);
+        float temp_NX = clamp(length(NX) * params.half_exposure, 0.1f, float(params.K));
+        if (temp_NX < HALF_VELOCITY_CUTOFF)
+        {
+            return TILE_CLASS_NO_BLUR;
+        }
+
+        uint32_t w = tile_max.get_width();
+        uint32_t h = tile_max.get_height();
+        for (int t = -1; t <= 1; ++t)
+        {
+            uint32_t y = uint32_t(std::min(std::max(int(ty) + t, 0), int(h) - 1));
+            for (int s = -1; s <= 1; ++s)
+            {
+                uint32_t x = uint32_t(std::min(std::max(int(tx) + s, 0), int(w) - 1));
+                Unorm8x2 neighbor = tile_max.at(x, y);
+                if (neighbor.x != texel.x || neighbor.y != texel.y)
+                {
+                    return TILE_CLASS_COMPLEX;
+                }
+            }
+        }
+        return TILE_CLASS_UNIFORM;
+    }
+
+    void classify_tiles(VelocityImage const &tile_max, VelocityImage const &neighbor_max, Parameters const &params, TileLists &out)
+    {
+        out.clear();
+        for (uint32_t ty = 0; ty < neighbor_max.get_height(); ++ty)
+        {
+            for (uint32_t tx = 0; tx < neighbor_max.get_width(); ++tx)
+            {
+                out.tiles[classify_tile(tile_max, neighbor_max, params, tx, ty)].push_back(pack_tile(tx, ty));
+            }
+        }
+    }
+
+    void compute_tile_pixel_ranges(uint32_t pixel_count, uint32_t tile_count, std::vector<uint32_t> &first_pixel)
+    {
+        first_pixel.assign(tile_count + 1, pixel_count);
+
+        for (uint32_t p = pixel_count; p-- > 0;)
+        {
+            uint32_t tile = VelocityImage::point_clamp_index((float(p) + 0.5f) / float(pixel_count), tile_count);
+            first_pixel[tile] = p;
+        }
+
+        // Tiles that no pixel maps to (only possible when K does not divide the frame) become empty ranges
+        for (uint32_t tile = tile_count; tile-- > 0;)
+        {
+            first_pixel[tile] = std::min(first_pixel[tile], first_pixel[tile + 1]);
+        }
+    }
+
+    void gather_classified(Inputs const &inputs, Parameters const &params, TileLists const &lists, ColorImage &out, ThreadPool &pool, GatherSpanFunction gather_span)
+    {
+        uint32_t tile_width = inputs.neighbor_max->get_width();
+        uint32_t tile_height = inputs.neighbor_max->get_height();
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(out.get_width(), tile_width, first_x);
+        compute_tile_pixel_ranges(out.get_height(), tile_height, first_y);
+
+        // Static tiles: a straight copy of C
+        std::vector<uint32_t> const &no_blur = lists.tiles[TILE_CLASS_NO_BLUR];
+        pool.parallel_rows(uint32_t(no_blur.size()), [&](uint32_t begin, uint32_t end) {
+            for (uint32_t index = begin; index < end; ++index)
+            {
+                uint32_t tx = unpack_tile_x(no_blur[index]);
+                uint32_t ty = unpack_tile_y(no_blur[index]);
+                for (uint32_t y = first_y[ty]; y < first_y[ty + 1]; ++y)
+                {
+                    Float4 const *src = inputs.color->row(y);
+                    Float4 *dst = out.row(y);
+                    std::copy(src + first_x[tx], src + first_x[tx + 1], dst + first_x[tx]);
+                }
+            }
+        });
+
+        for (uint32_t tile_class = TILE_CLASS_UNIFORM; tile_class < TILE_CLASS_COUNT; ++tile_class)
+        {
+            std::vector<uint32_t> const &tiles = lists.tiles[tile_class];
+            pool.parallel_rows(uint32_t(tiles.size()), [&](uint32_t begin, uint32_t end) {
+                for (uint32_t index = begin; index < end; ++index)
+                {
+                    uint32_t tx = unpack_tile_x(tiles[index]);
+                    uint32_t ty = unpack_tile_y(tiles[index]);
+                    for (uint32_t y = first_y[ty]; y < first_y[ty + 1]; ++y)
+                    {
+                        gather_span(inputs, params, y, first_x[tx], first_x[tx + 1], out.row(y));
+                    }
+                }
+            });
+        }
+    }
+}
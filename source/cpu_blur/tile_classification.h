@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/tile_classification.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// CPU counterpart of ps_tileclassify.hlsl: sorts the tiles into "no blur", "uniform velocity" and "complex" lists after
+// NeighborMax. Tiles without blur are a straight copy of C; only the two other lists run the S-tap gather loop.
+
+namespace CPUBlur
+{
+    enum TileClass
+    {
+        TILE_CLASS_NO_BLUR = 0, // NeighborMax is below HALF_VELOCITY_CUTOFF, so every pixel takes the early-out
+        TILE_CLASS_UNIFORM,     // Every TileMax in the 3x3 neighborhood equals the tile's NeighborMax
+        TILE_CLASS_COMPLEX,
+        TILE_CLASS_COUNT
+    };
+
+    struct TileLists
+    {
+        // Tiles as (ty << 16) | tx, as in the GPU append buffers
+        std::vector<uint32_t> tiles[TILE_CLASS_COUNT];
+
+        void clear()
+        {
+            for (uint32_t tile_class = 0; tile_class < TILE_CLASS_COUNT; ++tile_class)
+            {
+                this->tiles[tile_class].clear();
+            }
+        }
+    };
+
+    inline uint32_t pack_tile(uint32_t tx, uint32_t ty) { return (ty << 16) | tx; }
+    inline uint32_t unpack_tile_x(uint32_t tile) { return tile & 0xFFFF; }
+    inline uint32_t unpack_tile_y(uint32_t tile) { return tile >> 16; }
+
+    TileClass classify_tile(VelocityImage const &tile_max, VelocityImage const &neighbor_max, Parameters const &params, uint32_t tx, uint32_t ty);
+    void classify_tiles(VelocityImage const &tile_max, VelocityImage const &neighbor_max, Parameters const &params, TileLists &out);
+
+    // First pixel of every tile along one axis, plus the size of the frame as the final entry. A pixel belongs to
+    // the tile that its point-sampled NeighborMax lookup hits, so the ranges are not always exactly K wide.
+    void compute_tile_pixel_ranges(uint32_t pixel_count, uint32_t tile_count, std::vector<uint32_t> &first_pixel);
+
+    // Same result as gather(), driven by the tile lists; gather_span runs the uniform and complex tiles
+    void gather_classified(Inputs const &inputs, Parameters const &params, TileLists const &lists, ColorImage &out, ThreadPool &pool, GatherSpanFunction gather_span = gather_span_scalar);
+}
@@ -0,0 +1,473 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/uniform_velocity.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "uniform_velocity.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "gather_taps.h"
+#include "tile_classification.h"
+
+namespace CPUBlur
+{
+    namespace
+    {
+        // Most runs a tap set splits into: the taps of one parity are contiguous except around SelfIndex
+        const uint32_t MAX_TAP_RUNS = 2;
+
+        // The taps of one parity (odd loop indices along CorrectedVX, even ones along NX) as intervals of T, in units
+        // of max_sample_tap_distance. Each tap stands for the stretch of line half-way to its neighbors.
+        struct TapSet
+        {
+            float weight; // Sum of alpha over the taps
+            uint32_t run_count;
+            float run_begin[MAX_TAP_RUNS];
+            float run_end[MAX_TAP_RUNS];
+        };
+
+        // One run of a tap set laid over the pixels of a line, relative to the pixel: whole pixels in (first, last)
+        // plus the covered fractions of pixels first and last
+        struct PixelRun
+        {
+            int32_t first;
+            int32_t last;
+            float first_weight;
+            float last_weight;
+        };
+
+        // Per-tile setup of the fast path
+        struct UniformTile
+        {
+            bool x_major;                    // Whether the motion is closer to the x axis than to the y axis
+            float slope;                     // Minor-axis step per major-axis step
+            float shift;                     // Major-axis offset of the taps (half_texel), in pixels
+            float minor_shift;               // Minor-axis offset of the taps (half_texel), in pixels
+            float reach[2];                  // Major-axis length of max_sample_tap_distance along NX (0) and CorrectedVX (1), in pixels
+            TapSet taps[2];                  // Even and odd loop indices
+            PixelRun runs[2][MAX_TAP_RUNS];  // The runs of taps in pixels
+            float scale[2];                  // Weight of a tap set over the length of its runs
+        };
+
+        // Color running sums along lines parallel to the motion, one per pixel of the minor axis. Line j holds the
+        // colors at (a, j + a * slope + minor_shift) in major/minor coordinates, filtered linearly across the minor axis,
+        // for a in [a_first, a_first + length). A pixel lies between two lines and blends their results.
+        struct LineSums
+        {
+            int32_t a_first;
+            uint32_t length;
+            int32_t j_first;
+            std::vector<int32_t> minor_floor;   // Per a: integer part of a * slope + minor_shift
+            std::vector<float> minor_fraction;  // Per a: fractional part
+            std::vector<Float4> prefix;         // length + 1 entries per line, first one zero
+            std::vector<Float4> filtered;       // Weighted sum of both tap sets per line, for the a of the tile only
+        };
+
+        void make_tap_set(uint32_t S, uint32_t parity, float temp, float max_sample_tap_distance_uv, TapSet &set)
+        {
+            int32_t self_index = int32_t(S - 1) / 2;
+            float spacing = 4.0f / float(S + 1);
+
+            set.weight = 0.0f;
+            set.run_count = 0;
+            bool in_run = false;
+            for (int32_t i = int32_t(parity); i < int32_t(S); i += 2)
+            {
+                if (i == self_index)
+                {
+                    in_run = false;
+                    continue;
+                }
+
+                // alpha of the gather with ZX == ZY and VX == VY, at R = 0; T is in texture coordinates there
+                float offset = 2.0f * float(i + 1) / float(S + 1) - 1.0f;
+                float T = offset * max_sample_tap_distance_uv;
+                set.weight += 2.0f * cone(T, temp) + 2.0f * cylinder(T, temp) * cylinder(T, temp);
+
+                if (!in_run)
+                {
+                    set.run_begin[set.run_count] = offset - 0.5f * spacing;
+                    ++set.run_count;
+                    in_run = true;
+                }
+                set.run_end[set.run_count - 1] = offset + 0.5f * spacing;
+            }
+        }
+
+        void make_uniform_tile(Unorm8x2 neighbor_max, Parameters const &params, uint32_t width, uint32_t height, UniformTile &tile)
+        {
+            Float2 NX = read_velocity(neighbor_max);
+            float temp_NX = clamp(length(NX) * params.half_exposure, 0.1f, float(params.K));
+            Float2 direction = normalize(NX);
+
+            // Pixel offset of a tap at T = max_sample_tap_distance along the normalized velocity
+            float aspect = float(height) / float(width);
+            float dx = fabsf(direction.x * params.max_sample_tap_distance);
+            float dy = fabsf(direction.y * params.max_sample_tap_distance * aspect);
+
+            tile.x_major = (dx >= dy);
+            float major = tile.x_major ? dx : dy;
+            tile.slope = tile.x_major ? (direction.y * aspect) / direction.x : direction.x / (direction.y * aspect);
+            tile.shift = tile.x_major ? 0.5f : 0.5f * aspect;
+            tile.minor_shift = tile.x_major ? 0.5f * aspect : 0.5f;
+            tile.reach[0] = major * temp_NX;
+            tile.reach[1] = major;
+
+            float max_sample_tap_distance_uv = params.max_sample_tap_distance / float(width);
+            make_tap_set(params.S, 0, temp_NX, max_sample_tap_distance_uv, tile.taps[0]);
+            make_tap_set(params.S, 1, temp_NX, max_sample_tap_distance_uv, tile.taps[1]);
+
+            // Every pixel of the tile sees its runs at the same offsets, each pixel covering [k - 0.5, k + 0.5)
+            for (uint32_t set = 0; set < 2; ++set)
+            {
+                TapSet const &taps = tile.taps[set];
+                float set_length = 0.0f;
+                for (uint32_t run = 0; run < taps.run_count; ++run)
+                {
+                    float lo = tile.shift + taps.run_begin[run] * tile.reach[set];
+                    float hi = tile.shift + taps.run_end[run] * tile.reach[set];
+                    PixelRun &pixels = tile.runs[set][run];
+                    pixels.first = int32_t(floorf(lo + 0.5f));
+                    pixels.last = int32_t(floorf(hi + 0.5f));
+                    if (pixels.first == pixels.last)
+                    {
+                        // The whole pixels term is then minus the pixel, which last_weight puts back
+                        pixels.first_weight = hi - lo;
+                        pixels.last_weight = 1.0f;
+                    }
+                    else
+                    {
+                        pixels.first_weight = float(pixels.first) + 0.5f - lo;
+                        pixels.last_weight = hi - float(pixels.last) + 0.5f;
+                    }
+                    set_length += hi - lo;
+                }
+                tile.scale[set] = (set_length > 0.0f) ? taps.weight / set_length : 0.0f;
+            }
+        }
+
+        // Farthest a tap of the tile lands from its pixel along the major axis, rounded up to whole pixels
+        uint32_t get_uniform_tile_margin(UniformTile const &tile)
+        {
+            return uint32_t(ceilf(std::max(tile.reach[0], tile.reach[1]) + tile.shift)) + 1;
+        }
+
+        // Weighted sum of the two tap sets of the pixel at k along the line
+        void integrate_line(UniformTile const &tile, Float4 const *prefix, int32_t k, Float4 &sum)
+        {
+            for (uint32_t set = 0; set < 2; ++set)
+            {
+                float scale = tile.scale[set];
+                for (uint32_t run = 0; run < tile.taps[set].run_count; ++run)
+                {
+                    PixelRun const &pixels = tile.runs[set][run];
+                    Float4 const *first = prefix + (k + pixels.first);
+                    Float4 const *last = prefix + (k + pixels.last);
+                    float w_first = pixels.first_weight * scale;
+                    float w_last = pixels.last_weight * scale;
+                    sum.x += w_first * (first[1].x - first[0].x) + scale * (last[0].x - first[1].x) + w_last * (last[1].x - last[0].x);
+                    sum.y += w_first * (first[1].y - first[0].y) + scale * (last[0].y - first[1].y) + w_last * (last[1].y - last[0].y);
+                    sum.z += w_first * (first[1].z - first[0].z) + scale * (last[0].z - first[1].z) + w_last * (last[1].z - last[0].z);
+                }
+            }
+        }
+
+        void build_line_sums(ColorImage const &color, UniformTile const &tile, uint32_t a_begin, uint32_t a_end, uint32_t b_begin, uint32_t b_end, LineSums &sums)
+        {
+            int32_t margin = int32_t(get_uniform_tile_margin(tile));
+            int32_t a_size = int32_t(tile.x_major ? color.get_width() : color.get_height());
+            int32_t b_size = int32_t(tile.x_major ? color.get_height() : color.get_width());
+
+            sums.a_first = int32_t(a_begin) - margin;
+            sums.length = (a_end - a_begin) + 2 * uint32_t(margin);
+            sums.minor_floor.resize(sums.length);
+            sums.minor_fraction.resize(sums.length);
+            for (uint32_t k = 0; k < sums.length; ++k)
+            {
+                float minor = float(sums.a_first + int32_t(k)) * tile.slope + tile.minor_shift;
+                float minor_floor = floorf(minor);
+                sums.minor_floor[k] = int32_t(minor_floor);
+                sums.minor_fraction[k] = minor - minor_floor;
+            }
+
+            // Lines on either side of the pixels of the tile; b - a * slope is monotonic in a, so the ends bound it
+            float slope_begin = float(a_begin) * tile.slope;
+            float slope_end = float(a_end - 1) * tile.slope;
+            sums.j_first = int32_t(floorf(float(b_begin) - std::max(slope_begin, slope_end)));
+            int32_t j_last = int32_t(floorf(float(b_end - 1) - std::min(slope_begin, slope_end))) + 1;
+            uint32_t line_count = uint32_t(j_last - sums.j_first + 1);
+
+            sums.prefix.resize(line_count * (sums.length + 1));
+            for (uint32_t line = 0; line < line_count; ++line)
+            {
+                int32_t j = sums.j_first + int32_t(line);
+                Float4 *prefix = &sums.prefix[line * (sums.length + 1)];
+                Float4 sum = {0.0f, 0.0f, 0.0f, 0.0f};
+                prefix[0] = sum;
+                for (uint32_t k = 0; k < sums.length; ++k)
+                {
+                    // Clamped at the edges as sampLinearClamp
+                    uint32_t a = uint32_t(std::min(std::max(sums.a_first + int32_t(k), 0), a_size - 1));
+                    int32_t b = j + sums.minor_floor[k];
+                    uint32_t b0 = uint32_t(std::min(std::max(b, 0), b_size - 1));
+                    uint32_t b1 = uint32_t(std::min(std::max(b + 1, 0), b_size - 1));
+                    Float4 const &c0 = tile.x_major ? color.at(a, b0) : color.at(b0, a);
+                    Float4 const &c1 = tile.x_major ? color.at(a, b1) : color.at(b1, a);
+                    float f = sums.minor_fraction[k];
+                    sum.x += c0.x + f * (c1.x - c0.x);
+                    sum.y += c0.y + f * (c1.y - c0.y);
+                    sum.z += c0.z + f * (c1.z - c0.z);
+                    prefix[k + 1] = sum;
+                }
+            }
+
+            uint32_t tile_length = a_end - a_begin;
+            sums.filtered.resize(line_count * tile_length);
+            for (uint32_t line = 0; line < line_count; ++line)
+            {
+                Float4 const *prefix = &sums.prefix[line * (sums.length + 1)];
+                Float4 *filtered = &sums.filtered[line * tile_length];
+                for (uint32_t i = 0; i < tile_length; ++i)
+                {
+                    Float4 sum = {0.0f, 0.0f, 0.0f, 0.0f};
+                    integrate_line(tile, prefix, int32_t(i) + margin, sum);
+                    filtered[i] = sum;
+                }
+            }
+        }
+
+        void gather_uniform_tile(Inputs const &inputs, Parameters const &params, UniformTile const &tile, uint32_t x_begin, uint32_t x_end, uint32_t y_begin, uint32_t y_end, LineSums &sums, ColorImage &out)
+        {
+            ColorImage const &color = *inputs.color;
+            uint32_t a_begin = tile.x_major ? x_begin : y_begin;
+            uint32_t a_end = tile.x_major ? x_end : y_end;
+            uint32_t b_begin = tile.x_major ? y_begin : x_begin;
+            uint32_t b_end = tile.x_major ? y_end : x_end;
+            build_line_sums(color, tile, a_begin, a_end, b_begin, b_end, sums);
+
+            float S = float(params.S);
+            float K = float(params.K);
+            float tap_weight = tile.taps[0].weight + tile.taps[1].weight;
+            uint32_t tile_length = a_end - a_begin;
+            for (uint32_t y = y_begin; y < y_end; ++y)
+            {
+                Float4 *dst = out.row(y);
+                Unorm8x2 const *velocity = inputs.velocity->row(y);
+                for (uint32_t x = x_begin; x < x_end; ++x)
+                {
+                    int32_t a = int32_t(tile.x_major ? x : y);
+                    int32_t b = int32_t(tile.x_major ? y : x);
+
+                    // The pixel's own line lies at j = b - a * slope, between lines j0 and j0 + 1
+                    float j = float(b) - float(a) * tile.slope;
+                    float j_floor = floorf(j);
+                    float f = j - j_floor;
+                    Float4 const &line0 = sums.filtered[uint32_t(int32_t(j_floor) - sums.j_first) * tile_length + uint32_t(a) - a_begin];
+                    Float4 const &line1 = (&line0)[tile_length];
+
+                    // Center tap, weighted as in the gather
+                    Float4 CX = color.at(x, y);
+                    float temp_VX = clamp(length(read_velocity(velocity[x])) * params.half_exposure, 0.1f, K);
+                    float weight = S / WEIGHT_CORRECTION_FACTOR / temp_VX;
+
+                    Float4 result = {
+                        (CX.x * weight + line0.x + f * (line1.x - line0.x)) / (weight + tap_weight),
+                        (CX.y * weight + line0.y + f * (line1.y - line0.y)) / (weight + tap_weight),
+                        (CX.z * weight + line0.z + f * (line1.z - line0.z)) / (weight + tap_weight),
+                        1.0f};
+                    dst[x] = result;
+                }
+            }
+        }
+    }
+
+    void tile_bounds(VelocityImage const &velocity, DepthImage const &depth, uint32_t tile_width, uint32_t tile_height, TileBoundsImage &out, ThreadPool &pool)
+    {
+        out.resize(tile_width, tile_height);
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(velocity.get_width(), tile_width, first_x);
+        compute_tile_pixel_ranges(velocity.get_height(), tile_height, first_y);
+
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    TileBounds bounds = {{255, 255}, {0, 0}, HUGE_VALF, -HUGE_VALF};
+                    for (uint32_t y = first_y[ty]; y < first_y[ty + 1]; ++y)
+                    {
+                        Unorm8x2 const *v = velocity.row(y);
+                        float const *z = depth.row(y);
+                        for (uint32_t x = first_x[tx]; x < first_x[tx + 1]; ++x)
+                        {
+                            bounds.velocity_min.x = std::min(bounds.velocity_min.x, v[x].x);
+                            bounds.velocity_min.y = std::min(bounds.velocity_min.y, v[x].y);
+                            bounds.velocity_max.x = std::max(bounds.velocity_max.x, v[x].x);
+                            bounds.velocity_max.y = std::max(bounds.velocity_max.y, v[x].y);
+                            bounds.depth_min = std::min(bounds.depth_min, z[x]);
+                            bounds.depth_max = std::max(bounds.depth_max, z[x]);
+                        }
+                    }
+                    out.at(tx, ty) = bounds;
+                }
+            }
+        });
+    }
+
+    bool is_uniform_velocity_tile(TileBoundsImage const &bounds, VelocityImage const &neighbor_max, Parameters const &params, uint32_t width, uint32_t height, uint32_t tx, uint32_t ty)
+    {
+        // Tiles that take the early-out are cheaper through the regular gather
+        Unorm8x2 NX = neighbor_max.at(tx, ty);
+        float temp_NX = clamp(length(read_velocity(NX)) * params.half_exposure, 0.1f, float(params.K));
+        if (temp_NX < HALF_VELOCITY_CUTOFF)
+        {
+            return false;
+        }
+
+        // Bounds over the 3x3 neighborhood, which holds every tap when the reach check below passes
+        TileBounds merged = bounds.at(tx, ty);
+        uint32_t tx_first = (tx > 0) ? tx - 1 : 0;
+        uint32_t ty_first = (ty > 0) ? ty - 1 : 0;
+        uint32_t tx_last = std::min(tx + 1, bounds.get_width() - 1);
+        uint32_t ty_last = std::min(ty + 1, bounds.get_height() - 1);
+        for (uint32_t y = ty_first; y <= ty_last; ++y)
+        {
+            for (uint32_t x = tx_first; x <= tx_last; ++x)
+            {
+                TileBounds const &b = bounds.at(x, y);
+                merged.velocity_min.x = std::min(merged.velocity_min.x, b.velocity_min.x);
+                merged.velocity_min.y = std::min(merged.velocity_min.y, b.velocity_min.y);
+                merged.velocity_max.x = std::max(merged.velocity_max.x, b.velocity_max.x);
+                merged.velocity_max.y = std::max(merged.velocity_max.y, b.velocity_max.y);
+                merged.depth_min = std::min(merged.depth_min, b.depth_min);
+                merged.depth_max = std::max(merged.depth_max, b.depth_max);
+            }
+        }
+
+        // TileMin == TileMax up to the tolerance, and NeighborMax is that same velocity
+        if (uint32_t(merged.velocity_max.x - merged.velocity_min.x) > UNIFORM_VELOCITY_TOLERANCE ||
+            uint32_t(merged.velocity_max.y - merged.velocity_min.y) > UNIFORM_VELOCITY_TOLERANCE ||
+            NX.x < merged.velocity_min.x || NX.x > merged.velocity_max.x ||
+            NX.y < merged.velocity_min.y || NX.y > merged.velocity_max.y)
+        {
+            return false;
+        }
+
+        // Both soft depth comparisons near 1, so that alpha does not depend on the tap
+        if (merged.depth_max - merged.depth_min >= UNIFORM_DEPTH_EXTENT)
+        {
+            return false;
+        }
+
+        // Every pixel must take CorrectedVX = normalize(NX); the longest velocity is at a corner of the bounds
+        Float2 low = read_velocity(merged.velocity_min);
+        Float2 high = read_velocity(merged.velocity_max);
+        Float2 longest = {std::max(fabsf(low.x), fabsf(high.x)), std::max(fabsf(low.y), fabsf(high.y))};
+        if (length(longest) * params.half_exposure >= VARIANCE_THRESHOLD)
+        {
+            return false;
+        }
+
+        UniformTile tile;
+        make_uniform_tile(NX, params, width, height, tile);
+        return get_uniform_tile_margin(tile) + 1 <= params.K;
+    }
+
+    void gather_uniform_velocity(Inputs const &inputs, Parameters const &params, TileBoundsImage &bounds, ColorImage &out, ThreadPool &pool, SimdLevel level, UniformVelocityStats *stats)
+    {
+        VelocityImage const &neighbor_max = *inputs.neighbor_max;
+        uint32_t width = out.get_width();
+        uint32_t height = out.get_height();
+        uint32_t tile_width = neighbor_max.get_width();
+        uint32_t tile_height = neighbor_max.get_height();
+        tile_bounds(*inputs.velocity, *inputs.depth, tile_width, tile_height, bounds, pool);
+
+        std::vector<uint32_t> first_x, first_y;
+        compute_tile_pixel_ranges(width, tile_width, first_x);
+        compute_tile_pixel_ranges(height, tile_height, first_y);
+
+        GatherSpanFunction gather_span = get_gather_span_function(level, params.S);
+        std::vector<uint32_t> uniform_rows(tile_height, 0);
+
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            LineSums sums;
+            std::vector<uint8_t> uniform(tile_width);
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    uniform[tx] = is_uniform_velocity_tile(bounds, neighbor_max, params, width, height, tx, ty) ? 1 : 0;
+                    if (uniform[tx])
+                    {
+                        UniformTile tile;
+                        make_uniform_tile(neighbor_max.at(tx, ty), params, width, height, tile);
+                        gather_uniform_tile(inputs, params, tile, first_x[tx], first_x[tx + 1], first_y[ty], first_y[ty + 1], sums, out);
+                        ++uniform_rows[ty];
+                    }
+                }
+
+                // The other tiles of the row go through the gather as spans as long as possible, so that the SIMD
+                // kernel does not pay for a partial vector at the end of every tile
+                for (uint32_t y = first_y[ty]; y < first_y[ty + 1]; ++y)
+                {
+                    uint32_t tx = 0;
+                    while (tx < tile_width)
+                    {
+                        if (uniform[tx])
+                        {
+                            ++tx;
+                            continue;
+                        }
+                        uint32_t run_end = tx + 1;
+                        while (run_end < tile_width && !uniform[run_end])
+                        {
+                            ++run_end;
+                        }
+                        gather_span(inputs, params, y, first_x[tx], first_x[run_end], out.row(y));
+                        tx = run_end;
+                    }
+                }
+            }
+        });
+
+        if (stats)
+        {
+            stats->tile_count = tile_width * tile_height;
+            stats->uniform_tiles = 0;
+            for (uint32_t count : uniform_rows)
+            {
+                stats->uniform_tiles += count;
+            }
+        }
+    }
+}
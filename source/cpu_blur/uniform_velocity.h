@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/uniform_velocity.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "parameters.h"
+#include "simd_gather.h"
+#include "thread_pool.h"
+
+// Fast path for tiles whose neighborhood moves as one: when V is the same everywhere around a tile and Z varies by less
+// than SOFT_Z_EXTENT, every tap of the gather gets the same weight whatever the pixel, and the S taps along NX reduce
+// to two box filters along the motion direction (one over the reach of the normalized-VX taps, one over the reach of the
+// NX taps). Those are evaluated with running sums along digital lines through the tile, so the cost per pixel does not
+// depend on S or on the blur length. Other tiles go through the regular gather.
+
+namespace CPUBlur
+{
+    // Largest difference of a V component, in 8-bit steps, across a neighborhood that still counts as uniform
+    const uint32_t UNIFORM_VELOCITY_TOLERANCE = 1;
+
+    // Largest range of Z across a uniform neighborhood. Below SOFT_Z_EXTENT the two soft depth comparisons of a tap
+    // still add up to 2 - range / SOFT_Z_EXTENT, so the range is kept to a tenth of it for the weights to stay flat.
+    const float UNIFORM_DEPTH_EXTENT = 0.1f * SOFT_Z_EXTENT;
+
+    // TileMin and TileMax of each V component, and the range of Z, over the pixels of a tile
+    struct TileBounds
+    {
+        Unorm8x2 velocity_min;
+        Unorm8x2 velocity_max;
+        float depth_min;
+        float depth_max;
+    };
+
+    typedef Image<TileBounds> TileBoundsImage;
+
+    struct UniformVelocityStats
+    {
+        uint32_t tile_count;
+        uint32_t uniform_tiles;
+    };
+
+    // Bounds of the pixels that map to each NeighborMax texel (compute_tile_pixel_ranges); resizes out
+    void tile_bounds(VelocityImage const &velocity, DepthImage const &depth, uint32_t tile_width, uint32_t tile_height, TileBoundsImage &out, ThreadPool &pool);
+
+    // Whether the 3x3 neighborhood of tile (tx, ty) is uniform enough for the fast path, and close enough that the taps
+    // of the tile's pixels stay inside it
+    bool is_uniform_velocity_tile(TileBoundsImage const &bounds, VelocityImage const &neighbor_max, Parameters const &params, uint32_t width, uint32_t height, uint32_t tx, uint32_t ty);
+
+    // gather_simd with the uniform tiles taken by the fast path. bounds is scratch space; stats, when given, receives
+    // the number of tiles that took it.
+    void gather_uniform_velocity(Inputs const &inputs, Parameters const &params, TileBoundsImage &bounds, ColorImage &out, ThreadPool &pool, SimdLevel level, UniformVelocityStats *stats = nullptr);
+}
@@ -0,0 +1,384 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/velocity_encoding.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "velocity_encoding.h"
+#include <vector>
+#include "jitter.h"
+#include "reconstruction.h"
+
+namespace
+{
+    const float TWO_PI = 6.28318531f;
+
+    float round_to_unorm8(float v)
+    {
+        return CPUBlur::unorm8_to_float(CPUBlur::float_to_unorm8(v));
+    }
+}
+
+namespace CPUBlur
+{
+    char const *get_velocity_encoding_name(VelocityEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case VELOCITY_ENCODING_BIAS_SCALE:
+            return "R8G8 bias/scale";
+        case VELOCITY_ENCODING_HALF_FLOAT:
+            return "R16G16 float";
+        case VELOCITY_ENCODING_LOG_POLAR:
+            return "R8G8 log-polar";
+        default:
+            return "unknown";
+        }
+    }
+
+    uint32_t get_velocity_encoding_bytes(VelocityEncoding encoding)
+    {
+        return (encoding == VELOCITY_ENCODING_HALF_FLOAT) ? 4 : 2;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // constants.hlsli
+
+    Float2 encode_velocity(VelocityEncoding encoding, Float2 v)
+    {
+        if (encoding == VELOCITY_ENCODING_HALF_FLOAT)
+        {
+            return v;
+        }
+        if (encoding == VELOCITY_ENCODING_LOG_POLAR)
+        {
+            Float2 texel = {0.0f, 0.0f};
+            float v_length = length(v);
+            float magnitude = (v_length > 0.0f) ? roundf((log2f(v_length) - VELOCITY_LOG2_MIN) / (VELOCITY_LOG2_MAX - VELOCITY_LOG2_MIN) * 254.0f) : -1.0f;
+            if (magnitude >= 0.0f)
+            {
+                float angle = atan2f(v.y, v.x) / TWO_PI;
+                angle -= floorf(angle);
+                texel.x = fmodf(roundf(angle * 256.0f), 256.0f) / 255.0f;
+                texel.y = (std::min(magnitude, 254.0f) + 1.0f) / 255.0f;
+            }
+            return texel;
+        }
+        return write_bias_scale(v);
+    }
+
+    Float2 store_velocity_texel(VelocityEncoding encoding, Float2 texel)
+    {
+        Float2 result;
+        if (encoding == VELOCITY_ENCODING_HALF_FLOAT)
+        {
+            result.x = round_to_half(texel.x);
+            result.y = round_to_half(texel.y);
+        }
+        else
+        {
+            result.x = round_to_unorm8(texel.x);
+            result.y = round_to_unorm8(texel.y);
+        }
+        return result;
+    }
+
+    Float2 decode_velocity(VelocityEncoding encoding, Float2 texel)
+    {
+        if (encoding == VELOCITY_ENCODING_HALF_FLOAT)
+        {
+            return texel;
+        }
+        if (encoding == VELOCITY_ENCODING_LOG_POLAR)
+        {
+            Float2 v = {0.0f, 0.0f};
+            float magnitude = roundf(texel.y * 255.0f);
+            if (magnitude > 0.0f)
+            {
+                float v_length = exp2f(VELOCITY_LOG2_MIN + (magnitude - 1.0f) * ((VELOCITY_LOG2_MAX - VELOCITY_LOG2_MIN) / 254.0f));
+                float angle = roundf(texel.x * 255.0f) * (TWO_PI / 256.0f);
+                v.x = v_length * cosf(angle);
+                v.y = v_length * sinf(angle);
+            }
+            return v;
+        }
+        return read_bias_scale(texel);
+    }
+
+    Float2 quantize_velocity(VelocityEncoding encoding, Float2 v)
+    {
+        return decode_velocity(encoding, store_velocity_texel(encoding, encode_velocity(encoding, v)));
+    }
+
+    void quantize_velocity_field(VelocityFieldImage const &velocity, VelocityEncoding encoding, VelocityFieldImage &out, ThreadPool &pool)
+    {
+        out.resize(velocity.get_width(), velocity.get_height());
+        uint32_t width = velocity.get_width();
+
+        pool.parallel_rows(velocity.get_height(), [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                Float2 const *src = velocity.row(y);
+                Float2 *dst = out.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    dst[x] = quantize_velocity(encoding, src[x]);
+                }
+            }
+        });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Reference passes, line for line tile_max_texel, neighbor_max_texel, prepare_gather_pixel and gather_pixel
+
+    namespace
+    {
+        Float2 tile_max_field_texel(VelocityFieldImage const &velocity, uint32_t K, uint32_t tile_width, uint32_t tile_height, uint32_t tx, uint32_t ty)
+        {
+            Float2 output = {0.0f, 0.0f};
+
+            uint32_t w = velocity.get_width();
+            uint32_t h = velocity.get_height();
+            float tex_coord_base_x = (float(tx) + 0.5f) / float(tile_width);
+            float tex_coord_base_y = (float(ty) + 0.5f) / float(tile_height);
+            float tex_coord_increment_x = 1.0f / float(w);
+            float tex_coord_increment_y = 1.0f / float(h);
+
+            float max_magnitude_squared = 0.0f;
+            for (uint32_t s = 0; s < K; ++s)
+            {
+                uint32_t x = VelocityFieldImage::point_clamp_index(tex_coord_base_x + float(s) * tex_coord_increment_x, w);
+                for (uint32_t t = 0; t < K; ++t)
+                {
+                    uint32_t y = VelocityFieldImage::point_clamp_index(tex_coord_base_y + float(t) * tex_coord_increment_y, h);
+                    Float2 v = velocity.at(x, y);
+
+                    float magnitude_squared = dot(v, v);
+                    if (max_magnitude_squared < magnitude_squared)
+                    {
+                        output = v;
+                        max_magnitude_squared = magnitude_squared;
+                    }
+                }
+            }
+            return output;
+        }
+
+        Float2 neighbor_max_field_texel(VelocityFieldImage const &tile_max, uint32_t tx, uint32_t ty)
+        {
+            Float2 output = {0.0f, 0.0f};
+
+            uint32_t rows[3];
+            neighbor_max_rows(tile_max.get_height(), ty, rows);
+            uint32_t w = tile_max.get_width();
+            float tex_coord_base_x = (float(tx) + 0.5f) / float(w);
+            float tex_coord_increment_x = 1.0f / float(w);
+
+            float max_magnitude_squared = 0.0f;
+            for (int s = -1; s <= 1; ++s)
+            {
+                uint32_t x = VelocityFieldImage::point_clamp_index(tex_coord_base_x + float(s) * tex_coord_increment_x, w);
+                for (int t = -1; t <= 1; ++t)
+                {
+                    Float2 v = tile_max.at(x, rows[t + 1]);
+
+                    float magnitude_squared = dot(v, v);
+                    if (max_magnitude_squared < magnitude_squared)
+                    {
+                        float displacement = fabsf(float(s)) + fabsf(float(t));
+                        float orientation_x = sign(float(s) * v.x);
+                        float orientation_y = sign(float(t) * v.y);
+                        float distance = orientation_x + orientation_y;
+
+                        if (fabsf(distance) == displacement)
+                        {
+                            output = v;
+                            max_magnitude_squared = magnitude_squared;
+                        }
+                    }
+                }
+            }
+            return output;
+        }
+
+        // Returns false for pixels that take the HALF_VELOCITY_CUTOFF early-out
+        bool gather_field_pixel(ColorImage const &color, DepthImage const &depth, VelocityFieldImage const &velocity, VelocityFieldImage const &neighbor_max,
+                                RandomImage const *random, Parameters const &params, uint32_t x, uint32_t y, Float4 &result)
+        {
+            float tex_dim_x = float(color.get_width());
+            float tex_dim_y = float(color.get_height());
+            float K = float(params.K);
+            float S = float(params.S);
+
+            Float2 X = {(float(x) + 0.5f) / tex_dim_x, (float(y) + 0.5f) / tex_dim_y};
+            Float4 CX = color.at(x, y);
+            result = CX;
+
+            Float2 NX = neighbor_max.sample_point_clamp(X);
+            float NX_length = length(NX);
+            float temp_NX = NX_length * params.half_exposure;
+            bool flag_NX = (temp_NX >= EPSILON1);
+            temp_NX = clamp(temp_NX, 0.1f, K);
+            if (temp_NX < HALF_VELOCITY_CUTOFF)
+            {
+                return false;
+            }
+            if (flag_NX)
+            {
+                float scale = temp_NX / NX_length;
+                NX.x *= scale;
+                NX.y *= scale;
+            }
+
+            Float2 VX = velocity.at(x, y);
+            float VX_length = length(VX);
+            float temp_VX = VX_length * params.half_exposure;
+            bool flag_VX = (temp_VX >= EPSILON1);
+            temp_VX = clamp(temp_VX, 0.1f, K);
+            if (flag_VX)
+            {
+                float scale = temp_VX / VX_length;
+                VX.x *= scale;
+                VX.y *= scale;
+                VX_length = length(VX);
+            }
+
+            float R;
+            if (params.jitter_source == JITTER_INTERLEAVED_GRADIENT)
+            {
+                R = interleaved_gradient_noise(x, y) - 0.5f;
+            }
+            else if (params.jitter_source == JITTER_BLUE_NOISE)
+            {
+                R = unorm8_to_float(random->at(x & (BLUE_NOISE_SIZE - 1), y & (BLUE_NOISE_SIZE - 1))) - 0.5f;
+            }
+            else
+            {
+                Float2 random_uv = {X.x * K, X.y * K};
+                R = unorm8_to_float(random->sample_point_wrap(random_uv)) - 0.5f;
+            }
+
+            float ZX = -depth.at(x, y);
+            Float2 corrected_VX = (VX_length < VARIANCE_THRESHOLD) ? normalize(NX) : normalize(VX);
+
+            float weight = S / WEIGHT_CORRECTION_FACTOR / temp_VX;
+            float sum_x = CX.x * weight;
+            float sum_y = CX.y * weight;
+            float sum_z = CX.z * weight;
+
+            int self_index = int((S - 1.0f) / 2.0f);
+            float max_sample_tap_distance = params.max_sample_tap_distance / tex_dim_x;
+            float half_texel = 0.5f / tex_dim_x;
+
+            for (int i = 0; i < int(params.S); ++i)
+            {
+                if (i == self_index)
+                {
+                    continue;
+                }
+
+                float lerp_amount = (float(i) + R + 1.0f) / (S + 1.0f);
+                float T = -max_sample_tap_distance + (2.0f * max_sample_tap_distance) * lerp_amount;
+
+                Float2 switch_v = ((i & 1) == 1) ? corrected_VX : NX;
+                Float2 Y = {X.x + switch_v.x * T + half_texel, X.y + switch_v.y * T + half_texel};
+
+                Float2 VY = velocity.sample_point_clamp(Y);
+                float temp_VY = clamp(length(VY) * params.half_exposure, 0.1f, K);
+                float ZY = -depth.sample_point_clamp(Y);
+
+                float alpha_Y = soft_depth_compare(ZX, ZY) * cone(T, temp_VY) +
+                                soft_depth_compare(ZY, ZX) * cone(T, temp_VX) +
+                                cylinder(T, temp_VY) * cylinder(T, temp_VX) * 2.0f;
+
+                Float4 CY = sample_linear_clamp(color, Y);
+                weight += alpha_Y;
+                sum_x += alpha_Y * CY.x;
+                sum_y += alpha_Y * CY.y;
+                sum_z += alpha_Y * CY.z;
+            }
+
+            result.x = sum_x / weight;
+            result.y = sum_y / weight;
+            result.z = sum_z / weight;
+            result.w = 1.0f;
+            return true;
+        }
+    }
+
+    uint64_t reconstruct_velocity_field(ColorImage const &color, DepthImage const &depth, VelocityFieldImage const &velocity, RandomImage const *random,
+                                        Parameters const &params, ColorImage &out, ThreadPool &pool)
+    {
+        uint32_t width = color.get_width();
+        uint32_t height = color.get_height();
+        uint32_t tile_width, tile_height;
+        compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+
+        VelocityFieldImage tile_max_buffer(tile_width, tile_height);
+        VelocityFieldImage neighbor_max_buffer(tile_width, tile_height);
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    tile_max_buffer.at(tx, ty) = tile_max_field_texel(velocity, params.K, tile_width, tile_height, tx, ty);
+                }
+            }
+        });
+        pool.parallel_rows(tile_height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t ty = row_begin; ty < row_end; ++ty)
+            {
+                for (uint32_t tx = 0; tx < tile_width; ++tx)
+                {
+                    neighbor_max_buffer.at(tx, ty) = neighbor_max_field_texel(tile_max_buffer, tx, ty);
+                }
+            }
+        });
+
+        std::vector<uint64_t> gathered_pixels(height, 0);
+        pool.parallel_rows(height, [&](uint32_t row_begin, uint32_t row_end) {
+            for (uint32_t y = row_begin; y < row_end; ++y)
+            {
+                Float4 *dst = out.row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    gathered_pixels[y] += gather_field_pixel(color, depth, velocity, neighbor_max_buffer, random, params, x, y, dst[x]) ? 1 : 0;
+                }
+            }
+        });
+
+        uint64_t total = 0;
+        for (uint64_t count : gathered_pixels)
+        {
+            total += count;
+        }
+        return total;
+    }
+}
@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/cpu_blur/velocity_encoding.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "image.h"
+#include "parameters.h"
+#include "thread_pool.h"
+
+// Storage formats of V, TileMax and NeighborMax (c_velocity_encoding in cbCamera), and a scalar reference of the
+// TileMax, NeighborMax and gather passes that runs on decoded velocities, so that each format can be compared
+// against unquantized float velocities.
+
+namespace CPUBlur
+{
+    enum VelocityEncoding
+    {
+        VELOCITY_ENCODING_BIAS_SCALE = 0, // R8G8_UNORM, (v + 1) / 2: 8 bits per component over [-1, 1]
+        VELOCITY_ENCODING_HALF_FLOAT,     // R16G16_FLOAT, v as is
+        VELOCITY_ENCODING_LOG_POLAR,      // R8G8_UNORM, 256 directions and log2 of the length in [LOG2_MIN, LOG2_MAX]
+        VELOCITY_ENCODING_COUNT
+    };
+
+    // Range of the length of VELOCITY_ENCODING_LOG_POLAR. Code 0 of the magnitude byte is zero velocity, codes 1 to
+    // 255 step evenly through log2 of the length, about 3.6% apart.
+    const float VELOCITY_LOG2_MIN = -8.0f;
+    const float VELOCITY_LOG2_MAX = 5.0f;
+
+    // Unquantized V, as computed by ps_scene.hlsl before it is written to the target
+    typedef Image<Float2> VelocityFieldImage;
+
+    char const *get_velocity_encoding_name(VelocityEncoding encoding);
+    uint32_t get_velocity_encoding_bytes(VelocityEncoding encoding);
+
+    // encodeVelocity/decodeVelocity (constants.hlsli). The texel is the value the shader writes or reads;
+    // store_velocity_texel applies the conversion of the render target format in between.
+    Float2 encode_velocity(VelocityEncoding encoding, Float2 v);
+    Float2 store_velocity_texel(VelocityEncoding encoding, Float2 texel);
+    Float2 decode_velocity(VelocityEncoding encoding, Float2 texel);
+
+    // Velocity read back by every pass after v has been written to V
+    Float2 quantize_velocity(VelocityEncoding encoding, Float2 v);
+    void quantize_velocity_field(VelocityFieldImage const &velocity, VelocityEncoding encoding, VelocityFieldImage &out, ThreadPool &pool);
+
+    // TileMax, NeighborMax and the scalar gather of reconstruction.h on decoded velocities. TileMax and NeighborMax
+    // copy the texel they select, so with V from quantize_velocity_field this is the result of the given encoding,
+    // and with V as computed the float reference. Returns the number of pixels that ran the tap loop.
+    uint64_t reconstruct_velocity_field(ColorImage const &color, DepthImage const &depth, VelocityFieldImage const &velocity, RandomImage const *random,
+                                        Parameters const &params, ColorImage &out, ThreadPool &pool);
+}
@@ -42,35 +42,87 @@
 #define DISABLE_PERF_TRACKING 1
 #include "PerfTracker.h"
 #include "nvidia_util/DeviceManager.h"
+#include "cpu_blur/benchmark.h"
+#include "cpu_blur/half_resolution.h"
+#include "cpu_blur/instance_transforms.h"
+#include "cpu_blur/jitter.h"
+#include "cpu_blur/parameters.h"
+#include "cpu_blur/velocity_encoding.h"
 
 #include <AntTweakBar.h>
 #include <DXUT.h>
 #include <DXUTcamera.h>
 
+#include <float.h>
 #include <time.h>
 
 #ifndef NDEBUG
 #include "../shaders/dxbc/debug/_internal_vs_scene.inl"
+#include "../shaders/dxbc/debug/_internal_vs_scene_quantized.inl"
+#include "../shaders/dxbc/debug/_internal_vs_scene_instanced.inl"
+#include "../shaders/dxbc/debug/_internal_vs_scene_instanced_quantized.inl"
 #include "../shaders/dxbc/debug/_internal_ps_scene.inl"
 #include "../shaders/dxbc/debug/_internal_vs_quad.inl"
 #include "../shaders/dxbc/debug/_internal_ps_quad.inl"
 #include "../shaders/dxbc/debug/_internal_ps_depth.inl"
 #include "../shaders/dxbc/debug/_internal_ps_tilemax.inl"
+#include "../shaders/dxbc/debug/_internal_ps_tilemax_horizontal.inl"
+#include "../shaders/dxbc/debug/_internal_ps_tilemax_vertical.inl"
 #include "../shaders/dxbc/debug/_internal_ps_neighbormax.inl"
+#include "../shaders/dxbc/debug/_internal_ps_pack_velocity_depth.inl"
+#include "../shaders/dxbc/debug/_internal_ps_linear_depth.inl"
+#include "../shaders/dxbc/debug/_internal_ps_downsample.inl"
+#include "../shaders/dxbc/debug/_internal_ps_upsample.inl"
 #include "../shaders/dxbc/debug/_internal_ps_gather.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s1.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s3.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s5.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s7.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s9.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s11.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s13.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s15.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s17.inl"
+#include "../shaders/dxbc/debug/_internal_ps_gather_s19.inl"
+#include "../shaders/dxbc/debug/_internal_ps_tileclassify.inl"
+#include "../shaders/dxbc/debug/_internal_ps_tilesamples.inl"
+#include "../shaders/dxbc/debug/_internal_vs_tile.inl"
+#include "../shaders/dxbc/debug/_internal_cs_tilemax_neighbormax.inl"
 #else
 #include "../shaders/dxbc/release/_internal_vs_scene.inl"
+#include "../shaders/dxbc/release/_internal_vs_scene_quantized.inl"
+#include "../shaders/dxbc/release/_internal_vs_scene_instanced.inl"
+#include "../shaders/dxbc/release/_internal_vs_scene_instanced_quantized.inl"
 #include "../shaders/dxbc/release/_internal_ps_scene.inl"
 #include "../shaders/dxbc/release/_internal_vs_quad.inl"
 #include "../shaders/dxbc/release/_internal_ps_quad.inl"
 #include "../shaders/dxbc/release/_internal_ps_depth.inl"
 #include "../shaders/dxbc/release/_internal_ps_tilemax.inl"
+#include "../shaders/dxbc/release/_internal_ps_tilemax_horizontal.inl"
+#include "../shaders/dxbc/release/_internal_ps_tilemax_vertical.inl"
 #include "../shaders/dxbc/release/_internal_ps_neighbormax.inl"
+#include "../shaders/dxbc/release/_internal_ps_pack_velocity_depth.inl"
+#include "../shaders/dxbc/release/_internal_ps_linear_depth.inl"
+#include "../shaders/dxbc/release/_internal_ps_downsample.inl"
+#include "../shaders/dxbc/release/_internal_ps_upsample.inl"
 #include "../shaders/dxbc/release/_internal_ps_gather.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s1.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s3.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s5.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s7.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s9.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s11.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s13.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s15.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s17.inl"
+#include "../shaders/dxbc/release/_internal_ps_gather_s19.inl"
+#include "../shaders/dxbc/release/_internal_ps_tileclassify.inl"
+#include "../shaders/dxbc/release/_internal_ps_tilesamples.inl"
+#include "../shaders/dxbc/release/_internal_vs_tile.inl"
+#include "../shaders/dxbc/release/_internal_cs_tilemax_neighbormax.inl"
 #endif
 
-#include "../assets/house.h"
-#include "../assets/fan.h"
+#include "mesh_pack.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Globals
@@ -81,6 +133,9 @@ DeviceManager *g_device_manager;
 const float CAMERA_CLIP_NEAR = 1.0f;
 const float CAMERA_CLIP_FAR = 100.00f;
 
+// Pivot of the fan blades in model space
+const DirectX::XMFLOAT3 FAN_HUB_POSITION(0.0f, 8.74925041f, 2.67939997f);
+
 bool g_bRenderHUD = true;
 
 typedef enum eViewMode
@@ -95,6 +150,78 @@ typedef enum eViewMode
 
 eViewMode g_view_mode = VIEW_MODE_FINAL;
 
+typedef enum eTileMaxMode
+{
+	TILE_MAX_MODE_SINGLE_PASS = 0,
+	TILE_MAX_MODE_SEPARABLE,
+	TILE_MAX_MODE_FUSED
+};
+
+eTileMaxMode g_tile_max_mode = TILE_MAX_MODE_SINGLE_PASS;
+
+// Tiles per thread group side in cs_tilemax_neighbormax.hlsl (GROUP_SIZE)
+const unsigned int FUSED_TILE_GROUP_SIZE = 16;
+
+// Tile classification (no blur / uniform velocity / complex) ahead of the gather
+typedef enum eTileClass
+{
+	TILE_CLASS_NO_BLUR = 0,
+	TILE_CLASS_UNIFORM,
+	TILE_CLASS_COMPLEX,
+	TILE_CLASS_COUNT
+};
+
+bool g_tile_classification = false;
+
+// Gather permutations with the tap loop compiled for S = 1, 3, ..., 19 (ps_gather_s*.hlsl)
+const unsigned int GATHER_PERMUTATION_COUNT = 10;
+bool g_specialized_gather = true;
+unsigned int g_tile_class_counts[TILE_CLASS_COUNT] = {0, 0, 0};
+
+// Incremental TileMax/NeighborMax: while the camera is still only the tiles under the fan blades are recomputed
+bool g_incremental_tiles = false;
+float g_incremental_tile_max_fraction = 1.0f;
+float g_incremental_neighbor_max_fraction = 1.0f;
+
+// Gather taps read Z and the clamped length of V from one R32G32_FLOAT target (ps_pack_velocity_depth.hlsl)
+bool g_packed_velocity_depth = false;
+
+// Gather (and pack) read view-space depth from an R16_FLOAT target written by ps_linear_depth.hlsl instead of D24S8
+bool g_linear_depth = true;
+
+// Per-tile tap count from the NeighborMax length (ps_tilesamples.hlsl), clamped to [ADAPTIVE_MIN_S, g_S]
+bool g_adaptive_samples = false;
+float g_average_taps_per_pixel = 0.0f;
+
+// Gather at half resolution (ps_downsample.hlsl) followed by a depth/velocity-aware upsample (ps_upsample.hlsl)
+bool g_half_resolution_gather = false;
+
+// Temporal reuse: while nothing the passes read changes (paused blades, still camera, same settings) the last final
+// image is presented again instead of running the scene, TileMax, NeighborMax and gather passes
+bool g_temporal_reuse = false;
+unsigned int g_skipped_pass_frames = 0;
+
+// Scene meshes in the single-stream Scene::QuantizedVertex layout (vs_scene_quantized.hlsl) instead of three float
+// streams; both sets of vertex buffers are created at start-up
+bool g_quantized_vertices = false;
+unsigned int g_vertex_buffer_bytes[2] = {0, 0}; // Float, quantized
+
+// Copies of the blades in a grid behind the windmill, drawn with one DrawIndexedInstanced from per-instance transforms
+// built on the CPU (CPUBlur::build_instance_transforms) and uploaded once per frame
+int g_instance_count = 0;
+double g_instance_update_ms = 0.0;
+
+// Scene draws through a Scene::RenderQueue: sorted by a key of their state and depth, binding only what changes
+// between draws, with the counts of the last frame shown under the frame rate
+bool g_render_queue = false;
+Scene::RenderQueueStats g_render_queue_stats = {};
+
+// Source of the per-pixel jitter of the gather taps (c_jitter_source)
+CPUBlur::JitterSource g_jitter_source = CPUBlur::JITTER_RANDOM_TEXTURE;
+
+// Format of V, TileMax and NeighborMax (c_velocity_encoding); changing it recreates them
+CPUBlur::VelocityEncoding g_velocity_encoding = CPUBlur::VELOCITY_ENCODING_BIAS_SCALE;
+
 // Global speed of the fan blades
 float g_sailSpeed = 350.0f;
 int g_sailSpeedPaused = false;
@@ -102,9 +229,19 @@ int g_sailSpeedPaused = false;
 // Globals to define the mation blur reconstruction parameters
 float g_Exposure = 1.0f;
 unsigned int g_K = 2;
+const unsigned int MAX_K = 20; // Upper bound of the "Max Blur Radius" slider
 unsigned int g_S = 15;
 unsigned int g_MaxSampleTapDistance = 6;
 
+// "-check-k-sweep", a manual check on a machine with a D3D11 GPU (ctest does not run it): the first MAX_K frames set K
+// to 1, 2, ... MAX_K and the next MAX_K - 1 frames back down to 1, each change going through Render like a slider step.
+// The frames cycle through the TileMax modes with tile classification on. Fails if any step recreates C, Z, V, if the
+// way back creates tile buffers, or if the tile lists of a frame do not hold each tile once. The failures are written to
+// check_k_sweep.txt, and the sample quits after the sweep with 1 as exit code if there were any.
+bool g_check_k_sweep = false;
+FILE *g_check_k_sweep_output = nullptr;
+int g_check_k_sweep_result = 0;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Scene Controller
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -125,12 +262,46 @@ private:
 		FLOAT K;
 		FLOAT S;
 		FLOAT max_sample_tap_distance;
+		UINT jitter_source;
+		UINT packed_velocity_depth;
+		UINT velocity_encoding;
+		FLOAT clip_near;
+		FLOAT clip_far;
+		UINT adaptive_samples;
+		FLOAT padding[2];
 	};
 	struct CBSceneObject
 	{
 		DirectX::XMFLOAT4X4 model_xform_new;
 		DirectX::XMFLOAT4X4 model_xform_old;
 		DirectX::XMFLOAT4X4 model_xform_normal_new;
+		DirectX::XMFLOAT4 position_scale;
+		DirectX::XMFLOAT4 position_bias;
+	};
+
+	// Everything a frame's passes depend on apart from the meshes and textures, compared with memcmp, so it is
+	// zero-filled before being set. The old camera transforms are last frame's new ones, and the blade transforms
+	// follow from the two angles, so that a frame only matches once the velocities it renders have settled too.
+	struct FrameKey
+	{
+		DirectX::XMFLOAT4X4 world_xform_new;
+		DirectX::XMFLOAT4X4 world_xform_old;
+		DirectX::XMFLOAT4X4 view_xform_new;
+		DirectX::XMFLOAT4X4 view_xform_old;
+		DirectX::XMFLOAT4X4 projection_xform;
+		FLOAT blades_angle_new;
+		FLOAT blades_angle_old;
+		double delta_time;
+		FLOAT exposure;
+		UINT K;
+		UINT S;
+		UINT max_sample_tap_distance;
+		UINT view_mode;
+		UINT tile_max_mode;
+		UINT jitter_source;
+		UINT velocity_encoding;
+		UINT instance_count;
+		UINT options; // One bit per boolean setting
 	};
 
 	CModelViewerCamera *camera;
@@ -146,10 +317,21 @@ private:
 	DirectX::XMFLOAT4X4 model_blades_xform_old;
 	DirectX::XMFLOAT4X4 model_blades_xform_normal_new;
 
-	ID3D11InputLayout *scene_layout;
+	Scene::InputLayoutTable scene_layouts;
 	ID3D11VertexShader *scene_vs;
+	ID3D11VertexShader *scene_quantized_vs;
+	ID3D11VertexShader *scene_instanced_vs;
+	ID3D11VertexShader *scene_instanced_quantized_vs;
 	ID3D11PixelShader *scene_ps;
 
+	// Poses of the instanced blades this frame and last frame, and their transforms for vs_scene_instanced.hlsl
+	std::vector<CPUBlur::RigidPose> instance_poses_new;
+	std::vector<CPUBlur::RigidPose> instance_poses_old;
+	Scene::InstanceBuffer instance_buffer;
+
+	// Reused every frame, so that its arrays keep their capacity
+	Scene::RenderQueue render_queue;
+
 	ID3D11Texture2D *scene_tex;
 	ID3D11RenderTargetView *scene_rtv;
 	ID3D11ShaderResourceView *scene_srv;
@@ -162,15 +344,155 @@ private:
 	ID3D11RenderTargetView *velocity_rtv;
 	ID3D11ShaderResourceView *velocity_srv;
 
-	ID3D11Texture2D *velocity_tile_max_tex;
-	ID3D11RenderTargetView *velocity_tile_max_rtv;
-	ID3D11ShaderResourceView *velocity_tile_max_srv;
-	ID3D11PixelShader *velocity_tile_max_ps;
+	// View-space depth, written by linear_depth_ps
+	ID3D11Texture2D *linear_depth_tex;
+	ID3D11RenderTargetView *linear_depth_rtv;
+	ID3D11ShaderResourceView *linear_depth_srv;
+
+	// (Z, TempV) of every pixel for the gather taps, written by pack_velocity_depth_ps
+	ID3D11Texture2D *velocity_depth_tex;
+	ID3D11RenderTargetView *velocity_depth_rtv;
+	ID3D11ShaderResourceView *velocity_depth_srv;
+
+	// Fixed blue-noise tile for CPUBlur::JITTER_BLUE_NOISE; unlike the rand() texture it does not depend on the target size
+	ID3D11Texture2D *blue_noise_tex;
+	ID3D11ShaderResourceView *blue_noise_srv;
+
+	// Everything whose size depends on K. One set is kept per K, so changing K never recreates the
+	// full-resolution C, Z, V targets and only creates tile buffers the first time a K is used.
+	struct TileResources
+	{
+		ID3D11Texture2D *velocity_tile_max_tex;
+		ID3D11RenderTargetView *velocity_tile_max_rtv;
+		ID3D11ShaderResourceView *velocity_tile_max_srv;
+		ID3D11UnorderedAccessView *velocity_tile_max_uav;
+
+		// Intermediate (w/K, h) buffer of the separable TileMax mode
+		ID3D11Texture2D *velocity_tile_max_horizontal_tex;
+		ID3D11RenderTargetView *velocity_tile_max_horizontal_rtv;
+		ID3D11ShaderResourceView *velocity_tile_max_horizontal_srv;
+
+		ID3D11Texture2D *velocity_neighbor_max_tex;
+		ID3D11RenderTargetView *velocity_neighbor_max_rtv;
+		ID3D11ShaderResourceView *velocity_neighbor_max_srv;
+		ID3D11UnorderedAccessView *velocity_neighbor_max_uav;
+
+		ID3D11Texture2D *random_tex;
+		ID3D11ShaderResourceView *random_srv;
+
+		// Per-class tile lists, appended to by the classification pass and expanded by tile_vs
+		ID3D11Buffer *tile_list_buf[TILE_CLASS_COUNT];
+		ID3D11UnorderedAccessView *tile_list_uav[TILE_CLASS_COUNT];
+		ID3D11ShaderResourceView *tile_list_srv[TILE_CLASS_COUNT];
+
+		// Per-tile tap count of the adaptive mode, written by tile_samples_ps
+		ID3D11Texture2D *tile_samples_tex;
+		ID3D11RenderTargetView *tile_samples_rtv;
+		ID3D11ShaderResourceView *tile_samples_srv;
+
+		TileResources()
+		{
+			ZeroMemory(this, sizeof(*this));
+		}
+
+		void Release()
+		{
+			SAFE_RELEASE(this->velocity_tile_max_tex);
+			SAFE_RELEASE(this->velocity_tile_max_rtv);
+			SAFE_RELEASE(this->velocity_tile_max_srv);
+			SAFE_RELEASE(this->velocity_tile_max_uav);
+			SAFE_RELEASE(this->velocity_tile_max_horizontal_tex);
+			SAFE_RELEASE(this->velocity_tile_max_horizontal_rtv);
+			SAFE_RELEASE(this->velocity_tile_max_horizontal_srv);
+			SAFE_RELEASE(this->velocity_neighbor_max_tex);
+			SAFE_RELEASE(this->velocity_neighbor_max_rtv);
+			SAFE_RELEASE(this->velocity_neighbor_max_srv);
+			SAFE_RELEASE(this->velocity_neighbor_max_uav);
+			SAFE_RELEASE(this->random_tex);
+			SAFE_RELEASE(this->random_srv);
+			SAFE_RELEASE(this->tile_samples_tex);
+			SAFE_RELEASE(this->tile_samples_rtv);
+			SAFE_RELEASE(this->tile_samples_srv);
+			for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+			{
+				SAFE_RELEASE(this->tile_list_buf[i]);
+				SAFE_RELEASE(this->tile_list_uav[i]);
+				SAFE_RELEASE(this->tile_list_srv[i]);
+			}
+		}
+	};
+
+	// Indexed by K, created on the first use of each K and kept until the next resize, so that going back to a K
+	// allocates nothing. All MAX_K sets take about 43 bytes per pixel with R8G8 velocities (90 MB at 1080p), half of
+	// it the K = 1 set, whose tile buffers are full-resolution.
+	TileResources tile_resources[MAX_K + 1];
+	TileResources *tiles;
+
+	// Half-resolution C, Z, V written by downsample_ps, and the gather output read by upsample_ps
+	struct HalfResolutionResources
+	{
+		ID3D11Texture2D *color_tex;
+		ID3D11RenderTargetView *color_rtv;
+		ID3D11ShaderResourceView *color_srv;
+
+		ID3D11Texture2D *depth_tex;
+		ID3D11RenderTargetView *depth_rtv;
+		ID3D11ShaderResourceView *depth_srv;
+
+		ID3D11Texture2D *velocity_tex;
+		ID3D11RenderTargetView *velocity_rtv;
+		ID3D11ShaderResourceView *velocity_srv;
+
+		ID3D11Texture2D *blurred_tex;
+		ID3D11RenderTargetView *blurred_rtv;
+		ID3D11ShaderResourceView *blurred_srv;
+
+		HalfResolutionResources()
+		{
+			ZeroMemory(this, sizeof(*this));
+		}
+
+		void Release()
+		{
+			SAFE_RELEASE(this->color_tex);
+			SAFE_RELEASE(this->color_rtv);
+			SAFE_RELEASE(this->color_srv);
+			SAFE_RELEASE(this->depth_tex);
+			SAFE_RELEASE(this->depth_rtv);
+			SAFE_RELEASE(this->depth_srv);
+			SAFE_RELEASE(this->velocity_tex);
+			SAFE_RELEASE(this->velocity_rtv);
+			SAFE_RELEASE(this->velocity_srv);
+			SAFE_RELEASE(this->blurred_tex);
+			SAFE_RELEASE(this->blurred_rtv);
+			SAFE_RELEASE(this->blurred_srv);
+		}
+	};
+
+	HalfResolutionResources half_resolution;
 
-	ID3D11Texture2D *velocity_neighbor_max_tex;
-	ID3D11RenderTargetView *velocity_neighbor_max_rtv;
-	ID3D11ShaderResourceView *velocity_neighbor_max_srv;
+	// Number of textures created for the full-resolution targets (C, Z, V, packed Z and V, linear Z), which only a back
+	// buffer resize or a velocity format change may do
+	unsigned int full_resolution_allocation_count;
+	unsigned int tile_resource_allocation_count; // Sets of tile buffers created
+
+	// -check-k-sweep: frames swept so far, and the counts before the sweep
+	unsigned int k_sweep_frame;
+	unsigned int k_sweep_full_resolution_allocation_count;
+	unsigned int k_sweep_tile_resource_allocation_count;
+
+	// Encoding the current V, TileMax and NeighborMax targets were created for
+	CPUBlur::VelocityEncoding velocity_encoding;
+
+	ID3D11PixelShader *velocity_tile_max_ps;
+	ID3D11PixelShader *velocity_tile_max_horizontal_ps;
+	ID3D11PixelShader *velocity_tile_max_vertical_ps;
 	ID3D11PixelShader *velocity_neighbor_max_ps;
+	ID3D11PixelShader *pack_velocity_depth_ps;
+	ID3D11PixelShader *linear_depth_ps;
+	ID3D11PixelShader *downsample_ps;
+	ID3D11PixelShader *upsample_ps;
+	ID3D11ComputeShader *tile_max_neighbor_max_cs;
 
 	ID3D11Buffer *quad_verts;
 	ID3D11InputLayout *quad_layout;
@@ -179,8 +501,29 @@ private:
 
 	ID3D11PixelShader *depth_ps;
 	ID3D11PixelShader *gather_ps;
+	ID3D11PixelShader *gather_permutation_ps[GATHER_PERMUTATION_COUNT];
+
+	ID3D11PixelShader *tile_classify_ps;
+	ID3D11VertexShader *tile_vs;
+	ID3D11Buffer *tile_draw_args;
+	ID3D11Buffer *tile_draw_args_staging[3];
+	unsigned int tile_draw_args_frame;
+
+	// Sum of the per-tile tap counts, read back like the tile list counts
+	ID3D11PixelShader *tile_samples_ps;
+	ID3D11Buffer *tap_count_buf;
+	ID3D11UnorderedAccessView *tap_count_uav;
+	ID3D11Buffer *tap_count_staging[3];
+	unsigned int tap_count_frame;
 
 	ID3D11RasterizerState *rs_state;
+	ID3D11RasterizerState *rs_state_scissor;
+
+	// Incremental tiles: bounding sphere of the blades around the hub, and the pixels they covered last frame
+	FLOAT model_blades_radius;
+	D3D11_RECT blades_pixel_rect_old;
+	bool blades_pixel_rect_old_valid;
+	bool tile_buffers_valid;
 
 	ID3D11SamplerState *samp_point_wrap;
 	ID3D11SamplerState *samp_point_clamp;
@@ -192,17 +535,20 @@ private:
 	ID3D11BlendState *blend_state;
 	ID3D11BlendState *blend_state_disabled;
 
-	ID3D11Texture2D *random_tex;
-	ID3D11ShaderResourceView *random_srv;
-
 	ID3D11ShaderResourceView *background_srv;
 
 	Scene::RenderList scene;
+	Scene::RenderList quantized_scene; // The same meshes in the QuantizedVertex layout
 
 	DXGI_SURFACE_DESC surface_desc;
 	double last_delta_time;
 	unsigned int last_K;
 
+	// Copy of the back buffer after the last frame that ran the passes, created on first use at the back buffer size
+	ID3D11Texture2D *final_cache_tex;
+	FrameKey final_cache_key;
+	bool final_cache_valid;
+
 public:
 	SceneController(CModelViewerCamera *cam)
 	{
@@ -217,15 +563,29 @@ public:
 		this->velocity_tex = nullptr;
 		this->velocity_rtv = nullptr;
 		this->velocity_srv = nullptr;
-		this->velocity_tile_max_tex = nullptr;
-		this->velocity_tile_max_rtv = nullptr;
-		this->velocity_tile_max_srv = nullptr;
-		this->velocity_neighbor_max_tex = nullptr;
-		this->velocity_neighbor_max_rtv = nullptr;
-		this->velocity_neighbor_max_srv = nullptr;
-		this->random_tex = nullptr;
-		this->random_srv = nullptr;
+		this->velocity_depth_tex = nullptr;
+		this->velocity_depth_rtv = nullptr;
+		this->velocity_depth_srv = nullptr;
+		this->linear_depth_tex = nullptr;
+		this->linear_depth_rtv = nullptr;
+		this->linear_depth_srv = nullptr;
+		this->blue_noise_tex = nullptr;
+		this->blue_noise_srv = nullptr;
+		this->tiles = nullptr;
+		this->full_resolution_allocation_count = 0;
+		this->tile_resource_allocation_count = 0;
+		this->k_sweep_frame = 0;
+		this->k_sweep_full_resolution_allocation_count = 0;
+		this->k_sweep_tile_resource_allocation_count = 0;
+		this->velocity_encoding = g_velocity_encoding;
 		this->background_srv = nullptr;
+		this->tile_draw_args_frame = 0;
+		this->tap_count_frame = 0;
+		this->model_blades_radius = 0.0f;
+		this->blades_pixel_rect_old_valid = false;
+		this->tile_buffers_valid = false;
+		this->final_cache_tex = nullptr;
+		this->final_cache_valid = false;
 
 		model_blades_angle_new = model_blades_angle_old = 0.0f;
 		last_delta_time = 30.0f;
@@ -274,17 +634,80 @@ public:
 			_ASSERT(!FAILED(hr));
 		}
 
-		Scene::load_model(device, house_num_faces, house_indices, house_num_vertices, house_vertices, house_normals, house_texture_coords, L"windmill_diffuse.dds", L"windmill_normal.dds", this->scene);
-		Scene::load_model(device, fan_num_faces, fan_indices, fan_num_vertices, fan_vertices, fan_normals, fan_texture_coords, L"windmill_diffuse.dds", L"windmill_normal.dds", this->scene);
+		// Meshes from the pack written by MeshPackConverter. The streams are uploaded straight from the mapping, which
+		// stays open until the end of this function for the blade bounds below.
+		Scene::MeshPackFile mesh_pack;
+		Scene::MeshStreams house, fan;
+		{
+			WCHAR mesh_pack_path[MAX_PATH];
+			hr = DXUTFindDXSDKMediaFileCch(mesh_pack_path, MAX_PATH, L"windmill.meshpack");
+			if (FAILED(hr) || !mesh_pack.open(mesh_pack_path) || !mesh_pack.find_mesh("house", house) || !mesh_pack.find_mesh("fan", fan))
+			{
+				return E_FAIL;
+			}
+		}
+		for (int quantized = 0; quantized < 2; ++quantized)
+		{
+			Scene::RenderList &objects = quantized ? this->quantized_scene : this->scene;
+			Scene::load_model(device, house.num_faces, house.indices, house.num_vertices, house.vertices, house.normals, house.texture_coords, L"windmill_diffuse.dds", L"windmill_normal.dds", quantized != 0, objects);
+			Scene::load_model(device, fan.num_faces, fan.indices, fan.num_vertices, fan.vertices, fan.normals, fan.texture_coords, L"windmill_diffuse.dds", L"windmill_normal.dds", quantized != 0, objects);
+			g_vertex_buffer_bytes[quantized] = objects[0]->get_vertex_buffer_size() + objects[1]->get_vertex_buffer_size();
+		}
+
+		{
+			CPUBlur::RandomImage blue_noise;
+			CPUBlur::fill_blue_noise(blue_noise);
+
+			D3D11_TEXTURE2D_DESC tex_desc;
+			tex_desc.Width = blue_noise.get_width();
+			tex_desc.Height = blue_noise.get_height();
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = DXGI_FORMAT_R8_UNORM;
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.SampleDesc.Quality = 0;
+			tex_desc.Usage = D3D11_USAGE_IMMUTABLE;
+			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			tex_desc.CPUAccessFlags = 0;
+			tex_desc.MiscFlags = 0;
+
+			D3D11_SUBRESOURCE_DATA tex_data;
+			tex_data.pSysMem = blue_noise.data();
+			tex_data.SysMemPitch = blue_noise.get_width();
+			tex_data.SysMemSlicePitch = blue_noise.get_width() * blue_noise.get_height();
+
+			device->CreateTexture2D(&tex_desc, &tex_data, &this->blue_noise_tex);
+			device->CreateShaderResourceView(this->blue_noise_tex, NULL, &this->blue_noise_srv);
+		}
+
+		// The blades only ever rotate about the hub, so a sphere around it bounds them in every frame
+		{
+			DirectX::XMVECTOR hub = DirectX::XMLoadFloat3(&FAN_HUB_POSITION);
+			float radius_squared = 0.0f;
+			for (unsigned int i = 0; i < fan.num_vertices; i++)
+			{
+				DirectX::XMFLOAT3 position(fan.vertices[3 * i + 0], fan.vertices[3 * i + 1], fan.vertices[3 * i + 2]);
+				float distance_squared = DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&position), hub)));
+				radius_squared = std::max(radius_squared, distance_squared);
+			}
+			this->model_blades_radius = sqrtf(radius_squared);
+		}
 
 		{
 			device->CreateVertexShader(vs_scene_shader_module_code, sizeof(vs_scene_shader_module_code), nullptr, &this->scene_vs);
+			device->CreateVertexShader(vs_scene_quantized_shader_module_code, sizeof(vs_scene_quantized_shader_module_code), nullptr, &this->scene_quantized_vs);
+			device->CreateVertexShader(vs_scene_instanced_shader_module_code, sizeof(vs_scene_instanced_shader_module_code), nullptr, &this->scene_instanced_vs);
+			device->CreateVertexShader(vs_scene_instanced_quantized_shader_module_code, sizeof(vs_scene_instanced_quantized_shader_module_code), nullptr, &this->scene_instanced_quantized_vs);
 
-			D3D11_INPUT_ELEMENT_DESC scene_layout_desc[] = {
-				{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-				{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-				{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 2, 0, D3D11_INPUT_PER_VERTEX_DATA, 0}};
-			device->CreateInputLayout(scene_layout_desc, sizeof(scene_layout_desc) / sizeof(D3D11_INPUT_ELEMENT_DESC), vs_scene_shader_module_code, sizeof(vs_scene_shader_module_code), &this->scene_layout);
+			// Input layouts by the objects' LayoutDesc keys, each validated against the shader that reads it
+			for (auto object = this->scene.begin(); object != this->scene.end(); ++object)
+			{
+				Scene::find_input_layout(device, (*object)->get_layout(), vs_scene_shader_module_code, sizeof(vs_scene_shader_module_code), this->scene_layouts);
+			}
+			for (auto object = this->quantized_scene.begin(); object != this->quantized_scene.end(); ++object)
+			{
+				Scene::find_input_layout(device, (*object)->get_layout(), vs_scene_quantized_shader_module_code, sizeof(vs_scene_quantized_shader_module_code), this->scene_layouts);
+			}
 
 			device->CreatePixelShader(ps_scene_shader_module_code, sizeof(ps_scene_shader_module_code), nullptr, &this->scene_ps);
 		}
@@ -301,9 +724,90 @@ public:
 
 			device->CreatePixelShader(ps_tilemax_shader_module_code, sizeof(ps_tilemax_shader_module_code), nullptr, &this->velocity_tile_max_ps);
 
+			device->CreatePixelShader(ps_tilemax_horizontal_shader_module_code, sizeof(ps_tilemax_horizontal_shader_module_code), nullptr, &this->velocity_tile_max_horizontal_ps);
+
+			device->CreatePixelShader(ps_tilemax_vertical_shader_module_code, sizeof(ps_tilemax_vertical_shader_module_code), nullptr, &this->velocity_tile_max_vertical_ps);
+
 			device->CreatePixelShader(ps_neighbormax_shader_module_code, sizeof(ps_neighbormax_shader_module_code), nullptr, &this->velocity_neighbor_max_ps);
+			device->CreatePixelShader(ps_pack_velocity_depth_shader_module_code, sizeof(ps_pack_velocity_depth_shader_module_code), nullptr, &this->pack_velocity_depth_ps);
+			device->CreatePixelShader(ps_linear_depth_shader_module_code, sizeof(ps_linear_depth_shader_module_code), nullptr, &this->linear_depth_ps);
+			device->CreatePixelShader(ps_downsample_shader_module_code, sizeof(ps_downsample_shader_module_code), nullptr, &this->downsample_ps);
+			device->CreatePixelShader(ps_upsample_shader_module_code, sizeof(ps_upsample_shader_module_code), nullptr, &this->upsample_ps);
+			device->CreateComputeShader(cs_tilemax_neighbormax_shader_module_code, sizeof(cs_tilemax_neighbormax_shader_module_code), nullptr, &this->tile_max_neighbor_max_cs);
 
 			device->CreatePixelShader(ps_gather_shader_module_code, sizeof(ps_gather_shader_module_code), nullptr, &this->gather_ps);
+
+			struct
+			{
+				const BYTE *code;
+				SIZE_T size;
+			} gather_permutations[GATHER_PERMUTATION_COUNT] = {
+				{ps_gather_s1_shader_module_code, sizeof(ps_gather_s1_shader_module_code)},
+				{ps_gather_s3_shader_module_code, sizeof(ps_gather_s3_shader_module_code)},
+				{ps_gather_s5_shader_module_code, sizeof(ps_gather_s5_shader_module_code)},
+				{ps_gather_s7_shader_module_code, sizeof(ps_gather_s7_shader_module_code)},
+				{ps_gather_s9_shader_module_code, sizeof(ps_gather_s9_shader_module_code)},
+				{ps_gather_s11_shader_module_code, sizeof(ps_gather_s11_shader_module_code)},
+				{ps_gather_s13_shader_module_code, sizeof(ps_gather_s13_shader_module_code)},
+				{ps_gather_s15_shader_module_code, sizeof(ps_gather_s15_shader_module_code)},
+				{ps_gather_s17_shader_module_code, sizeof(ps_gather_s17_shader_module_code)},
+				{ps_gather_s19_shader_module_code, sizeof(ps_gather_s19_shader_module_code)},
+			};
+			for (unsigned int i = 0; i < GATHER_PERMUTATION_COUNT; i++)
+			{
+				device->CreatePixelShader(gather_permutations[i].code, gather_permutations[i].size, nullptr, &this->gather_permutation_ps[i]);
+			}
+
+			device->CreatePixelShader(ps_tileclassify_shader_module_code, sizeof(ps_tileclassify_shader_module_code), nullptr, &this->tile_classify_ps);
+
+			device->CreateVertexShader(vs_tile_shader_module_code, sizeof(vs_tile_shader_module_code), nullptr, &this->tile_vs);
+
+			device->CreatePixelShader(ps_tilesamples_shader_module_code, sizeof(ps_tilesamples_shader_module_code), nullptr, &this->tile_samples_ps);
+		}
+		{
+			// One D3D11_DRAW_INSTANCED_INDIRECT_ARGS per tile class; InstanceCount is filled in by CopyStructureCount
+			UINT args[TILE_CLASS_COUNT * 4];
+			for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+			{
+				args[i * 4 + 0] = 6;
+				args[i * 4 + 1] = 0;
+				args[i * 4 + 2] = 0;
+				args[i * 4 + 3] = 0;
+			}
+			D3D11_BUFFER_DESC desc = {sizeof(args), D3D11_USAGE_DEFAULT, 0, 0, D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS, 0};
+			D3D11_SUBRESOURCE_DATA data = {(void *)args, 0, 0};
+			hr = device->CreateBuffer(&desc, &data, &this->tile_draw_args);
+			_ASSERT(!FAILED(hr));
+
+			// Read back a few frames late so the HUD counters never stall the pipeline
+			D3D11_BUFFER_DESC staging_desc = {sizeof(args), D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ, 0, 0};
+			for (unsigned int i = 0; i < 3; i++)
+			{
+				hr = device->CreateBuffer(&staging_desc, nullptr, &this->tile_draw_args_staging[i]);
+				_ASSERT(!FAILED(hr));
+			}
+		}
+		{
+			// One raw UINT that tile_samples_ps adds every tile's tap count to
+			D3D11_BUFFER_DESC desc = {sizeof(UINT), D3D11_USAGE_DEFAULT, D3D11_BIND_UNORDERED_ACCESS, 0, D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS, 0};
+			hr = device->CreateBuffer(&desc, nullptr, &this->tap_count_buf);
+			_ASSERT(!FAILED(hr));
+
+			D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc;
+			ZeroMemory(&uav_desc, sizeof(uav_desc));
+			uav_desc.Format = DXGI_FORMAT_R32_TYPELESS;
+			uav_desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+			uav_desc.Buffer.NumElements = 1;
+			uav_desc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+			hr = device->CreateUnorderedAccessView(this->tap_count_buf, &uav_desc, &this->tap_count_uav);
+			_ASSERT(!FAILED(hr));
+
+			D3D11_BUFFER_DESC staging_desc = {sizeof(UINT), D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ, 0, 0};
+			for (unsigned int i = 0; i < 3; i++)
+			{
+				hr = device->CreateBuffer(&staging_desc, nullptr, &this->tap_count_staging[i]);
+				_ASSERT(!FAILED(hr));
+			}
 		}
 		{
 			D3D11_RASTERIZER_DESC desc;
@@ -319,6 +823,9 @@ public:
 			desc.ScissorEnable = FALSE;
 			desc.SlopeScaledDepthBias = 0;
 			device->CreateRasterizerState(&desc, &this->rs_state);
+
+			desc.ScissorEnable = TRUE;
+			device->CreateRasterizerState(&desc, &this->rs_state_scissor);
 		}
 		{
 			D3D11_SAMPLER_DESC desc;
@@ -426,11 +933,20 @@ public:
 
 	virtual void DeviceDestroyed()
 	{
+		SAFE_RELEASE(this->final_cache_tex);
 		SAFE_RELEASE(this->camera_cb);
 		SAFE_RELEASE(this->model_house_cb);
 		SAFE_RELEASE(this->model_blades_cb);
-		SAFE_RELEASE(this->scene_layout);
+		for (auto layout = this->scene_layouts.begin(); layout != this->scene_layouts.end(); ++layout)
+		{
+			SAFE_RELEASE(layout->second);
+		}
+		this->scene_layouts.clear();
 		SAFE_RELEASE(this->scene_vs);
+		SAFE_RELEASE(this->scene_quantized_vs);
+		SAFE_RELEASE(this->scene_instanced_vs);
+		SAFE_RELEASE(this->scene_instanced_quantized_vs);
+		this->instance_buffer.release();
 		SAFE_RELEASE(this->scene_ps);
 		SAFE_RELEASE(this->scene_tex);
 		SAFE_RELEASE(this->scene_rtv);
@@ -441,21 +957,55 @@ public:
 		SAFE_RELEASE(this->velocity_tex);
 		SAFE_RELEASE(this->velocity_rtv);
 		SAFE_RELEASE(this->velocity_srv);
-		SAFE_RELEASE(this->velocity_tile_max_tex);
-		SAFE_RELEASE(this->velocity_tile_max_rtv);
-		SAFE_RELEASE(this->velocity_tile_max_srv);
+		SAFE_RELEASE(this->velocity_depth_tex);
+		SAFE_RELEASE(this->velocity_depth_rtv);
+		SAFE_RELEASE(this->velocity_depth_srv);
+		SAFE_RELEASE(this->linear_depth_tex);
+		SAFE_RELEASE(this->linear_depth_rtv);
+		SAFE_RELEASE(this->linear_depth_srv);
+		this->half_resolution.Release();
+		SAFE_RELEASE(this->blue_noise_tex);
+		SAFE_RELEASE(this->blue_noise_srv);
 		SAFE_RELEASE(this->velocity_tile_max_ps);
-		SAFE_RELEASE(this->velocity_neighbor_max_tex);
-		SAFE_RELEASE(this->velocity_neighbor_max_rtv);
-		SAFE_RELEASE(this->velocity_neighbor_max_srv);
+		SAFE_RELEASE(this->velocity_tile_max_horizontal_ps);
+		SAFE_RELEASE(this->velocity_tile_max_vertical_ps);
 		SAFE_RELEASE(this->velocity_neighbor_max_ps);
+		SAFE_RELEASE(this->pack_velocity_depth_ps);
+		SAFE_RELEASE(this->linear_depth_ps);
+		SAFE_RELEASE(this->downsample_ps);
+		SAFE_RELEASE(this->upsample_ps);
+		SAFE_RELEASE(this->tile_max_neighbor_max_cs);
+		for (unsigned int k = 0; k <= MAX_K; k++)
+		{
+			this->tile_resources[k].Release();
+		}
+		this->tiles = nullptr;
 		SAFE_RELEASE(this->quad_verts);
 		SAFE_RELEASE(this->quad_layout);
 		SAFE_RELEASE(this->quad_vs);
 		SAFE_RELEASE(this->quad_ps);
 		SAFE_RELEASE(this->depth_ps);
 		SAFE_RELEASE(this->gather_ps);
+		for (unsigned int i = 0; i < GATHER_PERMUTATION_COUNT; i++)
+		{
+			SAFE_RELEASE(this->gather_permutation_ps[i]);
+		}
+		SAFE_RELEASE(this->tile_classify_ps);
+		SAFE_RELEASE(this->tile_vs);
+		SAFE_RELEASE(this->tile_draw_args);
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			SAFE_RELEASE(this->tile_draw_args_staging[i]);
+		}
+		SAFE_RELEASE(this->tile_samples_ps);
+		SAFE_RELEASE(this->tap_count_buf);
+		SAFE_RELEASE(this->tap_count_uav);
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			SAFE_RELEASE(this->tap_count_staging[i]);
+		}
 		SAFE_RELEASE(this->rs_state);
+		SAFE_RELEASE(this->rs_state_scissor);
 		SAFE_RELEASE(this->samp_point_wrap);
 		SAFE_RELEASE(this->samp_point_clamp);
 		SAFE_RELEASE(this->samp_linear_clamp);
@@ -463,8 +1013,6 @@ public:
 		SAFE_RELEASE(this->ds_state_disabled);
 		SAFE_RELEASE(this->blend_state);
 		SAFE_RELEASE(this->blend_state_disabled);
-		SAFE_RELEASE(this->random_tex);
-		SAFE_RELEASE(this->random_srv);
 		SAFE_RELEASE(this->background_srv);
 
 		for (auto object = this->scene.begin(); object != this->scene.end(); ++object)
@@ -472,6 +1020,11 @@ public:
 			delete (*object);
 		}
 		this->scene.clear();
+		for (auto object = this->quantized_scene.begin(); object != this->quantized_scene.end(); ++object)
+		{
+			delete (*object);
+		}
+		this->quantized_scene.clear();
 	}
 
 	void CreateTextureWithViews(
@@ -484,7 +1037,8 @@ public:
 		ID3D11Texture2D **target_tex,
 		ID3D11RenderTargetView **target_rtv,
 		ID3D11DepthStencilView **target_dsv,
-		ID3D11ShaderResourceView **target_srv)
+		ID3D11ShaderResourceView **target_srv,
+		ID3D11UnorderedAccessView **target_uav = nullptr)
 	{
 		HRESULT hr = S_OK;
 
@@ -498,8 +1052,16 @@ public:
 		tex_desc.SampleDesc.Count = 1;
 		tex_desc.Usage = D3D11_USAGE_DEFAULT;
 		tex_desc.BindFlags = (target_rtv ? D3D11_BIND_RENDER_TARGET : D3D11_BIND_DEPTH_STENCIL) | D3D11_BIND_SHADER_RESOURCE;
+		if (target_uav)
+		{
+			tex_desc.BindFlags |= D3D11_BIND_UNORDERED_ACCESS;
+		}
 		hr = device->CreateTexture2D(&tex_desc, nullptr, target_tex);
 		_ASSERT(!FAILED(hr));
+		if (IsFullResolutionTarget(target_tex))
+		{
+			this->full_resolution_allocation_count++;
+		}
 
 		if (target_rtv)
 		{
@@ -531,6 +1093,23 @@ public:
 		srv_desc.Texture2D.MostDetailedMip = 0;
 		hr = device->CreateShaderResourceView(*target_tex, &srv_desc, target_srv);
 		_ASSERT(!FAILED(hr));
+
+		if (target_uav)
+		{
+			D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc;
+			ZeroMemory(&uav_desc, sizeof(uav_desc));
+			uav_desc.Format = srv_format;
+			uav_desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+			uav_desc.Texture2D.MipSlice = 0;
+			hr = device->CreateUnorderedAccessView(*target_tex, &uav_desc, target_uav);
+			_ASSERT(!FAILED(hr));
+		}
+	}
+
+	bool IsFullResolutionTarget(ID3D11Texture2D *const *target_tex) const
+	{
+		return target_tex == &this->scene_tex || target_tex == &this->scene_depth_tex || target_tex == &this->velocity_tex ||
+			target_tex == &this->velocity_depth_tex || target_tex == &this->linear_depth_tex;
 	}
 
 	// Computes the appropriate max sample tap distance (our implementation needs to work both on small and
@@ -549,8 +1128,70 @@ public:
 		heightDividedByK = height / k;
 	}
 
+	// Format of V, TileMax and NeighborMax for the current encoding
+	DXGI_FORMAT GetVelocityFormat() const
+	{
+		return (this->velocity_encoding == CPUBlur::VELOCITY_ENCODING_HALF_FLOAT) ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R8G8_UNORM;
+	}
+
+	// Screen-space bounds of the blades' bounding sphere, false if any of it is behind the camera
+	bool ComputeBladesPixelRect(DirectX::FXMMATRIX world_view_proj, D3D11_RECT &rect) const
+	{
+		float x_min = FLT_MAX, y_min = FLT_MAX;
+		float x_max = -FLT_MAX, y_max = -FLT_MAX;
+		for (unsigned int corner = 0; corner < 8; corner++)
+		{
+			DirectX::XMFLOAT3 position = FAN_HUB_POSITION;
+			position.x += (corner & 1) ? this->model_blades_radius : -this->model_blades_radius;
+			position.y += (corner & 2) ? this->model_blades_radius : -this->model_blades_radius;
+			position.z += (corner & 4) ? this->model_blades_radius : -this->model_blades_radius;
+
+			DirectX::XMFLOAT4 clip;
+			DirectX::XMStoreFloat4(&clip, DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&position), world_view_proj));
+			if (clip.w <= 0.0f)
+			{
+				return false;
+			}
+
+			float x = (0.5f + 0.5f * clip.x / clip.w) * (float)this->surface_desc.Width;
+			float y = (0.5f - 0.5f * clip.y / clip.w) * (float)this->surface_desc.Height;
+			x_min = std::min(x_min, x);
+			x_max = std::max(x_max, x);
+			y_min = std::min(y_min, y);
+			y_max = std::max(y_max, y);
+		}
+
+		// One pixel of slack for rasterization and rounding
+		rect.left = (LONG)std::max(floorf(x_min) - 1.0f, 0.0f);
+		rect.top = (LONG)std::max(floorf(y_min) - 1.0f, 0.0f);
+		rect.right = (LONG)std::min(ceilf(x_max) + 1.0f, (float)this->surface_desc.Width);
+		rect.bottom = (LONG)std::min(ceilf(y_max) + 1.0f, (float)this->surface_desc.Height);
+		rect.right = std::max(rect.right, rect.left);
+		rect.bottom = std::max(rect.bottom, rect.top);
+		return true;
+	}
+
+	// Tiles whose K x K footprint in V may overlap the given pixels. Tile t reads from pixel (t + 0.5) * w / tiles
+	// onwards, so a pixel can belong to its own tile or the one to its left.
+	static D3D11_RECT ComputeDirtyTileRect(D3D11_RECT const &pixels, unsigned int width, unsigned int height, unsigned int widthDividedByK, unsigned int heightDividedByK)
+	{
+		D3D11_RECT tiles;
+		tiles.left = std::max((LONG)(pixels.left * widthDividedByK / width) - 1, 0L);
+		tiles.top = std::max((LONG)(pixels.top * heightDividedByK / height) - 1, 0L);
+		tiles.right = std::min((LONG)(pixels.right * widthDividedByK / width) + 2, (LONG)widthDividedByK);
+		tiles.bottom = std::min((LONG)(pixels.bottom * heightDividedByK / height) + 2, (LONG)heightDividedByK);
+		tiles.right = std::max(tiles.right, tiles.left);
+		tiles.bottom = std::max(tiles.bottom, tiles.top);
+		return tiles;
+	}
+
 	virtual void BackBufferResized(ID3D11Device *device, const DXGI_SURFACE_DESC *surface_desc)
 	{
+		this->tile_buffers_valid = false;
+		this->blades_pixel_rect_old_valid = false;
+		this->final_cache_valid = false;
+		SAFE_RELEASE(this->final_cache_tex);
+
 		SAFE_RELEASE(this->scene_tex);
 		SAFE_RELEASE(this->scene_rtv);
 		SAFE_RELEASE(this->scene_srv);
@@ -560,21 +1201,177 @@ public:
 		SAFE_RELEASE(this->velocity_tex);
 		SAFE_RELEASE(this->velocity_rtv);
 		SAFE_RELEASE(this->velocity_srv);
-		SAFE_RELEASE(this->velocity_tile_max_tex);
-		SAFE_RELEASE(this->velocity_tile_max_rtv);
-		SAFE_RELEASE(this->velocity_tile_max_srv);
-		SAFE_RELEASE(this->velocity_neighbor_max_tex);
-		SAFE_RELEASE(this->velocity_neighbor_max_rtv);
-		SAFE_RELEASE(this->velocity_neighbor_max_srv);
-		SAFE_RELEASE(this->random_tex);
-		SAFE_RELEASE(this->random_srv);
+		SAFE_RELEASE(this->velocity_depth_tex);
+		SAFE_RELEASE(this->velocity_depth_rtv);
+		SAFE_RELEASE(this->velocity_depth_srv);
+		SAFE_RELEASE(this->linear_depth_tex);
+		SAFE_RELEASE(this->linear_depth_rtv);
+		SAFE_RELEASE(this->linear_depth_srv);
+		this->half_resolution.Release();
+		for (unsigned int k = 0; k <= MAX_K; k++)
+		{
+			this->tile_resources[k].Release();
+		}
 
 		this->surface_desc = *surface_desc;
+		this->velocity_encoding = g_velocity_encoding;
+		ComputeMaxSampleTapDistance(surface_desc->Width, surface_desc->Height);
 
-		// C, Z, V are (width, height); TileMax and NeighborMax are (width/K, height/K)
+		// C, Z, V are (width, height) and do not depend on K
+		// C
+		CreateTextureWithViews(
+			device, surface_desc->Width, surface_desc->Height,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			&this->scene_tex,
+			&this->scene_rtv, nullptr,
+			&this->scene_srv);
+		// Z
+		CreateTextureWithViews(
+			device, surface_desc->Width, surface_desc->Height,
+			DXGI_FORMAT_R24G8_TYPELESS,
+			DXGI_FORMAT_D24_UNORM_S8_UINT,
+			DXGI_FORMAT_R24_UNORM_X8_TYPELESS,
+			&this->scene_depth_tex,
+			nullptr, &this->scene_depth_dsv,
+			&this->scene_depth_srv);
+		// V
+		CreateTextureWithViews(
+			device, surface_desc->Width, surface_desc->Height,
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			&this->velocity_tex,
+			&this->velocity_rtv, nullptr,
+			&this->velocity_srv);
+		// Packed (Z, TempV)
+		CreateTextureWithViews(
+			device, surface_desc->Width, surface_desc->Height,
+			DXGI_FORMAT_R32G32_FLOAT,
+			DXGI_FORMAT_R32G32_FLOAT,
+			DXGI_FORMAT_R32G32_FLOAT,
+			&this->velocity_depth_tex,
+			&this->velocity_depth_rtv, nullptr,
+			&this->velocity_depth_srv);
+		// Linear Z
+		CreateTextureWithViews(
+			device, surface_desc->Width, surface_desc->Height,
+			DXGI_FORMAT_R16_FLOAT,
+			DXGI_FORMAT_R16_FLOAT,
+			DXGI_FORMAT_R16_FLOAT,
+			&this->linear_depth_tex,
+			&this->linear_depth_rtv, nullptr,
+			&this->linear_depth_srv);
+
+		// Half-resolution C, Z, V and gather output, rounded up so that every pixel belongs to a 2x2 footprint
+		unsigned int half_width, half_height;
+		CPUBlur::compute_half_resolution_dimensions(surface_desc->Width, surface_desc->Height, half_width, half_height);
+		CreateTextureWithViews(
+			device, half_width, half_height,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			&this->half_resolution.color_tex,
+			&this->half_resolution.color_rtv, nullptr,
+			&this->half_resolution.color_srv);
+		// R32 since it holds either the D24 or the linear depth, whichever the gather reads
+		CreateTextureWithViews(
+			device, half_width, half_height,
+			DXGI_FORMAT_R32_FLOAT,
+			DXGI_FORMAT_R32_FLOAT,
+			DXGI_FORMAT_R32_FLOAT,
+			&this->half_resolution.depth_tex,
+			&this->half_resolution.depth_rtv, nullptr,
+			&this->half_resolution.depth_srv);
+		CreateTextureWithViews(
+			device, half_width, half_height,
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			&this->half_resolution.velocity_tex,
+			&this->half_resolution.velocity_rtv, nullptr,
+			&this->half_resolution.velocity_srv);
+		CreateTextureWithViews(
+			device, half_width, half_height,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			DXGI_FORMAT_R16G16B16A16_FLOAT,
+			&this->half_resolution.blurred_tex,
+			&this->half_resolution.blurred_rtv, nullptr,
+			&this->half_resolution.blurred_srv);
+
+		SelectTileResources(device);
+	}
+
+	// Switches to the tile buffers of the current K, creating them on first use
+	void SelectTileResources(ID3D11Device *device)
+	{
+		this->tiles = &this->tile_resources[std::min(std::max(g_K, 1u), MAX_K)];
+		this->tile_buffers_valid = false;
+		if (this->tiles->velocity_tile_max_tex == nullptr)
+		{
+			CreateTileResources(device, *this->tiles);
+		}
+	}
+
+	// -check-k-sweep, ahead of the K change in Render: the K of this frame, and the settings under which the passes
+	// that read the tile buffers all run
+	void BeginKSweepFrame()
+	{
+		if (this->k_sweep_frame == 0)
+		{
+			this->k_sweep_full_resolution_allocation_count = this->full_resolution_allocation_count;
+			this->k_sweep_tile_resource_allocation_count = this->tile_resource_allocation_count;
+		}
+		g_K = (this->k_sweep_frame < MAX_K) ? this->k_sweep_frame + 1 : 2 * MAX_K - 1 - this->k_sweep_frame;
+		g_tile_max_mode = (eTileMaxMode)(this->k_sweep_frame % 3);
+		g_view_mode = VIEW_MODE_FINAL;
+		g_half_resolution_gather = false;
+		g_tile_classification = true;
+		g_adaptive_samples = true;
+		g_temporal_reuse = false;
+	}
+
+	void ReportKSweepFailure(const char *failure)
+	{
+		fprintf(g_check_k_sweep_output ? g_check_k_sweep_output : stderr, "K = %u (frame %u): %s\n", g_K, this->k_sweep_frame, failure);
+		g_check_k_sweep_result = 1;
+	}
+
+	// -check-k-sweep, after the frame: checks what the K change allocated, and quits after the last frame
+	void EndKSweepFrame()
+	{
+		if (this->full_resolution_allocation_count != this->k_sweep_full_resolution_allocation_count)
+		{
+			ReportKSweepFailure("C, Z or V was recreated");
+			this->k_sweep_full_resolution_allocation_count = this->full_resolution_allocation_count;
+		}
+		if (this->k_sweep_frame < MAX_K)
+		{
+			this->k_sweep_tile_resource_allocation_count = this->tile_resource_allocation_count;
+		}
+		else if (this->tile_resource_allocation_count != this->k_sweep_tile_resource_allocation_count)
+		{
+			ReportKSweepFailure("tile buffers were created for a K used before");
+			this->k_sweep_tile_resource_allocation_count = this->tile_resource_allocation_count;
+		}
+
+		this->k_sweep_frame++;
+		if (this->k_sweep_frame == 2 * MAX_K - 1)
+		{
+			g_check_k_sweep = false;
+			PostQuitMessage(g_check_k_sweep_result);
+		}
+	}
+
+	void CreateTileResources(ID3D11Device *device, TileResources &resources)
+	{
+		this->tile_resource_allocation_count++;
+
+		// TileMax and NeighborMax are (width/K, height/K)
 		unsigned int widthDividedByK, heightDividedByK;
-		ComputeTiledDimensions(surface_desc->Width, surface_desc->Height, widthDividedByK, heightDividedByK);
-		ComputeMaxSampleTapDistance(surface_desc->Width, surface_desc->Height);
+		ComputeTiledDimensions(this->surface_desc.Width, this->surface_desc.Height, widthDividedByK, heightDividedByK);
 
 		// Texture to represent a pseudo-random number generator (used in gather pass)
 		{
@@ -605,57 +1402,239 @@ public:
 			tex_data.SysMemPitch = widthDividedByK;
 			tex_data.SysMemSlicePitch = widthDividedByK * heightDividedByK;
 
-			device->CreateTexture2D(&tex_desc, &tex_data, &this->random_tex);
-			device->CreateShaderResourceView(this->random_tex, NULL, &this->random_srv);
+			device->CreateTexture2D(&tex_desc, &tex_data, &resources.random_tex);
+			device->CreateShaderResourceView(resources.random_tex, NULL, &resources.random_srv);
 
 			delete[] rand_data;
 		}
 
-		// C
-		CreateTextureWithViews(
-			device, surface_desc->Width, surface_desc->Height,
-			DXGI_FORMAT_R16G16B16A16_FLOAT,
-			DXGI_FORMAT_R16G16B16A16_FLOAT,
-			DXGI_FORMAT_R16G16B16A16_FLOAT,
-			&this->scene_tex,
-			&this->scene_rtv, nullptr,
-			&this->scene_srv);
-		// Z
-		CreateTextureWithViews(
-			device, surface_desc->Width, surface_desc->Height,
-			DXGI_FORMAT_R24G8_TYPELESS,
-			DXGI_FORMAT_D24_UNORM_S8_UINT,
-			DXGI_FORMAT_R24_UNORM_X8_TYPELESS,
-			&this->scene_depth_tex,
-			nullptr, &this->scene_depth_dsv,
-			&this->scene_depth_srv);
-		// V
-		CreateTextureWithViews(
-			device, surface_desc->Width, surface_desc->Height,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			&this->velocity_tex,
-			&this->velocity_rtv, nullptr,
-			&this->velocity_srv);
 		// TileMax
 		CreateTextureWithViews(
 			device, widthDividedByK, heightDividedByK,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			&this->velocity_tile_max_tex,
-			&this->velocity_tile_max_rtv, nullptr,
-			&this->velocity_tile_max_srv);
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			&resources.velocity_tile_max_tex,
+			&resources.velocity_tile_max_rtv, nullptr,
+			&resources.velocity_tile_max_srv,
+			&resources.velocity_tile_max_uav);
+		// TileMax, horizontal stage of the separable mode (xy = velocity, z = column, w = valid)
+		DXGI_FORMAT horizontal_format = (this->velocity_encoding == CPUBlur::VELOCITY_ENCODING_HALF_FLOAT) ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		CreateTextureWithViews(
+			device, widthDividedByK, this->surface_desc.Height,
+			horizontal_format,
+			horizontal_format,
+			horizontal_format,
+			&resources.velocity_tile_max_horizontal_tex,
+			&resources.velocity_tile_max_horizontal_rtv, nullptr,
+			&resources.velocity_tile_max_horizontal_srv);
 		// NeighborMax
 		CreateTextureWithViews(
 			device, widthDividedByK, heightDividedByK,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			DXGI_FORMAT_R8G8_UNORM,
-			&this->velocity_neighbor_max_tex,
-			&this->velocity_neighbor_max_rtv, nullptr,
-			&this->velocity_neighbor_max_srv);
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			GetVelocityFormat(),
+			&resources.velocity_neighbor_max_tex,
+			&resources.velocity_neighbor_max_rtv, nullptr,
+			&resources.velocity_neighbor_max_srv,
+			&resources.velocity_neighbor_max_uav);
+		// Tap count per tile
+		CreateTextureWithViews(
+			device, widthDividedByK, heightDividedByK,
+			DXGI_FORMAT_R8_UINT,
+			DXGI_FORMAT_R8_UINT,
+			DXGI_FORMAT_R8_UINT,
+			&resources.tile_samples_tex,
+			&resources.tile_samples_rtv, nullptr,
+			&resources.tile_samples_srv);
+		// Tile lists, each large enough to hold every tile
+		{
+			UINT tile_count = widthDividedByK * heightDividedByK;
+
+			D3D11_BUFFER_DESC desc;
+			ZeroMemory(&desc, sizeof(desc));
+			desc.ByteWidth = tile_count * sizeof(UINT);
+			desc.Usage = D3D11_USAGE_DEFAULT;
+			desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+			desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+			desc.StructureByteStride = sizeof(UINT);
+
+			D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc;
+			ZeroMemory(&uav_desc, sizeof(uav_desc));
+			uav_desc.Format = DXGI_FORMAT_UNKNOWN;
+			uav_desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+			uav_desc.Buffer.NumElements = tile_count;
+			uav_desc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_APPEND;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc;
+			ZeroMemory(&srv_desc, sizeof(srv_desc));
+			srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			srv_desc.Buffer.NumElements = tile_count;
+
+			for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+			{
+				HRESULT hr = device->CreateBuffer(&desc, nullptr, &resources.tile_list_buf[i]);
+				_ASSERT(SUCCEEDED(hr));
+				device->CreateUnorderedAccessView(resources.tile_list_buf[i], &uav_desc, &resources.tile_list_uav[i]);
+				device->CreateShaderResourceView(resources.tile_list_buf[i], &srv_desc, &resources.tile_list_srv[i]);
+			}
+		}
+	}
+
+	// TileMax and NeighborMax of V in one compute pass (cs_tilemax_neighbormax.hlsl)
+	void DispatchFusedTileMax(ID3D11DeviceContext *ctx, unsigned int widthDividedByK, unsigned int heightDividedByK)
+	{
+		ID3D11SamplerState *samplers[3] = {this->samp_point_wrap, this->samp_point_clamp, this->samp_linear_clamp};
+		ID3D11UnorderedAccessView *uavs[2] = {this->tiles->velocity_tile_max_uav, this->tiles->velocity_neighbor_max_uav};
+		ctx->CSSetShader(this->tile_max_neighbor_max_cs, nullptr, 0);
+		ctx->CSSetConstantBuffers(0, 1, &this->camera_cb);
+		ctx->CSSetSamplers(0, 3, samplers);
+		ctx->CSSetShaderResources(0, 1, &this->velocity_srv);
+		ctx->CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+
+		ctx->Dispatch((widthDividedByK + FUSED_TILE_GROUP_SIZE - 1) / FUSED_TILE_GROUP_SIZE, (heightDividedByK + FUSED_TILE_GROUP_SIZE - 1) / FUSED_TILE_GROUP_SIZE, 1);
+
+		// Unbind everything so that the outputs can be read as SRVs, and V rendered to, next frame
+		ID3D11ShaderResourceView *null_srv = nullptr;
+		ID3D11UnorderedAccessView *null_uavs[2] = {nullptr, nullptr};
+		ctx->CSSetShaderResources(0, 1, &null_srv);
+		ctx->CSSetUnorderedAccessViews(0, 2, null_uavs, nullptr);
+		ctx->CSSetShader(nullptr, nullptr, 0);
+	}
+
+	ID3D11PixelShader *GetGatherShader() const
+	{
+		// Odd S up to 19 use the permutation compiled for that S, anything else (and the adaptive mode, whose count
+		// varies per tile) the generic loop
+		if (g_specialized_gather && !g_adaptive_samples && (g_S & 1) == 1 && g_S < 2 * GATHER_PERMUTATION_COUNT)
+		{
+			return this->gather_permutation_ps[g_S / 2];
+		}
+		return this->gather_ps;
+	}
+
+	void ClassifyTiles(ID3D11DeviceContext *ctx)
+	{
+		// One pixel per tile. The viewport is set here, since the fused TileMax dispatch leaves the full-resolution one
+		// of the scene pass in place, and each of its pixels would append an entry to lists sized for the tiles.
+		unsigned int widthDividedByK, heightDividedByK;
+		ComputeTiledDimensions(this->surface_desc.Width, this->surface_desc.Height, widthDividedByK, heightDividedByK);
+		D3D11_VIEWPORT viewport;
+		viewport.TopLeftX = 0.0f;
+		viewport.TopLeftY = 0.0f;
+		viewport.Width = (float)widthDividedByK;
+		viewport.Height = (float)heightDividedByK;
+		viewport.MinDepth = 0.0f;
+		viewport.MaxDepth = 1.0f;
+		ctx->RSSetViewports(1, &viewport);
+
+		// Append every tile to one of the three lists (no render target, UAVs only)
+		UINT initial_counts[TILE_CLASS_COUNT] = {0, 0, 0};
+		ctx->OMSetRenderTargetsAndUnorderedAccessViews(0, nullptr, nullptr, 0, TILE_CLASS_COUNT, this->tiles->tile_list_uav, initial_counts);
+		ctx->PSSetShader(this->tile_classify_ps, nullptr, 0);
+		ID3D11ShaderResourceView *tile_views[2];
+		tile_views[0] = this->tiles->velocity_tile_max_srv;
+		tile_views[1] = this->tiles->velocity_neighbor_max_srv;
+		ctx->PSSetShaderResources(0, 2, tile_views);
+		ctx->Draw(6, 0);
+
+		ID3D11UnorderedAccessView *null_uavs[TILE_CLASS_COUNT] = {nullptr};
+		ctx->OMSetRenderTargetsAndUnorderedAccessViews(0, nullptr, nullptr, 0, TILE_CLASS_COUNT, null_uavs, nullptr);
+
+		// The list lengths become the instance counts of the indirect draws
+		for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+		{
+			ctx->CopyStructureCount(this->tile_draw_args, i * 4 * sizeof(UINT) + sizeof(UINT), this->tiles->tile_list_uav[i]);
+		}
+
+		// Report the counts from the oldest copy, skipping the update if it is not ready yet
+		unsigned int staging_index = this->tile_draw_args_frame % 3;
+		this->tile_draw_args_frame++;
+		ctx->CopyResource(this->tile_draw_args_staging[staging_index], this->tile_draw_args);
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		ID3D11Buffer *oldest = this->tile_draw_args_staging[this->tile_draw_args_frame % 3];
+		if (this->tile_draw_args_frame >= 3 && ctx->Map(oldest, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped) == S_OK)
+		{
+			const UINT *args = static_cast<const UINT *>(mapped.pData);
+			for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+			{
+				g_tile_class_counts[i] = args[i * 4 + 1];
+			}
+			ctx->Unmap(oldest, 0);
+		}
+
+		// -check-k-sweep waits for this frame's counts: every tile must be in exactly one list
+		if (g_check_k_sweep)
+		{
+			ctx->CopyResource(this->tile_draw_args_staging[staging_index], this->tile_draw_args);
+			if (ctx->Map(this->tile_draw_args_staging[staging_index], 0, D3D11_MAP_READ, 0, &mapped) == S_OK)
+			{
+				const UINT *args = static_cast<const UINT *>(mapped.pData);
+				unsigned int listed_tile_count = 0;
+				for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+				{
+					listed_tile_count += args[i * 4 + 1];
+				}
+				ctx->Unmap(this->tile_draw_args_staging[staging_index], 0);
+				if (listed_tile_count != widthDividedByK * heightDividedByK)
+				{
+					ReportKSweepFailure("the tile lists do not hold every tile exactly once");
+				}
+			}
+		}
+	}
+
+	void ComputeTileSamples(ID3D11DeviceContext *ctx)
+	{
+		// One pixel per tile into the R8_UINT table, while summing the counts into tap_count_buf
+		UINT zero[4] = {0, 0, 0, 0};
+		ctx->ClearUnorderedAccessViewUint(this->tap_count_uav, zero);
+		ctx->OMSetRenderTargetsAndUnorderedAccessViews(1, &this->tiles->tile_samples_rtv, nullptr, 1, 1, &this->tap_count_uav, nullptr);
+		ctx->PSSetShader(this->tile_samples_ps, nullptr, 0);
+		ctx->PSSetShaderResources(0, 1, &this->tiles->velocity_neighbor_max_srv);
+		ctx->Draw(6, 0);
+
+		ID3D11UnorderedAccessView *null_uav = nullptr;
+		ctx->OMSetRenderTargetsAndUnorderedAccessViews(0, nullptr, nullptr, 1, 1, &null_uav, nullptr);
+
+		// Report the average from the oldest copy, as the tile class counts; tiles are K x K apart from the last row
+		// and column, so the tile average stands in for the pixel average
+		unsigned int staging_index = this->tap_count_frame % 3;
+		this->tap_count_frame++;
+		ctx->CopyResource(this->tap_count_staging[staging_index], this->tap_count_buf);
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		ID3D11Buffer *oldest = this->tap_count_staging[this->tap_count_frame % 3];
+		if (this->tap_count_frame >= 3 && ctx->Map(oldest, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped) == S_OK)
+		{
+			unsigned int widthDividedByK, heightDividedByK;
+			ComputeTiledDimensions(this->surface_desc.Width, this->surface_desc.Height, widthDividedByK, heightDividedByK);
+			g_average_taps_per_pixel = (float)*static_cast<const UINT *>(mapped.pData) / (float)(widthDividedByK * heightDividedByK);
+			ctx->Unmap(oldest, 0);
+		}
+	}
+
+	void DrawClassifiedTiles(ID3D11DeviceContext *ctx)
+	{
+		// Expects the gather inputs in t0..t4; static tiles are a copy of C (t0)
+		ctx->VSSetShader(this->tile_vs, nullptr, 0);
+		ctx->IASetInputLayout(nullptr);
+		ctx->IASetVertexBuffers(0, 0, nullptr, nullptr, nullptr);
+		ctx->VSSetShaderResources(1, 1, &this->tiles->velocity_neighbor_max_srv);
+
+		for (unsigned int i = 0; i < TILE_CLASS_COUNT; i++)
+		{
+			ctx->PSSetShader((i == TILE_CLASS_NO_BLUR) ? this->quad_ps : GetGatherShader(), nullptr, 0);
+			ctx->VSSetShaderResources(0, 1, &this->tiles->tile_list_srv[i]);
+			ctx->DrawInstancedIndirect(this->tile_draw_args, i * 4 * sizeof(UINT));
+		}
+
+		ID3D11ShaderResourceView *null_views[2] = {nullptr};
+		ctx->VSSetShaderResources(0, 2, null_views);
+		ctx->VSSetShader(this->quad_vs, nullptr, 0);
+		ctx->IASetInputLayout(this->quad_layout);
 	}
 
 	virtual void Animate(double fElapsedTimeSeconds)
@@ -669,15 +1648,207 @@ public:
 		}
 	}
 
+	void ComputeFrameKey(FrameKey &key)
+	{
+		ZeroMemory(&key, sizeof(key));
+		DirectX::XMStoreFloat4x4(&key.world_xform_new, this->camera->GetWorldMatrix());
+		DirectX::XMStoreFloat4x4(&key.view_xform_new, this->camera->GetViewMatrix());
+		DirectX::XMStoreFloat4x4(&key.projection_xform, this->camera->GetProjMatrix());
+		key.world_xform_old = this->camera_world_xform_new;
+		key.view_xform_old = this->camera_view_xform_new;
+		key.blades_angle_new = this->model_blades_angle_new;
+		key.blades_angle_old = this->model_blades_angle_old;
+		key.delta_time = this->last_delta_time;
+		key.exposure = g_Exposure;
+		key.K = g_K;
+		key.S = g_S;
+		key.max_sample_tap_distance = g_MaxSampleTapDistance;
+		key.view_mode = g_view_mode;
+		key.tile_max_mode = g_tile_max_mode;
+		key.jitter_source = g_jitter_source;
+		key.velocity_encoding = this->velocity_encoding;
+		key.instance_count = (UINT)g_instance_count;
+		key.options = (g_tile_classification ? 1 : 0) | (g_specialized_gather ? 2 : 0) | (g_incremental_tiles ? 4 : 0) |
+		              (g_packed_velocity_depth ? 8 : 0) | (g_linear_depth ? 16 : 0) | (g_adaptive_samples ? 32 : 0) |
+		              (g_half_resolution_gather ? 64 : 0) | (g_sailSpeedPaused ? 128 : 0) | (g_quantized_vertices ? 256 : 0);
+	}
+
+	// Blade copies in a grid behind the windmill, each turning about its own hub a golden angle of phase after the
+	// last. Last frame's poses are kept as the old ones, and neither changes while the animation is paused.
+	void UpdateInstancePoses(UINT instance_count)
+	{
+		bool resized = this->instance_poses_new.size() != instance_count;
+		if (!resized && g_sailSpeedPaused)
+		{
+			return;
+		}
+		if (resized)
+		{
+			this->instance_poses_new.resize(instance_count);
+		}
+		else
+		{
+			std::swap(this->instance_poses_old, this->instance_poses_new);
+		}
+
+		UINT columns = (UINT)ceilf(sqrtf((float)instance_count));
+		float spacing = 2.5f * this->model_blades_radius;
+		for (UINT i = 0; i < instance_count; i++)
+		{
+			float angle = DirectX::XMConvertToRadians(this->model_blades_angle_new + 137.5f * (float)i);
+			float sin_angle = sinf(angle);
+			float cos_angle = cosf(angle);
+			float offset_x = ((float)(i % columns) - 0.5f * (float)(columns - 1)) * spacing;
+			float offset_z = (float)(i / columns + 2) * spacing;
+
+			// Rotation about z through the hub: p' = (p - hub) * R + hub + offset
+			CPUBlur::RigidPose &pose = this->instance_poses_new[i];
+			pose.rotation = CPUBlur::Float4{0.0f, 0.0f, sinf(0.5f * angle), cosf(0.5f * angle)};
+			pose.translation.x = FAN_HUB_POSITION.x - (FAN_HUB_POSITION.x * cos_angle - FAN_HUB_POSITION.y * sin_angle) + offset_x;
+			pose.translation.y = FAN_HUB_POSITION.y - (FAN_HUB_POSITION.x * sin_angle + FAN_HUB_POSITION.y * cos_angle);
+			pose.translation.z = offset_z;
+		}
+		if (resized)
+		{
+			this->instance_poses_old = this->instance_poses_new;
+		}
+	}
+
+	// View-space depth of a point of the scene, for ordering the draws
+	static float GetViewDepth(DirectX::XMFLOAT3 const &position, DirectX::XMFLOAT4X4 const &world_matrix, DirectX::XMFLOAT4X4 const &view_matrix)
+	{
+		DirectX::XMMATRIX world_view = DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&world_matrix), DirectX::XMLoadFloat4x4(&view_matrix));
+		return DirectX::XMVectorGetZ(DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&position), world_view));
+	}
+
+	// The house, the blades and their instanced copies through the render queue. The camera constants (b0), pixel
+	// shader and output state are already set.
+	void SubmitSceneQueue(ID3D11DeviceContext *ctx, Scene::RenderList const &scene_objects, UINT instance_count, DirectX::XMFLOAT4X4 const &world_matrix, DirectX::XMFLOAT4X4 const &view_matrix)
+	{
+		Scene::D3D11CommandBackend backend(ctx, this->scene_layouts);
+		uint32_t shader = backend.add_vertex_shader(g_quantized_vertices ? this->scene_quantized_vs : this->scene_vs);
+		uint32_t instanced_shader = backend.add_vertex_shader(g_quantized_vertices ? this->scene_instanced_quantized_vs : this->scene_instanced_vs);
+		uint32_t house_constants = backend.add_object_constants(this->model_house_cb);
+		uint32_t blades_constants = backend.add_object_constants(this->model_blades_cb);
+
+		this->render_queue.clear();
+		Scene::DrawItem house = scene_objects[0]->get_draw_item(backend.add_geometry(scene_objects[0]));
+		house.shader = shader;
+		house.material = backend.add_material(scene_objects[0]->get_material());
+		house.object_constants = house_constants;
+		house.depth = GetViewDepth(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), world_matrix, view_matrix);
+		this->render_queue.push(house);
+
+		Scene::DrawItem blades = scene_objects[1]->get_draw_item(backend.add_geometry(scene_objects[1]));
+		blades.shader = shader;
+		blades.material = backend.add_material(scene_objects[1]->get_material());
+		blades.object_constants = blades_constants;
+		blades.depth = GetViewDepth(FAN_HUB_POSITION, world_matrix, view_matrix);
+		this->render_queue.push(blades);
+
+		// The copies start two grid rows behind the windmill, see UpdateInstancePoses
+		if (instance_count > 0)
+		{
+			Scene::DrawItem copies = blades;
+			copies.shader = instanced_shader;
+			copies.instance_data = backend.add_instance_data(this->instance_buffer.get_srv());
+			copies.instance_count = instance_count;
+			DirectX::XMFLOAT3 nearest_row(FAN_HUB_POSITION.x, FAN_HUB_POSITION.y, 5.0f * this->model_blades_radius);
+			copies.depth = GetViewDepth(nearest_row, world_matrix, view_matrix);
+			this->render_queue.push(copies);
+		}
+
+		this->render_queue.sort();
+		g_render_queue_stats = this->render_queue.submit(backend);
+
+		if (instance_count > 0)
+		{
+			ID3D11ShaderResourceView *null_view = nullptr;
+			ctx->VSSetShaderResources(0, 1, &null_view);
+		}
+	}
+
+	// Mapping of the object's UNORM positions to its model space (c_position_scale/_bias; identity for float positions)
+	static void SetPositionQuantization(CBSceneObject *object_buffer, Scene::RenderObject const *object)
+	{
+		Scene::PositionQuantization const &quantization = object->get_position_quantization();
+		object_buffer->position_scale = DirectX::XMFLOAT4(quantization.scale[0], quantization.scale[1], quantization.scale[2], 0.0f);
+		object_buffer->position_bias = DirectX::XMFLOAT4(quantization.bias[0], quantization.bias[1], quantization.bias[2], 0.0f);
+	}
+
+	// Copies the back buffer into final_cache_tex (store) or final_cache_tex into the back buffer
+	void CopyFinalCache(ID3D11Device *device, ID3D11DeviceContext *ctx, ID3D11RenderTargetView *pRTV, bool store)
+	{
+		ID3D11Resource *back_buffer = nullptr;
+		pRTV->GetResource(&back_buffer);
+
+		if (!this->final_cache_tex)
+		{
+			D3D11_TEXTURE2D_DESC tex_desc;
+			static_cast<ID3D11Texture2D *>(back_buffer)->GetDesc(&tex_desc);
+			tex_desc.Usage = D3D11_USAGE_DEFAULT;
+			tex_desc.BindFlags = 0;
+			tex_desc.CPUAccessFlags = 0;
+			tex_desc.MiscFlags = 0;
+			device->CreateTexture2D(&tex_desc, nullptr, &this->final_cache_tex);
+		}
+
+		if (this->final_cache_tex)
+		{
+			if (store)
+			{
+				ctx->CopyResource(this->final_cache_tex, back_buffer);
+			}
+			else
+			{
+				ctx->CopyResource(back_buffer, this->final_cache_tex);
+			}
+		}
+		SAFE_RELEASE(back_buffer);
+	}
+
 	virtual void Render(ID3D11Device *device, ID3D11DeviceContext *ctx, ID3D11RenderTargetView *pRTV, ID3D11DepthStencilView *pDSV)
 	{
-		// We need to resize buffers if K has changed
-		if (this->last_K != g_K)
+		if (g_check_k_sweep)
+		{
+			BeginKSweepFrame();
+		}
+
+		// A new velocity format recreates V and the tile buffers of every K
+		if (this->velocity_encoding != g_velocity_encoding)
 		{
 			BackBufferResized(device, &this->surface_desc);
 			this->last_K = g_K;
 		}
 
+		// Switch to the tile buffers of the new K if it has changed. C, Z, V stay as they are.
+		if (this->last_K != g_K)
+		{
+			SelectTileResources(device);
+			this->last_K = g_K;
+		}
+
+		// Present the cached final image again when nothing the passes read has changed since it was rendered. A
+		// resize or a new velocity format drops the cache in BackBufferResized; K, S, exposure and the other
+		// settings are part of the key.
+		FrameKey frame_key;
+		ComputeFrameKey(frame_key);
+		if (!g_temporal_reuse)
+		{
+			this->final_cache_valid = false;
+		}
+		else if (this->final_cache_valid && memcmp(&frame_key, &this->final_cache_key, sizeof(frame_key)) == 0)
+		{
+			PERF_FRAME_BEGIN(ctx);
+			{
+				PERF_EVENT_SCOPED(ctx, "Temporal Reuse");
+				CopyFinalCache(device, ctx, pRTV, false);
+			}
+			PERF_FRAME_END(ctx);
+			g_skipped_pass_frames++;
+			return;
+		}
+
 		D3D11_VIEWPORT viewportFull;
 		viewportFull.TopLeftX = 0.0f;
 		viewportFull.TopLeftY = 0.0f;
@@ -696,6 +1867,15 @@ public:
 		viewportScaled.MinDepth = 0.0f;
 		viewportScaled.MaxDepth = 1.0f;
 
+		D3D11_VIEWPORT viewportScaledHorizontal = viewportScaled;
+		viewportScaledHorizontal.Height = (float)this->surface_desc.Height;
+
+		unsigned int half_width, half_height;
+		CPUBlur::compute_half_resolution_dimensions(this->surface_desc.Width, this->surface_desc.Height, half_width, half_height);
+		D3D11_VIEWPORT viewportHalf = viewportFull;
+		viewportHalf.Width = (float)half_width;
+		viewportHalf.Height = (float)half_height;
+
 		UINT quad_strides = sizeof(DirectX::XMFLOAT2);
 		UINT quad_offsets = 0;
 
@@ -708,14 +1888,18 @@ public:
 				PERF_EVENT_BEGIN(ctx, "Render > Main");
 
 				float clear_color_scene[4] = {1.00f, 1.00f, 1.00f, 0.0f};
-				float clear_color_velcoity[4] = {0.50f, 0.50f, 0.50f, 0.0f};
+				CPUBlur::Float2 zero_velocity = CPUBlur::encode_velocity(this->velocity_encoding, CPUBlur::Float2{0.0f, 0.0f});
+				float clear_color_velcoity[4] = {zero_velocity.x, zero_velocity.y, 0.50f, 0.0f};
 				ctx->ClearRenderTargetView(pRTV, clear_color_scene);
 				ctx->ClearDepthStencilView(pDSV, D3D11_CLEAR_DEPTH, 1.0, 0);
 				ctx->ClearRenderTargetView(this->scene_rtv, clear_color_scene);
 				ctx->ClearDepthStencilView(this->scene_depth_dsv, D3D11_CLEAR_DEPTH, 1.0, 0);
 				ctx->ClearRenderTargetView(this->velocity_rtv, clear_color_velcoity);
-				ctx->ClearRenderTargetView(this->velocity_tile_max_rtv, clear_color_velcoity);
-				ctx->ClearRenderTargetView(this->velocity_neighbor_max_rtv, clear_color_velcoity);
+				if (!g_incremental_tiles)
+				{
+					ctx->ClearRenderTargetView(this->tiles->velocity_tile_max_rtv, clear_color_velcoity);
+					ctx->ClearRenderTargetView(this->tiles->velocity_neighbor_max_rtv, clear_color_velcoity);
+				}
 
 				ID3D11Buffer *cbs[3] = {nullptr};
 
@@ -726,6 +1910,49 @@ public:
 				DirectX::XMStoreFloat4x4(&view_matrix, this->camera->GetViewMatrix());
 				DirectX::XMFLOAT4X4 proj_matrix;
 				DirectX::XMStoreFloat4x4(&proj_matrix, this->camera->GetProjMatrix());
+
+				// Decide which tiles to recompute. A moving camera changes V everywhere; otherwise V can only change
+				// where the blades are now or were last frame, and TileMax/NeighborMax keep last frame's values elsewhere.
+				// The instanced blades are not bounded, so any of them turns this off.
+				D3D11_RECT tile_max_rect = {0, 0, (LONG)widthDividedByK, (LONG)heightDividedByK};
+				D3D11_RECT neighbor_max_rect = tile_max_rect;
+				{
+					bool camera_moved = memcmp(&world_matrix, &this->camera_world_xform_new, sizeof(world_matrix)) != 0 ||
+										memcmp(&view_matrix, &this->camera_view_xform_new, sizeof(view_matrix)) != 0;
+
+					DirectX::XMMATRIX world_view_proj = DirectX::XMMatrixMultiply(DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&world_matrix), DirectX::XMLoadFloat4x4(&view_matrix)), DirectX::XMLoadFloat4x4(&proj_matrix));
+					D3D11_RECT blades_pixel_rect;
+					bool blades_pixel_rect_valid = ComputeBladesPixelRect(world_view_proj, blades_pixel_rect);
+
+					// The fused compute pass always covers every tile
+					if (g_incremental_tiles && g_tile_max_mode != TILE_MAX_MODE_FUSED && g_instance_count == 0 && this->tile_buffers_valid && !camera_moved && blades_pixel_rect_valid && this->blades_pixel_rect_old_valid)
+					{
+						D3D11_RECT dirty_pixels;
+						dirty_pixels.left = std::min(blades_pixel_rect.left, this->blades_pixel_rect_old.left);
+						dirty_pixels.top = std::min(blades_pixel_rect.top, this->blades_pixel_rect_old.top);
+						dirty_pixels.right = std::max(blades_pixel_rect.right, this->blades_pixel_rect_old.right);
+						dirty_pixels.bottom = std::max(blades_pixel_rect.bottom, this->blades_pixel_rect_old.bottom);
+						tile_max_rect = ComputeDirtyTileRect(dirty_pixels, this->surface_desc.Width, this->surface_desc.Height, widthDividedByK, heightDividedByK);
+
+						// NeighborMax reads the 3x3 TileMax neighborhood
+						neighbor_max_rect.left = std::max(tile_max_rect.left - 1, 0L);
+						neighbor_max_rect.top = std::max(tile_max_rect.top - 1, 0L);
+						neighbor_max_rect.right = std::min(tile_max_rect.right + 1, (LONG)widthDividedByK);
+						neighbor_max_rect.bottom = std::min(tile_max_rect.bottom + 1, (LONG)heightDividedByK);
+					}
+
+					this->blades_pixel_rect_old = blades_pixel_rect;
+					this->blades_pixel_rect_old_valid = blades_pixel_rect_valid;
+					this->tile_buffers_valid = g_incremental_tiles;
+
+					float tile_count = (float)(widthDividedByK * heightDividedByK);
+					g_incremental_tile_max_fraction = (float)((tile_max_rect.right - tile_max_rect.left) * (tile_max_rect.bottom - tile_max_rect.top)) / tile_count;
+					g_incremental_neighbor_max_fraction = (float)((neighbor_max_rect.right - neighbor_max_rect.left) * (neighbor_max_rect.bottom - neighbor_max_rect.top)) / tile_count;
+				}
+
+				// House and blades, in the vertex layout selected in the UI
+				Scene::RenderList &scene_objects = g_quantized_vertices ? this->quantized_scene : this->scene;
+
 				{
 					D3D11_MAPPED_SUBRESOURCE mapped_resource;
 					ctx->Map(this->camera_cb, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource);
@@ -742,7 +1969,14 @@ public:
 					camera_buffer->half_exposure_x_framerate = 0.5f * g_Exposure / (float)this->last_delta_time;
 					camera_buffer->K = (float)g_K;
 					camera_buffer->S = (float)g_S;
-					camera_buffer->max_sample_tap_distance = (float)g_MaxSampleTapDistance;
+					// Same tap distance in UV at half resolution, where the gather divides by half the width
+					camera_buffer->max_sample_tap_distance = (float)g_MaxSampleTapDistance * (g_half_resolution_gather ? 0.5f : 1.0f);
+					camera_buffer->jitter_source = g_jitter_source;
+					camera_buffer->packed_velocity_depth = (g_packed_velocity_depth && !g_half_resolution_gather) ? 1 : 0;
+					camera_buffer->velocity_encoding = this->velocity_encoding;
+					camera_buffer->clip_near = CAMERA_CLIP_NEAR;
+					camera_buffer->clip_far = CAMERA_CLIP_FAR;
+					camera_buffer->adaptive_samples = g_adaptive_samples ? 1 : 0;
 
 					ctx->Unmap(this->camera_cb, 0);
 				}
@@ -755,6 +1989,7 @@ public:
 					DirectX::XMStoreFloat4x4(&object_buffer->model_xform_new, DirectX::XMMatrixIdentity());
 					DirectX::XMStoreFloat4x4(&object_buffer->model_xform_old, DirectX::XMMatrixIdentity());
 					DirectX::XMStoreFloat4x4(&object_buffer->model_xform_normal_new, DirectX::XMMatrixIdentity());
+					SetPositionQuantization(object_buffer, scene_objects[0]);
 
 					ctx->Unmap(this->model_house_cb, 0);
 				}
@@ -780,8 +2015,8 @@ public:
 						DirectX::XMFLOAT4X4 TranslateToWorld;
 						DirectX::XMFLOAT4X4 RotateFanBlades;
 						DirectX::XMFLOAT4X4 FinalTransform;
-						DirectX::XMStoreFloat4x4(&TranslateToOrigin, DirectX::XMMatrixTranslation(0.0f, -8.74925041f, -2.67939997f));
-						DirectX::XMStoreFloat4x4(&TranslateToWorld, DirectX::XMMatrixTranslation(0.0f, 8.74925041f, 2.67939997f));
+						DirectX::XMStoreFloat4x4(&TranslateToOrigin, DirectX::XMMatrixTranslation(-FAN_HUB_POSITION.x, -FAN_HUB_POSITION.y, -FAN_HUB_POSITION.z));
+						DirectX::XMStoreFloat4x4(&TranslateToWorld, DirectX::XMMatrixTranslation(FAN_HUB_POSITION.x, FAN_HUB_POSITION.y, FAN_HUB_POSITION.z));
 						DirectX::XMStoreFloat4x4(&RotateFanBlades, DirectX::XMMatrixRotationZ(DirectX::XMConvertToRadians(this->model_blades_angle_new)));
 
 						// Update our cache of the new transform and set it on the model constant data
@@ -792,8 +2027,29 @@ public:
 						DirectX::XMStoreFloat4x4(&FinalTransform, DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(nullptr, DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&FinalTransform), DirectX::XMLoadFloat4x4(&view_matrix)))));
 						object_buffer->model_xform_normal_new = this->model_blades_xform_normal_new = FinalTransform;
 					}
+					SetPositionQuantization(object_buffer, scene_objects[1]);
 					ctx->Unmap(this->model_blades_cb, 0);
 				}
+				// Instanced blade transforms, built straight into the mapped instance buffer
+				UINT instance_count = 0;
+				if (g_instance_count > 0)
+				{
+					CPUBlur::Stopwatch stopwatch;
+					stopwatch.start();
+					this->UpdateInstancePoses((UINT)g_instance_count);
+
+					CPUBlur::Float4x4 view_xform;
+					memcpy(view_xform.m, &view_matrix, sizeof(view_xform.m));
+					void *instances = this->instance_buffer.map(device, ctx, (UINT)g_instance_count, sizeof(CPUBlur::InstanceTransforms));
+					if (instances)
+					{
+						CPUBlur::build_instance_transforms(this->instance_poses_new.data(), this->instance_poses_old.data(), (uint32_t)g_instance_count, view_xform, (CPUBlur::InstanceTransforms *)instances);
+						this->instance_buffer.unmap(ctx);
+						instance_count = (UINT)g_instance_count;
+					}
+					stopwatch.stop();
+					g_instance_update_ms = stopwatch.milliseconds();
+				}
 
 				// Common sampler setup for all shaders
 				ID3D11SamplerState *samplers[3];
@@ -822,24 +2078,44 @@ public:
 				ctx->Draw(6, 0);
 
 				// Draw the scene
-				ctx->VSSetShader(this->scene_vs, nullptr, 0);
-				ctx->IASetInputLayout(this->scene_layout);
+				ctx->VSSetShader(g_quantized_vertices ? this->scene_quantized_vs : this->scene_vs, nullptr, 0);
 				ctx->RSSetState(this->rs_state);
 				ctx->PSSetShader(this->scene_ps, nullptr, 0);
 				ctx->PSSetConstantBuffers(0, 1, &this->camera_cb);
 				ctx->OMSetDepthStencilState(this->ds_state, 0xFF);
 
-				// Render the base/building
-				cbs[0] = this->camera_cb;
-				cbs[1] = this->model_house_cb;
-				ctx->VSSetConstantBuffers(0, 2, cbs);
-				this->scene[0]->render(ctx);
+				if (g_render_queue)
+				{
+					cbs[0] = this->camera_cb;
+					ctx->VSSetConstantBuffers(0, 1, cbs);
+					SubmitSceneQueue(ctx, scene_objects, instance_count, world_matrix, view_matrix);
+				}
+				else
+				{
+					// Render the base/building
+					cbs[0] = this->camera_cb;
+					cbs[1] = this->model_house_cb;
+					ctx->VSSetConstantBuffers(0, 2, cbs);
+					ctx->IASetInputLayout(this->scene_layouts[scene_objects[0]->get_layout().key]);
+					scene_objects[0]->render(ctx);
+
+					// Update the constant buffers and render the fan blades
+					cbs[0] = this->camera_cb;
+					cbs[1] = this->model_blades_cb;
+					ctx->VSSetConstantBuffers(0, 2, cbs);
+					ctx->IASetInputLayout(this->scene_layouts[scene_objects[1]->get_layout().key]);
+					scene_objects[1]->render(ctx);
+
+					// Every copy of the blades in one draw, with the blades' constants for the position quantization
+					if (instance_count > 0)
+					{
+						ctx->VSSetShader(g_quantized_vertices ? this->scene_instanced_quantized_vs : this->scene_instanced_vs, nullptr, 0);
+						scene_objects[1]->render_instanced(ctx, this->instance_buffer.get_srv(), instance_count);
 
-				// Update the constant buffers and render the fan blades
-				cbs[0] = this->camera_cb;
-				cbs[1] = this->model_blades_cb;
-				ctx->VSSetConstantBuffers(0, 2, cbs);
-				this->scene[1]->render(ctx);
+						ID3D11ShaderResourceView *null_view = nullptr;
+						ctx->VSSetShaderResources(0, 1, &null_view);
+					}
+				}
 
 				PERF_EVENT_END(ctx);
 
@@ -848,27 +2124,108 @@ public:
 				ctx->IASetInputLayout(this->quad_layout);
 				ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 				ctx->IASetVertexBuffers(0, 1, &this->quad_verts, &quad_strides, &quad_offsets);
-				ctx->RSSetState(this->rs_state);
 				ctx->OMSetDepthStencilState(this->ds_state_disabled, 0xFF);
 				ctx->OMSetBlendState(this->blend_state_disabled, nullptr, 0xFFFFFFFF);
 
+				// Depth as read by the gather
+				ID3D11ShaderResourceView *gather_depth_srv = g_linear_depth ? this->linear_depth_srv : this->scene_depth_srv;
+				if (g_linear_depth && g_view_mode == VIEW_MODE_FINAL)
+				{
+					PERF_EVENT_BEGIN(ctx, "Render > Linear Depth");
+					ctx->OMSetRenderTargets(1, &this->linear_depth_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportFull);
+					ctx->PSSetShader(this->linear_depth_ps, nullptr, 0);
+					ctx->PSSetShaderResources(0, 1, &this->scene_depth_srv);
+					ctx->Draw(6, 0);
+					PERF_EVENT_END(ctx);
+				}
+
+				// Pack Z and the clamped length of V into one target for the gather taps
+				if (g_packed_velocity_depth && !g_half_resolution_gather && g_view_mode == VIEW_MODE_FINAL)
+				{
+					PERF_EVENT_BEGIN(ctx, "Render > Pack");
+					ctx->OMSetRenderTargets(1, &this->velocity_depth_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportFull);
+					ctx->PSSetShader(this->pack_velocity_depth_ps, nullptr, 0);
+					ID3D11ShaderResourceView *pack_views[2] = {gather_depth_srv, this->velocity_srv};
+					ctx->PSSetShaderResources(0, 2, pack_views);
+					ctx->Draw(6, 0);
+					PERF_EVENT_END(ctx);
+				}
+				ctx->RSSetState(this->rs_state_scissor);
+
 				// Generate the TileMax buffer
 				PERF_EVENT_BEGIN(ctx, "Render > TileMax");
-				ctx->OMSetRenderTargets(1, &this->velocity_tile_max_rtv, nullptr);
-				ctx->RSSetViewports(1, &viewportScaled);
-				ctx->PSSetShader(this->velocity_tile_max_ps, nullptr, 0);
-				ctx->PSSetShaderResources(0, 1, &this->velocity_srv);
-				ctx->Draw(6, 0);
+				if (g_tile_max_mode == TILE_MAX_MODE_FUSED)
+				{
+					// NeighborMax is written by the same dispatch
+					ctx->OMSetRenderTargets(0, nullptr, nullptr);
+					DispatchFusedTileMax(ctx, widthDividedByK, heightDividedByK);
+				}
+				else if (g_tile_max_mode == TILE_MAX_MODE_SEPARABLE)
+				{
+					// The vertical pass of tile row ty reads rows (ty + 0.5) * h / tiles .. + K - 1 of the intermediate buffer
+					D3D11_RECT horizontal_rect = tile_max_rect;
+					horizontal_rect.top = tile_max_rect.top * this->surface_desc.Height / heightDividedByK;
+					horizontal_rect.bottom = std::min((LONG)(tile_max_rect.bottom * this->surface_desc.Height / heightDividedByK + g_K), (LONG)this->surface_desc.Height);
+
+					// K x 1 reduction of V into the intermediate buffer...
+					ctx->OMSetRenderTargets(1, &this->tiles->velocity_tile_max_horizontal_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportScaledHorizontal);
+					ctx->RSSetScissorRects(1, &horizontal_rect);
+					ctx->PSSetShader(this->velocity_tile_max_horizontal_ps, nullptr, 0);
+					ctx->PSSetShaderResources(0, 1, &this->velocity_srv);
+					ctx->Draw(6, 0);
+
+					// ...followed by a 1 x K reduction into TileMax
+					ctx->OMSetRenderTargets(1, &this->tiles->velocity_tile_max_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportScaled);
+					ctx->RSSetScissorRects(1, &tile_max_rect);
+					ctx->PSSetShader(this->velocity_tile_max_vertical_ps, nullptr, 0);
+					ctx->PSSetShaderResources(0, 1, &this->tiles->velocity_tile_max_horizontal_srv);
+					ctx->Draw(6, 0);
+				}
+				else
+				{
+					ctx->OMSetRenderTargets(1, &this->tiles->velocity_tile_max_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportScaled);
+					ctx->RSSetScissorRects(1, &tile_max_rect);
+					ctx->PSSetShader(this->velocity_tile_max_ps, nullptr, 0);
+					ctx->PSSetShaderResources(0, 1, &this->velocity_srv);
+					ctx->Draw(6, 0);
+				}
 				PERF_EVENT_END(ctx);
 
 				// Generate the NeighborMax buffer
-				PERF_EVENT_BEGIN(ctx, "Render > NeighborMax");
-				ctx->OMSetRenderTargets(1, &this->velocity_neighbor_max_rtv, nullptr);
-				ctx->RSSetViewports(1, &viewportScaled);
-				ctx->PSSetShader(this->velocity_neighbor_max_ps, nullptr, 0);
-				ctx->PSSetShaderResources(0, 1, &this->velocity_tile_max_srv);
-				ctx->Draw(6, 0);
-				PERF_EVENT_END(ctx);
+				if (g_tile_max_mode != TILE_MAX_MODE_FUSED)
+				{
+					PERF_EVENT_BEGIN(ctx, "Render > NeighborMax");
+					ctx->OMSetRenderTargets(1, &this->tiles->velocity_neighbor_max_rtv, nullptr);
+					ctx->RSSetViewports(1, &viewportScaled);
+					ctx->RSSetScissorRects(1, &neighbor_max_rect);
+					ctx->PSSetShader(this->velocity_neighbor_max_ps, nullptr, 0);
+					ctx->PSSetShaderResources(0, 1, &this->tiles->velocity_tile_max_srv);
+					ctx->Draw(6, 0);
+					PERF_EVENT_END(ctx);
+				}
+				ctx->RSSetState(this->rs_state);
+
+				// Sort the tiles into the no blur / uniform / complex lists
+				if (g_tile_classification && !g_half_resolution_gather && g_view_mode == VIEW_MODE_FINAL)
+				{
+					PERF_EVENT_BEGIN(ctx, "Render > Classify");
+					ClassifyTiles(ctx);
+					PERF_EVENT_END(ctx);
+				}
+
+				// Tap count of every tile from its NeighborMax
+				if (g_adaptive_samples && g_view_mode == VIEW_MODE_FINAL)
+				{
+					PERF_EVENT_BEGIN(ctx, "Render > Tile Samples");
+					ctx->RSSetViewports(1, &viewportScaled);
+					ComputeTileSamples(ctx);
+					PERF_EVENT_END(ctx);
+				}
 			}
 
 			// The final pass
@@ -879,19 +2236,72 @@ public:
 				ctx->RSSetViewports(1, &viewportFull);
 
 				// If requested, perform the final gather and display the results
-				if (g_view_mode == VIEW_MODE_FINAL)
+				if (g_view_mode == VIEW_MODE_FINAL && g_half_resolution_gather)
+				{
+					ID3D11ShaderResourceView *nullAttach[7] = {nullptr};
+
+					PERF_EVENT_BEGIN(ctx, "Final > Downsample");
+					ID3D11RenderTargetView *half_rtvs[3] = {this->half_resolution.color_rtv, this->half_resolution.depth_rtv, this->half_resolution.velocity_rtv};
+					ctx->OMSetRenderTargets(3, half_rtvs, nullptr);
+					ctx->RSSetViewports(1, &viewportHalf);
+					ctx->PSSetShader(this->downsample_ps, nullptr, 0);
+					ID3D11ShaderResourceView *downsample_views[3] = {this->scene_srv, gather_depth_srv, this->velocity_srv};
+					ctx->PSSetShaderResources(0, 3, downsample_views);
+					ctx->Draw(6, 0);
+					PERF_EVENT_END(ctx);
+
+					PERF_EVENT_BEGIN(ctx, "Final > Gather");
+					ctx->OMSetRenderTargets(1, &this->half_resolution.blurred_rtv, nullptr);
+					ctx->PSSetShader(GetGatherShader(), nullptr, 0);
+					ID3D11ShaderResourceView *texture_views[7];
+					texture_views[0] = this->half_resolution.color_srv;
+					texture_views[1] = this->half_resolution.depth_srv;
+					texture_views[2] = this->half_resolution.velocity_srv;
+					texture_views[3] = this->tiles->velocity_neighbor_max_srv;
+					texture_views[4] = (g_jitter_source == CPUBlur::JITTER_RANDOM_TEXTURE) ? this->tiles->random_srv :
+					                   (g_jitter_source == CPUBlur::JITTER_BLUE_NOISE) ? this->blue_noise_srv : nullptr;
+					texture_views[5] = nullptr;
+					texture_views[6] = g_adaptive_samples ? this->tiles->tile_samples_srv : nullptr;
+					ctx->PSSetShaderResources(0, 7, texture_views);
+					ctx->Draw(6, 0);
+					PERF_EVENT_END(ctx);
+
+					PERF_EVENT_BEGIN(ctx, "Final > Upsample");
+					ctx->PSSetShaderResources(0, 7, nullAttach);
+					ctx->OMSetRenderTargets(1, &pRTV, pDSV);
+					ctx->RSSetViewports(1, &viewportFull);
+					ctx->PSSetShader(this->upsample_ps, nullptr, 0);
+					ID3D11ShaderResourceView *upsample_views[7] = {
+						this->scene_srv, gather_depth_srv, this->velocity_srv, this->tiles->velocity_neighbor_max_srv,
+						this->half_resolution.depth_srv, this->half_resolution.velocity_srv, this->half_resolution.blurred_srv};
+					ctx->PSSetShaderResources(0, 7, upsample_views);
+					ctx->Draw(6, 0);
+				}
+				else if (g_view_mode == VIEW_MODE_FINAL)
 				{
 					PERF_EVENT_BEGIN(ctx, "Final > Gather");
 
-					ctx->PSSetShader(this->gather_ps, nullptr, 0);
+					ctx->PSSetShader(GetGatherShader(), nullptr, 0);
 
-					ID3D11ShaderResourceView *texture_views[5];
+					ID3D11ShaderResourceView *texture_views[7];
 					texture_views[0] = this->scene_srv;
-					texture_views[1] = this->scene_depth_srv;
+					texture_views[1] = gather_depth_srv;
 					texture_views[2] = this->velocity_srv;
-					texture_views[3] = this->velocity_neighbor_max_srv;
-					texture_views[4] = this->random_srv;
-					ctx->PSSetShaderResources(0, 5, texture_views);
+					texture_views[3] = this->tiles->velocity_neighbor_max_srv;
+					texture_views[4] = (g_jitter_source == CPUBlur::JITTER_RANDOM_TEXTURE) ? this->tiles->random_srv :
+					                   (g_jitter_source == CPUBlur::JITTER_BLUE_NOISE) ? this->blue_noise_srv : nullptr;
+					texture_views[5] = g_packed_velocity_depth ? this->velocity_depth_srv : nullptr;
+					texture_views[6] = g_adaptive_samples ? this->tiles->tile_samples_srv : nullptr;
+					ctx->PSSetShaderResources(0, 7, texture_views);
+
+					if (g_tile_classification)
+					{
+						DrawClassifiedTiles(ctx);
+					}
+					else
+					{
+						ctx->Draw(6, 0);
+					}
 				}
 				// Otherwise, display the requested intermediate buffer
 				else
@@ -915,15 +2325,15 @@ public:
 						break;
 					case VIEW_MODE_VELOCITY_TILE_MAX:
 						ctx->PSSetShader(this->quad_ps, nullptr, 0);
-						ctx->PSSetShaderResources(0, 1, &this->velocity_tile_max_srv);
+						ctx->PSSetShaderResources(0, 1, &this->tiles->velocity_tile_max_srv);
 						break;
 					case VIEW_MODE_VELOCITY_NEIGHBOR_MAX:
 						ctx->PSSetShader(this->quad_ps, nullptr, 0);
-						ctx->PSSetShaderResources(0, 1, &this->velocity_neighbor_max_srv);
+						ctx->PSSetShaderResources(0, 1, &this->tiles->velocity_neighbor_max_srv);
 						break;
 					}
+					ctx->Draw(6, 0);
 				}
-				ctx->Draw(6, 0);
 				PERF_EVENT_END(ctx);
 			}
 
@@ -931,8 +2341,23 @@ public:
 			ID3D11ShaderResourceView *nullAttach[16] = {nullptr};
 			ctx->PSSetShaderResources(0, 16, nullAttach);
 			ctx->OMSetRenderTargets(0, nullptr, nullptr);
+
+			// Keep the final image for the frames that reuse it; the key is taken ahead of the passes, which update
+			// the camera transforms it was built from
+			if (g_temporal_reuse)
+			{
+				PERF_EVENT_SCOPED(ctx, "Temporal Reuse > Store");
+				CopyFinalCache(device, ctx, pRTV, true);
+				this->final_cache_key = frame_key;
+				this->final_cache_valid = (this->final_cache_tex != nullptr);
+			}
 		}
 		PERF_FRAME_END(ctx);
+
+		if (g_check_k_sweep)
+		{
+			EndKSweepFrame();
+		}
 	}
 };
 
@@ -1012,6 +2437,43 @@ public:
 			double fps = (averageTime > 0) ? 1.0 / averageTime : 0.0;
 			sprintf_s(msg, "%.1f FPS", fps);
 			TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			if (g_tile_classification && g_view_mode == VIEW_MODE_FINAL)
+			{
+				sprintf_s(msg, "Tiles: no blur %u, uniform %u, complex %u", g_tile_class_counts[TILE_CLASS_NO_BLUR], g_tile_class_counts[TILE_CLASS_UNIFORM], g_tile_class_counts[TILE_CLASS_COMPLEX]);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_adaptive_samples && g_view_mode == VIEW_MODE_FINAL)
+			{
+				sprintf_s(msg, "Average taps per pixel: %.2f", g_average_taps_per_pixel);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_incremental_tiles)
+			{
+				sprintf_s(msg, "Incremental tiles: TileMax %.1f%%, NeighborMax %.1f%%", 100.0f * g_incremental_tile_max_fraction, 100.0f * g_incremental_neighbor_max_fraction);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_temporal_reuse)
+			{
+				sprintf_s(msg, "Temporal reuse: passes skipped on %u frames", g_skipped_pass_frames);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_quantized_vertices)
+			{
+				sprintf_s(msg, "Vertex buffers: %.1f KB quantized, %.1f KB float", g_vertex_buffer_bytes[1] / 1024.0f, g_vertex_buffer_bytes[0] / 1024.0f);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_render_queue)
+			{
+				sprintf_s(msg, "Render queue: %u draws, %u state changes, %u bindings skipped", g_render_queue_stats.draw_count,
+				          g_render_queue_stats.get_state_changes(), g_render_queue_stats.skipped_bindings);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
+			if (g_instance_count > 0)
+			{
+				sprintf_s(msg, "Instanced blades: %d in one draw, %.2f MB uploaded, transforms %.3f ms", g_instance_count,
+				          g_instance_count * sizeof(CPUBlur::InstanceTransforms) / (1024.0f * 1024.0f), g_instance_update_ms);
+				TwAddTextLine(msg, 0xFF9BD839, 0xFF000000);
+			}
 			TwEndText();
 
 			TwDraw();
@@ -1065,6 +2527,9 @@ public:
 
 		TwAddVarRW(settings_bar, "Pause Animation", TW_TYPE_BOOLCPP, &g_sailSpeedPaused, "group='' key=SPACE");
 		TwAddVarRW(settings_bar, "Sail Speed", TW_TYPE_FLOAT, &g_sailSpeed, "group='' min=0 max=700 step=1.0 keydecr=o keyincr=p");
+		TwAddVarRW(settings_bar, "Quantized Vertices", TW_TYPE_BOOLCPP, &g_quantized_vertices, "group=''");
+		TwAddVarRW(settings_bar, "Instanced Blades", TW_TYPE_INT32, &g_instance_count, "group='' min=0 max=65536 step=256");
+		TwAddVarRW(settings_bar, "Render Queue", TW_TYPE_BOOLCPP, &g_render_queue, "group=''");
 		TwAddVarRW(settings_bar, "Exposure Fraction", TW_TYPE_FLOAT, &g_Exposure, "group='Reconstruction' min=0.0 max=1.0 step=0.001 keydecr=k keyincr=l");
 		TwAddVarRW(settings_bar, "Max Blur Radius", TW_TYPE_UINT32, &g_K, "group='Reconstruction' min=1 max=20 step=1 keydecr=n keyincr=m");
 		TwAddVarRW(settings_bar, "Reconstruction Samples", TW_TYPE_UINT32, &g_S, "group='Reconstruction' min=1 max=20 step=2 keydecr=, keyincr=.");
@@ -1079,6 +2544,38 @@ public:
 			TwType enumModeType = TwDefineEnum("RenderMode", enumModeTypeEV, sizeof(enumModeTypeEV) / sizeof(enumModeTypeEV[0]));
 			TwAddVarRW(settings_bar, "View Mode", enumModeType, &g_view_mode, "keyIncr=v keyDecr=V");
 		}
+		{
+			TwEnumVal enumTileMaxModeEV[] = {
+				{TILE_MAX_MODE_SINGLE_PASS, "Single Pass (K x K)"},
+				{TILE_MAX_MODE_SEPARABLE, "Separable (K x 1, 1 x K)"},
+				{TILE_MAX_MODE_FUSED, "Fused with NeighborMax (compute)"}};
+			TwType enumTileMaxModeType = TwDefineEnum("TileMaxMode", enumTileMaxModeEV, sizeof(enumTileMaxModeEV) / sizeof(enumTileMaxModeEV[0]));
+			TwAddVarRW(settings_bar, "TileMax Mode", enumTileMaxModeType, &g_tile_max_mode, "group='Reconstruction'");
+		}
+		{
+			TwEnumVal enumJitterSourceEV[] = {
+				{CPUBlur::JITTER_RANDOM_TEXTURE, "Random Texture"},
+				{CPUBlur::JITTER_BLUE_NOISE, "Blue Noise"},
+				{CPUBlur::JITTER_INTERLEAVED_GRADIENT, "Interleaved Gradient Noise"}};
+			TwType enumJitterSourceType = TwDefineEnum("JitterSource", enumJitterSourceEV, sizeof(enumJitterSourceEV) / sizeof(enumJitterSourceEV[0]));
+			TwAddVarRW(settings_bar, "Jitter Source", enumJitterSourceType, &g_jitter_source, "group='Reconstruction'");
+		}
+		{
+			TwEnumVal enumVelocityEncodingEV[] = {
+				{CPUBlur::VELOCITY_ENCODING_BIAS_SCALE, "R8G8 Bias/Scale"},
+				{CPUBlur::VELOCITY_ENCODING_HALF_FLOAT, "R16G16 Float"},
+				{CPUBlur::VELOCITY_ENCODING_LOG_POLAR, "R8G8 Log-Polar"}};
+			TwType enumVelocityEncodingType = TwDefineEnum("VelocityEncoding", enumVelocityEncodingEV, sizeof(enumVelocityEncodingEV) / sizeof(enumVelocityEncodingEV[0]));
+			TwAddVarRW(settings_bar, "Velocity Format", enumVelocityEncodingType, &g_velocity_encoding, "group='Reconstruction'");
+		}
+		TwAddVarRW(settings_bar, "Linear Depth", TW_TYPE_BOOLCPP, &g_linear_depth, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Half-Resolution Gather", TW_TYPE_BOOLCPP, &g_half_resolution_gather, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Packed Velocity/Depth", TW_TYPE_BOOLCPP, &g_packed_velocity_depth, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Tile Classification", TW_TYPE_BOOLCPP, &g_tile_classification, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Adaptive Sample Count", TW_TYPE_BOOLCPP, &g_adaptive_samples, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Specialized Gather", TW_TYPE_BOOLCPP, &g_specialized_gather, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Incremental Tiles", TW_TYPE_BOOLCPP, &g_incremental_tiles, "group='Reconstruction'");
+		TwAddVarRW(settings_bar, "Temporal Reuse", TW_TYPE_BOOLCPP, &g_temporal_reuse, "group='Reconstruction'");
 	}
 };
 
@@ -1091,9 +2588,27 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 {
 	(void)hInstance;
 	(void)hPrevInstance;
-	(void)lpCmdLine;
 	(void)nCmdShow;
 
+	// "-benchmark" runs the CPU reconstruction benchmarks instead of the sample
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-benchmark"))
+	{
+		FILE *benchmark_output = nullptr;
+		if (_wfopen_s(&benchmark_output, L"cpu_benchmark.txt", L"w") == 0)
+		{
+			CPUBlur::run_benchmarks(benchmark_output);
+			fclose(benchmark_output);
+		}
+		return 0;
+	}
+
+	// "-check-k-sweep" runs the sample for the 2 * MAX_K - 1 frames of the sweep and returns its result
+	g_check_k_sweep = (lpCmdLine && wcsstr(lpCmdLine, L"-check-k-sweep"));
+	if (g_check_k_sweep)
+	{
+		_wfopen_s(&g_check_k_sweep_output, L"check_k_sweep.txt", L"w");
+	}
+
 	g_device_manager = new DeviceManager();
 
 	CModelViewerCamera eye_camera;
@@ -1119,10 +2634,16 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	PerfTracker::initialize();
 	PerfTracker::EventDesc perf_events[] = {
 		PERF_EVENT_DESC("Render Scene"),
+		PERF_EVENT_DESC("Render > Linear Depth"),
+		PERF_EVENT_DESC("Render > Pack"),
 		PERF_EVENT_DESC("Render > TileMax"),
 		PERF_EVENT_DESC("Render > NeighborMax"),
+		PERF_EVENT_DESC("Render > Classify"),
+		PERF_EVENT_DESC("Render > Tile Samples"),
 		PERF_EVENT_DESC("Final Pass"),
+		PERF_EVENT_DESC("Final > Downsample"),
 		PERF_EVENT_DESC("Final > Gather"),
+		PERF_EVENT_DESC("Final > Upsample"),
 		PERF_EVENT_DESC("Final > Display"),
 	};
 	PerfTracker::ui_setup(perf_events, sizeof(perf_events) / sizeof(PerfTracker::EventDesc), nullptr);
@@ -1133,5 +2654,10 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	PerfTracker::shutdown();
 	delete g_device_manager;
 
-	return 0;
+	if (g_check_k_sweep_output)
+	{
+		fprintf(g_check_k_sweep_output, g_check_k_sweep_result ? "FAILED\n" : "passed\n");
+		fclose(g_check_k_sweep_output);
+	}
+	return g_check_k_sweep_result;
 }
@@ -0,0 +1,382 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/mesh_optimizer.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "mesh_optimizer.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+    // Score parameters of Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+    const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    const uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+    // Position, normal and texture coordinates of one vertex, compared bit for bit
+    struct VertexKey
+    {
+        float attributes[8];
+    };
+
+    VertexKey get_vertex_key(Scene::MeshStreams const &mesh, uint32_t vertex)
+    {
+        VertexKey key;
+        memcpy(&key.attributes[0], &mesh.vertices[3 * vertex], sizeof(float) * 3);
+        memcpy(&key.attributes[3], &mesh.normals[3 * vertex], sizeof(float) * 3);
+        memcpy(&key.attributes[6], &mesh.texture_coords[2 * vertex], sizeof(float) * 2);
+        return key;
+    }
+
+    uint32_t hash_vertex_key(VertexKey const &key)
+    {
+        // FNV-1a over the attribute bits
+        uint32_t words[8];
+        memcpy(words, key.attributes, sizeof(words));
+        uint32_t hash = 2166136261u;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            hash = (hash ^ words[i]) * 16777619u;
+        }
+        return hash ^ (hash >> 15);
+    }
+
+    float forsyth_vertex_score(int32_t cache_position, uint32_t live_triangles)
+    {
+        if (live_triangles == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cache_position >= 0)
+        {
+            // The three vertices of the last triangle get a fixed score, so that the next triangle does not simply
+            // reuse its edge and turn the order into a strip
+            if (cache_position < 3)
+            {
+                score = FORSYTH_LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                float scale = 1.0f / float(Scene::MESH_OPTIMIZER_CACHE_SIZE - 3);
+                score = powf(1.0f - float(cache_position - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+
+        // Vertices with few triangles left are finished first, so that they leave no stragglers behind
+        return score + FORSYTH_VALENCE_BOOST_SCALE * powf(float(live_triangles), -FORSYTH_VALENCE_BOOST_POWER);
+    }
+}
+
+namespace Scene
+{
+    MeshStreams MeshData::get_streams() const
+    {
+        MeshStreams streams;
+        streams.num_faces = uint32_t(this->indices.size() / 3);
+        streams.indices = this->indices.data();
+        streams.num_vertices = uint32_t(this->vertices.size() / 3);
+        streams.vertices = this->vertices.data();
+        streams.normals = this->normals.data();
+        streams.texture_coords = this->texture_coords.data();
+        return streams;
+    }
+
+    void weld_vertices(MeshStreams const &mesh, MeshData &out)
+    {
+        out.indices.resize(3 * size_t(mesh.num_faces));
+        out.vertices.clear();
+        out.normals.clear();
+        out.texture_coords.clear();
+
+        // Open addressing table of welded vertices, at most half full
+        uint32_t table_size = 1;
+        while (table_size < 2 * mesh.num_vertices)
+        {
+            table_size *= 2;
+        }
+        std::vector<uint32_t> table(table_size, NO_VERTEX);
+        std::vector<VertexKey> welded;
+        std::vector<uint32_t> remap(mesh.num_vertices);
+
+        for (uint32_t vertex = 0; vertex < mesh.num_vertices; ++vertex)
+        {
+            VertexKey key = get_vertex_key(mesh, vertex);
+            uint32_t slot = hash_vertex_key(key) & (table_size - 1);
+            while (table[slot] != NO_VERTEX && memcmp(&welded[table[slot]], &key, sizeof(key)) != 0)
+            {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            if (table[slot] == NO_VERTEX)
+            {
+                table[slot] = uint32_t(welded.size());
+                welded.push_back(key);
+            }
+            remap[vertex] = table[slot];
+        }
+
+        for (size_t i = 0; i < out.indices.size(); ++i)
+        {
+            out.indices[i] = remap[mesh.indices[i]];
+        }
+
+        out.vertices.resize(3 * welded.size());
+        out.normals.resize(3 * welded.size());
+        out.texture_coords.resize(2 * welded.size());
+        for (size_t vertex = 0; vertex < welded.size(); ++vertex)
+        {
+            memcpy(&out.vertices[3 * vertex], &welded[vertex].attributes[0], sizeof(float) * 3);
+            memcpy(&out.normals[3 * vertex], &welded[vertex].attributes[3], sizeof(float) * 3);
+            memcpy(&out.texture_coords[2 * vertex], &welded[vertex].attributes[6], sizeof(float) * 2);
+        }
+    }
+
+    void optimize_vertex_cache(std::vector<uint32_t> &indices, uint32_t num_vertices)
+    {
+        uint32_t num_faces = uint32_t(indices.size() / 3);
+        if (num_faces == 0)
+        {
+            return;
+        }
+
+        // Triangles not yet emitted around each vertex: live_triangles[v] entries from first_triangle[v]
+        std::vector<uint32_t> live_triangles(num_vertices, 0);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            ++live_triangles[indices[i]];
+        }
+        std::vector<uint32_t> first_triangle(num_vertices + 1, 0);
+        for (uint32_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            first_triangle[vertex + 1] = first_triangle[vertex] + live_triangles[vertex];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(first_triangle.begin(), first_triangle.end() - 1);
+            for (uint32_t face = 0; face < num_faces; ++face)
+            {
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    adjacency[fill[indices[3 * face + corner]]++] = face;
+                }
+            }
+        }
+
+        std::vector<int32_t> cache_position(num_vertices, -1);
+        std::vector<float> vertex_score(num_vertices);
+        for (uint32_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            vertex_score[vertex] = forsyth_vertex_score(-1, live_triangles[vertex]);
+        }
+        std::vector<float> triangle_score(num_faces);
+        std::vector<bool> emitted(num_faces, false);
+        for (uint32_t face = 0; face < num_faces; ++face)
+        {
+            triangle_score[face] = vertex_score[indices[3 * face + 0]] + vertex_score[indices[3 * face + 1]] + vertex_score[indices[3 * face + 2]];
+        }
+
+        std::vector<uint32_t> ordered;
+        ordered.reserve(indices.size());
+        uint32_t cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+        uint32_t cache_count = 0;
+        int64_t best_face = -1;
+
+        while (ordered.size() < indices.size())
+        {
+            // Nothing left around the cache: start over from the best remaining triangle. This scan runs once per
+            // connected piece of the mesh, not per triangle.
+            if (best_face < 0)
+            {
+                float best_score = -1.0f;
+                for (uint32_t face = 0; face < num_faces; ++face)
+                {
+                    if (!emitted[face] && triangle_score[face] > best_score)
+                    {
+                        best_score = triangle_score[face];
+                        best_face = face;
+                    }
+                }
+            }
+
+            uint32_t const *corners = &indices[3 * size_t(best_face)];
+            ordered.insert(ordered.end(), corners, corners + 3);
+            emitted[size_t(best_face)] = true;
+
+            // Take the triangle off its vertices' lists
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t vertex = corners[corner];
+                uint32_t *list = &adjacency[first_triangle[vertex]];
+                uint32_t *found = std::find(list, list + live_triangles[vertex], uint32_t(best_face));
+                std::swap(*found, list[live_triangles[vertex] - 1]);
+                --live_triangles[vertex];
+            }
+
+            // Move its vertices to the front of the LRU cache; whatever falls past the end is evicted
+            uint32_t new_cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+            uint32_t new_count = 0;
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                new_cache[new_count++] = corners[corner];
+            }
+            for (uint32_t i = 0; i < cache_count; ++i)
+            {
+                uint32_t vertex = cache[i];
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                {
+                    new_cache[new_count++] = vertex;
+                }
+            }
+
+            // Rescore every vertex that moved and the live triangles around it
+            best_face = -1;
+            float best_score = -1.0f;
+            for (uint32_t i = 0; i < new_count; ++i)
+            {
+                uint32_t vertex = new_cache[i];
+                cache_position[vertex] = (i < MESH_OPTIMIZER_CACHE_SIZE) ? int32_t(i) : -1;
+                float score = forsyth_vertex_score(cache_position[vertex], live_triangles[vertex]);
+                float delta = score - vertex_score[vertex];
+                vertex_score[vertex] = score;
+                uint32_t const *list = &adjacency[first_triangle[vertex]];
+                for (uint32_t t = 0; t < live_triangles[vertex]; ++t)
+                {
+                    triangle_score[list[t]] += delta;
+                }
+            }
+            for (uint32_t i = 0; i < new_count && i < MESH_OPTIMIZER_CACHE_SIZE; ++i)
+            {
+                uint32_t vertex = new_cache[i];
+                uint32_t const *list = &adjacency[first_triangle[vertex]];
+                for (uint32_t t = 0; t < live_triangles[vertex]; ++t)
+                {
+                    if (triangle_score[list[t]] > best_score)
+                    {
+                        best_score = triangle_score[list[t]];
+                        best_face = list[t];
+                    }
+                }
+            }
+
+            cache_count = std::min(new_count, MESH_OPTIMIZER_CACHE_SIZE);
+            memcpy(cache, new_cache, sizeof(uint32_t) * cache_count);
+        }
+
+        indices.swap(ordered);
+    }
+
+    void optimize_vertex_fetch(MeshData &mesh)
+    {
+        uint32_t num_vertices = uint32_t(mesh.vertices.size() / 3);
+        std::vector<uint32_t> remap(num_vertices, NO_VERTEX);
+        uint32_t next = 0;
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+        {
+            uint32_t &vertex = remap[mesh.indices[i]];
+            if (vertex == NO_VERTEX)
+            {
+                vertex = next++;
+            }
+            mesh.indices[i] = vertex;
+        }
+
+        MeshData reordered;
+        reordered.vertices.resize(3 * size_t(next));
+        reordered.normals.resize(3 * size_t(next));
+        reordered.texture_coords.resize(2 * size_t(next));
+        for (uint32_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            uint32_t target = remap[vertex];
+            if (target != NO_VERTEX)
+            {
+                memcpy(&reordered.vertices[3 * size_t(target)], &mesh.vertices[3 * size_t(vertex)], sizeof(float) * 3);
+                memcpy(&reordered.normals[3 * size_t(target)], &mesh.normals[3 * size_t(vertex)], sizeof(float) * 3);
+                memcpy(&reordered.texture_coords[2 * size_t(target)], &mesh.texture_coords[2 * size_t(vertex)], sizeof(float) * 2);
+            }
+        }
+        mesh.vertices.swap(reordered.vertices);
+        mesh.normals.swap(reordered.normals);
+        mesh.texture_coords.swap(reordered.texture_coords);
+    }
+
+    float compute_acmr(uint32_t const *indices, uint32_t num_indices, uint32_t num_vertices, uint32_t cache_size)
+    {
+        if (num_indices < 3)
+        {
+            return 0.0f;
+        }
+
+        // A vertex is in the FIFO while fewer than cache_size misses have happened since its own
+        std::vector<uint32_t> inserted_at(num_vertices, 0);
+        uint32_t misses = 0;
+        for (uint32_t i = 0; i < num_indices; ++i)
+        {
+            uint32_t &stamp = inserted_at[indices[i]];
+            if (stamp == 0 || misses - stamp >= cache_size)
+            {
+                stamp = ++misses;
+            }
+        }
+        return float(misses) / float(num_indices / 3);
+    }
+
+    void optimize_mesh(MeshStreams const &mesh, MeshData &out, MeshOptimizationStats *stats)
+    {
+        if (stats)
+        {
+            stats->num_vertices_before = mesh.num_vertices;
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                stats->acmr_before[i] = compute_acmr(mesh.indices, 3 * mesh.num_faces, mesh.num_vertices, MESH_OPTIMIZER_REPORT_CACHE_SIZES[i]);
+            }
+        }
+
+        weld_vertices(mesh, out);
+        optimize_vertex_cache(out.indices, uint32_t(out.vertices.size() / 3));
+        optimize_vertex_fetch(out);
+
+        if (stats)
+        {
+            MeshStreams optimized = out.get_streams();
+            stats->num_vertices_after = optimized.num_vertices;
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                stats->acmr_after[i] = compute_acmr(optimized.indices, 3 * optimized.num_faces, optimized.num_vertices, MESH_OPTIMIZER_REPORT_CACHE_SIZES[i]);
+            }
+        }
+    }
+}
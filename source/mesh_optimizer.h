@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/mesh_optimizer.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "mesh_pack.h"
+
+// Offline optimization of the scene meshes before they go into a mesh pack: vertices with identical position, normal
+// and texture coordinates are welded, the triangles are reordered for the post-transform vertex cache (Forsyth's
+// linear-speed algorithm), and the vertices are renumbered in order of first use for fetch locality. The result
+// draws the same triangles with the same winding.
+
+namespace Scene
+{
+    // Vertex cache size assumed by the triangle ordering (the score table of Forsyth's algorithm)
+    const uint32_t MESH_OPTIMIZER_CACHE_SIZE = 32;
+
+    // FIFO cache sizes at which the ACMR is reported. 16 entries is the classic post-transform cache; 32 is closer to
+    // what current GPUs reuse within a wave.
+    const uint32_t MESH_OPTIMIZER_REPORT_CACHE_SIZES[2] = {16, 32};
+
+    // A mesh owning its streams, in the layout of MeshStreams
+    struct MeshData
+    {
+        std::vector<uint32_t> indices;     // 3 per face
+        std::vector<float> vertices;       // xyz
+        std::vector<float> normals;        // xyz
+        std::vector<float> texture_coords; // uv
+
+        MeshStreams get_streams() const;
+    };
+
+    struct MeshOptimizationStats
+    {
+        uint32_t num_vertices_before;
+        uint32_t num_vertices_after;
+        float acmr_before[2]; // At each of MESH_OPTIMIZER_REPORT_CACHE_SIZES
+        float acmr_after[2];
+    };
+
+    // Merges vertices whose position, normal and texture coordinates are bitwise equal and rewrites the indices
+    void weld_vertices(MeshStreams const &mesh, MeshData &out);
+
+    // Reorders the triangles of an indexed mesh for a post-transform cache of MESH_OPTIMIZER_CACHE_SIZE entries
+    void optimize_vertex_cache(std::vector<uint32_t> &indices, uint32_t num_vertices);
+
+    // Renumbers the vertices in the order the indices first reference them; unreferenced vertices are dropped
+    void optimize_vertex_fetch(MeshData &mesh);
+
+    // Average number of vertices transformed per triangle with a FIFO cache of cache_size entries (3 with no reuse)
+    float compute_acmr(uint32_t const *indices, uint32_t num_indices, uint32_t num_vertices, uint32_t cache_size);
+
+    // Welds, then orders for the vertex cache, then for fetch; stats may be null
+    void optimize_mesh(MeshStreams const &mesh, MeshData &out, MeshOptimizationStats *stats);
+}
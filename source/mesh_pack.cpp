@@ -0,0 +1,308 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/mesh_pack.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "mesh_pack.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    uint64_t align_offset(uint64_t offset)
+    {
+        return (offset + Scene::MESH_PACK_ALIGNMENT - 1) / Scene::MESH_PACK_ALIGNMENT * Scene::MESH_PACK_ALIGNMENT;
+    }
+
+    // True if [offset, offset + bytes) is an aligned range inside a file of size bytes
+    bool is_valid_stream(uint64_t offset, uint64_t bytes, uint64_t file_size)
+    {
+        return (offset % Scene::MESH_PACK_ALIGNMENT) == 0 && offset <= file_size && bytes <= file_size - offset;
+    }
+}
+
+namespace Scene
+{
+    bool write_mesh_pack(char const *path, char const *const *names, MeshStreams const *meshes, uint32_t mesh_count)
+    {
+        MeshPackHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = MESH_PACK_MAGIC;
+        header.version = MESH_PACK_VERSION;
+        header.mesh_count = mesh_count;
+
+        // Lay the streams out after the table
+        std::vector<MeshPackEntry> entries(mesh_count);
+        uint64_t offset = align_offset(sizeof(MeshPackHeader) + sizeof(MeshPackEntry) * uint64_t(mesh_count));
+        for (uint32_t i = 0; i < mesh_count; ++i)
+        {
+            MeshPackEntry &entry = entries[i];
+            memset(&entry, 0, sizeof(entry));
+            size_t name_length = strlen(names[i]);
+            if (name_length >= MESH_PACK_NAME_LENGTH)
+            {
+                return false;
+            }
+            memcpy(entry.name, names[i], name_length);
+            entry.num_faces = meshes[i].num_faces;
+            entry.num_vertices = meshes[i].num_vertices;
+
+            entry.indices_offset = offset;
+            offset = align_offset(offset + sizeof(uint32_t) * 3 * uint64_t(entry.num_faces));
+            entry.vertices_offset = offset;
+            offset = align_offset(offset + sizeof(float) * 3 * uint64_t(entry.num_vertices));
+            entry.normals_offset = offset;
+            offset = align_offset(offset + sizeof(float) * 3 * uint64_t(entry.num_vertices));
+            entry.texture_coords_offset = offset;
+            offset = align_offset(offset + sizeof(float) * 2 * uint64_t(entry.num_vertices));
+        }
+        header.file_size = offset;
+
+        std::vector<unsigned char> file(size_t(header.file_size), 0);
+        memcpy(&file[0], &header, sizeof(header));
+        if (mesh_count > 0)
+        {
+            memcpy(&file[sizeof(header)], &entries[0], sizeof(MeshPackEntry) * mesh_count);
+        }
+        for (uint32_t i = 0; i < mesh_count; ++i)
+        {
+            MeshPackEntry const &entry = entries[i];
+            memcpy(&file[size_t(entry.indices_offset)], meshes[i].indices, sizeof(uint32_t) * 3 * entry.num_faces);
+            memcpy(&file[size_t(entry.vertices_offset)], meshes[i].vertices, sizeof(float) * 3 * entry.num_vertices);
+            memcpy(&file[size_t(entry.normals_offset)], meshes[i].normals, sizeof(float) * 3 * entry.num_vertices);
+            memcpy(&file[size_t(entry.texture_coords_offset)], meshes[i].texture_coords, sizeof(float) * 2 * entry.num_vertices);
+        }
+
+        FILE *out = nullptr;
+#ifdef _WIN32
+        fopen_s(&out, path, "wb");
+#else
+        out = fopen(path, "wb");
+#endif
+        if (!out)
+        {
+            return false;
+        }
+        bool written = fwrite(&file[0], 1, file.size(), out) == file.size();
+        return (fclose(out) == 0) && written;
+    }
+
+    MeshPackFile::MeshPackFile()
+    {
+        this->data = nullptr;
+        this->size = 0;
+#ifdef _WIN32
+        this->file = INVALID_HANDLE_VALUE;
+        this->mapping = nullptr;
+#else
+        this->fd = -1;
+#endif
+    }
+
+    MeshPackFile::~MeshPackFile()
+    {
+        this->close();
+    }
+
+#ifdef _WIN32
+    bool MeshPackFile::open(char const *path)
+    {
+        wchar_t wide_path[MAX_PATH];
+        if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wide_path, MAX_PATH) == 0)
+        {
+            return false;
+        }
+        return this->open(wide_path);
+    }
+
+    bool MeshPackFile::open(wchar_t const *path)
+    {
+        this->close();
+
+        this->file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER file_size;
+        if (this->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->file, &file_size) || file_size.QuadPart < LONGLONG(sizeof(MeshPackHeader)))
+        {
+            this->close();
+            return false;
+        }
+
+        this->mapping = CreateFileMappingW(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        this->data = this->mapping ? static_cast<unsigned char const *>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        this->size = size_t(file_size.QuadPart);
+        if (!this->data || !this->validate())
+        {
+            this->close();
+            return false;
+        }
+        return true;
+    }
+
+    void MeshPackFile::close()
+    {
+        if (this->data)
+        {
+            UnmapViewOfFile(this->data);
+        }
+        if (this->mapping)
+        {
+            CloseHandle(this->mapping);
+        }
+        if (this->file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(this->file);
+        }
+        this->data = nullptr;
+        this->size = 0;
+        this->mapping = nullptr;
+        this->file = INVALID_HANDLE_VALUE;
+    }
+#else
+    bool MeshPackFile::open(char const *path)
+    {
+        this->close();
+
+        this->fd = ::open(path, O_RDONLY);
+        struct stat file_stat;
+        if (this->fd < 0 || fstat(this->fd, &file_stat) != 0 || file_stat.st_size < off_t(sizeof(MeshPackHeader)))
+        {
+            this->close();
+            return false;
+        }
+
+        void *mapped = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_SHARED, this->fd, 0);
+        this->data = (mapped != MAP_FAILED) ? static_cast<unsigned char const *>(mapped) : nullptr;
+        this->size = size_t(file_stat.st_size);
+        if (!this->data || !this->validate())
+        {
+            this->close();
+            return false;
+        }
+        return true;
+    }
+
+    void MeshPackFile::close()
+    {
+        if (this->data)
+        {
+            munmap(const_cast<unsigned char *>(this->data), this->size);
+        }
+        if (this->fd >= 0)
+        {
+            ::close(this->fd);
+        }
+        this->data = nullptr;
+        this->size = 0;
+        this->fd = -1;
+    }
+#endif
+
+    bool MeshPackFile::validate() const
+    {
+        MeshPackHeader const *header = reinterpret_cast<MeshPackHeader const *>(this->data);
+        if (header->magic != MESH_PACK_MAGIC || header->version != MESH_PACK_VERSION || header->file_size != this->size)
+        {
+            return false;
+        }
+        if (!is_valid_stream(0, sizeof(MeshPackHeader) + sizeof(MeshPackEntry) * uint64_t(header->mesh_count), this->size))
+        {
+            return false;
+        }
+
+        MeshPackEntry const *entries = this->get_entries();
+        for (uint32_t i = 0; i < header->mesh_count; ++i)
+        {
+            MeshPackEntry const &entry = entries[i];
+            if (memchr(entry.name, 0, MESH_PACK_NAME_LENGTH) == nullptr ||
+                !is_valid_stream(entry.indices_offset, sizeof(uint32_t) * 3 * uint64_t(entry.num_faces), this->size) ||
+                !is_valid_stream(entry.vertices_offset, sizeof(float) * 3 * uint64_t(entry.num_vertices), this->size) ||
+                !is_valid_stream(entry.normals_offset, sizeof(float) * 3 * uint64_t(entry.num_vertices), this->size) ||
+                !is_valid_stream(entry.texture_coords_offset, sizeof(float) * 2 * uint64_t(entry.num_vertices), this->size))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MeshPackEntry const *MeshPackFile::get_entries() const
+    {
+        return reinterpret_cast<MeshPackEntry const *>(this->data + sizeof(MeshPackHeader));
+    }
+
+    uint32_t MeshPackFile::get_mesh_count() const
+    {
+        return this->data ? reinterpret_cast<MeshPackHeader const *>(this->data)->mesh_count : 0;
+    }
+
+    char const *MeshPackFile::get_mesh_name(uint32_t index) const
+    {
+        return this->get_entries()[index].name;
+    }
+
+    MeshStreams MeshPackFile::get_mesh(uint32_t index) const
+    {
+        MeshPackEntry const &entry = this->get_entries()[index];
+        MeshStreams streams;
+        streams.num_faces = entry.num_faces;
+        streams.indices = reinterpret_cast<unsigned int const *>(this->data + entry.indices_offset);
+        streams.num_vertices = entry.num_vertices;
+        streams.vertices = reinterpret_cast<float const *>(this->data + entry.vertices_offset);
+        streams.normals = reinterpret_cast<float const *>(this->data + entry.normals_offset);
+        streams.texture_coords = reinterpret_cast<float const *>(this->data + entry.texture_coords_offset);
+        return streams;
+    }
+
+    bool MeshPackFile::find_mesh(char const *name, MeshStreams &out) const
+    {
+        for (uint32_t i = 0; i < this->get_mesh_count(); ++i)
+        {
+            if (strcmp(this->get_mesh_name(i), name) == 0)
+            {
+                out = this->get_mesh(i);
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/mesh_pack.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary mesh container (.meshpack) replacing the compiled-in arrays of assets/. A pack holds a header, a table of
+// meshes and, for each mesh, its index, position, normal and texture coordinate streams. Every stream starts on a
+// MESH_PACK_ALIGNMENT boundary and is stored exactly as RenderObject uploads it, so the pointers into a mapped pack
+// go straight to Scene::load_model. Values are little-endian, as on every target of the sample.
+
+namespace Scene
+{
+    const uint32_t MESH_PACK_MAGIC = 0x4B50534D; // "MSPK"
+    const uint32_t MESH_PACK_VERSION = 1;
+    const uint32_t MESH_PACK_ALIGNMENT = 64;
+    const uint32_t MESH_PACK_NAME_LENGTH = 32;
+
+    struct MeshPackHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t mesh_count;
+        uint32_t reserved;
+        uint64_t file_size;
+    };
+
+    // Offsets are in bytes from the start of the file
+    struct MeshPackEntry
+    {
+        char name[MESH_PACK_NAME_LENGTH]; // Zero-terminated
+        uint32_t num_faces;
+        uint32_t num_vertices;
+        uint64_t indices_offset;        // 3 * num_faces uint32_t
+        uint64_t vertices_offset;       // 3 * num_vertices float, xyz
+        uint64_t normals_offset;        // 3 * num_vertices float, xyz
+        uint64_t texture_coords_offset; // 2 * num_vertices float, uv
+    };
+
+    // Streams of one mesh, in the form load_model takes them
+    struct MeshStreams
+    {
+        unsigned int num_faces;
+        unsigned int const *indices;
+        unsigned int num_vertices;
+        float const *vertices;
+        float const *normals;
+        float const *texture_coords;
+    };
+
+    // Writes mesh_count meshes to a new pack at path; false if the file cannot be written or a name does not fit
+    bool write_mesh_pack(char const *path, char const *const *names, MeshStreams const *meshes, uint32_t mesh_count);
+
+    // Read-only memory mapping of a pack. The MeshStreams it returns point into the mapping and stay valid until
+    // close() or destruction.
+    class MeshPackFile
+    {
+    public:
+        MeshPackFile();
+        ~MeshPackFile();
+
+        // Maps the file and checks the header and every stream against the file size; false if any of it fails
+        bool open(char const *path);
+#ifdef _WIN32
+        bool open(wchar_t const *path);
+#endif
+        void close();
+
+        bool is_open() const { return this->data != nullptr; }
+        size_t get_size() const { return this->size; }
+
+        uint32_t get_mesh_count() const;
+        char const *get_mesh_name(uint32_t index) const;
+        MeshStreams get_mesh(uint32_t index) const;
+        bool find_mesh(char const *name, MeshStreams &out) const;
+
+    private:
+        MeshPackFile(MeshPackFile const &);
+        MeshPackFile &operator=(MeshPackFile const &);
+
+        bool validate() const;
+        MeshPackEntry const *get_entries() const;
+
+        unsigned char const *data;
+        size_t size;
+#ifdef _WIN32
+        void *file;
+        void *mapping;
+#else
+        int fd;
+#endif
+    };
+}
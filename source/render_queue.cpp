@@ -0,0 +1,289 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/render_queue.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "render_queue.h"
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+    const uint32_t RADIX_BITS = 8;
+    const uint32_t RADIX_BUCKETS = 1u << RADIX_BITS;
+
+    uint64_t get_field(uint32_t value, uint32_t bits)
+    {
+        return uint64_t(std::min(value, (1u << bits) - 1u));
+    }
+
+    // Non-negative floats order as their bit patterns; the top RENDER_QUEUE_DEPTH_BITS of those
+    uint64_t get_depth_field(float depth)
+    {
+        float clamped = std::max(depth, 0.0f);
+        uint32_t bits;
+        memcpy(&bits, &clamped, sizeof(bits));
+        return uint64_t(bits >> (31 - Scene::RENDER_QUEUE_DEPTH_BITS));
+    }
+}
+
+namespace Scene
+{
+    uint64_t make_sort_key(uint32_t layout_rank, DrawItem const &item)
+    {
+        // Handles past their field share its last value: still correct, only less well grouped
+        uint64_t key = get_field(layout_rank, RENDER_QUEUE_LAYOUT_BITS);
+        key = (key << RENDER_QUEUE_SHADER_BITS) | get_field(item.shader, RENDER_QUEUE_SHADER_BITS);
+        key = (key << RENDER_QUEUE_MATERIAL_BITS) | get_field(item.material, RENDER_QUEUE_MATERIAL_BITS);
+        key = (key << RENDER_QUEUE_GEOMETRY_BITS) | get_field(item.geometry, RENDER_QUEUE_GEOMETRY_BITS);
+        key = (key << RENDER_QUEUE_DEPTH_BITS) | get_depth_field(item.depth);
+        return key;
+    }
+
+    void radix_sort(std::vector<uint64_t> &keys, std::vector<uint32_t> &order)
+    {
+        uint32_t count = uint32_t(keys.size());
+        order.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            order[i] = i;
+        }
+
+        // One histogram per byte, from a single read of the keys
+        std::vector<uint32_t> histograms(RADIX_BUCKETS * 8, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (uint32_t pass = 0; pass < 8; ++pass)
+            {
+                ++histograms[pass * RADIX_BUCKETS + uint32_t(keys[i] >> (pass * RADIX_BITS)) % RADIX_BUCKETS];
+            }
+        }
+
+        std::vector<uint64_t> sorted_keys(count);
+        std::vector<uint32_t> sorted_order(count);
+        for (uint32_t pass = 0; pass < 8; ++pass)
+        {
+            uint32_t *histogram = &histograms[pass * RADIX_BUCKETS];
+            if (count == 0 || histogram[uint32_t(keys[0] >> (pass * RADIX_BITS)) % RADIX_BUCKETS] == count)
+            {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+            {
+                uint32_t bucket_count = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucket_count;
+            }
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t destination = histogram[uint32_t(keys[i] >> (pass * RADIX_BITS)) % RADIX_BUCKETS]++;
+                sorted_keys[destination] = keys[i];
+                sorted_order[destination] = order[i];
+            }
+            keys.swap(sorted_keys);
+            order.swap(sorted_order);
+        }
+    }
+
+    void RenderQueue::clear()
+    {
+        this->items.clear();
+        this->keys.clear();
+        this->sorted_keys.clear();
+        this->order.clear();
+        this->layout_keys.clear();
+    }
+
+    void RenderQueue::push(DrawItem const &item)
+    {
+        uint32_t layout_rank = uint32_t(std::find(this->layout_keys.begin(), this->layout_keys.end(), item.layout_key) - this->layout_keys.begin());
+        if (layout_rank == this->layout_keys.size())
+        {
+            this->layout_keys.push_back(item.layout_key);
+        }
+        this->items.push_back(item);
+        this->keys.push_back(make_sort_key(layout_rank, item));
+    }
+
+    void RenderQueue::sort()
+    {
+        this->sorted_keys = this->keys;
+        radix_sort(this->sorted_keys, this->order);
+    }
+
+    RenderQueueStats RenderQueue::submit(CommandBackend &backend) const
+    {
+        RenderQueueStats stats;
+        memset(&stats, 0, sizeof(stats));
+
+        DrawItem bound;
+        bound.layout_key = bound.shader = bound.material = bound.geometry = bound.object_constants = bound.instance_data = RENDER_QUEUE_NONE;
+
+        uint32_t count = uint32_t(this->items.size());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            DrawItem const &item = this->items[(this->order.size() == count) ? this->order[i] : i];
+            if (item.layout_key != bound.layout_key)
+            {
+                backend.set_input_layout(item.layout_key);
+                bound.layout_key = item.layout_key;
+                ++stats.layout_changes;
+            }
+            if (item.shader != bound.shader)
+            {
+                backend.set_vertex_shader(item.shader);
+                bound.shader = item.shader;
+                ++stats.shader_changes;
+            }
+            if (item.material != bound.material)
+            {
+                backend.set_material(item.material);
+                bound.material = item.material;
+                ++stats.material_changes;
+            }
+            if (item.geometry != bound.geometry)
+            {
+                backend.set_geometry(item.geometry);
+                bound.geometry = item.geometry;
+                ++stats.geometry_changes;
+            }
+            if (item.object_constants != bound.object_constants)
+            {
+                backend.set_object_constants(item.object_constants);
+                bound.object_constants = item.object_constants;
+                ++stats.constant_changes;
+            }
+
+            // Non-instanced draws do not read the instance data, so whatever is bound can stay
+            if (item.instance_data != RENDER_QUEUE_NONE && item.instance_data != bound.instance_data)
+            {
+                backend.set_instance_data(item.instance_data);
+                bound.instance_data = item.instance_data;
+                ++stats.instance_changes;
+            }
+
+            backend.draw(item);
+            ++stats.draw_count;
+        }
+
+        // Six bindings per draw without the tracking, five for one that is not instanced
+        uint32_t bindings = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            bindings += (this->items[i].instance_data != RENDER_QUEUE_NONE) ? 6 : 5;
+        }
+        stats.skipped_bindings = bindings - stats.get_state_changes();
+        return stats;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    RecordingBackend::RecordingBackend()
+    {
+        this->clear();
+    }
+
+    void RecordingBackend::clear()
+    {
+        this->commands.clear();
+        this->draws.clear();
+        this->bound_at_draw.clear();
+        memset(this->command_counts, 0, sizeof(this->command_counts));
+        memset(&this->bound, 0xFF, sizeof(this->bound));
+    }
+
+    void RecordingBackend::set_input_layout(uint32_t layout_key)
+    {
+        this->bound.layout_key = layout_key;
+        this->commands.push_back(Command{COMMAND_INPUT_LAYOUT, layout_key});
+        ++this->command_counts[COMMAND_INPUT_LAYOUT];
+    }
+
+    void RecordingBackend::set_vertex_shader(uint32_t shader)
+    {
+        this->bound.shader = shader;
+        this->commands.push_back(Command{COMMAND_VERTEX_SHADER, shader});
+        ++this->command_counts[COMMAND_VERTEX_SHADER];
+    }
+
+    void RecordingBackend::set_material(uint32_t material)
+    {
+        this->bound.material = material;
+        this->commands.push_back(Command{COMMAND_MATERIAL, material});
+        ++this->command_counts[COMMAND_MATERIAL];
+    }
+
+    void RecordingBackend::set_geometry(uint32_t geometry)
+    {
+        this->bound.geometry = geometry;
+        this->commands.push_back(Command{COMMAND_GEOMETRY, geometry});
+        ++this->command_counts[COMMAND_GEOMETRY];
+    }
+
+    void RecordingBackend::set_object_constants(uint32_t object_constants)
+    {
+        this->bound.object_constants = object_constants;
+        this->commands.push_back(Command{COMMAND_OBJECT_CONSTANTS, object_constants});
+        ++this->command_counts[COMMAND_OBJECT_CONSTANTS];
+    }
+
+    void RecordingBackend::set_instance_data(uint32_t instance_data)
+    {
+        this->bound.instance_data = instance_data;
+        this->commands.push_back(Command{COMMAND_INSTANCE_DATA, instance_data});
+        ++this->command_counts[COMMAND_INSTANCE_DATA];
+    }
+
+    void RecordingBackend::draw(DrawItem const &item)
+    {
+        this->commands.push_back(Command{COMMAND_DRAW, uint32_t(this->draws.size())});
+        ++this->command_counts[COMMAND_DRAW];
+        this->draws.push_back(item);
+        this->bound_at_draw.push_back(this->bound);
+    }
+
+    bool RecordingBackend::check_bound_state() const
+    {
+        for (size_t i = 0; i < this->draws.size(); ++i)
+        {
+            DrawItem const &item = this->draws[i];
+            DrawItem const &bound = this->bound_at_draw[i];
+            if (item.layout_key != bound.layout_key || item.shader != bound.shader || item.material != bound.material || item.geometry != bound.geometry ||
+                item.object_constants != bound.object_constants || (item.instance_data != RENDER_QUEUE_NONE && item.instance_data != bound.instance_data))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
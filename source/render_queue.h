@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/render_queue.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Sorted submission of the scene draws. Each draw names its state by handles into the tables of a CommandBackend;
+// the queue orders the draws by a 64-bit key of that state and their depth, and binds only what differs from the
+// previous draw. The queue does not depend on D3D: D3D11CommandBackend (scene.h) issues the draws, and
+// RecordingBackend records them, so the sorting and the state tracking can be measured on any platform.
+
+namespace Scene
+{
+    const uint32_t RENDER_QUEUE_NONE = 0xFFFFFFFFu; // No instance data, or nothing bound yet
+
+    // Widths of the sort key fields, from the most significant: layout, vertex shader, material, geometry, depth
+    const uint32_t RENDER_QUEUE_LAYOUT_BITS = 6;
+    const uint32_t RENDER_QUEUE_SHADER_BITS = 8;
+    const uint32_t RENDER_QUEUE_MATERIAL_BITS = 12;
+    const uint32_t RENDER_QUEUE_GEOMETRY_BITS = 14;
+    const uint32_t RENDER_QUEUE_DEPTH_BITS = 24;
+
+    struct DrawItem
+    {
+        uint32_t layout_key;       // LayoutDesc::key of the geometry
+        uint32_t shader;           // Vertex shader handle
+        uint32_t material;         // Material handle (pixel shader resources)
+        uint32_t geometry;         // Vertex and index buffer handle
+        uint32_t object_constants; // Handle of the cbObject buffer
+        uint32_t instance_data;    // Handle of the per-instance data, or RENDER_QUEUE_NONE
+        uint32_t index_count;
+        uint32_t first_index;
+        int32_t base_vertex;
+        uint32_t instance_count; // 0 for a non-instanced draw
+        float depth;             // View-space depth; equal state draws front to back
+    };
+
+    // Where the queue's bindings and draws go. Handles index the backend's own tables.
+    class CommandBackend
+    {
+    public:
+        virtual ~CommandBackend() {}
+        virtual void set_input_layout(uint32_t layout_key) = 0;
+        virtual void set_vertex_shader(uint32_t shader) = 0;
+        virtual void set_material(uint32_t material) = 0;
+        virtual void set_geometry(uint32_t geometry) = 0;
+        virtual void set_object_constants(uint32_t object_constants) = 0;
+        virtual void set_instance_data(uint32_t instance_data) = 0;
+        virtual void draw(DrawItem const &item) = 0;
+    };
+
+    // Bindings issued and skipped by one RenderQueue::submit
+    struct RenderQueueStats
+    {
+        uint32_t draw_count;
+        uint32_t layout_changes;
+        uint32_t shader_changes;
+        uint32_t material_changes;
+        uint32_t geometry_changes;
+        uint32_t constant_changes;
+        uint32_t instance_changes;
+        uint32_t skipped_bindings; // Bindings equal to the bound state
+
+        uint32_t get_state_changes() const
+        {
+            return layout_changes + shader_changes + material_changes + geometry_changes + constant_changes + instance_changes;
+        }
+    };
+
+    // Layouts are ranked in the order they are first pushed, since LayoutDesc::key does not fit the key's field
+    uint64_t make_sort_key(uint32_t layout_rank, DrawItem const &item);
+
+    // Stable LSD radix sort of keys, eight bits per pass, skipping the passes whose byte is the same in every key.
+    // order receives the indices of keys in sorted order; keys is left sorted.
+    void radix_sort(std::vector<uint64_t> &keys, std::vector<uint32_t> &order);
+
+    class RenderQueue
+    {
+    public:
+        void clear();
+        void push(DrawItem const &item);
+
+        // Orders the draws by their sort keys; without it, or after a later push, they are submitted in push order
+        void sort();
+
+        // Binds what each draw changes and issues it; every binding is treated as unknown at the start
+        RenderQueueStats submit(CommandBackend &backend) const;
+
+        uint32_t get_draw_count() const { return uint32_t(this->items.size()); }
+
+    private:
+        std::vector<DrawItem> items;
+        std::vector<uint64_t> keys;
+        std::vector<uint64_t> sorted_keys;
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> layout_keys; // By rank
+    };
+
+    // Records every binding and draw with the state bound at each draw, for measuring and checking a submission
+    class RecordingBackend : public CommandBackend
+    {
+    public:
+        enum CommandType
+        {
+            COMMAND_INPUT_LAYOUT,
+            COMMAND_VERTEX_SHADER,
+            COMMAND_MATERIAL,
+            COMMAND_GEOMETRY,
+            COMMAND_OBJECT_CONSTANTS,
+            COMMAND_INSTANCE_DATA,
+            COMMAND_DRAW,
+            COMMAND_TYPE_COUNT
+        };
+
+        struct Command
+        {
+            CommandType type;
+            uint32_t value; // Handle or layout key; the index of the DrawItem in draws for COMMAND_DRAW
+        };
+
+        RecordingBackend();
+        void clear();
+
+        virtual void set_input_layout(uint32_t layout_key);
+        virtual void set_vertex_shader(uint32_t shader);
+        virtual void set_material(uint32_t material);
+        virtual void set_geometry(uint32_t geometry);
+        virtual void set_object_constants(uint32_t object_constants);
+        virtual void set_instance_data(uint32_t instance_data);
+        virtual void draw(DrawItem const &item);
+
+        // Whether each recorded draw ran with the bindings its DrawItem asks for
+        bool check_bound_state() const;
+
+        std::vector<Command> const &get_commands() const { return this->commands; }
+        uint32_t get_command_count(CommandType type) const { return this->command_counts[type]; }
+
+    private:
+        std::vector<Command> commands;
+        uint32_t command_counts[COMMAND_TYPE_COUNT];
+
+        // The bound state (as a DrawItem) and, per draw, the item and the state it ran with
+        DrawItem bound;
+        std::vector<DrawItem> draws;
+        std::vector<DrawItem> bound_at_draw;
+    };
+}
@@ -35,6 +35,8 @@
 #include "common_util.h"
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <string.h>
 #include "scene.h"
 #include <DDSTextureLoader.h>
 #include <SDKmisc.h>
@@ -47,6 +49,95 @@ namespace
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    struct ElementFormat
+    {
+        DXGI_FORMAT format;
+        UINT size;
+    };
+
+    ElementFormat get_position_format(UINT position)
+    {
+        switch (position)
+        {
+        case Scene::VTXLAYOUTDESC_POSITION_FLOAT2:
+            return {DXGI_FORMAT_R32G32_FLOAT, 8};
+        case Scene::VTXLAYOUTDESC_POSITION_FLOAT3:
+            return {DXGI_FORMAT_R32G32B32_FLOAT, 12};
+        case Scene::VTXLAYOUTDESC_POSITION_UNORM16X4:
+            return {DXGI_FORMAT_R16G16B16A16_UNORM, 8};
+        default:
+            return {DXGI_FORMAT_UNKNOWN, 0};
+        }
+    }
+
+    // Normal, tangent and bitangent
+    ElementFormat get_nbt_format(UINT nbt)
+    {
+        switch (nbt)
+        {
+        case Scene::VTXLAYOUTDESC_NBT_FLOAT3:
+            return {DXGI_FORMAT_R32G32B32_FLOAT, 12};
+        case Scene::VTXLAYOUTDESC_NBT_OCT_SNORM16:
+            return {DXGI_FORMAT_R16G16_SNORM, 4};
+        default:
+            return {DXGI_FORMAT_UNKNOWN, 0};
+        }
+    }
+
+    // There are no 3-component 8- and 16-bit formats, so those are padded to 4 components
+    ElementFormat get_texcoord_format(UINT tc, bool half)
+    {
+        const ElementFormat formats[8] = {
+            {DXGI_FORMAT_R8_UNORM, 1}, {DXGI_FORMAT_R8G8_UNORM, 2}, {DXGI_FORMAT_R8G8B8A8_UNORM, 4}, {DXGI_FORMAT_R8G8B8A8_UNORM, 4},
+            {DXGI_FORMAT_R32_FLOAT, 4}, {DXGI_FORMAT_R32G32_FLOAT, 8}, {DXGI_FORMAT_R32G32B32_FLOAT, 12}, {DXGI_FORMAT_R32G32B32A32_FLOAT, 16}};
+        const ElementFormat half_formats[4] = {
+            {DXGI_FORMAT_R16_FLOAT, 2}, {DXGI_FORMAT_R16G16_FLOAT, 4}, {DXGI_FORMAT_R16G16B16A16_FLOAT, 8}, {DXGI_FORMAT_R16G16B16A16_FLOAT, 8}};
+        if (half && tc >= Scene::VTXLAYOUTDESC_TEXCOORD_FLOAT1)
+        {
+            return half_formats[tc - Scene::VTXLAYOUTDESC_TEXCOORD_FLOAT1];
+        }
+        return formats[tc & 7];
+    }
+
+    // Elements of a layout in the order of the vertex buffers: position, normal, tangent, bitangent, texture
+    // coordinates. Returns their count; out_size receives the bytes per vertex over all of them.
+    UINT get_layout_elements(Scene::LayoutDesc layout, D3D11_INPUT_ELEMENT_DESC *elements, UINT *out_size)
+    {
+        UINT count = 0;
+        UINT offset = 0;
+        auto add = [&](char const *semantic, UINT index, ElementFormat format) {
+            if (format.size == 0)
+            {
+                return;
+            }
+            D3D11_INPUT_ELEMENT_DESC &element = elements[count];
+            element.SemanticName = semantic;
+            element.SemanticIndex = index;
+            element.Format = format.format;
+            element.InputSlot = layout.desc.interleaved ? 0 : count;
+            element.AlignedByteOffset = layout.desc.interleaved ? offset : 0;
+            element.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+            element.InstanceDataStepRate = 0;
+            offset += format.size;
+            ++count;
+        };
+
+        add("POSITION", 0, get_position_format(layout.desc.position));
+        add("NORMAL", 0, get_nbt_format(layout.desc.normal));
+        add("TANGENT", 0, get_nbt_format(layout.desc.tangent));
+        add("BINORMAL", 0, get_nbt_format(layout.desc.bitangent));
+        UINT tcs[4] = {layout.desc.tc0, layout.desc.tc1, layout.desc.tc2, layout.desc.tc3};
+        for (UINT tc = 0; tc < layout.desc.tc_count && tc < 4; ++tc)
+        {
+            add("TEXCOORD", tc, get_texcoord_format(tcs[tc], layout.desc.tc_half != 0));
+        }
+        if (out_size)
+        {
+            *out_size = offset;
+        }
+        return count;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 }
@@ -55,6 +146,37 @@ namespace Scene
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    UINT get_vertex_size(LayoutDesc layout)
+    {
+        D3D11_INPUT_ELEMENT_DESC elements[8];
+        UINT size = 0;
+        get_layout_elements(layout, elements, &size);
+        return size;
+    }
+
+    HRESULT create_input_layout(ID3D11Device *device, LayoutDesc layout, void const *shader_code, SIZE_T shader_code_size, ID3D11InputLayout **out_layout)
+    {
+        D3D11_INPUT_ELEMENT_DESC elements[8];
+        UINT count = get_layout_elements(layout, elements, nullptr);
+        return device->CreateInputLayout(elements, count, shader_code, shader_code_size, out_layout);
+    }
+
+    ID3D11InputLayout *find_input_layout(ID3D11Device *device, LayoutDesc layout, void const *shader_code, SIZE_T shader_code_size, InputLayoutTable &layouts)
+    {
+        auto found = layouts.find(layout.key);
+        if (found != layouts.end())
+        {
+            return found->second;
+        }
+
+        ID3D11InputLayout *input_layout = nullptr;
+        HRESULT hr = create_input_layout(device, layout, shader_code, shader_code_size, &input_layout);
+        _ASSERT(SUCCEEDED(hr));
+        (void)hr;
+        layouts[layout.key] = input_layout;
+        return input_layout;
+    }
+
     HRESULT load_texture(ID3D11Device *device, wchar_t const *filename, ID3D11ShaderResourceView **out_srv)
     {
         WCHAR str[MAX_PATH];
@@ -66,18 +188,20 @@ namespace Scene
         return hr;
     }
 
-    HRESULT load_model(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, std::vector<RenderObject *> &out_objects)
+    HRESULT load_model(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, bool quantized_layout, std::vector<RenderObject *> &out_objects)
 
     {
-        out_objects.push_back(new RenderObject(device, num_faces, indices, num_vertices, vertices, normals, texture_coords, diffuse_texture_filename, normal_texture_filename));
+        out_objects.push_back(new RenderObject(device, num_faces, indices, num_vertices, vertices, normals, texture_coords, diffuse_texture_filename, normal_texture_filename, quantized_layout));
 
         return S_OK;
     }
 
-    RenderObject::RenderObject(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename)
+    RenderObject::RenderObject(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, bool quantized_layout)
     {
         HRESULT hr;
 
+        memset(&this->material, 0, sizeof(this->material));
+
         this->idx_count = num_faces * 3;
 
         this->idx_offset = 0;
@@ -86,13 +210,6 @@ namespace Scene
 
         UINT idx_buffer_size = idx_size * this->idx_count;
 
-        UINT *source_indices = new UINT[this->idx_count];
-
-        for (UINT idx_idx = 0; idx_idx < this->idx_count; ++idx_idx)
-        {
-            source_indices[idx_idx] = indices[idx_idx];
-        }
-
         D3D11_BUFFER_DESC ib_desc = {
 
             idx_buffer_size, // Byte Width
@@ -111,7 +228,7 @@ namespace Scene
 
         D3D11_SUBRESOURCE_DATA ib_data = {
 
-            (void *)source_indices, // Source Data
+            (void *)indices, // Source Data, uploaded in place (a mapped mesh pack or the caller's array)
 
             0, // Line Pitch
 
@@ -121,8 +238,6 @@ namespace Scene
 
         device->CreateBuffer(&ib_desc, &ib_data, &this->idx_buffer);
 
-        delete[] source_indices;
-
         this->vtx_count = num_vertices;
 
         this->vtx_offset = 0;
@@ -131,29 +246,66 @@ namespace Scene
 
         UINT source_strides[MAX_VTX_BUFFERS];
 
-        source_data[0] = (void *)vertices;
+        std::vector<QuantizedVertex> quantized_vertices;
+
+        this->vtx_layout.key = 0;
+
+        this->vtx_layout.desc.tc_count = 1;
+
+        this->vtx_layout.desc.tc0 = VTXLAYOUTDESC_TEXCOORD_FLOAT2;
 
-        source_strides[0] = sizeof(float) * 3U;
+        if (quantized_layout)
+        {
+            // One interleaved stream of QuantizedVertex, decoded by vs_scene_quantized.hlsl
+            MeshStreams mesh = {num_faces, indices, num_vertices, vertices, normals, texture_coords};
 
-        source_data[1] = (void *)normals;
+            this->position_quantization = compute_position_quantization(vertices, num_vertices);
 
-        source_strides[1] = sizeof(float) * 3U;
+            quantized_vertices.resize(num_vertices);
 
-        source_data[2] = (void *)texture_coords;
+            quantize_vertices(mesh, this->position_quantization, quantized_vertices.data());
 
-        source_strides[2] = sizeof(float) * 2U;
+            source_data[0] = (void *)quantized_vertices.data();
 
-        this->vtx_layout.key = 0;
+            source_strides[0] = sizeof(QuantizedVertex);
 
-        this->vtx_layout.desc.position = VTXLAYOUTDESC_POSITION_FLOAT3;
+            this->vtx_layout.desc.position = VTXLAYOUTDESC_POSITION_UNORM16X4;
 
-        this->vtx_layout.desc.normal = VTXLAYOUTDESC_NBT_FLOAT3;
+            this->vtx_layout.desc.normal = VTXLAYOUTDESC_NBT_OCT_SNORM16;
 
-        this->vtx_layout.desc.tc_count = 1;
+            this->vtx_layout.desc.tc_half = 1;
 
-        this->vtx_layout.desc.tc0 = VTXLAYOUTDESC_TEXCOORD_FLOAT2;
+            this->vtx_layout.desc.interleaved = 1;
 
-        this->vtx_buffer_count = 3;
+            this->vtx_buffer_count = 1;
+        }
+        else
+        {
+            for (UINT axis = 0; axis < 3; ++axis)
+            {
+                this->position_quantization.scale[axis] = 1.0f;
+
+                this->position_quantization.bias[axis] = 0.0f;
+            }
+
+            source_data[0] = (void *)vertices;
+
+            source_strides[0] = sizeof(float) * 3U;
+
+            source_data[1] = (void *)normals;
+
+            source_strides[1] = sizeof(float) * 3U;
+
+            source_data[2] = (void *)texture_coords;
+
+            source_strides[2] = sizeof(float) * 2U;
+
+            this->vtx_layout.desc.position = VTXLAYOUTDESC_POSITION_FLOAT3;
+
+            this->vtx_layout.desc.normal = VTXLAYOUTDESC_NBT_FLOAT3;
+
+            this->vtx_buffer_count = 3;
+        }
 
         for (UINT idx = 0; idx < MAX_VTX_BUFFERS; ++idx)
         {
@@ -206,7 +358,7 @@ namespace Scene
 
             _ASSERT(SUCCEEDED(hr));
 
-            this->material_properties[Scene::DIFFUSE_TEX] = (void *)srv;
+            this->material.srvs[Scene::DIFFUSE_TEX] = srv;
         }
 
         {
@@ -216,7 +368,7 @@ namespace Scene
 
             _ASSERT(SUCCEEDED(hr));
 
-            this->material_properties[Scene::NORMAL_TEX] = (void *)srv;
+            this->material.srvs[Scene::NORMAL_TEX] = srv;
         }
     }
 
@@ -238,37 +390,213 @@ namespace Scene
             }
         }
 
-        for (auto prop = this->material_properties.begin(); prop != this->material_properties.end(); ++prop)
+        for (int i = 0; i < PROPERTY_COUNT; ++i)
 
         {
 
-            ID3D11ShaderResourceView *srv = (ID3D11ShaderResourceView *)(*prop).second;
-
-            SAFE_RELEASE(srv);
+            SAFE_RELEASE(this->material.srvs[i]);
         }
     }
 
+    void RenderObject::bind(ID3D11DeviceContext *ctx) const
+    {
+        ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        this->bind_geometry(ctx);
+        ctx->PSSetShaderResources(0, PROPERTY_COUNT, this->material.srvs);
+    }
+
+    void RenderObject::bind_geometry(ID3D11DeviceContext *ctx) const
+    {
+        ctx->IASetVertexBuffers(0, this->vtx_buffer_count, this->vtx_buffers, this->vtx_strides, this->vtx_offsets);
+        ctx->IASetIndexBuffer(this->idx_buffer, DXGI_FORMAT_R32_UINT, this->idx_offset);
+    }
+
+    DrawItem RenderObject::get_draw_item(uint32_t geometry) const
+    {
+        DrawItem item;
+        item.layout_key = this->vtx_layout.key;
+        item.shader = 0;
+        item.material = 0;
+        item.geometry = geometry;
+        item.object_constants = 0;
+        item.instance_data = RENDER_QUEUE_NONE;
+        item.index_count = this->idx_count;
+        item.first_index = this->idx_offset;
+        item.base_vertex = (int32_t)this->vtx_offset;
+        item.instance_count = 0;
+        item.depth = 0.0f;
+        return item;
+    }
+
     void RenderObject::render(ID3D11DeviceContext *ctx)
+    {
+        this->bind(ctx);
+        ctx->DrawIndexed(this->idx_count, this->idx_offset, this->vtx_offset);
+    }
 
+    void RenderObject::render_instanced(ID3D11DeviceContext *ctx, ID3D11ShaderResourceView *instances, UINT instance_count)
     {
+        this->bind(ctx);
+        ctx->VSSetShaderResources(0, 1, &instances);
+        ctx->DrawIndexedInstanced(this->idx_count, instance_count, this->idx_offset, this->vtx_offset, 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    D3D11CommandBackend::D3D11CommandBackend(ID3D11DeviceContext *ctx, InputLayoutTable const &layouts)
+        : context(ctx), layouts(layouts)
+    {
         ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    }
 
-        ctx->IASetVertexBuffers(0, this->vtx_buffer_count, this->vtx_buffers, this->vtx_strides, this->vtx_offsets);
+    uint32_t D3D11CommandBackend::add_vertex_shader(ID3D11VertexShader *shader)
+    {
+        this->shaders.push_back(shader);
+        return (uint32_t)this->shaders.size() - 1;
+    }
 
-        ctx->IASetIndexBuffer(this->idx_buffer, DXGI_FORMAT_R32_UINT, this->idx_offset);
+    uint32_t D3D11CommandBackend::add_material(Material const &material)
+    {
+        for (size_t i = 0; i < this->materials.size(); ++i)
+        {
+            if (memcmp(&this->materials[i], &material, sizeof(material)) == 0)
+            {
+                return (uint32_t)i;
+            }
+        }
+        this->materials.push_back(material);
+        return (uint32_t)this->materials.size() - 1;
+    }
 
-        ID3D11ShaderResourceView *srvs[16];
+    uint32_t D3D11CommandBackend::add_geometry(RenderObject const *object)
+    {
+        this->geometries.push_back(object);
+        return (uint32_t)this->geometries.size() - 1;
+    }
 
-        srvs[0] = (ID3D11ShaderResourceView *)material_properties[Scene::DIFFUSE_TEX];
+    uint32_t D3D11CommandBackend::add_object_constants(ID3D11Buffer *buffer)
+    {
+        this->object_constants.push_back(buffer);
+        return (uint32_t)this->object_constants.size() - 1;
+    }
 
-        srvs[1] = (ID3D11ShaderResourceView *)material_properties[Scene::SPECULAR_TEX];
+    uint32_t D3D11CommandBackend::add_instance_data(ID3D11ShaderResourceView *srv)
+    {
+        this->instance_data.push_back(srv);
+        return (uint32_t)this->instance_data.size() - 1;
+    }
 
-        srvs[2] = (ID3D11ShaderResourceView *)material_properties[Scene::NORMAL_TEX];
+    void D3D11CommandBackend::set_input_layout(uint32_t layout_key)
+    {
+        auto found = this->layouts.find(layout_key);
+        this->context->IASetInputLayout((found != this->layouts.end()) ? found->second : nullptr);
+    }
 
-        ctx->PSSetShaderResources(0, 3, srvs);
+    void D3D11CommandBackend::set_vertex_shader(uint32_t shader)
+    {
+        this->context->VSSetShader(this->shaders[shader], nullptr, 0);
+    }
 
-        ctx->DrawIndexed(this->idx_count, this->idx_offset, this->vtx_offset);
+    void D3D11CommandBackend::set_material(uint32_t material)
+    {
+        this->context->PSSetShaderResources(0, PROPERTY_COUNT, this->materials[material].srvs);
+    }
+
+    void D3D11CommandBackend::set_geometry(uint32_t geometry)
+    {
+        this->geometries[geometry]->bind_geometry(this->context);
+    }
+
+    void D3D11CommandBackend::set_object_constants(uint32_t object_constants)
+    {
+        this->context->VSSetConstantBuffers(1, 1, &this->object_constants[object_constants]);
+    }
+
+    void D3D11CommandBackend::set_instance_data(uint32_t instance_data)
+    {
+        this->context->VSSetShaderResources(0, 1, &this->instance_data[instance_data]);
+    }
+
+    void D3D11CommandBackend::draw(DrawItem const &item)
+    {
+        if (item.instance_count > 0)
+        {
+            this->context->DrawIndexedInstanced(item.index_count, item.instance_count, item.first_index, item.base_vertex, 0);
+        }
+        else
+        {
+            this->context->DrawIndexed(item.index_count, item.first_index, item.base_vertex);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    InstanceBuffer::InstanceBuffer()
+    {
+        this->buffer = nullptr;
+        this->srv = nullptr;
+        this->capacity = 0;
+        this->stride = 0;
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        this->release();
+    }
+
+    void InstanceBuffer::release()
+    {
+        SAFE_RELEASE(this->srv);
+        SAFE_RELEASE(this->buffer);
+        this->capacity = 0;
+        this->stride = 0;
+    }
+
+    void *InstanceBuffer::map(ID3D11Device *device, ID3D11DeviceContext *ctx, UINT count, UINT stride)
+    {
+        if (count > this->capacity || stride != this->stride)
+        {
+            this->release();
+
+            // Half again what is asked for, so that a slowly growing count does not recreate the buffer every frame
+            UINT capacity = std::max(count + count / 2, 64u);
+            D3D11_BUFFER_DESC buffer_desc;
+            buffer_desc.ByteWidth = capacity * stride;
+            buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+            buffer_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            buffer_desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            buffer_desc.StructureByteStride = stride;
+            if (FAILED(device->CreateBuffer(&buffer_desc, nullptr, &this->buffer)))
+            {
+                return nullptr;
+            }
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc;
+            srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+            srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srv_desc.Buffer.FirstElement = 0;
+            srv_desc.Buffer.NumElements = capacity;
+            if (FAILED(device->CreateShaderResourceView(this->buffer, &srv_desc, &this->srv)))
+            {
+                this->release();
+                return nullptr;
+            }
+            this->capacity = capacity;
+            this->stride = stride;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mapped_resource;
+        if (FAILED(ctx->Map(this->buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource)))
+        {
+            return nullptr;
+        }
+        return mapped_resource.pData;
+    }
+
+    void InstanceBuffer::unmap(ID3D11DeviceContext *ctx)
+    {
+        ctx->Unmap(this->buffer, 0);
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
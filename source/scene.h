@@ -33,13 +33,18 @@
 //----------------------------------------------------------------------------------
 #pragma once
 
+#include "render_queue.h"
+#include "vertex_quantization.h"
+
 namespace Scene
 {
     // Vertex formats
     const UINT VTXLAYOUTDESC_POSITION_FLOAT2 = 1;
     const UINT VTXLAYOUTDESC_POSITION_FLOAT3 = 2;
+    const UINT VTXLAYOUTDESC_POSITION_UNORM16X4 = 3; // Over the mesh bounds, see PositionQuantization
     const UINT VTXLAYOUTDESC_NBT_NONE = 0;
     const UINT VTXLAYOUTDESC_NBT_FLOAT3 = 1;
+    const UINT VTXLAYOUTDESC_NBT_OCT_SNORM16 = 2; // Octahedral, two components
     const UINT VTXLAYOUTDESC_TEXCOORD_BYTE1 = 0;
     const UINT VTXLAYOUTDESC_TEXCOORD_BYTE2 = 1;
     const UINT VTXLAYOUTDESC_TEXCOORD_BYTE3 = 2;
@@ -61,6 +66,8 @@ namespace Scene
             UINT tc1 : 3;
             UINT tc2 : 3;
             UINT tc3 : 3;
+            UINT tc_half : 1;     // The FLOAT texture coordinate formats are stored as half floats
+            UINT interleaved : 1; // All elements in vertex buffer 0 instead of one buffer each
         } desc;
         UINT key;
     };
@@ -74,18 +81,55 @@ namespace Scene
         DISPLACEMENT_TEX,
         PROPERTY_COUNT
     };
-    typedef std::map<MaterialProperty, void *> MaterialTable;
+
+    // Pixel shader resources by MaterialProperty, in slot order, so a draw binds them with one call and no lookups
+    struct Material
+    {
+        ID3D11ShaderResourceView *srvs[PROPERTY_COUNT];
+    };
+
+    // Input layouts by LayoutDesc::key
+    typedef std::map<UINT, ID3D11InputLayout *> InputLayoutTable;
+
+    // Bytes per vertex of a layout, summed over its buffers
+    UINT get_vertex_size(LayoutDesc layout);
+
+    // Input layout for the elements of layout (POSITION, NORMAL, TANGENT, BINORMAL, TEXCOORDn) against a vertex shader
+    HRESULT create_input_layout(ID3D11Device *device, LayoutDesc layout, void const *shader_code, SIZE_T shader_code_size, ID3D11InputLayout **out_layout);
+
+    // The layout from the table, created on first use; the table keeps the reference
+    ID3D11InputLayout *find_input_layout(ID3D11Device *device, LayoutDesc layout, void const *shader_code, SIZE_T shader_code_size, InputLayoutTable &layouts);
 
     class RenderObject
     {
     public:
-        RenderObject(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename);
+        // quantized_layout selects the single-stream QuantizedVertex layout over the three float streams
+        RenderObject(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, bool quantized_layout);
         virtual ~RenderObject();
         void render(ID3D11DeviceContext *context);
 
+        // instance_count copies in one DrawIndexedInstanced, with the per-instance data bound to VS t0
+        void render_instanced(ID3D11DeviceContext *context, ID3D11ShaderResourceView *instances, UINT instance_count);
+
+        // Vertex and index buffers only, for D3D11CommandBackend
+        void bind_geometry(ID3D11DeviceContext *context) const;
+
+        // A DrawItem of this object's geometry and draw arguments; the other handles are left to the caller
+        DrawItem get_draw_item(uint32_t geometry) const;
+
+        Material const &get_material() const { return this->material; }
+        LayoutDesc get_layout() const { return this->vtx_layout; }
+        UINT get_vertex_buffer_size() const { return get_vertex_size(this->vtx_layout) * this->vtx_count; }
+
+        // Identity for the float layout
+        PositionQuantization const &get_position_quantization() const { return this->position_quantization; }
+
     private:
+        // Topology, vertex and index buffers, and the material SRVs
+        void bind(ID3D11DeviceContext *context) const;
+
         static const int MAX_VTX_BUFFERS = 16;
-        MaterialTable material_properties;
+        Material material;
 
         UINT vtx_count;
         UINT vtx_offset;
@@ -93,6 +137,7 @@ namespace Scene
         UINT idx_offset;
 
         LayoutDesc vtx_layout;
+        PositionQuantization position_quantization;
         UINT vtx_buffer_count;
         UINT vtx_strides[MAX_VTX_BUFFERS];
         UINT vtx_offsets[MAX_VTX_BUFFERS];
@@ -103,6 +148,61 @@ namespace Scene
 
     typedef std::vector<RenderObject *> RenderList;
 
+    // RenderQueue backend issuing the draws on a D3D11 context. Handles index the tables filled through the add_
+    // functions; the camera constants (b0), pixel shader and output state are left to the caller. Every draw is a
+    // triangle list, set once at construction.
+    class D3D11CommandBackend : public CommandBackend
+    {
+    public:
+        D3D11CommandBackend(ID3D11DeviceContext *context, InputLayoutTable const &layouts);
+
+        uint32_t add_vertex_shader(ID3D11VertexShader *shader);
+        uint32_t add_material(Material const &material); // Equal materials share a handle
+        uint32_t add_geometry(RenderObject const *object);
+        uint32_t add_object_constants(ID3D11Buffer *buffer);
+        uint32_t add_instance_data(ID3D11ShaderResourceView *srv);
+
+        virtual void set_input_layout(uint32_t layout_key);
+        virtual void set_vertex_shader(uint32_t shader);
+        virtual void set_material(uint32_t material);
+        virtual void set_geometry(uint32_t geometry);
+        virtual void set_object_constants(uint32_t object_constants);
+        virtual void set_instance_data(uint32_t instance_data);
+        virtual void draw(DrawItem const &item);
+
+    private:
+        ID3D11DeviceContext *context;
+        InputLayoutTable const &layouts;
+        std::vector<ID3D11VertexShader *> shaders;
+        std::vector<Material> materials;
+        std::vector<RenderObject const *> geometries;
+        std::vector<ID3D11Buffer *> object_constants;
+        std::vector<ID3D11ShaderResourceView *> instance_data;
+    };
+
+    // Dynamic structured buffer of per-instance data behind a shader resource view, rewritten with one
+    // D3D11_MAP_WRITE_DISCARD per frame
+    class InstanceBuffer
+    {
+    public:
+        InstanceBuffer();
+        ~InstanceBuffer();
+
+        // Grows the buffer to hold count elements of stride bytes if needed and maps it for writing; nullptr on failure
+        void *map(ID3D11Device *device, ID3D11DeviceContext *context, UINT count, UINT stride);
+        void unmap(ID3D11DeviceContext *context);
+        void release();
+
+        ID3D11ShaderResourceView *get_srv() const { return this->srv; }
+        UINT get_capacity() const { return this->capacity; }
+
+    private:
+        ID3D11Buffer *buffer;
+        ID3D11ShaderResourceView *srv;
+        UINT capacity;
+        UINT stride;
+    };
+
     HRESULT load_texture(ID3D11Device *device, wchar_t const *filename, ID3D11ShaderResourceView **out_srv);
-    HRESULT load_model(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, RenderList &out_objects);
+    HRESULT load_model(ID3D11Device *device, unsigned int num_faces, unsigned int const *indices, unsigned int num_vertices, float const *vertices, float const *normals, float const *texture_coords, wchar_t const *diffuse_texture_filename, wchar_t const *normal_texture_filename, bool quantized_layout, RenderList &out_objects);
 };
\ No newline at end of file
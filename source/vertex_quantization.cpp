@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/vertex_quantization.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#include "vertex_quantization.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+    const float UNORM16_MAX = 65535.0f;
+    const float SNORM16_MAX = 32767.0f;
+
+    float sign_not_zero(float v)
+    {
+        return (v >= 0.0f) ? 1.0f : -1.0f;
+    }
+
+    // D3D FLOAT -> UNORM and SNORM conversions (saturate, scale and round to nearest)
+    uint16_t float_to_unorm16(float v)
+    {
+        return uint16_t(std::min(std::max(v, 0.0f), 1.0f) * UNORM16_MAX + 0.5f);
+    }
+
+    int16_t float_to_snorm16(float v)
+    {
+        return int16_t(floorf(std::min(std::max(v, -1.0f), 1.0f) * SNORM16_MAX + 0.5f));
+    }
+
+    float snorm16_to_float(int16_t v)
+    {
+        return std::max(float(v) / SNORM16_MAX, -1.0f);
+    }
+}
+
+namespace Scene
+{
+    PositionQuantization compute_position_quantization(float const *vertices, uint32_t num_vertices)
+    {
+        PositionQuantization quantization;
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            float low = (num_vertices > 0) ? vertices[axis] : 0.0f;
+            float high = low;
+            for (uint32_t vertex = 1; vertex < num_vertices; ++vertex)
+            {
+                low = std::min(low, vertices[3 * vertex + axis]);
+                high = std::max(high, vertices[3 * vertex + axis]);
+            }
+            quantization.scale[axis] = high - low;
+            quantization.bias[axis] = low;
+        }
+        return quantization;
+    }
+
+    void encode_octahedral(float const normal[3], float out[2])
+    {
+        float l1 = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+        float x = (l1 > 0.0f) ? normal[0] / l1 : 0.0f;
+        float y = (l1 > 0.0f) ? normal[1] / l1 : 0.0f;
+        if (normal[2] < 0.0f)
+        {
+            // Fold the lower hemisphere over the diagonals
+            float folded_x = (1.0f - fabsf(y)) * sign_not_zero(x);
+            float folded_y = (1.0f - fabsf(x)) * sign_not_zero(y);
+            x = folded_x;
+            y = folded_y;
+        }
+        out[0] = x;
+        out[1] = y;
+    }
+
+    void decode_octahedral(float const encoded[2], float out[3])
+    {
+        float x = encoded[0];
+        float y = encoded[1];
+        float z = 1.0f - fabsf(x) - fabsf(y);
+        float t = std::max(-z, 0.0f);
+        x += (x >= 0.0f) ? -t : t;
+        y += (y >= 0.0f) ? -t : t;
+        float length = sqrtf(x * x + y * y + z * z);
+        out[0] = x / length;
+        out[1] = y / length;
+        out[2] = z / length;
+    }
+
+    uint16_t float_to_half(float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+        if (magnitude >= 0x7F800000u)
+        {
+            // Infinity stays infinity, NaN stays a quiet NaN
+            return uint16_t(sign | 0x7C00u | ((magnitude > 0x7F800000u) ? 0x0200u : 0u));
+        }
+        if (magnitude >= 0x477FF000u)
+        {
+            // Rounds past 65504
+            return uint16_t(sign | 0x7C00u);
+        }
+        if (magnitude >= 0x38800000u)
+        {
+            // Normal range: rebias the exponent and round the 13 dropped mantissa bits to nearest even
+            magnitude += 0xC8000FFFu + ((magnitude >> 13) & 1u);
+            return uint16_t(sign | (magnitude >> 13));
+        }
+        // Subnormal range: fixed step of 2^-24
+        float scaled;
+        memcpy(&scaled, &magnitude, sizeof(scaled));
+        return uint16_t(sign | uint32_t(nearbyintf(ldexpf(scaled, 24))));
+    }
+
+    float half_to_float(uint16_t h)
+    {
+        uint32_t sign = uint32_t(h & 0x8000u) << 16;
+        uint32_t exponent = (h >> 10) & 0x1Fu;
+        uint32_t mantissa = h & 0x3FFu;
+        float result;
+        if (exponent == 0)
+        {
+            result = ldexpf(float(mantissa), -24);
+            uint32_t bits;
+            memcpy(&bits, &result, sizeof(bits));
+            bits |= sign;
+            memcpy(&result, &bits, sizeof(bits));
+            return result;
+        }
+        uint32_t bits = sign | ((exponent == 0x1Fu) ? (0x7F800000u | (mantissa << 13)) : (((exponent + 112u) << 23) | (mantissa << 13)));
+        memcpy(&result, &bits, sizeof(bits));
+        return result;
+    }
+
+    void quantize_vertices(MeshStreams const &mesh, PositionQuantization const &quantization, QuantizedVertex *out)
+    {
+        for (uint32_t vertex = 0; vertex < mesh.num_vertices; ++vertex)
+        {
+            QuantizedVertex &q = out[vertex];
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                float scale = quantization.scale[axis];
+                float unorm = (scale > 0.0f) ? (mesh.vertices[3 * vertex + axis] - quantization.bias[axis]) / scale : 0.0f;
+                q.position[axis] = float_to_unorm16(unorm);
+            }
+            q.position[3] = 0;
+
+            float encoded[2];
+            encode_octahedral(&mesh.normals[3 * vertex], encoded);
+            q.normal[0] = float_to_snorm16(encoded[0]);
+            q.normal[1] = float_to_snorm16(encoded[1]);
+
+            q.texture_coord[0] = float_to_half(mesh.texture_coords[2 * vertex + 0]);
+            q.texture_coord[1] = float_to_half(mesh.texture_coords[2 * vertex + 1]);
+        }
+    }
+
+    void dequantize_vertices(QuantizedVertex const *vertices, uint32_t num_vertices, PositionQuantization const &quantization, float *out_vertices, float *out_normals, float *out_texture_coords)
+    {
+        for (uint32_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            QuantizedVertex const &q = vertices[vertex];
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                out_vertices[3 * vertex + axis] = float(q.position[axis]) / UNORM16_MAX * quantization.scale[axis] + quantization.bias[axis];
+            }
+
+            float encoded[2] = {snorm16_to_float(q.normal[0]), snorm16_to_float(q.normal[1])};
+            decode_octahedral(encoded, &out_normals[3 * vertex]);
+
+            out_texture_coords[2 * vertex + 0] = half_to_float(q.texture_coord[0]);
+            out_texture_coords[2 * vertex + 1] = half_to_float(q.texture_coord[1]);
+        }
+    }
+}
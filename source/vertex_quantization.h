@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\src/vertex_quantization.h
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include "mesh_pack.h"
+
+// Interleaved, quantized vertex format of RenderObject (VTXLAYOUTDESC_POSITION_UNORM16X4, VTXLAYOUTDESC_NBT_OCT_SNORM16
+// and half-float texture coordinates in one stream): 16 bytes per vertex instead of 32 across three streams. The
+// encoders and decoders follow the D3D conversion rules of the formats, so the CPU decode matches what the input
+// assembler hands vs_scene_quantized.hlsl.
+
+namespace Scene
+{
+    struct QuantizedVertex
+    {
+        uint16_t position[4];      // R16G16B16A16_UNORM over the mesh bounds; w is padding
+        int16_t normal[2];         // R16G16_SNORM, octahedral
+        uint16_t texture_coord[2]; // R16G16_FLOAT
+    };
+
+    // Maps the UNORM position back to the mesh's space: position = unorm * scale + bias (c_position_scale/_bias)
+    struct PositionQuantization
+    {
+        float scale[3];
+        float bias[3];
+    };
+
+    // Bounds of the vertices; an axis with no extent gets a zero scale
+    PositionQuantization compute_position_quantization(float const *vertices, uint32_t num_vertices);
+
+    // Octahedral mapping of a unit vector to [-1, 1]^2, and back (normalized)
+    void encode_octahedral(float const normal[3], float out[2]);
+    void decode_octahedral(float const encoded[2], float out[3]);
+
+    // D3D FLOAT32 <-> FLOAT16 conversions (round to nearest even)
+    uint16_t float_to_half(float v);
+    float half_to_float(uint16_t h);
+
+    void quantize_vertices(MeshStreams const &mesh, PositionQuantization const &quantization, QuantizedVertex *out);
+
+    // CPU decode for the software rasterizer: num_vertices vertices to xyz positions, xyz normals and uv
+    void dequantize_vertices(QuantizedVertex const *vertices, uint32_t num_vertices, PositionQuantization const &quantization, float *out_vertices, float *out_normals, float *out_texture_coords);
+}
@@ -0,0 +1,567 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\tests/cpu_blur_tests.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+// Checks of the portable code that fail the build's ctest run instead of only showing up in the benchmark output.
+// Each check prints what differs and the process exits with 1 if any failed.
+//
+// Usage: cpu_blur_tests
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "benchmark.h"
+#include "fused_tile_max.h"
+#include "incremental_tiles.h"
+#include "reconstruction.h"
+#include "separable_tile_max.h"
+#include "simd_gather.h"
+#include "../source/render_queue.h"
+
+namespace
+{
+    uint32_t g_failures = 0;
+
+#define CHECK(condition)                                                                    \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                                   \
+        }                                                                                   \
+    } while (0)
+
+    float get_max_color_difference(CPUBlur::ColorImage const &a, CPUBlur::ColorImage const &b)
+    {
+        float max_difference = 0.0f;
+        for (uint32_t y = 0; y < a.get_height(); ++y)
+        {
+            for (uint32_t x = 0; x < a.get_width(); ++x)
+            {
+                CPUBlur::Float4 const &p = a.at(x, y);
+                CPUBlur::Float4 const &q = b.at(x, y);
+                max_difference = std::max(max_difference, std::max(fabsf(p.x - q.x), std::max(fabsf(p.y - q.y), fabsf(p.z - q.z))));
+            }
+        }
+        return max_difference;
+    }
+
+    // Every SIMD gather kernel the CPU supports returns the scalar gather's colors bit for bit. The kernels specialized
+    // for S round their precomputed tap offsets differently, so they only match up to SPECIALIZED_TOLERANCE.
+    void test_simd_gather_matches_scalar()
+    {
+        const float SPECIALIZED_TOLERANCE = 1e-5f;
+        const uint32_t width = 320;
+        const uint32_t height = 180;
+        CPUBlur::ThreadPool pool;
+        CPUBlur::TestFrame frame;
+        CPUBlur::make_test_frame(width, height, frame);
+
+        CPUBlur::Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 20;
+        params.S = 15;
+        params.max_sample_tap_distance = float(CPUBlur::compute_max_sample_tap_distance(height));
+        params.jitter_source = CPUBlur::JITTER_RANDOM_TEXTURE;
+
+        uint32_t tile_width, tile_height;
+        CPUBlur::compute_tiled_dimensions(width, height, params.K, tile_width, tile_height);
+        CPUBlur::VelocityImage tile_max_buffer(tile_width, tile_height);
+        CPUBlur::VelocityImage neighbor_max_buffer(tile_width, tile_height);
+        CPUBlur::RandomImage random(tile_width, tile_height);
+        CPUBlur::tile_max(frame.velocity, params.K, tile_max_buffer, pool);
+        CPUBlur::neighbor_max(tile_max_buffer, neighbor_max_buffer, pool);
+        CPUBlur::fill_random(random, 0);
+
+        CPUBlur::Inputs inputs = {&frame.color, &frame.depth, &frame.velocity, &neighbor_max_buffer, &random, nullptr};
+        CPUBlur::ColorImage reference(width, height);
+        CPUBlur::ColorImage result(width, height);
+        CPUBlur::gather(inputs, params, reference, pool);
+
+        CPUBlur::SimdLevel supported = CPUBlur::detect_simd_level();
+        for (uint32_t level = CPUBlur::SIMD_LEVEL_SCALAR; level <= uint32_t(supported); ++level)
+        {
+            char const *name = CPUBlur::get_simd_level_name(CPUBlur::SimdLevel(level));
+
+            CPUBlur::gather_simd(inputs, params, result, pool, CPUBlur::SimdLevel(level), false);
+            float generic_difference = get_max_color_difference(reference, result);
+            if (generic_difference != 0.0f)
+            {
+                fprintf(stderr, "%s gather differs from the scalar gather by up to %g\n", name, generic_difference);
+            }
+            CHECK(generic_difference == 0.0f);
+
+            CPUBlur::gather_simd(inputs, params, result, pool, CPUBlur::SimdLevel(level), true);
+            float specialized_difference = get_max_color_difference(reference, result);
+            if (specialized_difference > SPECIALIZED_TOLERANCE)
+            {
+                fprintf(stderr, "%s gather specialized for S=%u differs from the scalar gather by up to %g\n", name, params.S, specialized_difference);
+            }
+            CHECK(specialized_difference <= SPECIALIZED_TOLERANCE);
+        }
+    }
+
+    // Records the order of the draws, by the index each DrawItem carries in first_index
+    class DrawOrderBackend : public Scene::RecordingBackend
+    {
+    public:
+        virtual void draw(Scene::DrawItem const &item)
+        {
+            this->order.push_back(item.first_index);
+            Scene::RecordingBackend::draw(item);
+        }
+
+        std::vector<uint32_t> order;
+    };
+
+    Scene::DrawItem make_draw_item(uint32_t index, uint32_t layout_key, uint32_t shader, uint32_t material, uint32_t geometry, uint32_t instance_data, float depth)
+    {
+        Scene::DrawItem item;
+        item.layout_key = layout_key;
+        item.shader = shader;
+        item.material = material;
+        item.geometry = geometry;
+        item.object_constants = index;
+        item.instance_data = instance_data;
+        item.index_count = 3;
+        item.first_index = index;
+        item.base_vertex = 0;
+        item.instance_count = (instance_data != Scene::RENDER_QUEUE_NONE) ? 4 : 0;
+        item.depth = depth;
+        return item;
+    }
+
+    // Five draws over two layouts, two of them instanced, submitted in push order and then sorted
+    void test_render_queue_state_changes()
+    {
+        const uint32_t NONE = Scene::RENDER_QUEUE_NONE;
+        Scene::RenderQueue queue;
+        queue.push(make_draw_item(0, 0x100, 0, 1, 0, NONE, 5.0f));
+        queue.push(make_draw_item(1, 0x200, 1, 2, 1, 0, 3.0f));
+        queue.push(make_draw_item(2, 0x100, 0, 0, 0, NONE, 2.0f));
+        queue.push(make_draw_item(3, 0x100, 0, 1, 0, NONE, 1.0f));
+        queue.push(make_draw_item(4, 0x200, 1, 2, 1, 1, 4.0f));
+
+        // In push order only draw 3 keeps part of the state (layout, shader and geometry of draw 2)
+        DrawOrderBackend unsorted_backend;
+        Scene::RenderQueueStats unsorted = queue.submit(unsorted_backend);
+        CHECK(unsorted_backend.check_bound_state());
+        CHECK((unsorted_backend.order == std::vector<uint32_t>{0, 1, 2, 3, 4}));
+        CHECK(unsorted.draw_count == 5);
+        CHECK(unsorted.layout_changes == 4);
+        CHECK(unsorted.shader_changes == 4);
+        CHECK(unsorted.material_changes == 5);
+        CHECK(unsorted.geometry_changes == 4);
+        CHECK(unsorted.constant_changes == 5);
+        CHECK(unsorted.instance_changes == 2);
+        CHECK(unsorted.skipped_bindings == 3); // 3 x 5 + 2 x 6 bindings, 24 changes
+        CHECK(unsorted_backend.get_command_count(Scene::RecordingBackend::COMMAND_INPUT_LAYOUT) == 4);
+        CHECK(unsorted_backend.get_command_count(Scene::RecordingBackend::COMMAND_MATERIAL) == 5);
+        CHECK(unsorted_backend.get_command_count(Scene::RecordingBackend::COMMAND_DRAW) == 5);
+
+        // Sorted by layout, shader, material, geometry and then front to back
+        queue.sort();
+        DrawOrderBackend sorted_backend;
+        Scene::RenderQueueStats sorted = queue.submit(sorted_backend);
+        CHECK(sorted_backend.check_bound_state());
+        CHECK((sorted_backend.order == std::vector<uint32_t>{2, 3, 0, 1, 4}));
+        CHECK(sorted.draw_count == 5);
+        CHECK(sorted.layout_changes == 2);
+        CHECK(sorted.shader_changes == 2);
+        CHECK(sorted.material_changes == 3);
+        CHECK(sorted.geometry_changes == 2);
+        CHECK(sorted.constant_changes == 5);
+        CHECK(sorted.instance_changes == 2);
+        CHECK(sorted.skipped_bindings == 11);
+        CHECK(sorted_backend.get_command_count(Scene::RecordingBackend::COMMAND_INPUT_LAYOUT) == 2);
+        CHECK(sorted_backend.get_command_count(Scene::RecordingBackend::COMMAND_INSTANCE_DATA) == 2);
+
+        // A push after the sort falls back to push order
+        queue.push(make_draw_item(5, 0x100, 0, 0, 0, NONE, 0.0f));
+        DrawOrderBackend pushed_backend;
+        queue.submit(pushed_backend);
+        CHECK(pushed_backend.check_bound_state());
+        CHECK((pushed_backend.order == std::vector<uint32_t>{0, 1, 2, 3, 4, 5}));
+    }
+
+    // The radix sort orders keys as std::stable_sort does, equal keys included, for sizes that skip different passes
+    void test_radix_sort_matches_stable_sort()
+    {
+        uint32_t state = 0x2545f491u;
+        auto next = [&state](uint32_t range) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state % range;
+        };
+
+        const uint32_t sizes[] = {0, 1, 2, 17, 1000, 20000};
+        for (uint32_t count : sizes)
+        {
+            // Few distinct states and depths, so many keys are equal and many bytes are shared
+            std::vector<uint64_t> keys(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Scene::DrawItem item = make_draw_item(i, 0, next(4), next(32), next(256), Scene::RENDER_QUEUE_NONE, float(next(64)));
+                keys[i] = Scene::make_sort_key(next(2), item);
+            }
+
+            std::vector<uint32_t> reference_order(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                reference_order[i] = i;
+            }
+            std::stable_sort(reference_order.begin(), reference_order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+            std::vector<uint64_t> sorted_keys = keys;
+            std::vector<uint32_t> order;
+            Scene::radix_sort(sorted_keys, order);
+            CHECK(order == reference_order);
+
+            bool keys_sorted = (sorted_keys.size() == count);
+            for (uint32_t i = 0; keys_sorted && i < count; ++i)
+            {
+                keys_sorted = (sorted_keys[i] == keys[reference_order[i]]);
+            }
+            CHECK(keys_sorted);
+        }
+    }
+
+    // parallel_tasks' makespan is when the last thread finished: no thread finishes later or is busy longer, and the
+    // call returns after it
+    void test_task_stats_makespan()
+    {
+        CPUBlur::ThreadPool pool(4);
+        std::vector<uint32_t> tasks;
+        for (uint32_t task = 0; task < 32; ++task)
+        {
+            tasks.push_back(32 - task);
+        }
+        std::vector<float> results(tasks.size() + 1, 0.0f);
+        CPUBlur::TaskStats stats;
+        pool.parallel_tasks(tasks, [&results](uint32_t task) {
+            float x = 0.0f;
+            for (uint32_t i = 0; i < task * 20000; ++i)
+            {
+                x = x * 0.999f + 1.0f;
+            }
+            results[task] = x;
+        }, &stats);
+
+        CHECK(stats.task_count == 32);
+        CHECK(stats.thread_busy_ms.size() == 4 && stats.thread_finish_ms.size() == 4);
+        CHECK(stats.makespan_ms > 0.0 && stats.makespan_ms <= stats.wall_ms);
+        double latest_finish_ms = 0.0;
+        for (uint32_t thread_index = 0; thread_index < stats.thread_finish_ms.size(); ++thread_index)
+        {
+            CHECK(stats.thread_busy_ms[thread_index] <= stats.thread_finish_ms[thread_index]);
+            latest_finish_ms = std::max(latest_finish_ms, stats.thread_finish_ms[thread_index]);
+        }
+        CHECK(latest_finish_ms == stats.makespan_ms);
+        CHECK(stats.get_utilization() > 0.0 && stats.get_utilization() <= 1.0);
+    }
+
+    // parallel_rows covers every row exactly once, and splits fewer rows than threads one row per band
+    void test_parallel_rows_bands()
+    {
+        CPUBlur::ThreadPool pool(8);
+        const uint32_t row_counts[] = {1, 3, 8, 54, 1080};
+        for (uint32_t row_count : row_counts)
+        {
+            std::mutex mutex;
+            std::vector<uint32_t> row_visits(row_count, 0);
+            uint32_t band_count = 0;
+            uint32_t largest_band = 0;
+            pool.parallel_rows(row_count, [&](uint32_t row_begin, uint32_t row_end) {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (uint32_t row = row_begin; row < row_end; ++row)
+                {
+                    row_visits[row]++;
+                }
+                band_count++;
+                largest_band = std::max(largest_band, row_end - row_begin);
+            });
+
+            CHECK(std::count(row_visits.begin(), row_visits.end(), 1u) == std::ptrdiff_t(row_count));
+            CHECK(band_count == std::min(row_count, pool.get_thread_count()));
+            CHECK(largest_band == (row_count + pool.get_thread_count() - 1) / pool.get_thread_count());
+        }
+    }
+
+    // V where most texels tie in magnitude with others of a different direction: the components of a few texels, in
+    // either order, at random. Every tile then has to break ties, which the separable TileMax must do as the single pass.
+    void make_tied_velocities(uint32_t width, uint32_t height, CPUBlur::VelocityImage &velocity)
+    {
+        const CPUBlur::Unorm8x2 texels[6] = {{200, 90}, {90, 200}, {60, 180}, {180, 60}, {128, 128}, {30, 30}};
+        uint32_t state = 0x2545f491u;
+        velocity.resize(width, height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                velocity.at(x, y) = texels[state % 6];
+            }
+        }
+    }
+
+    // Separable and single-pass TileMax give the same texels, ties included, for every K of the slider
+    void test_separable_tile_max_matches_single_pass()
+    {
+        const uint32_t width = 333;
+        const uint32_t height = 187;
+        CPUBlur::ThreadPool pool(4);
+        CPUBlur::TestFrame frame;
+        CPUBlur::make_test_frame(width, height, frame);
+        CPUBlur::VelocityImage tied;
+        make_tied_velocities(width, height, tied);
+
+        CPUBlur::VelocityImage const *velocities[2] = {&tied, &frame.velocity};
+        for (uint32_t v = 0; v < 2; ++v)
+        {
+            for (uint32_t K = 1; K <= 20; ++K)
+            {
+                uint32_t tile_width, tile_height;
+                CPUBlur::compute_tiled_dimensions(width, height, K, tile_width, tile_height);
+                CPUBlur::VelocityImage single_pass(tile_width, tile_height);
+                CPUBlur::VelocityImage separable(tile_width, tile_height);
+                CPUBlur::TileMaxCandidateImage horizontal(tile_width, height);
+                CPUBlur::tile_max(*velocities[v], K, single_pass, pool);
+                CPUBlur::tile_max_separable(*velocities[v], K, horizontal, separable, pool);
+
+                bool identical = (memcmp(single_pass.data(), separable.data(), sizeof(CPUBlur::Unorm8x2) * tile_width * tile_height) == 0);
+                if (!identical)
+                {
+                    fprintf(stderr, "separable TileMax differs from the single pass at K=%u on the %s velocities\n", K, v ? "disk" : "tied");
+                }
+                CHECK(identical);
+            }
+        }
+    }
+
+    // Frame of a sequence for the incremental tiles: the disk, with a square of velocity (speed, 0) at object_x
+    void make_moving_square_frame(uint32_t width, uint32_t height, uint32_t object_x, float speed, CPUBlur::VelocityImage &velocity)
+    {
+        CPUBlur::TestFrame frame;
+        CPUBlur::make_test_frame(width, height, frame);
+        velocity = frame.velocity;
+        uint32_t object_size = height / 10;
+        CPUBlur::Float2 object_velocity = {speed, 0.0f};
+        for (uint32_t y = height / 8; y < height / 8 + object_size; ++y)
+        {
+            for (uint32_t x = object_x; x < std::min(object_x + object_size, width); ++x)
+            {
+                velocity.at(x, y) = CPUBlur::write_velocity(object_velocity);
+            }
+        }
+    }
+
+    // IncrementalTiles::update matches the full TileMax and NeighborMax byte for byte over a sequence of frames that
+    // moves an object, leaves a frame unchanged, changes K and resizes, and only recomputes everything on the last two
+    void test_incremental_tiles_match_full_passes()
+    {
+        struct SequenceFrame
+        {
+            uint32_t width, height, K;
+            uint32_t object_x;
+            float speed;
+            bool full_update; // Expected to recompute every tile
+        };
+        const SequenceFrame sequence[] = {
+            {320, 180, 20, 40, 1.0f, true},
+            {320, 180, 20, 48, 1.0f, false},
+            {320, 180, 20, 48, 1.0f, false},
+            {320, 180, 20, 48, 0.5f, false},
+            {320, 180, 10, 56, 0.5f, true},
+            {320, 180, 10, 70, -0.75f, false},
+            {333, 201, 10, 70, -0.75f, true},
+            {333, 201, 10, 90, 1.0f, false},
+            {333, 201, 7, 90, 1.0f, true},
+            {333, 201, 7, 3, 0.25f, false},
+        };
+
+        CPUBlur::ThreadPool pool(3);
+        CPUBlur::IncrementalTiles incremental;
+        CPUBlur::VelocityImage tile_max_buffer, neighbor_max_buffer;
+        for (uint32_t f = 0; f < sizeof(sequence) / sizeof(sequence[0]); ++f)
+        {
+            SequenceFrame const &frame = sequence[f];
+            CPUBlur::VelocityImage velocity;
+            make_moving_square_frame(frame.width, frame.height, frame.object_x, frame.speed, velocity);
+
+            // The caller sizes the tile buffers, keeping their contents while the size stays the same
+            uint32_t tile_width, tile_height;
+            CPUBlur::compute_tiled_dimensions(frame.width, frame.height, frame.K, tile_width, tile_height);
+            if (tile_max_buffer.get_width() != tile_width || tile_max_buffer.get_height() != tile_height)
+            {
+                tile_max_buffer.resize(tile_width, tile_height);
+                neighbor_max_buffer.resize(tile_width, tile_height);
+            }
+            incremental.update(velocity, frame.K, tile_max_buffer, neighbor_max_buffer, pool);
+
+            CPUBlur::VelocityImage full_tile_max(tile_width, tile_height);
+            CPUBlur::VelocityImage full_neighbor_max(tile_width, tile_height);
+            CPUBlur::tile_max(velocity, frame.K, full_tile_max, pool);
+            CPUBlur::neighbor_max(full_tile_max, full_neighbor_max, pool);
+
+            size_t tile_bytes = sizeof(CPUBlur::Unorm8x2) * tile_width * tile_height;
+            bool identical = (memcmp(full_tile_max.data(), tile_max_buffer.data(), tile_bytes) == 0) &&
+                             (memcmp(full_neighbor_max.data(), neighbor_max_buffer.data(), tile_bytes) == 0);
+            if (!identical)
+            {
+                fprintf(stderr, "incremental tiles differ from the full passes at frame %u (%ux%u, K=%u)\n", f, frame.width, frame.height, frame.K);
+            }
+            CHECK(identical);
+
+            CPUBlur::IncrementalTileStats const &stats = incremental.get_stats();
+            CHECK(stats.tile_count == tile_width * tile_height);
+            CHECK((stats.tile_max_recomputed == stats.tile_count) == frame.full_update);
+        }
+    }
+
+    // The fused pass matches tile_max followed by neighbor_max byte for byte, with bands of every size: thread counts
+    // up to more threads than tile rows leave bands of one or two rows, smaller than the three-row window
+    void test_fused_tile_max_matches_two_passes()
+    {
+        struct FusedCase
+        {
+            uint32_t width, height;
+        };
+        const FusedCase cases[] = {{333, 187}, {160, 45}, {97, 30}};
+        const uint32_t tile_sizes[] = {1, 2, 5, 10, 20};
+        const uint32_t thread_counts[] = {1, 2, 3, 7, 16, 64};
+
+        for (FusedCase const &size : cases)
+        {
+            CPUBlur::TestFrame frame;
+            CPUBlur::make_test_frame(size.width, size.height, frame);
+            CPUBlur::VelocityImage tied;
+            make_tied_velocities(size.width, size.height, tied);
+            CPUBlur::VelocityImage const *velocities[2] = {&tied, &frame.velocity};
+
+            for (uint32_t thread_count : thread_counts)
+            {
+                CPUBlur::ThreadPool pool(thread_count);
+                for (uint32_t K : tile_sizes)
+                {
+                    uint32_t tile_width, tile_height;
+                    CPUBlur::compute_tiled_dimensions(size.width, size.height, K, tile_width, tile_height);
+                    for (uint32_t v = 0; v < 2; ++v)
+                    {
+                        CPUBlur::VelocityImage tile_max_buffer(tile_width, tile_height);
+                        CPUBlur::VelocityImage two_pass(tile_width, tile_height);
+                        CPUBlur::VelocityImage fused(tile_width, tile_height);
+                        CPUBlur::tile_max(*velocities[v], K, tile_max_buffer, pool);
+                        CPUBlur::neighbor_max(tile_max_buffer, two_pass, pool);
+                        CPUBlur::tile_max_neighbor_max_fused(*velocities[v], K, fused, pool);
+
+                        bool identical = (memcmp(two_pass.data(), fused.data(), sizeof(CPUBlur::Unorm8x2) * tile_width * tile_height) == 0);
+                        if (!identical)
+                        {
+                            fprintf(stderr, "fused TileMax/NeighborMax differs from the two passes at %ux%u, K=%u, %u threads, %s velocities\n", size.width, size.height,
+                                    K, thread_count, v ? "disk" : "tied");
+                        }
+                        CHECK(identical);
+                    }
+                }
+            }
+        }
+    }
+
+    // Reconstruction gives the plain gather's colors with the fused pass, with tile classification, and with both
+    void test_reconstruction_fused_with_classification()
+    {
+        const uint32_t width = 320;
+        const uint32_t height = 180;
+        CPUBlur::TestFrame frame;
+        CPUBlur::make_test_frame(width, height, frame);
+
+        CPUBlur::Parameters params;
+        params.half_exposure = 0.5f;
+        params.K = 10;
+        params.S = 15;
+        params.max_sample_tap_distance = float(CPUBlur::compute_max_sample_tap_distance(height));
+        params.jitter_source = CPUBlur::JITTER_INTERLEAVED_GRADIENT;
+
+        CPUBlur::ColorImage reference(width, height);
+        CPUBlur::Reconstruction plain(4);
+        plain.set_simd_level(CPUBlur::SIMD_LEVEL_SCALAR);
+        plain.run(frame.color, frame.depth, frame.velocity, params, reference);
+
+        for (uint32_t mode = 1; mode < 4; ++mode)
+        {
+            bool fused = (mode & 1) != 0;
+            bool classification = (mode & 2) != 0;
+            CPUBlur::Reconstruction reconstruction(4);
+            reconstruction.set_simd_level(CPUBlur::SIMD_LEVEL_SCALAR);
+            reconstruction.set_fused_tile_max(fused);
+            reconstruction.set_tile_classification(classification);
+            CPUBlur::ColorImage result(width, height);
+            reconstruction.run(frame.color, frame.depth, frame.velocity, params, result);
+
+            bool identical = (memcmp(reference.data(), result.data(), sizeof(CPUBlur::Float4) * width * height) == 0);
+            if (!identical)
+            {
+                fprintf(stderr, "Reconstruction with%s fused TileMax and with%s tile classification differs from the plain run\n", fused ? "" : "out",
+                        classification ? "" : "out");
+            }
+            CHECK(identical);
+        }
+    }
+}
+
+int main()
+{
+    test_separable_tile_max_matches_single_pass();
+    test_fused_tile_max_matches_two_passes();
+    test_reconstruction_fused_with_classification();
+    test_incremental_tiles_match_full_passes();
+    test_simd_gather_matches_scalar();
+    test_render_queue_state_changes();
+    test_radix_sort_matches_stable_sort();
+    test_task_stats_makespan();
+    test_parallel_rows_bands();
+
+    if (g_failures > 0)
+    {
+        fprintf(stderr, "%u checks failed\n", g_failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\tools/cpu_blur_benchmark.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+// Runs the CPU reconstruction benchmarks without a window or a GPU: the same CPUBlur::run_benchmarks as the sample's
+// -benchmark flag, for build machines and farm nodes. Run from the build directory or the repository so that
+// media/windmill.meshpack is found.
+//
+// Usage: cpu_blur_benchmark [output path, standard output by default]
+
+#include <stdio.h>
+#include "benchmark.h"
+
+int main(int argc, char **argv)
+{
+    FILE *out = stdout;
+    if (argc > 1)
+    {
+#if defined(_WIN32)
+        if (fopen_s(&out, argv[1], "w") != 0)
+        {
+            out = nullptr;
+        }
+#else
+        out = fopen(argv[1], "w");
+#endif
+        if (!out)
+        {
+            fprintf(stderr, "cannot write %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    CPUBlur::run_benchmarks(out);
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
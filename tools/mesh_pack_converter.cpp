@@ -0,0 +1,155 @@
+//----------------------------------------------------------------------------------
+// File:        MotionBlurAdvanced\tools/mesh_pack_converter.cpp
+// SDK Version: v1.2
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+// Writes the meshes compiled into assets/ to a .meshpack, checks that the mapped pack holds the same bytes, and times
+// reading every stream from the compiled-in arrays against opening, mapping and reading the pack. The meshes are
+// welded and reordered for the vertex cache first (mesh_optimizer.h) unless --no-optimize is given.
+//
+// Usage: MeshPackConverter [--no-optimize] [output path, media/windmill.meshpack by default]
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "../source/mesh_optimizer.h"
+#include "../source/mesh_pack.h"
+#include "../assets/house.h"
+#include "../assets/fan.h"
+
+namespace
+{
+    const char *const MESH_NAMES[2] = {"house", "fan"};
+
+    // Reads every byte of the streams, as the upload to the GPU does
+    uint32_t checksum(Scene::MeshStreams const &mesh)
+    {
+        uint32_t sum = 0;
+        for (unsigned int i = 0; i < 3 * mesh.num_faces; ++i)
+        {
+            sum = sum * 31 + mesh.indices[i];
+        }
+        float const *streams[3] = {mesh.vertices, mesh.normals, mesh.texture_coords};
+        unsigned int components[3] = {3, 3, 2};
+        for (unsigned int s = 0; s < 3; ++s)
+        {
+            for (unsigned int i = 0; i < components[s] * mesh.num_vertices; ++i)
+            {
+                uint32_t bits;
+                memcpy(&bits, &streams[s][i], sizeof(bits));
+                sum = sum * 31 + bits;
+            }
+        }
+        return sum;
+    }
+
+    bool same_streams(Scene::MeshStreams const &a, Scene::MeshStreams const &b)
+    {
+        return a.num_faces == b.num_faces && a.num_vertices == b.num_vertices &&
+               memcmp(a.indices, b.indices, sizeof(unsigned int) * 3 * a.num_faces) == 0 &&
+               memcmp(a.vertices, b.vertices, sizeof(float) * 3 * a.num_vertices) == 0 &&
+               memcmp(a.normals, b.normals, sizeof(float) * 3 * a.num_vertices) == 0 &&
+               memcmp(a.texture_coords, b.texture_coords, sizeof(float) * 2 * a.num_vertices) == 0;
+    }
+
+    double milliseconds_since(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool optimize = true;
+    char const *path = "media/windmill.meshpack";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--no-optimize") == 0)
+        {
+            optimize = false;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    Scene::MeshStreams arrays[2] = {{house_num_faces, house_indices, house_num_vertices, house_vertices, house_normals, house_texture_coords},
+                                    {fan_num_faces, fan_indices, fan_num_vertices, fan_vertices, fan_normals, fan_texture_coords}};
+    Scene::MeshStreams meshes[2] = {arrays[0], arrays[1]};
+    Scene::MeshData optimized[2];
+    if (optimize)
+    {
+        printf("Optimized meshes (ACMR with FIFO caches of %u and %u vertices)\n", Scene::MESH_OPTIMIZER_REPORT_CACHE_SIZES[0], Scene::MESH_OPTIMIZER_REPORT_CACHE_SIZES[1]);
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            Scene::MeshOptimizationStats stats;
+            Scene::optimize_mesh(arrays[i], optimized[i], &stats);
+            meshes[i] = optimized[i].get_streams();
+            printf("  %-8s vertices %6u -> %6u (%4.1f%%), ACMR %.3f -> %.3f, %.3f -> %.3f\n", MESH_NAMES[i], stats.num_vertices_before, stats.num_vertices_after,
+                   100.0f * float(stats.num_vertices_after) / float(stats.num_vertices_before), stats.acmr_before[0], stats.acmr_after[0], stats.acmr_before[1], stats.acmr_after[1]);
+        }
+    }
+
+    if (!Scene::write_mesh_pack(path, MESH_NAMES, meshes, 2))
+    {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+
+    // Compiled-in arrays: nothing to load, the streams are paged in from the executable on first use
+    auto start = std::chrono::high_resolution_clock::now();
+    uint32_t array_sum = checksum(arrays[0]) + checksum(arrays[1]);
+    double array_ms = milliseconds_since(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    Scene::MeshPackFile pack;
+    Scene::MeshStreams packed[2];
+    bool opened = pack.open(path) && pack.find_mesh(MESH_NAMES[0], packed[0]) && pack.find_mesh(MESH_NAMES[1], packed[1]);
+    double open_ms = milliseconds_since(start);
+    if (!opened)
+    {
+        fprintf(stderr, "Cannot read back %s\n", path);
+        return 1;
+    }
+    uint32_t pack_sum = checksum(packed[0]) + checksum(packed[1]);
+    double pack_ms = milliseconds_since(start);
+
+    bool identical = same_streams(meshes[0], packed[0]) && same_streams(meshes[1], packed[1]) && (optimize || array_sum == pack_sum);
+    printf("%s: %u meshes, %zu bytes, identical to the %s: %s\n", path, pack.get_mesh_count(), pack.get_size(), optimize ? "optimized meshes" : "arrays", identical ? "yes" : "NO");
+    for (uint32_t i = 0; i < pack.get_mesh_count(); ++i)
+    {
+        Scene::MeshStreams mesh = pack.get_mesh(i);
+        printf("  %-8s %6u faces %6u vertices\n", pack.get_mesh_name(i), mesh.num_faces, mesh.num_vertices);
+    }
+    printf("Reading every stream: compiled-in arrays %.3f ms, pack %.3f ms (open and map %.3f ms)\n", array_ms, pack_ms, open_ms);
+    return identical ? 0 : 1;
+}